@@ -420,6 +420,7 @@ fi
 %exclude %{pbs_prefix}/sbin/pbs_ds_password
 %exclude %{pbs_prefix}/sbin/pbs_ds_password.bin
 %exclude %{pbs_prefix}/sbin/pbs_sched
+%exclude %{pbs_prefix}/sbin/pbs_sched_replay
 %exclude %{pbs_prefix}/sbin/pbs_server
 %exclude %{pbs_prefix}/sbin/pbs_server.bin
 %exclude %{pbs_prefix}/sbin/pbsfs
@@ -460,6 +461,7 @@ fi
 %exclude %{pbs_prefix}/sbin/pbs_mom
 %exclude %{pbs_prefix}/sbin/pbs_rcp
 %exclude %{pbs_prefix}/sbin/pbs_sched
+%exclude %{pbs_prefix}/sbin/pbs_sched_replay
 %exclude %{pbs_prefix}/sbin/pbs_server
 %exclude %{pbs_prefix}/sbin/pbs_server.bin
 %exclude %{pbs_prefix}/sbin/pbs_upgrade_job
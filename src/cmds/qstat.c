@@ -2163,6 +2163,8 @@ main(int argc, char **argv, char **envp) /* qstat */
 	int f_opt, B_opt, Q_opt, p_opt, E_opt;
 	int p_header = TRUE;
 	int stat_single_job = 0;
+	int page_jobs = 0;
+	char *cursor = NULL;
 	int new_remote_server = 0;
 	enum { JOBS, QUEUES, SERVERS } mode;
 	struct batch_status *p_status;
@@ -2743,13 +2745,26 @@ job_no_args:
 					p_server = NULL;
 				}
 
+#ifndef NAS /* localmod 071 */
+				/*
+				 * The jobs of a queue or of the server are listed a page
+				 * at a time, unless they are sorted across pages (-T) or
+				 * the full listing may go to tcl.
+				 */
+				page_jobs = (stat_single_job == 0) && (f_opt == 0) &&
+					!(alt_opt & ALT_DISPLAY_T);
+#endif /* localmod 071 */
 				if ((stat_single_job == 1) || (new_atropl == 0)) {
 					if (E_opt == 1)
 						p_status = pbs_statjob(connect, query_job_list, display_attribs, extend);
+#ifndef NAS /* localmod 071 */
+					else if (page_jobs)
+						p_status = pbs_statjob_page(connect, job_id_out, display_attribs, extend, &cursor);
+#endif /* localmod 071 */
 					else
 						p_status = pbs_statjob(connect, job_id_out, display_attribs, extend);
 				} else {
-					p_status = pbs_selstat(connect, new_atropl, NULL, extend);
+					p_status = pbs_selstat(connect, new_atropl, display_attribs, extend);
 				}
 
 				if (added_queue) {
@@ -2833,9 +2848,33 @@ job_no_args:
 							fprintf(stderr, "qstat: out of memory\n");
 							exit(1);
 						}
+					pbs_statfree(p_status);
+
+					/* print the rest of the pages as they come, under the same header */
+					while (cursor != NULL) {
+						p_status = pbs_statjob_page(connect, job_id_out, display_attribs, extend, &cursor);
+						if (p_status == NULL) {
+							if (pbs_errno != PBSE_NONE) {
+								prt_job_err("qstat", connect, job_id_out);
+								any_failed = pbs_errno;
+							}
+							break;
+						}
+						if (alt_opt != 0)
+							altdsp_statjob(p_status, NULL, alt_opt, wide);
+						else if (display_statjob(p_status, NULL, f_opt, p_opt, alt_opt)) {
+							fprintf(stderr, "qstat: out of memory\n");
+							exit(1);
+						}
+						pbs_statfree(p_status);
+					}
+					free(cursor);
+					cursor = NULL;
 #endif /* localmod 071 */
 					p_header = FALSE;
+#ifdef NAS /* localmod 071 */
 					pbs_statfree(p_status);
+#endif /* localmod 071 */
 				}
 				pbs_statfree(p_server);
 				p_server = NULL;
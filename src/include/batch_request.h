@@ -147,6 +147,13 @@ struct rq_manage {
 	pbs_list_head    rq_attr;	/* svrattrlist */
 };
 
+/* ModifyJobs - a ModifyJob for each of a number of jobs */
+
+struct rq_modifyjobs {
+	int		  rq_count;
+	struct rq_manage *rq_jobs;	/* rq_count entries */
+};
+
 /* HoldJob -  plus preference flag */
 
 struct rq_hold {
@@ -200,6 +207,13 @@ struct rq_runjob {
 	unsigned long rq_resch;
 };
 
+/* RunJobs - an asynchronous RunJob for each of a number of jobs */
+
+struct rq_runjobs {
+	int		  rq_count;
+	struct rq_runjob *rq_jobs;	/* rq_count entries */
+};
+
 
 /* SignalJob */
 
@@ -354,12 +368,14 @@ struct batch_request {
 		struct rq_relnodes	rq_relnodes;
 		struct rq_py_spawn	rq_py_spawn;
 		struct rq_manage	rq_modify;
+		struct rq_modifyjobs	rq_modifyjobs;
 		struct rq_move		rq_move;
 		struct rq_register	rq_register;
 		struct rq_manage	rq_release;
 		char		        rq_rerun[PBS_MAXSVRJOBID+1];
 		struct rq_rescq		rq_rescq;
 		struct rq_runjob        rq_run;
+		struct rq_runjobs	rq_runjobs;
 		struct rq_selstat       rq_select;
 		int			rq_shutdown;
 		struct rq_signal	rq_signal;
@@ -413,6 +429,7 @@ extern void  req_register(struct batch_request *req);
 extern void  req_releasejob(struct batch_request *req);
 extern void  req_rescq(struct batch_request *req);
 extern void  req_runjob(struct batch_request *req);
+extern void  req_runjobs(struct batch_request *req);
 extern void  req_selectjobs(struct batch_request *req);
 extern void  req_stat_que(struct batch_request *req);
 extern void  req_stat_svr(struct batch_request *req);
@@ -443,6 +460,7 @@ extern int decode_DIS_Manage(int socket, struct batch_request *);
 extern int decode_DIS_MoveJob(int socket, struct batch_request *);
 extern int decode_DIS_MessageJob(int socket, struct batch_request *);
 extern int decode_DIS_ModifyResv(int socket, struct batch_request *);
+extern int decode_DIS_ModifyJobs(int socket, struct batch_request *);
 extern int decode_DIS_PySpawn(int socket, struct batch_request *);
 extern int decode_DIS_QueueJob(int socket, struct batch_request *);
 extern int decode_DIS_Register(int socket, struct batch_request *);
@@ -452,6 +470,7 @@ extern int decode_DIS_ReqHdr(int socket, struct batch_request *, int *tp, int *p
 extern int decode_DIS_Rescl(int socket, struct batch_request *);
 extern int decode_DIS_Rescq(int socket, struct batch_request *);
 extern int decode_DIS_Run(int socket, struct batch_request *);
+extern int decode_DIS_RunJobs(int socket, struct batch_request *);
 extern int decode_DIS_ShutDown(int socket, struct batch_request *);
 extern int decode_DIS_SignalJob(int socket, struct batch_request *);
 extern int decode_DIS_Status(int socket, struct batch_request *);
@@ -468,6 +487,8 @@ extern int encode_DIS_TrackJob(int socket, struct batch_request *);
 extern int encode_DIS_reply(int socket, struct batch_reply *);
 extern int encode_DIS_replyRPP(int socket, char *, struct batch_reply *);
 extern int encode_DIS_svrattrl(int socket, svrattrl *);
+extern int encode_DIS_reply_status_head(int socket, struct batch_reply *, int);
+extern int encode_DIS_status_entry(int socket, struct brp_status *);
 
 extern int dis_request_read(int socket, struct batch_request *);
 extern int dis_reply_read(int socket, struct batch_reply *, int rpp);
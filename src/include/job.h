@@ -587,6 +587,7 @@ struct job {
 	int		ji_jdcd_waiting;/* set if waiting on a mom for a response to discard job request */
 	char	       *ji_acctrec;	/* holder for accounting info */
 	char	       *ji_clterrmsg;	/* error message to return to client */
+	long		ji_chgseq;	/* server change seq of last update */
 
 	/*
 	 *	The flag ji_newjob is used to ensure that calls to svr_setjobstate
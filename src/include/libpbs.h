@@ -146,6 +146,7 @@ struct connect_handle {
 };
 extern struct connect_handle connection[];
 #define PBS_MAX_CONNECTIONS        5000  /* Max connections in the connections array */
+#define PBS_STAT_PAGE_SIZE         1000  /* job status entries asked for per page */
 /* PBS Batch Reply Structure		   */
 /* structures that make up the reply union */
 
@@ -282,6 +283,11 @@ struct batch_reply {
 #define PBS_BATCH_RelnodesJob	90
 #define PBS_BATCH_ModifyResv	91
 #define PBS_BATCH_ResvOccurEnd	92
+#define PBS_BATCH_ModifyJobs	93
+#define PBS_BATCH_RunJobs	94
+
+/* most jobs in one Modify Jobs or Run Jobs request */
+#define PBS_MAX_MULTIJOB	10000
 
 #define PBS_BATCH_FileOpt_Default	0
 #define PBS_BATCH_FileOpt_OFlg		1
@@ -342,6 +348,7 @@ extern struct batch_status *PBSD_status(int c, int function,
 	char *objid, struct attrl *attrib, char *extend);
 
 extern struct batch_status *PBSD_status_get(int c);
+extern struct batch_status *PBSD_status_get_more(int c, int *more);
 extern char * PBSD_queuejob(int c, char *j, char *d,
 	struct attropl *a, char *ex, int rpp, char **msgid);
 extern int decode_DIS_svrattrl(int sock, pbs_list_head *phead);
@@ -359,6 +366,7 @@ extern int encode_DIS_Manage(int socket, int cmd, int objt,
 extern int encode_DIS_MessageJob(int socket, char *jid, int fopt, char *m);
 extern int encode_DIS_MoveJob(int socket, char *jid, char *dest);
 extern int encode_DIS_ModifyResv(int socket, char *resv_id, struct attropl *aoplp);
+extern int encode_DIS_ModifyJobs(int socket, struct batch_status *jobs);
 extern int encode_DIS_RelnodesJob(int socket, char *jid, char *node_list);
 extern int encode_DIS_PySpawn(int socket, char *jid, char **argv, char **envp);
 extern int encode_DIS_QueueJob(int socket, char *jid,
@@ -370,6 +378,7 @@ extern int encode_DIS_ReqHdr(int socket, int reqt, char *user);
 extern int encode_DIS_Rescq(int socket, char **rlist, int num);
 extern int encode_DIS_Run(int socket, char *jid, char *where,
 	unsigned long resch);
+extern int encode_DIS_RunJobs(int socket, struct batch_status *jobs);
 extern int encode_DIS_ShutDown(int socket, int manner);
 extern int encode_DIS_SignalJob(int socket, char *jid, char *sig);
 extern int encode_DIS_Status(int socket, char *objid, struct attrl *);
@@ -384,6 +393,11 @@ extern int DIS_reply_read(int socket, struct batch_reply *preply, int rpp);
 extern void pbs_authors(void);
 extern int DIS_wflush(int sock, int rpp);
 
+extern struct batch_status *pbs_statjob_page(int c, char *id,
+	struct attrl *attrib, char *extend, char **cursor);
+extern struct batch_status *pbs_statchanged(int c, int obj_type,
+	struct attrl *attrib, char *extend, char **since);
+
 extern int engage_external_authentication(int out, int auth_type, int fromsvr, char *ebuf, int ebufsz);
 extern char *PBSD_modify_resv(int connect, char *resv_id,
 	struct attropl *attrib, char *extend);
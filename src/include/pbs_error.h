@@ -295,6 +295,7 @@ extern "C" {
 #define PBSE_ALPS_SWITCH_ERR 15222	/* ALPS failed to do the suspend/resume */
 #define PBSE_SCHED_OP_NOT_PERMITTED 15223 /* Operation not permitted on default scheduler */
 #define PBSE_SCHED_PARTITION_ALREADY_EXISTS 15224 /* Partition already exists */
+#define PBSE_RESYNC_REQUIRED 15225	/* change seq expired, full stat needed */
 
 /* the following structure is used to tie error number      */
 /* with text to be returned to a client, see svr_messages.c */
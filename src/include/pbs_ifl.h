@@ -325,6 +325,8 @@ extern "C" {
  * Larger values can have a marginal impact on latency of frontend requests.
  */
 #define ATTR_rpp_max_pkt_check "rpp_max_pkt_check"
+#define ATTR_job_chgseq "job_change_seq"
+#define ATTR_multijob_reqs "multijob_requests"
 
 /* additional scheduler "attribute" names */
 
@@ -511,6 +513,16 @@ struct batch_status {
 	char		    *text;
 };
 
+/* attributes of a job which failed in a multi-job request, returned by
+ * pbs_alterjobs() and pbs_asyrunjobs()
+ */
+#define MULTIJOB_ERRCODE	"error_code"
+#define MULTIJOB_ERRTEXT	"error_text"
+
+/* multi-job requests a server accepts, listed in its multijob_requests */
+#define MULTIJOB_REQ_MODIFY	"modifyjobs"
+#define MULTIJOB_REQ_RUN	"runjobs"
+
 /* structure to hold an attribute that failed verification at ECL
  * and the associated errcode and errmsg
  */
@@ -564,8 +576,12 @@ DECLDIR char *__pbs_server_location(void);
 
 DECLDIR int pbs_asyrunjob(int, char *, char *, char *);
 
+DECLDIR struct batch_status *pbs_asyrunjobs(int, struct batch_status *, char *);
+
 DECLDIR int pbs_alterjob(int, char *, struct attrl *, char *);
 
+DECLDIR struct batch_status *pbs_alterjobs(int, struct batch_status *, char *);
+
 DECLDIR int pbs_connect(char *);
 
 DECLDIR int pbs_connect_extend(char *, char *);
@@ -655,8 +671,12 @@ extern char *__pbs_server_location(void);
 
 extern int pbs_asyrunjob(int, char *, char *, char *);
 
+extern struct batch_status *pbs_asyrunjobs(int, struct batch_status *, char *);
+
 extern int pbs_alterjob(int, char *, struct attrl *, char *);
 
+extern struct batch_status *pbs_alterjobs(int, struct batch_status *, char *);
+
 extern int pbs_connect(char *);
 
 extern int pbs_connect_extend(char *, char *);
@@ -193,6 +193,7 @@ struct resc_resv {
 	resc_resv		*ri_parent;		/* reservation in a reservation */
 
 	int			ri_modified;		/*struct changed, needs to be saved*/
+	long			ri_chgseq;		/*server change seq of last update*/
 	int			ri_giveback;		/*flag, return resources to parent */
 
 	int			ri_vnodes_down;		/* the number of vnodes that are unavailable */
@@ -318,6 +319,7 @@ struct resc_resv {
 #define	Q_CHNG_START		1
 
 extern resc_resv  *find_resv(char *);
+extern void	   svr_avlresv_oper(resc_resv *, int);
 extern resc_resv  *resc_resv_alloc(void);
 extern void  resv_purge(resc_resv *);
 extern int   start_end_dur_wall(void *, int);
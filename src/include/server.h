@@ -157,6 +157,8 @@ enum srv_atr {
 	SRV_ATR_show_hidden_attribs,
 	SRV_ATR_sync_mom_hookfiles_timeout,
 	SRV_ATR_rpp_max_pkt_check,
+	SRV_ATR_JobChangeSeq,
+	SRV_ATR_MultiJobReqs,
 	/* This must be last */
 	SRV_ATR_LAST
 };
@@ -176,6 +178,7 @@ struct server {
 	int	  sv_jobstates[PBS_NUMJOBSTATE];  /* # of jobs per state */
 	char	  sv_jobstbuf[150];
 	char	  sv_license_ct_buf[150]; /* license_count buffer */
+	char	  sv_chgseqbuf[64];	/* job_change_seq buffer */
 	int	  sv_nseldft;		/* num of elems in sv_seldft	    */
 	key_value_pair *sv_seldft;	/* defelts for job's -l select	    */
 
@@ -74,6 +74,7 @@ extern "C" {
 #define PBS_RESTAT_JOB	       30 /* ask mom for status only once in 30 sec  */
 #define PBS_STAGEFAIL_WAIT   1800 /* retry time after stage in failuere */
 #define PBS_MAX_ARRAY_JOB_DFL 10000 /* default max size of an array job */
+#define PBS_CHGSEQ_DELETED 8192 /* purged job ids kept for delta stat */
 
 /* Server Database information - path names */
 
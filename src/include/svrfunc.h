@@ -115,6 +115,9 @@ extern int update_svrlive(void);
 extern void init_socket_licenses(char *);
 extern void update_job_finish_comment(job *, int, char *);
 extern void svr_saveorpurge_finjobhist(job *);
+extern void svr_job_changed(job *);
+extern void svr_chgseq_purged(int, char *);
+extern void advance_stat_cursors(job *, pbs_queue *);
 extern int recreate_exec_vnode(job *, char *, char *, int);
 extern void unset_extra_attributes(job *);
 extern int node_delete_db(struct pbsnode *);
@@ -159,6 +162,7 @@ extern	void	tfree2(struct tree **rootp);
 #ifdef	_RESOURCE_H
 extern  int  set_clear_target(struct pbsnode *, resource *, int, int);
 #endif 	/* _RESOURCE_H */
+extern	void	svr_node_changed(struct pbsnode *);
 #endif	/* _PBS_NODES_H */
 
 #ifdef	_PBS_JOB_H
@@ -259,6 +263,9 @@ extern void  req_messagejob(struct batch_request *preq);
 extern void  req_py_spawn(struct batch_request *preq);
 extern void  req_relnodesjob(struct batch_request *preq);
 extern void  req_modifyjob(struct batch_request *preq);
+extern void  req_modifyjobs(struct batch_request *preq);
+extern void  reply_multijob_error(struct batch_request *preq, char *jobid, int code, char *text);
+extern void  reply_multijob_child(struct batch_request *preq, char *jobid);
 extern void  req_modifyReservation(struct batch_request *preq);
 extern void  req_orderjob(struct batch_request *req);
 extern void  req_rescreserve(struct batch_request *preq);
@@ -337,6 +344,7 @@ extern	void	Update_Resvstate_if_resv(job *);
 extern	int	add_resc_resv_to_job(job *);
 extern	void	is_resv_window_in_future(resc_resv *);
 extern	void	resv_setResvState(resc_resv *, int, int);
+extern	void	svr_resv_changed(resc_resv *);
 extern	void    is_resv_window_in_future(resc_resv *);
 extern  int	gen_task_EndResvWindow(resc_resv *);
 extern	int	gen_future_deleteResv(resc_resv *, long);
@@ -407,6 +415,10 @@ struct	stat_cntl { /* used in req_stat_job */
 extern  int 	status_job(job *, struct batch_request *, svrattrl  *, pbs_list_head *, int *);
 extern  int 	status_subjob(job *, struct batch_request *, svrattrl  *, int, pbs_list_head *, int *);
 extern	int	stat_to_mom(job *, struct stat_cntl *);
+extern	int	chgseq_expired(long);
+extern	int	chgseq_since(char *, long *);
+extern	int	status_purged_obj(int, char *, pbs_list_head *);
+extern	int	status_purged_objs(int, long, pbs_list_head *);
 
 #endif	/* STAT_CNTL */
 #ifdef	__cplusplus
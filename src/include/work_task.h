@@ -86,6 +86,9 @@ struct work_task  {
 	void		*wt_parm3;	/* used to store reply for deferred cmds TPP */
 	int		 wt_aux;	/* optional info: e.g. child status */
 	int		 wt_aux2;	/* optional info 2: e.g. *real* child pid (windows), rpp msg etc */
+	pbs_list_link	 wt_linkparm1;	/* link in index of tasks by wt_parm1 */
+	int		 wt_heapidx;	/* slot in timed task heap, -1 if not in it */
+	unsigned long	 wt_heapseq;	/* order set, breaks ties on wt_event */
 };
 
 extern struct work_task *set_task(enum work_type, long event, void (*func)(), void *param);
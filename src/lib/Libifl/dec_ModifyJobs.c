@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+/**
+ * @file	dec_ModifyJobs.c
+ * @brief
+ * decode_DIS_ModifyJobs() - decode a Modify Jobs Batch Request
+ *
+ *	This request alters the attributes of a number of jobs at once.
+ *
+ *	The batch_request structure must already exist (be allocated by the
+ *	caller.   It is assumed that the header fields (protocol type,
+ *	protocol version, request type, and user name) have already be decoded.
+ *
+ * @par	Data items are:
+ *			unsigned int	number of jobs
+ *			and for each job:
+ *			string		job id
+ *			attropl		attributes
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <sys/types.h>
+#include <stdlib.h>
+#include "libpbs.h"
+#include "list_link.h"
+#include "server_limits.h"
+#include "attribute.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-decode a Modify Jobs Batch Request
+ *
+ * @par	Functionality:
+ *	Each job is decoded into its own rq_manage, the same as the one of a
+ *	Modify Job request.  rq_count only counts the entries which have been
+ *	set up, so the request can be freed if decoding stops part way.  The
+ *	job count comes from the client, so more than PBS_MAX_MULTIJOB jobs
+ *	are refused before anything is allocated for them.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[out] preq - pointer to batch_request structure
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+decode_DIS_ModifyJobs(int sock, struct batch_request *preq)
+{
+	int rc;
+	unsigned int ct;
+	unsigned int i;
+	struct rq_manage *pmgr;
+
+	preq->rq_ind.rq_modifyjobs.rq_count = 0;
+	preq->rq_ind.rq_modifyjobs.rq_jobs = NULL;
+
+	ct = disrui(sock, &rc);
+	if (rc) return rc;
+	if (ct == 0)
+		return 0;
+	if (ct > PBS_MAX_MULTIJOB)
+		return DIS_PROTO;
+
+	preq->rq_ind.rq_modifyjobs.rq_jobs = calloc(ct, sizeof(struct rq_manage));
+	if (preq->rq_ind.rq_modifyjobs.rq_jobs == NULL)
+		return DIS_NOMALLOC;
+
+	for (i = 0; i < ct; i++) {
+		pmgr = &preq->rq_ind.rq_modifyjobs.rq_jobs[i];
+		CLEAR_HEAD(pmgr->rq_attr);
+		pmgr->rq_cmd = MGR_CMD_SET;
+		pmgr->rq_objtype = MGR_OBJ_JOB;
+		preq->rq_ind.rq_modifyjobs.rq_count++;
+
+		rc = disrfst(sock, PBS_MAXSVRJOBID+1, pmgr->rq_objname);
+		if (rc) return rc;
+		rc = decode_DIS_svrattrl(sock, &pmgr->rq_attr);
+		if (rc) return rc;
+	}
+
+	return 0;
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+/**
+ * @file	enc_RunJobs.c
+ * @brief
+ * encode_DIS_RunJobs() - encode a Run Jobs Batch Request
+ *
+ *	This request runs a number of jobs at once, asynchronously.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <string.h>
+#include "libpbs.h"
+#include "pbs_error.h"
+#include "dis.h"
+
+/**
+ * @brief
+ *	-encode a Run Jobs Batch Request
+ *
+ * @par	Data items are:\n
+ *		unsigned int	number of jobs\n
+ *		and for each job, the same as a Run Job request:\n
+ *		string		job id\n
+ *		string		destination\n
+ *		unsigned int	resource handle (currently 0)
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] jobs - list of jobs, the destination of each is the value of
+ *		     its ATTR_execvnode attribute
+ *
+ * @return      int
+ * @retval      DIS_SUCCESS(0)  success
+ * @retval      error code      error
+ *
+ */
+
+int
+encode_DIS_RunJobs(int sock, struct batch_status *jobs)
+{
+	unsigned int ct = 0;
+	struct batch_status *pbs;
+	struct attrl *pattr;
+	char *where;
+	int rc;
+
+	for (pbs = jobs; pbs != NULL; pbs = pbs->next)
+		++ct;
+
+	if ((rc = diswui(sock, ct)) != 0)
+		return rc;
+
+	for (pbs = jobs; pbs != NULL; pbs = pbs->next) {
+		where = "";
+		for (pattr = pbs->attribs; pattr != NULL; pattr = pattr->next) {
+			if ((strcmp(pattr->name, ATTR_execvnode) == 0) &&
+				(pattr->value != NULL))
+				where = pattr->value;
+		}
+		if ((rc = encode_DIS_Run(sock, pbs->name, where, 0)) != 0)
+			return rc;
+	}
+
+	return 0;
+}
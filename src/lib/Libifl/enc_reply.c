@@ -56,6 +56,31 @@
 
 int encode_DIS_svrattrl(int sock, svrattrl *psattl);
 
+/**
+ * @brief
+ *	encode one object of a Status reply: its type, its name and its
+ *	attributes
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] pstat - pointer to the status of the object
+ *
+ * @return      int
+ * @retval      0       Success
+ * @retval      !0      DIS error
+ *
+ */
+
+int
+encode_DIS_status_entry(int sock, struct brp_status *pstat)
+{
+	int rc;
+
+	if ((rc = diswui(sock, pstat->brp_objtype))	||
+		(rc = diswst(sock, pstat->brp_objname)))
+			return rc;
+
+	return (encode_DIS_svrattrl(sock, (svrattrl *)GET_NEXT(pstat->brp_attr)));
+}
 
 /**
  * @brief-
@@ -80,7 +105,6 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 	int		    i;
 	struct brp_select  *psel;
 	struct brp_status  *pstat;
-	svrattrl	   *psvrl;
 
 	int rc;
 
@@ -147,12 +171,7 @@ encode_DIS_reply_inner(int sock, struct batch_reply *reply)
 				return rc;
 			pstat = (struct brp_status *)GET_NEXT(reply->brp_un.brp_status);
 			while (pstat) {
-				if ((rc = diswui(sock, pstat->brp_objtype))	||
-					(rc = diswst(sock, pstat->brp_objname)))
-						return rc;
-
-				psvrl = (svrattrl *)GET_NEXT(pstat->brp_attr);
-				if ((rc = encode_DIS_svrattrl(sock, psvrl)) != 0)
+				if ((rc = encode_DIS_status_entry(sock, pstat)) != 0)
 					return rc;
 				pstat =(struct brp_status *)GET_NEXT(pstat->brp_stlink);
 			}
@@ -221,6 +240,37 @@ encode_DIS_reply(int sock, struct batch_reply *reply)
 	return (encode_DIS_reply_inner(sock, reply));
 }
 
+/**
+ * @brief
+ *	encode the head of a Status reply whose objects are sent afterwards,
+ *	one at a time, with encode_DIS_status_entry().  The objects hung off
+ *	the reply itself are not encoded.
+ *
+ * @param[in] sock - socket descriptor
+ * @param[in] reply - pointer to batch_reply structure
+ * @param[in] ct - number of objects that will follow
+ *
+ * @return      int
+ * @retval      0       Success
+ * @retval      !0      DIS error
+ *
+ */
+
+int
+encode_DIS_reply_status_head(int sock, struct batch_reply *reply, int ct)
+{
+	int rc;
+
+	if ((rc = diswui(sock, PBS_BATCH_PROT_TYPE))	||
+		(rc = diswui(sock, PBS_BATCH_PROT_VER))	||
+		(rc = diswsi(sock, reply->brp_code))	||
+		(rc = diswsi(sock, reply->brp_auxcode))	||
+		(rc = diswui(sock, BATCH_REPLY_CHOICE_Status)))
+			return rc;
+
+	return (diswui(sock, ct));
+}
+
 int
 encode_DIS_replyRPP(int sock, char *rppcmd_msgid, struct batch_reply *reply)
 {
@@ -100,6 +100,24 @@ PBSD_status(int c, int function, char *objid, struct attrl *attrib, char *extend
  * @retval NULL on failure
  */
 struct batch_status *PBSD_status_get(int c)
+{
+	return (PBSD_status_get_more(c, NULL));
+}
+
+/**
+ * @brief
+ *	Returns pointer to status record, and whether the server has more
+ *	objects to return after this page of status
+ *
+ * @param[in]   c - index into connection table
+ * @param[out]  more - if not NULL, set to the reply's auxiliary code,
+ *		       1 if more objects follow the page, otherwise 0
+ *
+ * @return returns a pointer to a batch_status structure
+ * @retval pointer to batch status on SUCCESS
+ * @retval NULL on failure
+ */
+struct batch_status *PBSD_status_get_more(int c, int *more)
 {
 	struct brp_cmdstat  *stp; /* pointer to a returned status record */
 	struct batch_status *bsp  = NULL;
@@ -121,6 +139,8 @@ struct batch_status *PBSD_status_get(int c)
 		stp = reply->brp_un.brp_statc;
 		i = 0;
 		pbs_errno = 0;
+		if (more != NULL)
+			*more = (reply->brp_auxcode == 1);
 		while (stp != NULL) {
 			if (i++ == 0) {
 				rbsp = bsp = alloc_bs();
@@ -0,0 +1,156 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+/**
+ * @file	pbsD_asyrunjobs.c
+ * @brief
+ *	Send the Run Jobs request to the server.  It runs a number of jobs
+ *	asynchronously in one request.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <string.h>
+#include <stdio.h>
+#include "libpbs.h"
+#include "dis.h"
+#include "pbs_ecl.h"
+
+
+static int PBSD_asyrunjobs_put(int, struct batch_status *, char *);
+
+/**
+ * @brief
+ *	-Send the Run Jobs request to the server
+ *
+ * @par Functionality:
+ *	Each entry of jobs names a job and, in its ATTR_execvnode attribute,
+ *	the vnodes and resources to allocate to it, the same as a
+ *	pbs_asyrunjob() for that job.  All of the jobs are run in one request,
+ *	so there may be at most PBS_MAX_MULTIJOB of them.
+ *	As with pbs_asyrunjob(), the server replies once it has sent each job
+ *	to its MoM, without waiting for the MoM to start it.  A job which can
+ *	not be run does not stop the rest of the jobs from being run.
+ *
+ * @param[in] c - connection handle
+ * @param[in] jobs - jobs to run, name is the job id
+ * @param[in] extend - extend string for encoding req
+ *
+ * @return	struct batch_status *
+ * @retval	list of the jobs which could not be run.  Each one has
+ *		the attributes MULTIJOB_ERRCODE and MULTIJOB_ERRTEXT
+ * @retval	NULL	all jobs were run, or error if pbs_errno is set
+ *
+ */
+struct batch_status *
+pbs_asyrunjobs(int c, struct batch_status *jobs, char *extend)
+{
+	struct batch_status *pbs;
+	struct batch_status *ret = NULL;
+	int ct = 0;
+
+	pbs_errno = PBSE_NONE;
+	if (jobs == NULL)
+		return NULL;
+
+	for (pbs = jobs; pbs != NULL; pbs = pbs->next) {
+		if ((pbs->name == NULL) || (*pbs->name == '\0') ||
+			(++ct > PBS_MAX_MULTIJOB)) {
+			pbs_errno = PBSE_IVALREQ;
+			return NULL;
+		}
+	}
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* lock pthread mutex here for this connection */
+	/* blocking call, waits for mutex release */
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	if (PBSD_asyrunjobs_put(c, jobs, extend) == 0)
+		ret = PBSD_status_get(c);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return NULL;
+
+	return ret;
+}
+
+/**
+ * @brief
+ *	-encode and send the Run Jobs request
+ *
+ * @param[in] c - communication handle
+ * @param[in] jobs - jobs to run
+ * @param[in] extend - extend string to encode req
+ *
+ * @return	int
+ * @retval	0	success
+ * @retval	!0	error
+ *
+ */
+static int
+PBSD_asyrunjobs_put(int c, struct batch_status *jobs, char *extend)
+{
+	int rc;
+	int sock;
+
+	sock = connection[c].ch_socket;
+
+	/* setup DIS support routines for following DIS calls */
+
+	DIS_tcp_setup(sock);
+
+	if ((rc = encode_DIS_ReqHdr(sock, PBS_BATCH_RunJobs, pbs_current_user)) ||
+		(rc = encode_DIS_RunJobs(sock, jobs)) ||
+		(rc = encode_DIS_ReqExtend(sock, extend))) {
+		connection[c].ch_errtxt = strdup(dis_emsg[rc]);
+		if (connection[c].ch_errtxt == NULL)
+			return (pbs_errno = PBSE_SYSTEM);
+		return (pbs_errno = PBSE_PROTOCOL);
+	}
+
+	if (DIS_tcp_wflush(sock)) {
+		return (pbs_errno = PBSE_PROTOCOL);
+	}
+
+	return 0;
+}
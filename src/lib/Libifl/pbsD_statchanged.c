@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+/**
+ * @file	pbsD_statchanged.c
+ * @brief
+ * Return the jobs, vnodes or reservations changed since an earlier call.
+ */
+
+#include <pbs_config.h>   /* the master config generated by configure */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libpbs.h"
+#include "pbs_ecl.h"
+
+
+/**
+ * @brief
+ *	-Return the status of the jobs, vnodes or reservations which changed
+ *	since the server's change sequence was last read by this function.
+ *
+ * @par
+ *	The server's change sequence (the job_change_seq server attribute, in
+ *	the form "<server start time>:<seq>") is read first, then the objects
+ *	are statused with "D<since>" appended to the extend string.  An
+ *	object which was deleted is returned as an entry with no attributes.
+ *	On success *since is replaced by the sequence read, to be passed to
+ *	the next call.  If the server restarted or forgot the changes since
+ *	*since, the call fails with PBSE_RESYNC_REQUIRED; the caller should
+ *	then set *since to NULL and start over with a full status.
+ *
+ * @param[in] c - communication handle
+ * @param[in] obj_type - MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_RESV
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ * @param[in,out] since - NULL (or *since NULL) for a full status, else the
+ *			  value set by the previous call; replaced by a
+ *			  malloc'ed string which the caller must free
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		success
+ * @retval	NULL					error, or nothing changed
+ *							(pbs_errno is 0)
+ *
+ */
+struct batch_status *
+pbs_statchanged(int c, int obj_type, struct attrl *attrib, char *extend, char **since)
+{
+	struct attrl seqattr;
+	struct batch_status *ret = NULL;
+	char *next;
+	char *ext;
+	char *old;
+	size_t len;
+
+	if (since == NULL) {
+		pbs_errno = PBSE_IVALREQ;
+		return NULL;
+	}
+	old = *since;
+
+	/* read the sequence first, so nothing changed meanwhile is missed */
+	memset(&seqattr, 0, sizeof(seqattr));
+	seqattr.name = ATTR_job_chgseq;
+	seqattr.value = "";
+	ret = pbs_statserver(c, &seqattr, NULL);
+	if (ret == NULL)
+		return NULL;
+	if ((ret->attribs == NULL) || (ret->attribs->value == NULL)) {
+		pbs_statfree(ret);
+		pbs_errno = PBSE_NOSUP;
+		return NULL;
+	}
+	next = strdup(ret->attribs->value);
+	pbs_statfree(ret);
+	if (next == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+
+	len = 1;
+	if (extend != NULL)
+		len += strlen(extend);
+	if ((old != NULL) && (*old != '\0'))
+		len += strlen(old) + 1;
+	if ((ext = malloc(len)) == NULL) {
+		free(next);
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	snprintf(ext, len, "%s%s%s", extend ? extend : "",
+		((old != NULL) && (*old != '\0')) ? "D" : "", old ? old : "");
+
+	pbs_errno = 0;
+	switch (obj_type) {
+		case MGR_OBJ_JOB:
+			ret = pbs_selstat(c, NULL, attrib, ext);
+			break;
+		case MGR_OBJ_NODE:
+			ret = pbs_statvnode(c, "", attrib, ext);
+			break;
+		case MGR_OBJ_RESV:
+			ret = pbs_statresv(c, NULL, attrib, ext);
+			break;
+		default:
+			ret = NULL;
+			pbs_errno = PBSE_IVALREQ;
+	}
+	free(ext);
+
+	if ((ret == NULL) && (pbs_errno != 0)) {
+		free(next);
+		return NULL;
+	}
+	free(old);
+	*since = next;
+	return ret;
+}
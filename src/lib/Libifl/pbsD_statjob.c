@@ -43,10 +43,132 @@
 
 #include <pbs_config.h>   /* the master config generated by configure */
 
+#include <string.h>
 #include "libpbs.h"
 #include "pbs_ecl.h"
 
 
+/**
+ * @brief
+ *	-Send the request for one page of the status of the jobs in a queue
+ *	or at the server and read the reply.  The connection must be locked.
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - queue name, or null string for all the jobs at the server
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ * @param[in,out] cursor - NULL for the first page, else the cursor returned
+ *			   with the previous page; replaced by the cursor
+ *			   for the next page, or NULL after the last page
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		success
+ * @retval	NULL					error or no jobs
+ *
+ */
+static struct batch_status *
+statjob_page(int c, char *id, struct attrl *attrib, char *extend, char **cursor)
+{
+	struct batch_status *ret;
+	struct batch_status *last;
+	char *ext;
+	char *pc;
+	char *pe;
+	int more = 0;
+
+	if (id == NULL)
+		id = "";
+	if (extend == NULL)
+		extend = "";
+
+	/* page size, then the cursor which must come last */
+	ext = malloc(strlen(extend) + (*cursor ? strlen(*cursor) : 0) + 16);
+	if (ext == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+	if (*cursor)
+		sprintf(ext, "%sP%dC%s", extend, PBS_STAT_PAGE_SIZE, *cursor);
+	else
+		sprintf(ext, "%sP%d", extend, PBS_STAT_PAGE_SIZE);
+
+	free(*cursor);
+	*cursor = NULL;
+
+	if (PBSD_status_put(c, PBS_BATCH_StatusJob, id, attrib, ext, 0, NULL)) {
+		free(ext);
+		return NULL;
+	}
+	free(ext);
+
+	ret = PBSD_status_get_more(c, &more);
+	if ((ret == NULL) || !more)
+		return ret;
+
+	/* the next page starts after the last job, the Array job of a subjob */
+	for (last = ret; last->next != NULL; last = last->next)
+		;
+	if ((*cursor = strdup(last->name)) == NULL) {
+		pbs_errno = PBSE_SYSTEM;
+		pbs_statfree(ret);
+		return NULL;
+	}
+	if (((pc = strchr(*cursor, (int)'[')) != NULL) &&
+		((pe = strchr(pc, (int)']')) != NULL))
+		memmove(pc + 1, pe, strlen(pe) + 1);
+	return ret;
+}
+
+/**
+ * @brief
+ *	-Return one page of the status of the jobs in a queue or at the
+ *	server.  A client can page through all the jobs in bounded chunks
+ *	by calling again with the returned cursor until it is NULL.  A server
+ *	that does not page returns all the jobs in the first page.
+ *	Paging is opt-in: pbs_statjob() always returns all the jobs in one
+ *	reply.  The pages are not one snapshot, jobs may move between them,
+ *	and a call fails with PBSE_UNKJOBID if the server no longer knows
+ *	where the previous page ended.
+ *
+ * @param[in] c - communication handle
+ * @param[in] id - queue name, or null string for all the jobs at the server
+ * @param[in] attrib - pointer to attribute list
+ * @param[in] extend - extend string for req
+ * @param[in,out] cursor - NULL for the first page, else the cursor returned
+ *			   with the previous page; replaced by the cursor
+ *			   for the next page, or NULL after the last page
+ *
+ * @return	structure handle
+ * @retval	pointer to batch_status struct		success
+ * @retval	NULL					error or no jobs
+ *
+ */
+struct batch_status *
+pbs_statjob_page(int c, char *id, struct attrl *attrib, char *extend, char **cursor)
+{
+	struct batch_status *ret = NULL;
+
+	/* initialize the thread context data, if not already initialized */
+	if (pbs_client_thread_init_thread_context() != 0)
+		return NULL;
+
+	/* first verify the attributes, if verification is enabled */
+	if ((pbs_verify_attributes(c, PBS_BATCH_StatusJob,
+		MGR_OBJ_JOB, MGR_CMD_NONE, (struct attropl *) attrib)))
+		return NULL;
+
+	if (pbs_client_thread_lock_connection(c) != 0)
+		return NULL;
+
+	ret = statjob_page(c, id, attrib, extend, cursor);
+
+	/* unlock the thread lock and update the thread context data */
+	if (pbs_client_thread_unlock_connection(c) != 0)
+		return NULL;
+
+	return ret;
+}
+
 /**
  * @brief
  *	-Return the status of a job.
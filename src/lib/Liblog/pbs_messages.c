@@ -408,6 +408,7 @@ char *msg_partition_not_in_queue = "Partition %s is not part of queue for node";
 char *msg_invalid_partion_in_queue = "Invalid partition in queue";
 char *msg_sched_op_not_permitted = "Operation is not permitted on default scheduler";
 char *msg_sched_part_already_used = "Partition is already associated with other scheduler";
+char *msg_resync_required = "Changes since requested sequence are no longer available, full resync required";
 
 char *msg_resv_not_empty = "Reservation not empty";
 char *msg_stdg_resv_occr_conflict = "Requested time(s) will interfere with a later occurrence";
@@ -592,6 +593,7 @@ struct pbs_err_to_txt pbs_err_to_txt[] = {
 	{PBSE_SOFTWT_STF, &msg_softwt_stf},
 	{PBSE_SCHED_OP_NOT_PERMITTED, &msg_sched_op_not_permitted},
 	{PBSE_SCHED_PARTITION_ALREADY_EXISTS, &msg_sched_part_already_used},
+	{PBSE_RESYNC_REQUIRED, &msg_resync_required},
 	{ 0, NULL }		/* MUST be the last entry */
 };
 
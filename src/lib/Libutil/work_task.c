@@ -39,6 +39,12 @@
  * @file	work_task.c
  * @brief
  * work_task.c - contains functions to deal with the server's task list
+ *
+ *	Timed tasks are kept in a binary min-heap ordered by wt_event, ties
+ *	being broken by the order in which they were set, so that inserting
+ *	or cancelling one is O(log n) rather than a walk of a sorted list.
+ *	Every task with a wt_parm1 is also kept in a hash index keyed on
+ *	that pointer for delete_task_by_parm1() and has_task_by_parm1().
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
@@ -56,18 +62,273 @@
 /* Global Data Items: */
 
 extern pbs_list_head task_list_immed; /* list of tasks that can execute now */
-extern pbs_list_head task_list_timed; /* list of tasks that have set start times */
 extern pbs_list_head task_list_event; /* list of tasks responding to an event */
 extern int svr_delay_entry;
 extern time_t	time_now;
 
+#define TIMED_HEAP_INIT		256	/* initial slots in the timed task heap */
+#define PARM1_INDEX_INIT	256	/* initial buckets in the parm1 index */
+
+static struct work_task **timed_heap = NULL;	/* min-heap of timed tasks */
+static int		  timed_heap_cnt = 0;	/* tasks in the heap */
+static int		  timed_heap_size = 0;	/* slots allocated */
+static unsigned long	  timed_heap_seq = 0;	/* insertion order for ties */
+
+static pbs_list_head	 *parm1_index = NULL;	/* buckets of tasks by wt_parm1 */
+static int		  parm1_index_cnt = 0;	/* tasks in the index */
+static int		  parm1_index_size = 0;	/* buckets, a power of 2 */
+
+#define PARM1_HASH(p, size) ((int)(((unsigned long)(p) >> 4) & ((size) - 1)))
+
+/**
+ * @brief
+ *	Returns true if timed task 'pa' is due before timed task 'pb'.
+ *
+ * @param[in]	pa - first task
+ * @param[in]	pb - second task
+ *
+ * @return int
+ * @retval 1	- 'pa' is to be dispatched first
+ * @retval 0	- otherwise
+ */
+static int
+timed_before(struct work_task *pa, struct work_task *pb)
+{
+	if (pa->wt_event != pb->wt_event)
+		return (pa->wt_event < pb->wt_event);
+	return (pa->wt_heapseq < pb->wt_heapseq);
+}
+
+/**
+ * @brief
+ *	Stores 'ptask' in slot 'idx' of the timed task heap.
+ *
+ * @param[in]	idx   - slot
+ * @param[in]	ptask - task
+ */
+static void
+timed_heap_place(int idx, struct work_task *ptask)
+{
+	timed_heap[idx] = ptask;
+	ptask->wt_heapidx = idx;
+}
+
+/**
+ * @brief
+ *	Moves the task in slot 'idx' toward the root of the heap until its
+ *	parent is due before it.
+ *
+ * @param[in]	idx - slot of the task to move
+ */
+static void
+timed_heap_up(int idx)
+{
+	struct work_task *ptask = timed_heap[idx];
+	int parent;
+
+	while (idx > 0) {
+		parent = (idx - 1) / 2;
+		if (!timed_before(ptask, timed_heap[parent]))
+			break;
+		timed_heap_place(idx, timed_heap[parent]);
+		idx = parent;
+	}
+	timed_heap_place(idx, ptask);
+}
+
+/**
+ * @brief
+ *	Moves the task in slot 'idx' away from the root of the heap until
+ *	it is due before both of its children.
+ *
+ * @param[in]	idx - slot of the task to move
+ */
+static void
+timed_heap_down(int idx)
+{
+	struct work_task *ptask = timed_heap[idx];
+	int child;
+
+	while ((child = 2 * idx + 1) < timed_heap_cnt) {
+		if ((child + 1 < timed_heap_cnt) &&
+			timed_before(timed_heap[child + 1], timed_heap[child]))
+			child++;
+		if (!timed_before(timed_heap[child], ptask))
+			break;
+		timed_heap_place(idx, timed_heap[child]);
+		idx = child;
+	}
+	timed_heap_place(idx, ptask);
+}
+
+/**
+ * @brief
+ *	Adds a timed task to the heap, growing the heap if needed.
+ *
+ * @param[in]	ptask - task to add
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory
+ */
+static int
+timed_heap_add(struct work_task *ptask)
+{
+	struct work_task **pnew;
+	int newsize;
+
+	if (timed_heap_cnt == timed_heap_size) {
+		newsize = timed_heap_size ? timed_heap_size * 2 : TIMED_HEAP_INIT;
+		pnew = (struct work_task **)realloc(timed_heap,
+			newsize * sizeof(struct work_task *));
+		if (pnew == NULL)
+			return (-1);
+		timed_heap = pnew;
+		timed_heap_size = newsize;
+	}
+	ptask->wt_heapseq = timed_heap_seq++;
+	timed_heap_place(timed_heap_cnt++, ptask);
+	timed_heap_up(ptask->wt_heapidx);
+	return (0);
+}
+
+/**
+ * @brief
+ *	Removes a task from the timed task heap if it is in it.
+ *
+ * @param[in]	ptask - task to remove
+ */
+static void
+timed_heap_del(struct work_task *ptask)
+{
+	int idx = ptask->wt_heapidx;
+	struct work_task *plast;
+
+	if ((idx < 0) || (idx >= timed_heap_cnt) || (timed_heap[idx] != ptask))
+		return;
+	ptask->wt_heapidx = -1;
+	plast = timed_heap[--timed_heap_cnt];
+	if (plast == ptask)
+		return;
+	timed_heap_place(idx, plast);
+	if ((idx > 0) && timed_before(plast, timed_heap[(idx - 1) / 2]))
+		timed_heap_up(idx);
+	else
+		timed_heap_down(idx);
+}
+
+/**
+ * @brief
+ *	Doubles the number of buckets in the parm1 index, rehashing the
+ *	tasks already in it.
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory, the index is left as it was
+ */
+static int
+parm1_index_grow(void)
+{
+	pbs_list_head *pnew;
+	struct work_task *ptask;
+	int newsize;
+	int i;
+
+	newsize = parm1_index_size ? parm1_index_size * 2 : PARM1_INDEX_INIT;
+	pnew = (pbs_list_head *)malloc(newsize * sizeof(pbs_list_head));
+	if (pnew == NULL)
+		return (-1);
+	for (i = 0; i < newsize; i++)
+		CLEAR_HEAD(pnew[i]);
+
+	for (i = 0; i < parm1_index_size; i++) {
+		while ((ptask = (struct work_task *)GET_NEXT(parm1_index[i])) != NULL) {
+			delete_link(&ptask->wt_linkparm1);
+			append_link(&pnew[PARM1_HASH(ptask->wt_parm1, newsize)],
+				&ptask->wt_linkparm1, ptask);
+		}
+	}
+	free(parm1_index);
+	parm1_index = pnew;
+	parm1_index_size = newsize;
+	return (0);
+}
+
+/**
+ * @brief
+ *	Adds a task with a non-NULL wt_parm1 to the parm1 index.
+ *
+ * @param[in]	ptask - task to add
+ *
+ * @return int
+ * @retval 0	- success
+ * @retval -1	- out of memory
+ *
+ * @note
+ *	If the index cannot grow it keeps its current buckets, so only the
+ *	very first allocation can fail the add.
+ */
+static int
+parm1_index_add(struct work_task *ptask)
+{
+	if (ptask->wt_parm1 == NULL)
+		return (0);
+	if ((parm1_index_cnt >= 2 * parm1_index_size) &&
+		(parm1_index_grow() != 0) && (parm1_index == NULL))
+		return (-1);
+	append_link(&parm1_index[PARM1_HASH(ptask->wt_parm1, parm1_index_size)],
+		&ptask->wt_linkparm1, ptask);
+	parm1_index_cnt++;
+	return (0);
+}
+
+/**
+ * @brief
+ *	Removes a task from the timed task heap, the parm1 index and the
+ *	lists it is linked into.
+ *
+ * @param[in]	ptask - task to unlink
+ */
+static void
+unlink_task(struct work_task *ptask)
+{
+	if (ptask->wt_linkparm1.ll_next != &ptask->wt_linkparm1) {
+		delete_link(&ptask->wt_linkparm1);
+		parm1_index_cnt--;
+	}
+	timed_heap_del(ptask);
+	delete_link(&ptask->wt_linkall);
+	delete_link(&ptask->wt_linkobj);
+	delete_link(&ptask->wt_linkobj2);
+}
+
+/**
+ * @brief
+ *	Returns true if 'ptask' is waiting on the immediate or event list
+ *	or in the timed task heap, which are where delete_task_by_parm1()
+ *	and has_task_by_parm1() look.
+ *
+ * @param[in]	ptask - task to check
+ *
+ * @return int
+ * @retval 1	- task is pending
+ * @retval 0	- task has been taken off those lists (e.g. a TPP deferred
+ *		  command moved to a mom's list)
+ */
+static int
+task_is_pending(struct work_task *ptask)
+{
+	return ((ptask->wt_heapidx >= 0) ||
+		(ptask->wt_linkall.ll_next != &ptask->wt_linkall));
+}
+
 /**
  *
  * @brief
  * 	Creates a task of type 'type', 'event_id', and when task is dispatched,
  *	execute func with argument 'parm'. The task is added to
- *	'task_list_immed' if 'type' is  WORK_Immed; otherwise, task is added
- *	'task_list_event'.
+ *	'task_list_immed' if 'type' is  WORK_Immed, to the timed task heap if
+ *	'type' is WORK_Timed; otherwise, task is added 'task_list_event'.
  *
  * @param[in]	type - of task
  * @param[in]	event_id - event id of the task
@@ -82,7 +343,6 @@ extern time_t	time_now;
 struct work_task *set_task(enum work_type type, long event_id, void (*func)(struct work_task *) , void *parm)
 {
 	struct work_task *pnew;
-	struct work_task *pold;
 
 	pnew = (struct work_task *)malloc(sizeof(struct work_task));
 	if (pnew == NULL)
@@ -90,6 +350,7 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	CLEAR_LINK(pnew->wt_linkall);
 	CLEAR_LINK(pnew->wt_linkobj);
 	CLEAR_LINK(pnew->wt_linkobj2);
+	CLEAR_LINK(pnew->wt_linkparm1);
 	pnew->wt_event = event_id;
 	pnew->wt_event2 = NULL;
 	pnew->wt_type  = type;
@@ -99,21 +360,22 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 	pnew->wt_parm3 = NULL;
 	pnew->wt_aux   = 0;
 	pnew->wt_aux2  = 0;
+	pnew->wt_heapidx = -1;
+	pnew->wt_heapseq = 0;
+
+	if (parm1_index_add(pnew) != 0) {
+		free(pnew);
+		return NULL;
+	}
 
 	if (type == WORK_Immed)
 		append_link(&task_list_immed, &pnew->wt_linkall, pnew);
 	else if (type == WORK_Timed) {
-		pold = (struct work_task *)GET_NEXT(task_list_timed);
-		while (pold) {
-			if (pold->wt_event > pnew->wt_event)
-				break;
-			pold = (struct work_task *)GET_NEXT(pold->wt_linkall);
+		if (timed_heap_add(pnew) != 0) {
+			unlink_task(pnew);
+			free(pnew);
+			return NULL;
 		}
-		if (pold)
-			insert_link(&pold->wt_linkall, &pnew->wt_linkall, pnew,
-				LINK_INSET_BEFORE);
-		else
-			append_link(&task_list_timed, &pnew->wt_linkall, pnew);
 	} else
 		append_link(&task_list_event, &pnew->wt_linkall, pnew);
 	return (pnew);
@@ -135,9 +397,7 @@ struct work_task *set_task(enum work_type type, long event_id, void (*func)(stru
 void
 dispatch_task(struct work_task *ptask)
 {
-	delete_link(&ptask->wt_linkall);
-	delete_link(&ptask->wt_linkobj);
-	delete_link(&ptask->wt_linkobj2);
+	unlink_task(ptask);
 	if (ptask->wt_func)
 		ptask->wt_func(ptask);		/* dispatch process function */
 	(void)free(ptask);
@@ -154,9 +414,7 @@ dispatch_task(struct work_task *ptask)
 void
 delete_task(struct work_task *ptask)
 {
-	delete_link(&ptask->wt_linkobj);
-	delete_link(&ptask->wt_linkobj2);
-	delete_link(&ptask->wt_linkall);
+	unlink_task(ptask);
 	(void)free(ptask);
 }
 
@@ -164,7 +422,7 @@ delete_task(struct work_task *ptask)
  *
  * @brief
  *	Delete task found in task_list_event, task_list_immed, or
- *	task_list_timed that has a wt_parm1 field of value 'parm1'.
+ *	the timed task heap that has a wt_parm1 field of value 'parm1'.
  *
  * @param[in]	parm1	- parameter being matched.
  * @param[in]	option  - option is used to decide whether the
@@ -172,6 +430,10 @@ delete_task(struct work_task *ptask)
  *			  matches parm1 values or just one.
  *
  * @return none
+ *
+ * @par
+ *	Only the index bucket for 'parm1' is walked, in the order the tasks
+ *	were set.
  */
 void
 delete_task_by_parm1(void *parm1, enum wtask_delete_option option)
@@ -179,48 +441,26 @@ delete_task_by_parm1(void *parm1, enum wtask_delete_option option)
 	struct work_task  *ptask;
 	struct work_task  *ptask_next;
 
+	if ((parm1 == NULL) || (parm1_index == NULL))
+		return;
 
-	/* only 1 ptask can be possibly matched */
-	ptask = (struct work_task *)GET_NEXT(task_list_event);
-	while (ptask) {
-		ptask_next = (struct work_task *)GET_NEXT(ptask->wt_linkall);
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
-			delete_task(ptask);
-			if (option == DELETE_ONE)
-				return;
-		}
-		ptask = ptask_next;
-	}
-
-	ptask = (struct work_task *)GET_NEXT(task_list_timed);
-	while (ptask) {
-		ptask_next = (struct work_task *)GET_NEXT(ptask->wt_linkall);
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
-			delete_task(ptask);
-			if (option == DELETE_ONE)
-				return;
-		}
-		ptask = ptask_next;
-	}
-
-	ptask = (struct work_task *)GET_NEXT(task_list_immed);
+	ptask = (struct work_task *)GET_NEXT(parm1_index[PARM1_HASH(parm1, parm1_index_size)]);
 	while (ptask) {
-		ptask_next = (struct work_task *)GET_NEXT(ptask->wt_linkall);
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
+		ptask_next = (struct work_task *)GET_NEXT(ptask->wt_linkparm1);
+		if ((ptask->wt_parm1 == parm1) && task_is_pending(ptask)) {
 			delete_task(ptask);
 			if (option == DELETE_ONE)
 				return;
 		}
 		ptask = ptask_next;
 	}
-
 }
 
 /**
  *
  * @brief
- *	Check if some task in any of the task lists (task_list_event,
- *	task_list_timed, task_list_immed) has a wt_parm1 matching 'parm1'.
+ *	Check if some task in task_list_event, task_list_immed or the timed
+ *	task heap has a wt_parm1 matching 'parm1'.
  *
  * @param[in]	parm1	- parameter being matched.
  *
@@ -233,29 +473,14 @@ has_task_by_parm1(void *parm1)
 {
 	struct work_task  *ptask;
 
-	/* only 1 ptask can be possibly matched */
-	ptask = (struct work_task *)GET_NEXT(task_list_event);
-	while (ptask) {
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
-			return 1;
-		}
-		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkall);
-	}
-
-	ptask = (struct work_task *)GET_NEXT(task_list_timed);
-	while (ptask) {
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
-			return 1;
-		}
-		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkall);
-	}
+	if ((parm1 == NULL) || (parm1_index == NULL))
+		return 0;
 
-	ptask = (struct work_task *)GET_NEXT(task_list_immed);
+	ptask = (struct work_task *)GET_NEXT(parm1_index[PARM1_HASH(parm1, parm1_index_size)]);
 	while (ptask) {
-		if ((ptask->wt_parm1 != NULL) && (ptask->wt_parm1 == parm1)) {
+		if ((ptask->wt_parm1 == parm1) && task_is_pending(ptask))
 			return 1;
-		}
-		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkall);
+		ptask = (struct work_task *)GET_NEXT(ptask->wt_linkparm1);
 	}
 
 	return 0;
@@ -267,7 +492,8 @@ has_task_by_parm1(void *parm1)
  *	1. If svr_delay_entry is set, then a delayed task in the
  *	   task_list_event is ready so find and process it.
  *	2. All items on the immediate list, then
- *	3. All items on the timed task list which have expired times
+ *	3. All items in the timed task heap which have expired times,
+ *	   earliest first.
  *
  * @return time_t
  * @retval The amount of time till next task
@@ -307,13 +533,14 @@ default_next_task(void)
 	while ((ptask=(struct work_task *)GET_NEXT(task_list_immed)) != NULL)
 		dispatch_task(ptask);
 
-	while ((ptask=(struct work_task *)GET_NEXT(task_list_timed))!=NULL) {
+	while (timed_heap_cnt > 0) {
+		ptask = timed_heap[0];
 		if ((delay = ptask->wt_event - time_now) > 0) {
 			if (tilwhen > delay)
 				tilwhen = delay;
 			break;
 		} else {
-			dispatch_task(ptask);	/* will delete link */
+			dispatch_task(ptask);	/* will remove it from the heap */
 		}
 
 	}
@@ -612,6 +612,33 @@ set_working_bucket_to_truth(node_bucket *nb) {
 	nb->free_pool->working_ct = nb->free_pool->truth_ct;
 }
 
+/**
+ * @brief move nodes from one of a bucket's working pools to its busy pool
+ *	  and allocate them to a chunk
+ * @param[in,out] bkt - the bucket
+ * @param[in,out] pool - the bucket's pool the nodes are moved out of
+ * @param[in] nodes - the nodes to move
+ * @param[in,out] cmap - chunk the nodes are allocated to
+ * @return int - number of nodes moved
+ */
+static int
+move_working_to_busy(node_bucket *bkt, bucket_bitpool *pool, pbs_bitmap *nodes, chunk_map *cmap)
+{
+	int ct;
+
+	ct = pbs_bitmap_count_on_bits(nodes);
+	if (ct == 0)
+		return 0;
+
+	pbs_bitmap_andnot(pool->working, nodes);
+	pool->working_ct -= ct;
+	pbs_bitmap_or(bkt->busy_pool->working, nodes);
+	bkt->busy_pool->working_ct += ct;
+	pbs_bitmap_or(cmap->node_bits, nodes);
+
+	return ct;
+}
+
 /**
  * @brief map job to nodes in buckets and allocate nodes to job
  * @param[in, out] cmap - mapping between chunks and buckets for the job
@@ -627,15 +654,15 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 	int i;
 	int j;
 	int k;
-	static pbs_bitmap *zeromap = NULL;
+	static pbs_bitmap *take = NULL;	/* nodes to allocate from a pool */
 	server_info *sinfo;
 	
 	if (cmap == NULL || resresv == NULL || resresv->select == NULL)
 		return 0;
 
-	if (zeromap == NULL) {
-		zeromap = pbs_bitmap_alloc(NULL, 1);
-		if (zeromap == NULL)
+	if (take == NULL) {
+		take = pbs_bitmap_alloc(NULL, 1);
+		if (take == NULL)
 			return 0;
 	}
 	
@@ -643,10 +670,9 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 
 	for (i = 0; cmap[i] != NULL; i++) {
 		if (cmap[i]->bkt_cnts != NULL) {
-			for (j = 0; cmap[i]->bkt_cnts[j] != NULL; j++) {
+			for (j = 0; cmap[i]->bkt_cnts[j] != NULL; j++)
 				set_working_bucket_to_truth(cmap[i]->bkt_cnts[j]->bkt);
-				pbs_bitmap_assign(cmap[i]->node_bits, zeromap);
-			}
+			pbs_bitmap_range_off(cmap[i]->node_bits, 0, cmap[i]->node_bits->num_bits);
 		}
 	}
 
@@ -658,9 +684,11 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 
 		for (j = 0; cmap[i]->bkt_cnts[j] != NULL && num_chunks_needed > 0; j++) {
 			node_bucket *bkt = cmap[i]->bkt_cnts[j]->bkt;
+			int chunk_count = cmap[i]->bkt_cnts[j]->chunk_count;
 			int chunks_added = 0;
 
-
+			/* busy later nodes need to be checked one at a time */
+			pbs_bitmap_range_off(take, 0, take->num_bits);
 			for (k = pbs_bitmap_first_on_bit(bkt->busy_later_pool->working);
 			     num_chunks_needed > chunks_added && k >= 0;
 			     k = pbs_bitmap_next_on_bit(bkt->busy_later_pool->working, k)) {
@@ -673,33 +701,36 @@ bucket_match(chunk_map **cmap, resource_resv *resresv, schd_error *err)
 						}
 				}
 				if (node_can_fit_job_time(k, resresv)) {
-					pbs_bitmap_bit_off(bkt->busy_later_pool->working, k);
-					bkt->busy_later_pool->working_ct--;
-					pbs_bitmap_bit_on(bkt->busy_pool->working, k);
-					bkt->busy_pool->working_ct++;
-					pbs_bitmap_bit_on(cmap[i]->node_bits, k);
-					chunks_added += cmap[i]->bkt_cnts[j]->chunk_count;
+					pbs_bitmap_bit_on(take, k);
+					chunks_added += chunk_count;
 				}
 
 			}
+			move_working_to_busy(bkt, bkt->busy_later_pool, take, cmap[i]);
 
-			for (k = pbs_bitmap_first_on_bit(bkt->free_pool->working);
-			     num_chunks_needed > chunks_added && k >= 0;
-			     k = pbs_bitmap_next_on_bit(bkt->free_pool->working, k)) {
-				clear_schd_error(err);
-				if (resresv->aoename != NULL) {
+			if (num_chunks_needed > chunks_added && resresv->aoename == NULL) {
+				/* Any free node will do: take the first ones we need all at once */
+				int nodes_needed = (num_chunks_needed - chunks_added + chunk_count - 1) / chunk_count;
+
+				if (pbs_bitmap_first_n_on_bits(bkt->free_pool->working, nodes_needed, take) > 0) {
+					clear_schd_error(err);
+					chunks_added += move_working_to_busy(bkt, bkt->free_pool, take, cmap[i]) * chunk_count;
+				}
+			} else if (num_chunks_needed > chunks_added) {
+				pbs_bitmap_range_off(take, 0, take->num_bits);
+				for (k = pbs_bitmap_first_on_bit(bkt->free_pool->working);
+				     num_chunks_needed > chunks_added && k >= 0;
+				     k = pbs_bitmap_next_on_bit(bkt->free_pool->working, k)) {
+					clear_schd_error(err);
 					if (sinfo->unordered_nodes[k]->current_aoe == NULL ||
 					   strcmp(sinfo->unordered_nodes[k]->current_aoe, resresv->aoename) != 0)
 						if (is_provisionable(sinfo->unordered_nodes[k], resresv, err) == NOT_PROVISIONABLE) {
 							continue;
 						}
+					pbs_bitmap_bit_on(take, k);
+					chunks_added += chunk_count;
 				}
-				pbs_bitmap_bit_off(bkt->free_pool->working, k);
-				bkt->free_pool->working_ct--;
-				pbs_bitmap_bit_on(bkt->busy_pool->working, k);
-				bkt->busy_pool->working_ct++;
-				pbs_bitmap_bit_on(cmap[i]->node_bits, k);
-				chunks_added += cmap[i]->bkt_cnts[j]->chunk_count;
+				move_working_to_busy(bkt, bkt->free_pool, take, cmap[i]);
 			}
 
 			if (chunks_added > 0)
@@ -103,6 +103,7 @@
 #include "resource.h"
 #include "buckets.h"
 #include "pbs_bitmap.h"
+#include "cycle_profile.h"
 
 
 /**
@@ -1139,6 +1140,7 @@ check_avail_resources(schd_resource *reslist, resource_req *reqlist,
 	schd_resource *fres = false_res();
 	schd_resource *zres = zero_res();
 	schd_resource *ustr = unset_str_res();
+	schd_resource tmpres;			/* stand-in for an unset resource */
 	char resbuf1[MAX_LOG_SIZE];
 	char resbuf2[MAX_LOG_SIZE];
 	char resbuf3[MAX_LOG_SIZE];
@@ -1182,14 +1184,18 @@ check_avail_resources(schd_resource *reslist, resource_req *reqlist,
 				 * reslist, then this means the boolean is false
 				 */
 				if (resreq->type.is_boolean)
-					res = fres;
+					tmpres = *fres;
 				else if (resreq->type.is_num && (flags & UNSET_RES_ZERO))
-					res = zres;
+					tmpres = *zres;
 				else if (resreq->type.is_string && (flags & UNSET_RES_ZERO))
-					res = ustr;
+					tmpres = *ustr;
 				else /* ignore check: effect is resource is infinite */
 					continue;
 
+				/* work on a copy so the shared singletons are never modified
+				 * (nodes may be checked from several threads at once)
+				 */
+				res = &tmpres;
 				res->name = resreq->name;
 				res->def = resreq->def;
 			}
@@ -1512,6 +1518,7 @@ check_nodes(status *policy, server_info *sinfo, queue_info *qinfo, resource_resv
 	int			error = 0;
 	node_partition		**nodepart = NULL;
 	node_info		**ninfo_arr = NULL;
+	double			prof_ts;
 
 	if (sinfo == NULL || resresv == NULL || err == NULL) {
 		if (err != NULL)
@@ -1625,8 +1632,10 @@ check_nodes(status *policy, server_info *sinfo, queue_info *qinfo, resource_resv
 	get_resresv_spec(resresv, &spec, &pl);
 
 	err->status_code = NOT_RUN;
+	prof_ts = profile_begin();
 	rc = eval_selspec(policy, spec, pl, ninfo_arr, nodepart, resresv,
 		flags, &nspec_arr, err);
+	profile_end(PROF_EVAL_SELSPEC, resresv, prof_ts);
 
 	/* We can run, yippie! */
 	if (rc > 0)
@@ -53,6 +53,10 @@
 #define CONFIG_FILE "sched_config"
 #define USAGE_FILE "usage"
 #define USAGE_TOUCH USAGE_FILE ".touch"
+/* usage file updates are journaled here first */
+#define USAGE_JOURNAL_SUFFIX ".journal"
+/* full rewrites of the usage file are written here and renamed over it */
+#define USAGE_NEW_SUFFIX ".new"
 #define HOLIDAYS_FILE "holidays"
 #define RESGROUP_FILE "resource_group"
 #define DEDTIME_FILE "dedicated_time"
@@ -61,6 +65,8 @@
 #define USAGE_MAGIC "PBS_MAG!"
 #define USAGE_VERSION 2
 #define USAGE_NAME_MAX 50
+/* usage journal "magic number" - needs to be 8 chars */
+#define USAGE_JOURNAL_MAGIC "PBS_JRN!"
 
 #define UNKNOWN_GROUP_NAME "unknown"
 
@@ -161,6 +167,10 @@
 
 /* undocumented */
 #define PARSE_MAX_JOB_CHECK "max_job_check"
+#define PARSE_NODE_EVAL_THREADS "node_eval_threads"
+#define PARSE_CYCLE_PROFILE "cycle_profile"
+#define PARSE_CYCLE_PROFILE_TRACE "cycle_profile_trace"
+#define PARSE_SNAPSHOT_CAPTURE "snapshot_capture"
 #define PARSE_PREEMPT_ATTEMPTS "preempt_attempts"
 #define PARSE_UPDATE_COMMENTS "update_comments"
 #define PARSE_RESV_CONFIRM_IGNORE "resv_confirm_ignore"
@@ -190,6 +200,8 @@
 #define NUM_PPRIO 20
 #define NUM_PEERS 50
 #define MAX_DEF_REPLY 5
+#define MAX_ATTR_UPDATES_BATCH 1000	/* jobs per pbs_alterjobs() */
+#define MAX_RUNJOBS_INFLIGHT 64	/* jobs per pbs_asyrunjobs() */
 #define MAX_PTIME_SIZE 64
 
 /* resource names for sorting special cases */
@@ -92,6 +92,29 @@ enum select_job_status
 
 #define INIT_ARR_SIZE 2048
 
+/* counts lists longer than this get a name index on their head */
+#define COUNTS_INDEX_MIN 16
+
+/* nodes each thread checks per window of parallel node evaluation */
+#define NODE_EVAL_CHUNK 32
+
+/* length of a calendar time index key (an encoded time_t) */
+#define EVENT_TIME_KEY_LEN 8
+
+/* a job array is resorted incrementally if fewer than 1/this of its jobs
+ * are out of place, otherwise it is sorted from scratch
+ */
+#define JOB_RESORT_MOVED_DIV 8
+
+/* the cycle profile trace is rolled over to <file>.old at this size */
+#define PROFILE_TRACE_MAX_SIZE (64 * 1024 * 1024)
+
+/* number of distinct formulas whose compiled form is kept */
+#define FORMULA_CACHE_SIZE 4
+
+/* deepest nesting (and value stack) a compiled formula may have */
+#define FORMULA_MAX_NEST 64
+
 /* Unspecified resource value */
 #define UNSPECIFIED -1
 #define UNSPECIFIED_STR "UNSPECIFIED"
@@ -311,7 +334,8 @@ enum { SIMULATE_SD = -1 };
 
 enum fairshare_flags
 {
-	FS_TRIM = 1
+	FS_TRIM = 1,
+	FS_READ_ONLY = 2	/* reader only: don't replay the update journal */
 };
 
 /* flags used for copy constructors - bit field */
@@ -353,8 +377,17 @@ enum run_update_resresv_flags
 {
 	RURR_NO_FLAGS = 0,
 	RURR_ADD_END_EVENT = 1, /* add end events to calendar for job */
-	RURR_NOPRINT = 2       /* don't print messages */
-	/* next value 4 */
+	RURR_NOPRINT = 2,      /* don't print messages */
+	RURR_PIPELINE = 4      /* in throughput mode, queue the run request (see flush_run_jobs()) */
+	/* next value 8 */
+};
+
+/* how run_job() sends a run request to the server */
+enum runjob_mode
+{
+	RUNJOB_WAIT,		/* pbs_runjob(), wait for the job to start */
+	RUNJOB_ASYNC,		/* pbs_asyrunjob(), throughput mode */
+	RUNJOB_PIPELINED	/* queued to be sent with others by flush_run_jobs() */
 };
 
 enum delete_event_flags
@@ -524,6 +557,72 @@ enum update_sort_defs
 	SD_UPDATE
 };
 
+/* phases of a scheduling cycle timed by the cycle profiler */
+enum profile_phase
+{
+	PROF_QUERY_SERVER,
+	PROF_SORT,
+	PROF_MAIN_LOOP,
+	PROF_IS_OK_TO_RUN,
+	PROF_EVAL_SELSPEC,
+	PROF_CALENDAR,
+	PROF_PREEMPT,
+	PROF_RUN_JOB,
+	PROF_SEND_UPDATES,
+	PROF_NUM_PHASES
+};
+
+/* classes of jobs the cycle profiler splits each phase by */
+enum profile_class
+{
+	PROF_CLASS_NONE,	/* phase is not for a job */
+	PROF_CLASS_NORMAL,
+	PROF_CLASS_EXPRESS,	/* in a queue at or above preempt_queue_prio */
+	PROF_CLASS_STARVING,
+	PROF_CLASS_RESV,	/* reservations and jobs in reservations */
+	PROF_NUM_CLASSES
+};
+
+/* kinds of server status kept in a cycle snapshot, in the order queried */
+enum snap_obj
+{
+	SNAP_RESOURCES,
+	SNAP_SERVER,
+	SNAP_SCHED,
+	SNAP_RESVS,
+	SNAP_NODES,
+	SNAP_QUEUES,
+	SNAP_JOBS,		/* one section per queue */
+	SNAP_NUM_OBJS
+};
+
+/* decisions of the main loop reported when replaying a snapshot */
+enum snap_decision
+{
+	SNAP_DEC_RUN,
+	SNAP_DEC_PREEMPT,	/* ran after preempting other jobs */
+	SNAP_DEC_TOPJOB,	/* added to the calendar, also reported as not run */
+	SNAP_DEC_NOT_RUN,
+	SNAP_NUM_DECISIONS
+};
+
+/* entity types of the limit counts kept in a usage_profile */
+enum usage_entity
+{
+	USAGE_USER,
+	USAGE_GROUP,
+	USAGE_PROJECT,
+	USAGE_ALL
+};
+
+/* return codes of eval_formula() */
+enum formula_ret
+{
+	FORMULA_OK,
+	FORMULA_ERROR,
+	FORMULA_PYTHON
+};
+
 enum update_attr_flags
 {
 	UPDATE_FLAGS_LOW = 0,
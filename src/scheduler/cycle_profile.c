@@ -0,0 +1,343 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    cycle_profile.c
+ *
+ * @brief
+ * 		cycle_profile.c - time the phases of a scheduling cycle.
+ *
+ *		When cycle_profile is set in sched_config, the wall time and
+ *		number of calls of each phase of the cycle are collected per job
+ *		class.  At the end of the cycle they are logged, and appended to
+ *		the cycle_profile_trace file if one is set.  When cycle_profile
+ *		is not set, profile_begin() and profile_end() return right away.
+ *
+ * Functions included are:
+ * 	profile_cycle_start()
+ * 	profile_begin()
+ * 	profile_end()
+ * 	profile_cycle_end()
+ * 	profile_report()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <sys/time.h>
+#endif
+
+#include <log.h>
+#include "data_types.h"
+#include "constant.h"
+#include "globals.h"
+#include "misc.h"
+#include "cycle_profile.h"
+
+static const char *phase_names[PROF_NUM_PHASES] = {
+	"query_server",
+	"sort",
+	"main_loop",
+	"is_ok_to_run",
+	"eval_selspec",
+	"calendar",
+	"preempt",
+	"run_job",
+	"send_job_updates"
+};
+
+static const char *class_names[PROF_NUM_CLASSES] = {
+	"none",
+	"normal",
+	"express",
+	"starving",
+	"resv"
+};
+
+static int profiling = 0;		/* profiling the current cycle */
+static double cycle_start_ts;		/* profile_now() at cycle start */
+static struct profile_trace_rec cur_prof;
+
+/**
+ * @brief
+ * 		a monotonic timestamp in seconds
+ *
+ * @return	double
+ */
+static double
+profile_now(void)
+{
+#ifdef WIN32
+	return (double) time(NULL);
+#else
+	struct timespec ts;
+
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+		return ts.tv_sec + ts.tv_nsec / 1e9;
+	return (double) time(NULL);
+#endif
+}
+
+/**
+ * @brief
+ * 		the profile class of a job or reservation
+ *
+ * @param[in]	resresv	-	job or reservation (may be NULL)
+ *
+ * @return	enum profile_class
+ */
+static enum profile_class
+profile_class(resource_resv *resresv)
+{
+	job_info *job;
+
+	if (resresv == NULL)
+		return PROF_CLASS_NONE;
+	if (resresv->is_resv)
+		return PROF_CLASS_RESV;
+
+	job = resresv->job;
+	if (job == NULL)
+		return PROF_CLASS_NONE;
+	if (job->resv != NULL)
+		return PROF_CLASS_RESV;
+	if (job->queue != NULL && job->queue->priority >= conf.preempt_queue_prio)
+		return PROF_CLASS_EXPRESS;
+	if (job->is_starving)
+		return PROF_CLASS_STARVING;
+
+	return PROF_CLASS_NORMAL;
+}
+
+/**
+ * @brief
+ * 		profile_cycle_start - start profiling a cycle if cycle_profile
+ *		is set in sched_config
+ *
+ * @return	void
+ */
+void
+profile_cycle_start(void)
+{
+	profiling = conf.cycle_profile;
+	if (!profiling)
+		return;
+
+	memset(&cur_prof, 0, sizeof(cur_prof));
+	cur_prof.magic = PROFILE_TRACE_MAGIC;
+	cur_prof.version = PROFILE_TRACE_VERSION;
+	cur_prof.num_phases = PROF_NUM_PHASES;
+	cur_prof.num_classes = PROF_NUM_CLASSES;
+	cur_prof.cycle_start = (int64_t) time(NULL);
+	cycle_start_ts = profile_now();
+}
+
+/**
+ * @brief
+ * 		profile_begin - start timing a phase
+ *
+ * @return	double
+ * @retval	timestamp to pass to profile_end()
+ * @retval	0	: not profiling
+ */
+double
+profile_begin(void)
+{
+	if (!profiling)
+		return 0;
+
+	return profile_now();
+}
+
+/**
+ * @brief
+ * 		profile_end - account for one call of a phase
+ *
+ * @param[in]	phase	-	phase which was timed
+ * @param[in]	resresv	-	job or reservation the phase was for (or NULL)
+ * @param[in]	start	-	return of profile_begin() at the start of the phase
+ *
+ * @return	void
+ */
+void
+profile_end(enum profile_phase phase, resource_resv *resresv, double start)
+{
+	enum profile_class cls;
+
+	if (!profiling || start == 0)
+		return;
+
+	cls = profile_class(resresv);
+	cur_prof.calls[phase][cls]++;
+	cur_prof.secs[phase][cls] += profile_now() - start;
+}
+
+/**
+ * @brief
+ * 		append the current profile to the trace file.  The file is
+ *		rolled over to <file>.old when it grows past PROFILE_TRACE_MAX_SIZE
+ *
+ * @param[in]	fname	-	trace file
+ *
+ * @return	void
+ */
+static void
+write_profile_trace(char *fname)
+{
+	char oldname[MAXPATHLEN + 1];
+	struct stat st;
+	FILE *fp;
+
+	if (stat(fname, &st) == 0 &&
+		st.st_size + sizeof(cur_prof) > PROFILE_TRACE_MAX_SIZE) {
+		snprintf(oldname, sizeof(oldname), "%s.old", fname);
+		if (rename(fname, oldname) == -1)
+			log_err(errno, __func__, "Failed to roll over cycle profile trace");
+	}
+
+	if ((fp = fopen(fname, "ab")) == NULL) {
+		log_err(errno, __func__, "Failed to open cycle profile trace");
+		return;
+	}
+	if (fwrite(&cur_prof, sizeof(cur_prof), 1, fp) != 1)
+		log_err(errno, __func__, "Failed to write cycle profile trace");
+	fclose(fp);
+}
+
+/**
+ * @brief
+ * 		format the profile line of a phase of the last profiled cycle
+ *
+ * @param[in]	phase	-	phase to format
+ * @param[out]	buf	-	buffer to format into
+ * @param[in]	bufsize	-	size of buf
+ *
+ * @return	int
+ * @retval	1	: the phase ran, buf is set
+ * @retval	0	: the phase did not run
+ */
+static int
+format_profile_phase(int phase, char *buf, int bufsize)
+{
+	unsigned long calls = 0;
+	double secs = 0;
+	int len;
+	int j;
+
+	for (j = 0; j < PROF_NUM_CLASSES; j++) {
+		calls += cur_prof.calls[phase][j];
+		secs += cur_prof.secs[phase][j];
+	}
+	if (calls == 0)
+		return 0;
+
+	len = snprintf(buf, bufsize, "phase=%s calls=%lu secs=%.6f",
+		phase_names[phase], calls, secs);
+	for (j = 0; j < PROF_NUM_CLASSES && len < bufsize; j++) {
+		if (cur_prof.calls[phase][j] == 0)
+			continue;
+		len += snprintf(buf + len, bufsize - len, " %s=%lu/%.6f",
+			class_names[j], (unsigned long) cur_prof.calls[phase][j],
+			cur_prof.secs[phase][j]);
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		profile_cycle_end - log the profile of the cycle, one line per
+ *		phase which ran, and append it to the cycle_profile_trace file
+ *
+ * @return	void
+ */
+void
+profile_cycle_end(void)
+{
+	char buf[MAX_LOG_SIZE];
+	int i;
+
+	if (!profiling)
+		return;
+	profiling = 0;
+
+	cur_prof.cycle_secs = profile_now() - cycle_start_ts;
+
+	for (i = 0; i < PROF_NUM_PHASES; i++) {
+		if (format_profile_phase(i, buf, sizeof(buf)))
+			schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG,
+				"cycle_profile", buf);
+	}
+	snprintf(buf, sizeof(buf), "phase=cycle calls=1 secs=%.6f",
+		cur_prof.cycle_secs);
+	schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_SCHED, LOG_DEBUG,
+		"cycle_profile", buf);
+
+	if (conf.cycle_profile_trace != NULL)
+		write_profile_trace(conf.cycle_profile_trace);
+}
+
+/**
+ * @brief
+ * 		profile_report - print the profile of the last profiled cycle,
+ *		in the same form it is logged in
+ *
+ * @param[in]	fp	-	where to print
+ *
+ * @return	void
+ */
+void
+profile_report(FILE *fp)
+{
+	char buf[MAX_LOG_SIZE];
+	int i;
+
+	for (i = 0; i < PROF_NUM_PHASES; i++) {
+		if (format_profile_phase(i, buf, sizeof(buf)))
+			fprintf(fp, "%s\n", buf);
+	}
+	fprintf(fp, "phase=cycle calls=1 secs=%.6f\n", cur_prof.cycle_secs);
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+#ifndef	_CYCLE_PROFILE_H
+#define	_CYCLE_PROFILE_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <stdint.h>
+#include "data_types.h"
+#include "constant.h"
+
+#define PROFILE_TRACE_MAGIC 0x50425350		/* "PBSP" */
+#define PROFILE_TRACE_VERSION 1
+
+/*
+ *	one record of the cycle profile trace file, written at the end of each
+ *	profiled cycle in host byte order.  Times are wall clock seconds and
+ *	include time spent in nested phases (e.g. eval_selspec is also counted
+ *	in is_ok_to_run).
+ */
+struct profile_trace_rec
+{
+	uint32_t magic;				/* PROFILE_TRACE_MAGIC */
+	uint16_t version;			/* PROFILE_TRACE_VERSION */
+	uint16_t num_phases;			/* PROF_NUM_PHASES */
+	uint16_t num_classes;			/* PROF_NUM_CLASSES */
+	uint16_t pad[3];
+	int64_t cycle_start;			/* time the cycle started */
+	double cycle_secs;			/* length of the cycle */
+	uint32_t calls[PROF_NUM_PHASES][PROF_NUM_CLASSES];
+	double secs[PROF_NUM_PHASES][PROF_NUM_CLASSES];
+};
+
+/*
+ *	profile_cycle_start - start profiling a cycle if cycle_profile is set
+ */
+void profile_cycle_start(void);
+
+/*
+ *	profile_begin - start timing a phase
+ *
+ *	returns a timestamp to pass to profile_end(), 0 if not profiling
+ */
+double profile_begin(void);
+
+/*
+ *	profile_end - account for a phase started by profile_begin()
+ *		      resresv is the job or reservation the phase was for (or NULL)
+ */
+void profile_end(enum profile_phase phase, resource_resv *resresv, double start);
+
+/*
+ *	profile_cycle_end - log the cycle's profile and append it to the trace
+ */
+void profile_cycle_end(void);
+
+/*
+ *	profile_report - print the profile of the last profiled cycle
+ */
+void profile_report(FILE *fp);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _CYCLE_PROFILE_H */
@@ -54,9 +54,11 @@
 extern "C" {
 #endif
 
+#include <sys/types.h>
 #include <time.h>
 #include <pbs_ifl.h>
 #include <libutil.h>
+#include <avltree.h>
 #include "constant.h"
 #include "config.h"
 #include "pbs_bitmap.h"
@@ -83,6 +85,8 @@ struct resource_resv;
 struct place;
 struct schd_error;
 struct np_cache;
+struct np_layout;
+struct np_persist;
 struct chunk;
 struct selspec;
 struct resdef;
@@ -91,6 +95,8 @@ struct status;
 struct fairshare_head;
 struct node_scratch;
 struct te_list;
+struct event_time_slot;
+struct job_sort_key;
 struct node_bucket;
 struct bucket_bitpool;
 struct chunk_map;
@@ -116,6 +122,8 @@ typedef struct resource_resv resource_resv;
 typedef struct place place;
 typedef struct schd_error schd_error;
 typedef struct np_cache np_cache;
+typedef struct np_layout np_layout;
+typedef struct np_persist np_persist;
 typedef struct chunk chunk;
 typedef struct selspec selspec;
 typedef struct resdef resdef;
@@ -126,10 +134,15 @@ typedef struct fairshare_head fairshare_head;
 typedef struct node_scratch node_scratch;
 typedef struct resresv_set resresv_set;
 typedef struct te_list te_list;
+typedef struct event_time_slot event_time_slot;
+typedef struct job_sort_key job_sort_key;
 typedef struct node_bucket node_bucket;
 typedef struct bucket_bitpool bucket_bitpool;
 typedef struct chunk_map chunk_map;
 typedef struct node_bucket_count node_bucket_count;
+typedef struct formula_expr formula_expr;
+typedef struct usage_profile usage_profile;
+typedef struct start_horizon start_horizon;
 
 #ifdef NAS
 /* localmod 034 */
@@ -199,6 +212,7 @@ struct place
 	unsigned int share:1;		/* will share nodes */
 
 	char *group;			/* resource to node group by */
+	int refct;			/* # of owners sharing this spec */
 };
 
 struct chunk
@@ -215,6 +229,7 @@ struct selspec
 	int total_cpus;			/* # of cpus requested in this select spec */
 	resdef **defs;			/* the resources requested by this select spec*/
 	chunk **chunks;
+	int refct;			/* # of owners sharing this spec */
 };
 
 /* for description of these bits, check the PBS admin guide or scheduler IDS */
@@ -297,10 +312,13 @@ struct server_info
 	unsigned enforce_prmptd_job_resumption:1;/* If set, preempted jobs will resume after the preemptor finishes */
 	unsigned preempt_targets_enable:1;/* if preemptable limit targets are enabled */
 	unsigned use_hard_duration:1;	/* use hard duration when creating the calendar */
+	unsigned has_modifyjobs:1;	/* server accepts pbs_alterjobs() */
+	unsigned has_runjobs:1;		/* server accepts pbs_asyrunjobs() */
 	char *name;			/* name of server */
 	struct schd_resource *res;	/* list of resources */
 	void *liminfo;			/* limit storage information */
 	int flt_lic;			/* number of free floating licences */
+	int release_gen;		/* incremented when resources are released on nodes */
 	int num_queues;			/* number of queues that reside on the server */
 	int num_nodes;			/* number of nodes associated with the server */
 	int num_resvs;			/* number of reservations on the server */
@@ -360,6 +378,7 @@ struct server_info
 
 	resource_resv *qrun_job;	/* used if running a job via qrun request */
 	char *job_formula;		/* formula used for sorting */
+	char *job_chgseq;		/* server's job change sequence "epoch:seq" */
 	/* policy structure for the server.  This is an easy storage location for
 	 * the policy struct.  The policy struct will be passed around separately
 	 */
@@ -368,6 +387,7 @@ struct server_info
 	resresv_set **equiv_classes;
 	node_bucket **buckets;		/* node bucket array */
 	node_info **unordered_nodes;
+	AVL_IX_DESC *node_idx;		/* node name -> node for nodes/unordered_nodes */
 #ifdef NAS
 	/* localmod 049 */
 	node_info **nodes_by_NASrank;	/* nodes indexed by NASrank */
@@ -495,6 +515,8 @@ struct job_info
 
 	struct attrl *attr_updates;	/* used to federate all attr updates to server*/
 	float formula_value;		/* evaluated job sort formula value */
+	job_sort_key *sort_key;		/* [reference] precomputed key while sorting */
+	int sort_pos;			/* index of job after it was last sorted */
 	nspec **resreleased;		/* list of resources released by the job on each node */
 	resource_req *resreq_rel;	/* list of resources released */
 
@@ -746,6 +768,12 @@ struct schd_resource
 	resdef *def;			/* resource definition */
 
 	struct schd_resource *next;	/* next resource in list */
+
+	/* only set on the head of a list: the list's resources indexed by
+	 * resdef->ind, so find_resource() does not have to walk the list
+	 */
+	schd_resource **def_ind;
+	int def_ind_size;		/* number of slots in def_ind */
 };
 
 struct resource_req
@@ -764,6 +792,7 @@ struct resdef
 	char *name;			/* name of resource */
 	struct resource_type type;	/* resource type */
 	unsigned int flags;		/* resource flags (see pbs_ifl.h) */
+	int ind;			/* index of the resource in allres, -1 if none */
 };
 
 struct prev_job_info
@@ -786,6 +815,8 @@ struct counts
 	int running;		/* count of running jobs in object */
 	resource_req *rescts;	/* resources used */
 	counts *next;
+	AVL_IX_DESC *name_idx;	/* name index of the list, only set on the head */
+	counts *tail;		/* last element of the list, kept with name_idx */
 };
 
 /* global data types */
@@ -795,6 +826,14 @@ struct fairshare_head
 {
 	group_info *root;			/* root of fairshare tree */
 	time_t last_decay;			/* last time tree was decayed */
+
+	/* the usage file the tree was last read from or written to.  If it
+	 * is still the same file, only changed records are written to it.
+	 */
+	int usage_slots;			/* number of records, 0 if unknown */
+	dev_t usage_dev;
+	ino_t usage_ino;
+	time_t usage_last_decay;		/* last_decay in the file */
 };
 
 /* a path from the root to a group_info in the tree */
@@ -824,10 +863,13 @@ struct group_info
 	float usage_factor;			/* usage calculation taking parent's usage into account: number between 0 and 1 */
 
 	struct group_path *gpath;		/* path from the root of the tree */
+	int sort_rank;				/* fairshare order of group while sorting jobs */
 
 	group_info *parent;			/* parent node */
 	group_info *sibling;			/* sibling node */
 	group_info *child;			/* child node */
+	AVL_IX_DESC *name_idx;			/* name index of the tree, only set on the root */
+	int usage_slot;				/* record of the entity in the usage file or -1 */
 };
 
 /**
@@ -851,6 +893,14 @@ struct resresv_set
 
 	resource_resv **resresv_arr;	/* The resresvs in the set */
 	int num_resresvs;		/* The number of resresvs in the set */
+
+	/* Placement memo: where earlier members of the set did not fit.  Only
+	 * valid while the server's release_gen equals memo_gen
+	 */
+	int memo_gen;			/* server release_gen the memo was made in */
+	pbs_bitmap *memo_nofit;		/* nodes (by node_ind) a chunk did not fit on */
+	int *memo_np_nofit;		/* ranks of node partitions the set did not fit in */
+	int memo_np_ct;			/* number of ranks in memo_np_nofit */
 };
 
 struct node_partition
@@ -867,6 +917,7 @@ struct node_partition
 	node_info **ninfo_arr;	/* array of pointers to node structures  */
 	node_bucket **bkts;	/* node buckets for node part */
 	int rank;		/* unique numeric identifier for node partition */
+	pbs_bitmap *node_map;	/* bitmap of member nodes by node_ind */
 };
 
 struct np_cache
@@ -877,6 +928,32 @@ struct np_cache
 	node_partition **nodepart;	/* node partitions */
 };
 
+/* one partition of a node partition layout kept across cycles */
+struct np_layout
+{
+	unsigned int ok_break:1;	/* OK to break up chunks on this node part */
+	unsigned int dirty:1;		/* membership changed, recompute ok_break */
+	char *name;			/* res_name=res_val */
+	char *res_name;			/* resource which defines the partition */
+	char *res_val;			/* value of res_name */
+};
+
+/* node partition layout remembered across cycles.  Nodes whose
+ * signature is unchanged keep their cached partition membership.
+ */
+struct np_persist
+{
+	char *key;			/* owner of the layout (e.g., server or queue) */
+	char **resnames;		/* resource names used to create partitions */
+	unsigned int flags;		/* NP_* flags used to create partitions */
+	int num_nodes;			/* number of nodes in node_sigs/node_parts */
+	char **node_sigs;		/* per node membership signature */
+	int **node_parts;		/* per node -1 terminated layout indices */
+	int num_layouts;		/* number of entries in layouts */
+	np_layout **layouts;		/* partition layouts */
+	int generation;			/* last cycle the layout was used */
+};
+
 /* header to usage file.  Needs to be EXACTLY the same size as a
  * group_node_usage for backwards compatibility
  * tag defined in config.h
@@ -910,6 +987,25 @@ struct group_node_usage_v2
 	usage_t usage;
 };
 
+/* The usage file is updated in place one record at a time.  The records to
+ * update are first written to a journal, which is replayed onto the usage
+ * file if the update does not finish.  The journal is a header, count
+ * usage_journal_rec's and a checksum of both.
+ */
+struct usage_journal_header
+{
+	char tag[9];			/* USAGE_JOURNAL_MAGIC */
+	int count;			/* number of records */
+	int nslots;			/* records in the usage file after the update */
+	time_t last_decay;		/* last_decay of the usage file */
+};
+
+struct usage_journal_rec
+{
+	int slot;			/* record of the usage file to write */
+	struct group_node_usage_v2 grp;
+};
+
 struct usage_info
 {
 	char *name;			/* name of the user */
@@ -1035,6 +1131,7 @@ struct config
 	unsigned prime_pre	:1;	/* preemptive scheduling */
 	unsigned non_prime_pre:1;
 	unsigned update_comments:1;	/* should we update comments or not */
+	unsigned cycle_profile:1;	/* time the phases of each cycle */
 	unsigned prime_exempt_anytime_queues:1; /* backfill affects anytime queues */
 	unsigned assign_ssinodes:1;	/* assign the ssinodes resource */
 	unsigned preempt_suspend:1;	/* allow preemption through suspention */
@@ -1076,6 +1173,7 @@ struct config
 	int preempt_queue_prio;			/* Queue prio that defines an express queue */
 	int max_preempt_attempts;		/* max num of preempt attempts per cyc*/
 	int max_jobs_to_check;			/* max number of jobs to check in cyc*/
+	int node_eval_threads;			/* threads used to evaluate nodes */
 	long dflt_opt_backfill_fuzzy;		/* default time for the fuzzy backfill optimization */
 	char ded_prefix[PBS_MAXQUEUENAME +1];	/* prefix to dedicated queues */
 	char pt_prefix[PBS_MAXQUEUENAME +1];	/* prefix to primetime queues */
@@ -1083,6 +1181,8 @@ struct config
 	char *fairshare_res;			/* resource to calc fairshare usage */
 	float fairshare_decay_factor;		/* decay factor used when decaying fairshare tree */
 	char *fairshare_ent;			/* job attribute to use as fs entity */
+	char *cycle_profile_trace;		/* file cycle profiles are appended to */
+	char *snapshot_capture;			/* file the server status of each cycle is saved to */
 	char **dyn_res_to_get;			/* dynamic resources to get from moms */
 	char **res_to_check;			/* the resources schedule on */
 	resdef **resdef_to_check;		/* the res to schedule on in def form */
@@ -1126,7 +1226,38 @@ struct event_list
 	unsigned int eol:1;		/* we've reached the end of time */
 	timed_event *events;		/* the calendar of events */
 	timed_event *next_event;	/* the next event to be performed */
+	timed_event *last_event;	/* the last event in the calendar */
 	time_t *current_time;		/* [reference] current time in the calendar */
+	AVL_IX_DESC *time_index;	/* event_time -> event_time_slot */
+	AVL_IX_DESC *name_index;	/* event name -> first event of that name */
+	timed_event *run_event_from;	/* next_event run_event was computed from */
+	timed_event *run_event;		/* cached first enabled run event */
+	unsigned long run_event_gen;	/* calendar generation of the cache */
+	unsigned long gen;		/* bumped when an event is linked or unlinked */
+	usage_profile *usage_prof;	/* future job usage for check_limits() */
+	start_horizon *horizon;		/* future free resources for calc_run_time() */
+};
+
+/* everything cmp_sort() compares two jobs on, computed once per sort */
+struct job_sort_key
+{
+	unsigned int runnable:1;	/* job is in a runnable state */
+	unsigned int starving:1;	/* job is starving */
+	int preempt;			/* preempt priority */
+	time_t time_preempted;		/* time the job was preempted */
+	long sch_priority;		/* scheduler priority of the job */
+	float formula_value;		/* evaluated job sort formula value */
+	int fairshare_rank;		/* sort_rank of the job's group or -1 */
+	sch_resource_t *res;		/* value of each job_sort_key entry */
+	long qrank;
+	int rank;
+};
+
+/* all events of a calendar which happen at the same time */
+struct event_time_slot
+{
+	timed_event *first;		/* first event at this time */
+	timed_event *last;		/* last event at this time */
 };
 
 struct timed_event
@@ -1140,6 +1271,8 @@ struct timed_event
 	void *event_func_arg;		/* optional argument to function - not freed */
 	timed_event *next;
 	timed_event *prev;
+	timed_event *name_next;		/* next event in calendar with same name */
+	timed_event *name_prev;		/* prev event in calendar with same name */
 };
 
 struct te_list {
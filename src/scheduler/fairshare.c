@@ -44,7 +44,10 @@
  *
  * Functions included are:
  * 	add_child()
+ * 	index_group_info()
+ * 	new_group_index()
  * 	add_unknown()
+ * 	alloc_unknown_ginfo()
  * 	find_group_info()
  * 	find_alloc_ginfo()
  * 	new_group_info()
@@ -57,8 +60,16 @@
  * 	decay_fairshare_tree()
  * 	compare_path()
  * 	print_fairshare()
+ * 	usage_data_offset()
+ * 	usage_journal_sum()
+ * 	usage_journal_name()
+ * 	apply_usage_records()
+ * 	replay_usage_journal()
+ * 	collect_usage_changes()
+ * 	update_usage()
  * 	write_usage()
  * 	rec_write_usage()
+ * 	reset_usage_slots()
  * 	read_usage()
  * 	read_usage_v1()
  * 	read_usage_v2()
@@ -81,6 +92,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <sys/stat.h>
+#ifndef WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif /* WIN32 */
 
 #include <log.h>
 
@@ -122,9 +139,72 @@ add_child(group_info *ginfo, group_info *parent)
 		ginfo->parent = parent;
 		ginfo->resgroup = parent->cresgroup;
 		ginfo->gpath = create_group_path(ginfo);
+		if (ginfo->gpath != NULL)
+			index_group_info(ginfo->gpath->ginfo, ginfo);
 	}
 }
 
+/**
+ * @brief
+ *		index_group_info - add a group_info to the name index of its tree.
+ *		If the name is already in the index, the first one stays.
+ *
+ * @param[in,out]	root	-	root of the tree
+ * @param[in]	ginfo	-	ginfo to add
+ *
+ * @return	int
+ * @retval	1	: success or the tree has no index
+ * @retval	0	: error, the tree is searched without the index
+ *
+ */
+int
+index_group_info(group_info *root, group_info *ginfo)
+{
+	if (root == NULL || root->name_idx == NULL || ginfo == NULL || ginfo->name == NULL)
+		return 1;
+
+	if (find_tree(root->name_idx, ginfo->name) != NULL)
+		return 1;
+
+	if (tree_add_del(root->name_idx, ginfo->name, ginfo, TREE_OP_ADD) != 0) {
+		/* fall back to walking the tree */
+		log_err(errno, __func__, MEM_ERR_MSG);
+		avl_destroy_index(root->name_idx);
+		free(root->name_idx);
+		root->name_idx = NULL;
+		return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		new_group_index - create the name index on the root of a tree
+ *		and add the root to it.  Nodes added with add_child() are
+ *		added to the index from then on.
+ *
+ * @param[in,out]	root	-	root of the tree
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error, the tree is searched without the index
+ *
+ */
+int
+new_group_index(group_info *root)
+{
+	if (root == NULL)
+		return 0;
+
+	if ((root->name_idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+
+	return index_group_info(root, root);
+}
+
 /**
  * @brief
  * 		add a ginfo to the "unknown" group
@@ -145,10 +225,44 @@ add_unknown(group_info *ginfo, group_info *root)
 	calc_fair_share_perc(unknown->child, UNSPECIFIED);
 }
 
+/**
+ * @brief
+ *		alloc_unknown_ginfo - allocate a new ginfo and add it to the
+ *			  "unknown" group
+ *
+ * @param[in]	name	-	name of the new ginfo
+ * @param[in]	root	-	root of the fairshare tree
+ * @param[in]	calc_perc -	recalculate the percentages of the "unknown"
+ *				  group.  Adding many entities at once should
+ *				  recalculate them once when done instead.
+ *
+ * @return	the newly allocated ginfo
+ * @retval	NULL	: error
+ *
+ */
+static group_info *
+alloc_unknown_ginfo(char *name, group_info *root, int calc_perc)
+{
+	group_info *ginfo;
+
+	if ((ginfo = new_group_info()) == NULL)
+		return NULL;
+
+	ginfo->name = string_dup(name);
+	ginfo->shares = 1;
+	if (calc_perc)
+		add_unknown(ginfo, root);
+	else
+		add_child(ginfo, find_group_info(UNKNOWN_GROUP_NAME, root));
+
+	return ginfo;
+}
+
 /**
  * @brief
  *		find_group_info - recursive function to find a group_info in the
- *			  resgroup tree
+ *			  resgroup tree.  The name index is used if root is
+ *			  the root of an indexed tree.
  *
  * @param[in]	name	-	name of the ginfo to find
  * @param[in]	root	-	the root of the current sub-tree
@@ -163,6 +277,9 @@ find_group_info(char *name, group_info *root)
 	if (root == NULL || name == NULL || !strcmp(name, root->name))
 		return root;
 
+	if (root->name_idx != NULL)
+		return find_tree(root->name_idx, name);
+
 	ginfo = find_group_info(name, root->sibling);
 	if (ginfo == NULL)
 		ginfo = find_group_info(name, root->child);
@@ -192,14 +309,9 @@ find_alloc_ginfo(char *name, group_info *root)
 
 	ginfo = find_group_info(name, root);
 
-	if (ginfo == NULL) {
-		if ((ginfo = new_group_info()) == NULL)
-			return NULL;
+	if (ginfo == NULL)
+		ginfo = alloc_unknown_ginfo(name, root, 1);
 
-		ginfo->name = string_dup(name);
-		ginfo->shares = 1;
-		add_unknown(ginfo, root);
-	}
 	return ginfo;
 }
 
@@ -230,9 +342,12 @@ new_group_info()
 	new->temp_usage = 1;
 	new->usage_factor = 0.0;
 	new->gpath = NULL;
+	new->sort_rank = -1;
 	new->parent = NULL;
 	new->sibling = NULL;
 	new->child = NULL;
+	new->name_idx = NULL;
+	new->usage_slot = -1;
 
 	return new;
 }
@@ -380,6 +495,7 @@ preload_tree()
 	root->resgroup = -1;
 	root->cresgroup = 0;
 	root->tree_percentage = 1.0;
+	new_group_index(root);
 
 	if ((unknown = new_group_info()) == NULL) {
 		free_fairshare_head(head);
@@ -450,17 +566,19 @@ calc_fair_share_perc(group_info *root, int shares)
 	else
 		cur_shares = shares;
 
-	if (cur_shares * root->parent->tree_percentage == 0) {
-		root->group_percentage = 0;
-		root->tree_percentage = 0;
-	}
-	else {
-		root->group_percentage = (float) root->shares / cur_shares;
-		root->tree_percentage = root->group_percentage  * root->parent->tree_percentage;
-	}
+	/* walk the siblings in a loop, resource groups can be very wide */
+	for (; root != NULL; root = root->sibling) {
+		if (cur_shares * root->parent->tree_percentage == 0) {
+			root->group_percentage = 0;
+			root->tree_percentage = 0;
+		}
+		else {
+			root->group_percentage = (float) root->shares / cur_shares;
+			root->tree_percentage = root->group_percentage  * root->parent->tree_percentage;
+		}
 
-	calc_fair_share_perc(root->sibling, cur_shares);
-	calc_fair_share_perc(root->child, UNSPECIFIED);
+		calc_fair_share_perc(root->child, UNSPECIFIED);
+	}
 	return 1;
 }
 
@@ -514,15 +632,13 @@ update_usage_on_run(resource_resv *resresv)
 void
 decay_fairshare_tree(group_info *root)
 {
-	if (root == NULL)
-		return;
+	for (; root != NULL; root = root->sibling) {
+		decay_fairshare_tree(root->child);
 
-	decay_fairshare_tree(root->sibling);
-	decay_fairshare_tree(root->child);
-
-	root->usage *= conf.fairshare_decay_factor;
-	if (root->usage == 0)
-		root->usage = 1;
+		root->usage *= conf.fairshare_decay_factor;
+		if (root->usage == 0)
+			root->usage = 1;
+	}
 }
 
 /**
@@ -586,10 +702,346 @@ compare_path(struct group_path *gp1, struct group_path *gp2)
 	return rc;
 }
 
+#ifndef WIN32
+/**
+ * @brief
+ *		usage_data_offset - offset of the first record of a version 2
+ *		usage file
+ *
+ * @return	off_t
+ */
+static off_t
+usage_data_offset(void)
+{
+	return sizeof(struct group_node_header) + sizeof(time_t);
+}
+
+/**
+ * @brief
+ *		usage_journal_sum - checksum of a usage journal
+ *
+ * @param[in]	jhead	-	journal header
+ * @param[in]	recs	-	journal records
+ *
+ * @return	unsigned long
+ */
+static unsigned long
+usage_journal_sum(struct usage_journal_header *jhead, struct usage_journal_rec *recs)
+{
+	unsigned long sum = 5381;
+	unsigned char *p;
+	size_t len;
+	size_t i;
+
+	p = (unsigned char *) jhead;
+	for (i = 0; i < sizeof(struct usage_journal_header); i++)
+		sum = sum * 33 + p[i];
+	p = (unsigned char *) recs;
+	len = jhead->count * sizeof(struct usage_journal_rec);
+	for (i = 0; i < len; i++)
+		sum = sum * 33 + p[i];
+
+	return sum;
+}
+
 /**
  * @brief
- *		write_usage - write the usage information to the usage file
- *		      This function uses a recursive helper function
+ *		usage_journal_name - name of the journal of a usage file
+ *
+ * @param[in]	filename	-	usage file
+ * @param[out]	buf	-	buffer for the name
+ * @param[in]	len	-	length of buf
+ *
+ * @return	char *	buf
+ */
+static char *
+usage_journal_name(char *filename, char *buf, size_t len)
+{
+	snprintf(buf, len, "%s%s", filename, USAGE_JOURNAL_SUFFIX);
+	return buf;
+}
+
+/**
+ * @brief
+ *		apply_usage_records - write records to their slots of a usage file
+ *
+ * @param[in]	fd	-	usage file open for writing
+ * @param[in]	jhead	-	journal header of the records
+ * @param[in]	recs	-	records to write
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+apply_usage_records(int fd, struct usage_journal_header *jhead, struct usage_journal_rec *recs)
+{
+	off_t off;
+	int i;
+
+	for (i = 0; i < jhead->count; i++) {
+		if (recs[i].slot < 0 || recs[i].slot >= jhead->nslots)
+			return 0;
+		off = usage_data_offset() + (off_t) recs[i].slot * sizeof(struct group_node_usage_v2);
+		if (pwrite(fd, &recs[i].grp, sizeof(struct group_node_usage_v2), off) !=
+			sizeof(struct group_node_usage_v2))
+			return 0;
+	}
+	if (pwrite(fd, &jhead->last_decay, sizeof(time_t), sizeof(struct group_node_header)) !=
+		sizeof(time_t))
+		return 0;
+	if (fsync(fd) == -1)
+		return 0;
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		replay_usage_journal - finish an update of a usage file which was
+ *			  interrupted.  A journal which was not completely
+ *			  written is thrown away; the usage file was not touched.
+ *
+ * @param[in]	filename	-	usage file
+ *
+ * @return	void
+ */
+static void
+replay_usage_journal(char *filename)
+{
+	char jname[MAXPATHLEN + 1];
+	struct usage_journal_header jhead;
+	struct usage_journal_rec *recs = NULL;
+	unsigned long sum;
+	FILE *jfp;
+	int fd;
+	int ok = 0;
+
+	usage_journal_name(filename, jname, sizeof(jname));
+	if ((jfp = fopen(jname, "rb")) == NULL)
+		return;
+
+	if (fread(&jhead, sizeof(jhead), 1, jfp) == 1 &&
+		strncmp(jhead.tag, USAGE_JOURNAL_MAGIC, sizeof(jhead.tag)) == 0 &&
+		jhead.count >= 0 && jhead.nslots >= 0 && jhead.count <= jhead.nslots) {
+		recs = malloc((jhead.count + 1) * sizeof(struct usage_journal_rec));
+		if (recs != NULL &&
+			fread(recs, sizeof(struct usage_journal_rec), jhead.count, jfp) == jhead.count &&
+			fread(&sum, sizeof(sum), 1, jfp) == 1 &&
+			sum == usage_journal_sum(&jhead, recs))
+			ok = 1;
+	}
+	fclose(jfp);
+
+	if (ok) {
+		if ((fd = open(filename, O_WRONLY)) == -1 ||
+			ftruncate(fd, usage_data_offset() +
+			(off_t) jhead.nslots * sizeof(struct group_node_usage_v2)) == -1 ||
+			!apply_usage_records(fd, &jhead, recs)) {
+			sprintf(log_buffer, "Error replaying usage journal %s", jname);
+			log_err(errno, __func__, log_buffer);
+			if (fd != -1)
+				close(fd);
+			free(recs);
+			/* keep the journal to replay next time */
+			return;
+		}
+		close(fd);
+		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_NOTICE, "fairshare usage",
+			"Replayed usage journal of an interrupted update");
+	} else
+		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_NOTICE, "fairshare usage",
+			"Discarded incomplete usage journal, usage file left unchanged");
+	free(recs);
+	unlink(jname);
+}
+
+/**
+ * @brief
+ *		collect_usage_changes - collect the fairshare entities whose usage
+ *			  differs from their record in the usage file, and
+ *			  give entities which need one a new record
+ *
+ * @param[in]	root	-	the root of the current subtree
+ * @param[in]	map	-	the records of the usage file
+ * @param[in,out]	jhead	-	journal header, count and nslots are updated
+ * @param[in,out]	recs	-	journal records
+ * @param[in,out]	size	-	number of records recs can hold
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure, or the usage file does not match the tree
+ */
+static int
+collect_usage_changes(group_info *root, struct group_node_usage_v2 *map,
+	struct usage_journal_header *jhead, struct usage_journal_rec **recs, int *size)
+{
+	struct usage_journal_rec *tmp;
+	int slot;
+
+	for (; root != NULL; root = root->sibling) {
+		/* same entities rec_write_usage() writes, plus those with a record */
+#ifdef NAS /* localmod 043 */
+		if (root->child == NULL) {
+#else
+		if (root->child == NULL && strcmp(root->name, UNKNOWN_GROUP_NAME) != 0 &&
+			(root->usage != 1 || root->usage_slot >= 0)) {
+#endif /* localmod 043 */
+			slot = root->usage_slot;
+			if (slot >= 0) {
+				if (strncmp(map[slot].name, root->name, USAGE_NAME_MAX) != 0)
+					return 0;
+				if (map[slot].usage == root->usage)
+					slot = -2;
+			} else {
+				slot = jhead->nslots++;
+				root->usage_slot = slot;
+			}
+
+			if (slot != -2) {
+				if (jhead->count == *size) {
+					*size = *size * 2 + 64;
+					tmp = realloc(*recs, *size * sizeof(struct usage_journal_rec));
+					if (tmp == NULL) {
+						log_err(errno, __func__, MEM_ERR_MSG);
+						return 0;
+					}
+					*recs = tmp;
+				}
+				memset(&(*recs)[jhead->count], 0, sizeof(struct usage_journal_rec));
+				(*recs)[jhead->count].slot = slot;
+				strncpy((*recs)[jhead->count].grp.name, root->name, USAGE_NAME_MAX);
+				(*recs)[jhead->count].grp.usage = root->usage;
+				jhead->count++;
+			}
+		}
+		if (!collect_usage_changes(root->child, map, jhead, recs, size))
+			return 0;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		update_usage - write only the changed records of a usage file
+ *			  the tree was read from or written to before.  The
+ *			  changes are journaled first so an interrupted update
+ *			  is finished by the next read_usage().
+ *
+ * @param[in]	filename	-	usage file
+ * @param[in]	fhead	-	Pointer to fairshare_head structure.
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: the file must be rewritten.  Slots of the tree
+ *			  may have been changed, the rewrite sets them.
+ */
+static int
+update_usage(char *filename, fairshare_head *fhead)
+{
+	char jname[MAXPATHLEN + 1];
+	struct usage_journal_header jhead;
+	struct usage_journal_rec *recs = NULL;
+	struct group_node_usage_v2 *map;
+	struct stat sb;
+	unsigned long sum;
+	size_t maplen;
+	void *addr;
+	FILE *jfp;
+	int size = 0;
+	int fd;
+	int rc;
+
+	if (fhead->usage_slots <= 0)
+		return 0;
+
+	/* new records are given slots as they are found */
+
+	if ((fd = open(filename, O_RDWR)) == -1)
+		return 0;
+
+	/* the file must be the one we know, e.g. pbsfs replaces it */
+	maplen = usage_data_offset() + (size_t) fhead->usage_slots * sizeof(struct group_node_usage_v2);
+	if (fstat(fd, &sb) == -1 || sb.st_dev != fhead->usage_dev ||
+		sb.st_ino != fhead->usage_ino || sb.st_size != maplen) {
+		close(fd);
+		return 0;
+	}
+
+	if ((addr = mmap(NULL, maplen, PROT_READ, MAP_SHARED, fd, 0)) == MAP_FAILED) {
+		close(fd);
+		return 0;
+	}
+	map = (struct group_node_usage_v2 *) ((char *) addr + usage_data_offset());
+
+	memset(&jhead, 0, sizeof(jhead));
+	strncpy(jhead.tag, USAGE_JOURNAL_MAGIC, sizeof(jhead.tag));
+	jhead.nslots = fhead->usage_slots;
+	jhead.last_decay = fhead->last_decay;
+	rc = collect_usage_changes(fhead->root, map, &jhead, &recs, &size);
+	munmap(addr, maplen);
+
+	if (!rc) {
+		free(recs);
+		close(fd);
+		return 0;
+	}
+
+	if (jhead.count == 0 && jhead.last_decay == fhead->usage_last_decay) {
+		free(recs);
+		close(fd);
+		return 1;
+	}
+
+	/* journal the update */
+	usage_journal_name(filename, jname, sizeof(jname));
+	sum = usage_journal_sum(&jhead, recs);
+	if ((jfp = fopen(jname, "wb")) == NULL ||
+		fwrite(&jhead, sizeof(jhead), 1, jfp) != 1 ||
+		fwrite(recs, sizeof(struct usage_journal_rec), jhead.count, jfp) != jhead.count ||
+		fwrite(&sum, sizeof(sum), 1, jfp) != 1 ||
+		fflush(jfp) != 0 || fsync(fileno(jfp)) == -1) {
+		sprintf(log_buffer, "Error writing usage journal %s", jname);
+		log_err(errno, __func__, log_buffer);
+		if (jfp != NULL)
+			fclose(jfp);
+		unlink(jname);
+		free(recs);
+		close(fd);
+		return 0;
+	}
+	fclose(jfp);
+
+	/* new records go at the end of the file */
+	if ((jhead.nslots > fhead->usage_slots &&
+		ftruncate(fd, usage_data_offset() +
+		(off_t) jhead.nslots * sizeof(struct group_node_usage_v2)) == -1) ||
+		!apply_usage_records(fd, &jhead, recs)) {
+		/* the journal is replaced by the rewrite of the file */
+		sprintf(log_buffer, "Error updating usage file %s", filename);
+		log_err(errno, __func__, log_buffer);
+		free(recs);
+		close(fd);
+		return 0;
+	}
+	close(fd);
+	unlink(jname);
+	free(recs);
+	fhead->usage_slots = jhead.nslots;
+	fhead->usage_last_decay = jhead.last_decay;
+
+	return 1;
+}
+#endif /* WIN32 */
+
+/**
+ * @brief
+ *		write_usage - write the usage information to the usage file.
+ *		      If the file is the one the tree was last read from or
+ *		      written to, only the changed records are written in place.
+ *		      Otherwise the file is rewritten to a new file which is
+ *		      renamed over it, so readers always see a whole file.
  *
  * @param[in]	filename	-	usage file
  * @param[in]	fhead	-	Pointer to fairshare_head structure.
@@ -602,6 +1054,10 @@ write_usage(char *filename, fairshare_head *fhead)
 {
 	FILE *fp;		/* file pointer to usage file */
 	struct group_node_header head;
+	char newname[MAXPATHLEN + 1];
+	char jname[MAXPATHLEN + 1];
+	struct stat sb;
+	int nslots = 0;
 
 	if (fhead == NULL)
 		return 0;
@@ -609,8 +1065,15 @@ write_usage(char *filename, fairshare_head *fhead)
 	if (filename == NULL)
 		filename = USAGE_FILE;
 
-	if ((fp = fopen(filename, "wb")) == NULL) {
-		sprintf(log_buffer, "Error opening file %s", filename);
+#ifndef WIN32
+	if (update_usage(filename, fhead))
+		return 1;
+#endif /* WIN32 */
+	fhead->usage_slots = 0;
+
+	snprintf(newname, sizeof(newname), "%s%s", filename, USAGE_NEW_SUFFIX);
+	if ((fp = fopen(newname, "wb")) == NULL) {
+		sprintf(log_buffer, "Error opening file %s", newname);
 		log_err(errno, "write_usage", log_buffer);
 		return 0;
 	}
@@ -623,13 +1086,46 @@ write_usage(char *filename, fairshare_head *fhead)
 	 * ...
 	 */
 
+	memset(&head, 0, sizeof(head));
 	strcpy(head.tag, USAGE_MAGIC);
 	head.version = USAGE_VERSION;
 	fwrite(&head, sizeof(struct group_node_header), 1, fp);
 	fwrite(&fhead->last_decay, sizeof(time_t), 1, fp);
 
-	rec_write_usage(fhead->root, fp);
+	rec_write_usage(fhead->root, fp, &nslots);
+	if (fflush(fp) != 0 || ferror(fp)
+#ifndef WIN32
+		|| fsync(fileno(fp)) == -1
+#endif /* WIN32 */
+		) {
+		sprintf(log_buffer, "Error writing file %s", newname);
+		log_err(errno, "write_usage", log_buffer);
+		fclose(fp);
+		unlink(newname);
+		return 0;
+	}
 	fclose(fp);
+
+	/* the new file has everything an unfinished update journaled */
+	snprintf(jname, sizeof(jname), "%s%s", filename, USAGE_JOURNAL_SUFFIX);
+	unlink(jname);
+#ifdef WIN32
+	/* rename() does not replace an existing file on Windows */
+	unlink(filename);
+#endif /* WIN32 */
+	if (rename(newname, filename) == -1) {
+		sprintf(log_buffer, "Error renaming %s to %s", newname, filename);
+		log_err(errno, "write_usage", log_buffer);
+		unlink(newname);
+		return 0;
+	}
+
+	if (stat(filename, &sb) == 0) {
+		fhead->usage_slots = nslots;
+		fhead->usage_dev = sb.st_dev;
+		fhead->usage_ino = sb.st_ino;
+		fhead->usage_last_decay = fhead->last_decay;
+	}
 	return 1;
 }
 
@@ -640,35 +1136,55 @@ write_usage(char *filename, fairshare_head *fhead)
  *
  * @param[in]	root	-	the root of the current subtree
  * @param[in]	fp	-	the file to write the ginfo out to
+ * @param[in,out]	nslots	-	number of records written so far
  *
  * @return nothing
  *
  */
 void
-rec_write_usage(group_info *root, FILE *fp)
+rec_write_usage(group_info *root, FILE *fp, int *nslots)
 {
 	struct group_node_usage_v2 grp;	/* used to write out usage info */
 
-	if (root == NULL)
-		return;
-
-	/* only write out leaves of the tree (fairshare entities)
-	 * usage defaults to 1 so don't bother writing those out either
-	 * It is possible that the unknown group is empty.  Don't want to write it out
-	 */
+	for (; root != NULL; root = root->sibling) {
+		root->usage_slot = -1;
+		/* only write out leaves of the tree (fairshare entities)
+		 * usage defaults to 1 so don't bother writing those out either
+		 * It is possible that the unknown group is empty.  Don't want to write it out
+		 */
 #ifdef NAS /* localmod 043 */
-	if (root->child == NULL) {
+		if (root->child == NULL) {
 #else
-	if (root->usage != 1 && root->child == NULL && strcmp(root->name, UNKNOWN_GROUP_NAME) != 0) {
+		if (root->usage != 1 && root->child == NULL && strcmp(root->name, UNKNOWN_GROUP_NAME) != 0) {
 #endif /* localmod 043 */
-		strncpy(grp.name, root->name, USAGE_NAME_MAX);
-		grp.usage = root->usage;
+			memset(&grp, 0, sizeof(grp));
+			strncpy(grp.name, root->name, USAGE_NAME_MAX);
+			grp.usage = root->usage;
+
+			fwrite(&grp, sizeof(struct group_node_usage_v2), 1, fp);
+			root->usage_slot = (*nslots)++;
+		}
 
-		fwrite(&grp, sizeof(struct group_node_usage_v2), 1, fp);
+		rec_write_usage(root->child, fp, nslots);
 	}
+}
 
-	rec_write_usage(root->sibling, fp);
-	rec_write_usage(root->child, fp);
+/**
+ * @brief
+ *		reset_usage_slots - forget the usage file records of a tree
+ *
+ * @param[in,out]	root	-	the root of the current subtree
+ *
+ * @return nothing
+ *
+ */
+static void
+reset_usage_slots(group_info *root)
+{
+	for (; root != NULL; root = root->sibling) {
+		root->usage_slot = -1;
+		reset_usage_slots(root->child);
+	}
 }
 
 /**
@@ -677,7 +1193,8 @@ rec_write_usage(group_info *root, FILE *fp)
  *		     resgroup tree.
  *
  * @param[in]	filename	-	The file which stores the usage information.
- * @param[in]	flags	-	flags to check whether to trim or not.
+ * @param[in]	flags	-	FS_TRIM to drop unknown entities,
+ *				FS_READ_ONLY to leave an unfinished update journal alone
  * @param[in]	fhead	-	pointer to fairshare_head struct.
  *
  * @return void
@@ -690,6 +1207,9 @@ read_usage(char *filename, int flags, fairshare_head *fhead)
 	struct group_node_header head;		/* usage file header */
 	time_t last;				/* read the last sync from the file */
 	int error = 0;				/* error reading in usage header */
+	int nrecs = 0;				/* records in the file */
+	int nslots = 0;				/* records given to entities */
+	struct stat sb;
 
 	if (fhead == NULL || fhead->root == NULL)
 		return;
@@ -697,6 +1217,13 @@ read_usage(char *filename, int flags, fairshare_head *fhead)
 	if (filename == NULL)
 		filename = USAGE_FILE;
 
+	fhead->usage_slots = 0;
+	reset_usage_slots(fhead->root);
+#ifndef WIN32
+	if (!(flags & FS_READ_ONLY))
+		replay_usage_journal(filename);
+#endif /* WIN32 */
+
 	if ((fp = fopen(filename, "r")) == NULL) {
 		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_FILE, LOG_WARNING, "fairshare usage",
 			"Creating usage database for fairshare");
@@ -715,8 +1242,20 @@ read_usage(char *filename, int flags, fairshare_head *fhead)
 					else
 						error = 1;
 				}
-				if (!error)
-					read_usage_v2(fp, flags, fhead->root);
+				if (!error) {
+					read_usage_v2(fp, flags, fhead->root, &nrecs, &nslots);
+					/* only update the file in place if every record
+					 * belongs to one entity of the tree
+					 */
+					if (nrecs == nslots && fstat(fileno(fp), &sb) == 0 &&
+						sb.st_size == sizeof(struct group_node_header) + sizeof(time_t) +
+						(off_t) nrecs * sizeof(struct group_node_usage_v2)) {
+						fhead->usage_slots = nslots;
+						fhead->usage_dev = sb.st_dev;
+						fhead->usage_ino = sb.st_ino;
+						fhead->usage_last_decay = fhead->last_decay;
+					}
+				}
 			}
 			else
 				error = 1;
@@ -752,13 +1291,18 @@ read_usage_v1(FILE *fp, group_info *root)
 	struct group_node_usage_v1 grp;
 	group_info *ginfo;
 	struct group_path *gpath;
+	int added = 0;			/* entities were added to "unknown" */
 
 	if (fp == NULL)
 		return 0;
 
 	while (fread(&grp, sizeof(struct group_node_usage_v1), 1, fp)) {
 		if (grp.usage >= 0 && is_valid_pbs_name(grp.name, USAGE_NAME_MAX)) {
-			ginfo = find_alloc_ginfo(grp.name, root);
+			ginfo = find_group_info(grp.name, root);
+			if (ginfo == NULL) {
+				ginfo = alloc_unknown_ginfo(grp.name, root, 0);
+				added = 1;
+			}
 			if (ginfo != NULL) {
 				ginfo->usage = grp.usage;
 				ginfo->temp_usage = grp.usage;
@@ -778,6 +1322,9 @@ read_usage_v1(FILE *fp, group_info *root)
 				"fairshare usage", "Invalid entity");
 	}
 
+	if (added)
+		calc_fair_share_perc(find_group_info(UNKNOWN_GROUP_NAME, root)->child, UNSPECIFIED);
+
 	return 1;
 }
 
@@ -788,32 +1335,42 @@ read_usage_v1(FILE *fp, group_info *root)
  * @param[in]	fp	- the file pointer to the open file
  * @param[in]	flags	- flags to check whether to trim or not.
  * @param[in]	root	- root of the fairshare tree
+ * @param[out]	nrecs	- number of records read
+ * @param[out]	nslots	- number of records given to an entity as its usage_slot
  *
  *	@retval 1 success
  *	@retval 0 failure
  *
  */
 int
-read_usage_v2(FILE *fp, int flags, group_info *root)
+read_usage_v2(FILE *fp, int flags, group_info *root, int *nrecs, int *nslots)
 {
 	struct group_node_usage_v2 grp;
 	group_info *ginfo;
 	struct group_path *gpath;
+	int added = 0;			/* entities were added to "unknown" */
 
 	if (fp == NULL)
 		return 0;
 
 	while (fread(&grp, sizeof(struct group_node_usage_v2), 1, fp)) {
+		(*nrecs)++;
 		if (grp.usage >= 0 && is_valid_pbs_name(grp.name, USAGE_NAME_MAX)) {
 			/* if we're trimming the tree, don't add any new nodes which are not
 			 * already in the resource_group file
 			 */
-			if (flags & FS_TRIM)
-				ginfo = find_group_info(grp.name, root);
-			else
-				ginfo = find_alloc_ginfo(grp.name, root);
+			ginfo = find_group_info(grp.name, root);
+			if (ginfo == NULL && !(flags & FS_TRIM)) {
+				ginfo = alloc_unknown_ginfo(grp.name, root, 0);
+				added = 1;
+			}
 
 			if (ginfo != NULL) {
+				/* the record can be updated in place by write_usage() */
+				if (ginfo->child == NULL && ginfo->usage_slot < 0) {
+					ginfo->usage_slot = *nrecs - 1;
+					(*nslots)++;
+				}
 				ginfo->usage = grp.usage;
 				ginfo->temp_usage = grp.usage;
 				if (ginfo->child == NULL) {
@@ -833,6 +1390,9 @@ read_usage_v2(FILE *fp, int flags, group_info *root)
 
 	}
 
+	if (added)
+		calc_fair_share_perc(find_group_info(UNKNOWN_GROUP_NAME, root)->child, UNSPECIFIED);
+
 	return 1;
 }
 
@@ -976,6 +1536,8 @@ dup_fairshare_tree(group_info *root, group_info *nparent)
 		return NULL;
 	}
 
+	if (nparent == NULL && root->name_idx != NULL)
+		new_group_index(nroot);
 	add_child(nroot, nparent);
 
 
@@ -1016,6 +1578,10 @@ free_fairshare_node(group_info *node)
 
 	free(node->name);
 	free_group_path_list(node->gpath);
+	if (node->name_idx != NULL) {
+		avl_destroy_index(node->name_idx);
+		free(node->name_idx);
+	}
 	free(node);
 }
 
@@ -1035,6 +1601,10 @@ new_fairshare_head()
 
 	fhead->root = NULL;
 	fhead->last_decay = 0;
+	fhead->usage_slots = 0;
+	fhead->usage_dev = 0;
+	fhead->usage_ino = 0;
+	fhead->usage_last_decay = 0;
 
 	return fhead;
 }
@@ -1099,12 +1669,10 @@ free_fairshare_head(fairshare_head *fhead)
 void
 reset_temp_usage(group_info *head)
 {
-	if (head == NULL)
-		return;
-
-	head->temp_usage = head->usage;
-	reset_temp_usage(head->sibling);
-	reset_temp_usage(head->child);
+	for (; head != NULL; head = head->sibling) {
+		head->temp_usage = head->usage;
+		reset_temp_usage(head->child);
+	}
 }
 
 /**
@@ -1120,14 +1688,15 @@ calc_usage_factor_rec(group_info *root, group_info *ginfo)
 {
 	float usage;
 
-	if (root == NULL || ginfo == NULL)
+	if (root == NULL)
 		return;
 
-	usage = ginfo->usage / root->usage;
-	ginfo->usage_factor = usage + ((ginfo->parent->usage_factor - usage) * ginfo->group_percentage);
+	for (; ginfo != NULL; ginfo = ginfo->sibling) {
+		usage = ginfo->usage / root->usage;
+		ginfo->usage_factor = usage + ((ginfo->parent->usage_factor - usage) * ginfo->group_percentage);
 
-	calc_usage_factor_rec(root, ginfo->sibling);
-	calc_usage_factor_rec(root, ginfo->child);
+		calc_usage_factor_rec(root, ginfo->child);
+	}
 }
 
 /**
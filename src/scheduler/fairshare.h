@@ -47,6 +47,16 @@ extern "C" {
  */
 void add_child(group_info *ginfo, group_info *parent);
 
+/*
+ *      index_group_info - add a ginfo to the name index of its tree
+ */
+int index_group_info(group_info *root, group_info *ginfo);
+
+/*
+ *      new_group_index - create the name index on the root of a tree
+ */
+int new_group_index(group_info *root);
+
 /*
  *      find_group_info - recursive function to find a ginfo in the
  resgroup tree
@@ -141,7 +151,7 @@ int write_usage(char *filename, fairshare_head *fhead);
  *      rec_write_usage - recursive helper function which will write out all
  *                        the group_info structs of the resgroup tree
  */
-void rec_write_usage(group_info *root, FILE *fp);
+void rec_write_usage(group_info *root, FILE *fp, int *nslots);
 
 /*
  *      read_usage - read the usage information and load it into the
@@ -157,7 +167,7 @@ int read_usage_v1(FILE *fp, group_info *root);
 /*
  *      read_usage_v2 - read version 2 usage file
  */
-int read_usage_v2(FILE *fp, int flags, group_info *root);
+int read_usage_v2(FILE *fp, int flags, group_info *root, int *nrecs, int *nslots);
 
 /*
  *      new_group_path - create a new group_path structure and init it
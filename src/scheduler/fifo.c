@@ -54,6 +54,10 @@
  * 	update_last_running()
  * 	update_job_can_not_run()
  * 	run_job()
+ * 	send_run_job()
+ * 	queue_run_job()
+ * 	flush_run_jobs()
+ * 	undo_run_job()
  * 	run_update_resresv()
  * 	sim_run_update_resresv()
  * 	should_backfill_with_job()
@@ -106,14 +110,19 @@
 #include "range.h"
 #include "resource_resv.h"
 #include "simulate.h"
+#include "start_horizon.h"
 #include "node_partition.h"
 #include "resource.h"
 #include "resource_resv.h"
 #include "pbs_share.h"
 #include "pbs_internal.h"
+#include "attribute.h"
 #include "limits_if.h"
 #include "pbs_version.h"
 #include "buckets.h"
+#include "cycle_profile.h"
+#include "snapshot.h"
+#include "thread_pool.h"
 
 
 #ifdef NAS
@@ -124,6 +133,15 @@
 static prev_job_info *last_running = NULL;
 static int last_running_size = 0;
 
+/* run requests queued to be sent together by flush_run_jobs() */
+static struct batch_status *pending_runs = NULL;
+static struct batch_status *pending_runs_tail = NULL;
+static int num_pending_runs = 0;
+
+static int send_run_job(int pbs_sd, resource_resv *rjob, char *execvnode, enum runjob_mode mode);
+static int queue_run_job(int pbs_sd, resource_resv *rjob, char *execvnode);
+static void undo_run_job(int pbs_sd, server_info *sinfo, char *name, int errcode, char *errbuf);
+
 #ifdef WIN32
 extern void win_toolong(void);
 #endif
@@ -161,6 +179,7 @@ schedinit(void)
 
 	init_config();
 	parse_config(CONFIG_FILE);
+	set_thread_pool_size(conf.node_eval_threads);
 
 	parse_holidays(HOLIDAYS_FILE);
 	time(&(cstat.current_time));
@@ -435,7 +454,8 @@ init_scheduling_cycle(status *policy, int pbs_sd, server_info *sinfo)
 				sinfo->fairshare->last_decay) % conf.decay_time;
 		}
 
-		if (policy->sync_fairshare_files && (decayed || last_running != NULL)) {
+		if (policy->sync_fairshare_files && (decayed || last_running != NULL) &&
+			!snapshot_replaying()) {
 			write_usage(USAGE_FILE, sinfo->fairshare);
 			schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
 				"Fairshare", "Usage Sync");
@@ -656,21 +676,28 @@ scheduling_cycle(int sd, char *jobid)
 	int error = 0;			/* error happened, don't run main loop */
 	status *policy;			/* policy structure used for cycle */
 	schd_error *err = NULL;
+	double prof_ts;			/* cycle profile timestamp */
 
 	schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		"", "Starting Scheduling Cycle");
 
-	update_cycle_status(&cstat, 0);
+	profile_cycle_start();
+	/* a replayed snapshot is scheduled at the time it was captured */
+	update_cycle_status(&cstat, snapshot_time());
+	snapshot_cycle_start(cstat.current_time);
 
 #ifdef NAS /* localmod 030 */
 	do_soft_cycle_interrupt = 0;
 	do_hard_cycle_interrupt = 0;
 #endif /* localmod 030 */
 	/* create the server / queue / job / node structures */
-	if ((sinfo = query_server(&cstat, sd)) == NULL) {
+	prof_ts = profile_begin();
+	sinfo = query_server(&cstat, sd);
+	profile_end(PROF_QUERY_SERVER, NULL, prof_ts);
+	if (sinfo == NULL) {
 		schdlog(PBSEVENT_SYSTEM, PBS_EVENTCLASS_SERVER, LOG_NOTICE,
 			"", "Problem with creating server data structure");
-		end_cycle_tasks(sinfo);
+		end_cycle_tasks(sd, sinfo);
 		return 0;
 	}
 	policy = sinfo->policy;
@@ -685,7 +712,7 @@ scheduling_cycle(int sd, char *jobid)
 			 * further in the scheduling cycle since we don't have the up to date
 			 * information about the newly confirmed reservations
 			 */
-			end_cycle_tasks(sinfo);
+			end_cycle_tasks(sd, sinfo);
 			/* Problem occurred confirming reservation, retry cycle */
 			if (rc < 0)
 				return -1;
@@ -716,7 +743,7 @@ scheduling_cycle(int sd, char *jobid)
 	if (init_scheduling_cycle(policy, sd, sinfo) == 0) {
 		schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG,
 			sinfo->name, "init_scheduling_cycle failed.");
-		end_cycle_tasks(sinfo);
+		end_cycle_tasks(sd, sinfo);
 		return 0;
 	}
 
@@ -783,7 +810,7 @@ scheduling_cycle(int sd, char *jobid)
 	/* localmod 034 */
 	site_list_shares(stdout, sinfo, "eoc_", 1);
 #endif
-	end_cycle_tasks(sinfo);
+	end_cycle_tasks(sd, sinfo);
 
 	free_schd_error(err);
 	if (rc < 0)
@@ -834,6 +861,8 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 	schd_error *err;
 	schd_error *chk_lim_err;
 	unsigned int flags = NO_FLAGS;	/* flags to is_ok_to_run @see is_ok_to_run() */
+	double loop_ts;			/* cycle profile timestamps */
+	double prof_ts;
 	
 
 	if (policy == NULL || sinfo == NULL || rerr == NULL)
@@ -871,6 +900,7 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		}
 #endif /* localmod 030 */
 
+		loop_ts = profile_begin();
 		rc = 0;
 		comment[0] = '\0';
 		log_msg[0] = '\0';
@@ -886,11 +916,13 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		if(should_use_buckets)
 			flags = USE_BUCKETS;
 
+		prof_ts = profile_begin();
 		if (njob->is_shrink_to_fit) {
 			/* Pass the suitable heuristic for shrinking */
 			ns_arr = is_ok_to_run_STF(policy, sinfo, qinfo, njob, flags, err, shrink_job_algorithm);
 		} else
 			ns_arr = is_ok_to_run(policy, sinfo, qinfo, njob, flags, err);
+		profile_end(PROF_IS_OK_TO_RUN, njob, prof_ts);
 		
 		if (err->status_code == NEVER_RUN)
 			njob->can_never_run = 1;
@@ -907,9 +939,10 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 				tj = njob;
 
 			if (rc != SCHD_ERROR) {
-				if(run_update_resresv(policy, sd, sinfo, qinfo, tj, ns_arr, RURR_ADD_END_EVENT, err) > 0 ) {
+				if(run_update_resresv(policy, sd, sinfo, qinfo, tj, ns_arr, RURR_ADD_END_EVENT | RURR_PIPELINE, err) > 0 ) {
 					rc = SUCCESS;
 					sort_again = MAY_RESORT_JOBS;
+					snapshot_decision(tj, SNAP_DEC_RUN, NULL);
 				} else {
 					/* if run_update_resresv() returns 0 and pbs_errno == PBSE_HOOKERROR,
 					 * then this job is required to be ignored in this scheduling cycle
@@ -921,9 +954,18 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 				free_nspecs(ns_arr);
 		}
 		else if (policy->preempting && in_runnable_state(njob) && (!njob -> can_never_run)) {
-			if (find_and_preempt_jobs(policy, sd, njob, sinfo, err) > 0) {
+			int preempt_rc;
+
+			/* preemption acts on what has really run */
+			flush_run_jobs(sd, sinfo);
+
+			prof_ts = profile_begin();
+			preempt_rc = find_and_preempt_jobs(policy, sd, njob, sinfo, err);
+			profile_end(PROF_PREEMPT, njob, prof_ts);
+			if (preempt_rc > 0) {
 				rc = SUCCESS;
 				sort_again = MUST_RESORT_JOBS;
+				snapshot_decision(njob, SNAP_DEC_PREEMPT, NULL);
 			}
 			else
 				sort_again = SORTED;
@@ -955,9 +997,12 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 			sort_again = SORTED;
 			if (should_backfill_with_job(policy, sinfo, njob, num_topjobs) != 0) {
 #endif
+				prof_ts = profile_begin();
 				cal_rc = add_job_to_calendar(sd, policy, sinfo, njob, should_use_buckets);
+				profile_end(PROF_CALENDAR, njob, prof_ts);
 
 				if (cal_rc > 0) { /* Success! */
+					snapshot_decision(njob, SNAP_DEC_TOPJOB, NULL);
 #ifdef NAS /* localmod 034 */
 					switch(bf_rc)
 					{
@@ -1027,6 +1072,7 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 
 		if ((rc != SUCCESS) && (err->error_code != 0)) {
 			translate_fail_code(err, comment, log_msg);
+			snapshot_decision(njob, SNAP_DEC_NOT_RUN, log_msg);
 			if (comment[0] != '\0' &&
 				(!njob->job->is_array || !njob->job->is_begin))
 				update_job_comment(sd, njob, comment);
@@ -1106,8 +1152,9 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
 		}
 #endif /* localmod 030 */
 
-		/* send any attribute updates to server that we've collected */
+		/* queue any attribute updates we've collected to send at the end of the cycle */
 		send_job_updates(sd, njob);
+		profile_end(PROF_MAIN_LOOP, njob, loop_ts);
 	}
 
 	*rerr = err;
@@ -1120,16 +1167,23 @@ main_sched_loop(status *policy, int sd, server_info *sinfo, schd_error **rerr)
  * @brief
  *		end_cycle_tasks - stuff which needs to happen at the end of a cycle
  *
+ * @param[in]	pbs_sd	-	connection to the server
  * @param[in]	sinfo	-	the server structure
  *
  * @return	nothing
  *
  */
 void
-end_cycle_tasks(server_info *sinfo)
+end_cycle_tasks(int pbs_sd, server_info *sinfo)
 {
 	int i;
 
+	/* send the run requests still in flight, then the job attribute
+	 * updates of the cycle (including those of jobs which failed to run)
+	 */
+	flush_run_jobs(pbs_sd, sinfo);
+	flush_job_updates(pbs_sd, sinfo);
+
 	/* keep track of update used resources for fairshare */
 	if (sinfo != NULL && sinfo->policy->fair_share)
 		update_last_running(sinfo);
@@ -1138,6 +1192,7 @@ end_cycle_tasks(server_info *sinfo)
 	 * we don't want to free it now, or we'd lose all fairshare data
 	 */
 	if (sinfo != NULL) {
+		save_job_sort_order(sinfo);
 		sinfo->fairshare = NULL;
 		free_server(sinfo, 1);	/* free server and queues and jobs */
 	}
@@ -1160,6 +1215,8 @@ end_cycle_tasks(server_info *sinfo)
 	}
 
 	got_sigpipe = 0;
+	snapshot_cycle_end();
+	profile_cycle_end();
 	schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_REQUEST, LOG_DEBUG,
 		"", "Leaving Scheduling Cycle");
 }
@@ -1236,7 +1293,8 @@ update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
 				job->name, log_buf);
 
 		/* We won't be looking at this job in main_sched_loop()
-		 * and we just updated some attributes just above.  Send Now.
+		 * and we just updated some attributes just above.  Queue them
+		 * to be sent at the end of the cycle.
 		 */
 		send_job_updates(pbs_sd, job);
 	}
@@ -1255,7 +1313,8 @@ update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
  * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
  * @param[in]	rjob	-	the job to run
  * @param[in]	execvnode	-	the execvnode to run a multi-node job on
- * @param[in]	throughput	-	thoughput mode enabled?
+ * @param[in]	mode	-	wait for the job to start, run it asynchronously
+ *							(throughput mode) or queue it (see flush_run_jobs())
  * @param[out]	err	-	error struct to return errors
  *
  * @retval	0	: success
@@ -1263,7 +1322,7 @@ update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err)
  * @retval -1	: error
  */
 int
-run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_error *err)
+run_job(int pbs_sd, resource_resv *rjob, char *execvnode, enum runjob_mode mode, schd_error *err)
 {
 	char buf[100];	/* used to assemble queue@localserver */
 	char *errbuf;		/* comes from pbs_geterrmsg() */
@@ -1318,17 +1377,10 @@ run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_e
 					snprintf(logbuf, MAX_LOG_SIZE, "Job will run for duration=%s", timebuf);
 					schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, rjob->name, logbuf);
 				}
-				if (throughput)
-					rc = pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
-				else
-					rc = pbs_runjob(pbs_sd, rjob->name, execvnode, NULL);
+				rc = send_run_job(pbs_sd, rjob, execvnode, mode);
 			}
-		} else {
-			if (throughput)
-				rc = pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
-			else
-				rc = pbs_runjob(pbs_sd, rjob->name, execvnode, NULL);
-		}
+		} else
+			rc = send_run_job(pbs_sd, rjob, execvnode, mode);
 	}
 
 	if (rc) {
@@ -1348,6 +1400,225 @@ run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_e
 	return rc;
 }
 
+/**
+ * @brief
+ * 		send_run_job - send the run request of a job to the server
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	rjob	-	the job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ * @param[in]	mode	-	how to send the request
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	!0	: PBS error code
+ */
+static int
+send_run_job(int pbs_sd, resource_resv *rjob, char *execvnode, enum runjob_mode mode)
+{
+	switch (mode) {
+		case RUNJOB_PIPELINED:
+			return queue_run_job(pbs_sd, rjob, execvnode);
+		case RUNJOB_ASYNC:
+			return pbs_asyrunjob(pbs_sd, rjob->name, execvnode, NULL);
+		default:
+			return pbs_runjob(pbs_sd, rjob->name, execvnode, NULL);
+	}
+}
+
+/**
+ * @brief
+ * 		queue_run_job - queue the run request of a job to be sent with
+ *		others by flush_run_jobs().  The caller goes on as if the job
+ *		had been run; if the server refuses to run it, flush_run_jobs()
+ *		undoes it.
+ *
+ * @par
+ *		If MAX_RUNJOBS_INFLIGHT jobs are already queued, they are sent
+ *		first.  The job itself is always left queued, so its caller has
+ *		updated the universe for it before it can be undone.
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	rjob	-	the job to run
+ * @param[in]	execvnode	-	the execvnode to run the job on
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	!0	: PBS error code
+ */
+static int
+queue_run_job(int pbs_sd, resource_resv *rjob, char *execvnode)
+{
+	struct batch_status *bs;
+	struct attrl *pattr;
+
+	if (num_pending_runs >= MAX_RUNJOBS_INFLIGHT)
+		flush_run_jobs(pbs_sd, rjob->server);
+
+	bs = calloc(1, sizeof(struct batch_status));
+	pattr = new_attrl();
+	if (bs == NULL || pattr == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(bs);
+		free_attrl(pattr);
+		return (pbs_errno = PBSE_SYSTEM);
+	}
+	bs->attribs = pattr;
+	bs->name = string_dup(rjob->name);
+	pattr->name = string_dup(ATTR_execvnode);
+	pattr->value = string_dup(execvnode != NULL ? execvnode : "");
+	if (bs->name == NULL || pattr->name == NULL || pattr->value == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		pbs_statfree(bs);
+		return (pbs_errno = PBSE_SYSTEM);
+	}
+
+	if (pending_runs_tail != NULL)
+		pending_runs_tail->next = bs;
+	else
+		pending_runs = bs;
+	pending_runs_tail = bs;
+	num_pending_runs++;
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		flush_run_jobs - send the run requests queued by queue_run_job()
+ *		in one pbs_asyrunjobs(), and undo the jobs which the server
+ *		refused to run.
+ *
+ * @par
+ *		A server which does not list the Run Jobs request in its
+ *		multijob_requests attribute would close the connection on it, so
+ *		its jobs are sent one at a time with pbs_asyrunjob().
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	sinfo	-	the server the jobs were run in, or NULL if it
+ *				is gone and the jobs need not be undone
+ *
+ * @return	int
+ * @retval	number of jobs which failed to run
+ */
+int
+flush_run_jobs(int pbs_sd, server_info *sinfo)
+{
+	struct batch_status *jobs;
+	struct batch_status *failed;
+	struct batch_status *bs;
+	struct attrl *pattr;
+	char *errbuf;
+	int errcode;
+	int nfailed = 0;
+	double prof_ts;
+
+	jobs = pending_runs;
+	pending_runs = pending_runs_tail = NULL;
+	num_pending_runs = 0;
+
+	if (jobs == NULL)
+		return 0;
+
+	/* the server most likely crashed, the cycle is over */
+	if (got_sigpipe) {
+		pbs_statfree(jobs);
+		return 0;
+	}
+
+	prof_ts = profile_begin();
+	if (sinfo != NULL && sinfo->has_runjobs) {
+		failed = pbs_asyrunjobs(pbs_sd, jobs, NULL);
+		if (failed == NULL && pbs_errno != PBSE_NONE) {
+			errcode = pbs_errno;
+			errbuf = pbs_geterrmsg(pbs_sd);
+			for (bs = jobs; bs != NULL; bs = bs->next) {
+				undo_run_job(pbs_sd, sinfo, bs->name, errcode, errbuf);
+				nfailed++;
+			}
+		}
+		for (bs = failed; bs != NULL; bs = bs->next) {
+			errcode = PBSE_SYSTEM;
+			errbuf = NULL;
+			for (pattr = bs->attribs; pattr != NULL; pattr = pattr->next) {
+				if (strcmp(pattr->name, MULTIJOB_ERRCODE) == 0)
+					errcode = atoi(pattr->value);
+				else if (strcmp(pattr->name, MULTIJOB_ERRTEXT) == 0)
+					errbuf = pattr->value;
+			}
+			undo_run_job(pbs_sd, sinfo, bs->name, errcode, errbuf);
+			nfailed++;
+		}
+		pbs_statfree(failed);
+	} else {
+		for (bs = jobs; bs != NULL && !got_sigpipe; bs = bs->next) {
+			if (pbs_asyrunjob(pbs_sd, bs->name, bs->attribs->value, NULL) != 0) {
+				undo_run_job(pbs_sd, sinfo, bs->name, pbs_errno,
+					pbs_geterrmsg(pbs_sd));
+				nfailed++;
+			}
+		}
+	}
+	profile_end(PROF_RUN_JOB, NULL, prof_ts);
+
+	pbs_statfree(jobs);
+	return nfailed;
+}
+
+/**
+ * @brief
+ * 		undo_run_job - undo a job which was queued to run, but which the
+ *		server refused to run.  Its resources are given back to the
+ *		universe and it is treated as if run_job() had failed for it.
+ *
+ * @param[in]	pbs_sd	-	pbs connection descriptor to the LOCAL server
+ * @param[in]	sinfo	-	the server the job was run in, or NULL
+ * @param[in]	name	-	name of the job
+ * @param[in]	errcode	-	PBS error code of the failure
+ * @param[in]	errbuf	-	error message, or NULL
+ *
+ * @return	void
+ */
+static void
+undo_run_job(int pbs_sd, server_info *sinfo, char *name, int errcode, char *errbuf)
+{
+	resource_resv *rjob;
+	timed_event *te;
+	schd_error *err;
+	char buf[MAX_LOG_SIZE];
+
+	if (errbuf == NULL)
+		errbuf = "";
+	snprintf(buf, sizeof(buf), "Failed to run job: %s (%d)", errbuf, errcode);
+	schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_WARNING, name, buf);
+
+	if (sinfo == NULL)
+		return;
+
+	rjob = find_resource_resv(sinfo->jobs, name);
+	if (rjob == NULL || rjob->job == NULL)
+		return;
+
+	if (rjob->job->is_running) {
+		update_universe_on_end(sinfo->policy, rjob, "Q", NO_FLAGS);
+		if (sinfo->calendar != NULL) {
+			te = find_calendar_event(sinfo->calendar, rjob->name, TIMED_END_EVENT, 0);
+			if (te != NULL)
+				delete_event(sinfo, te, DE_NO_FLAGS);
+		}
+	}
+
+	err = new_schd_error();
+	if (err == NULL)
+		return;
+	set_schd_error_codes(err, NOT_RUN, RUN_FAILURE);
+	set_schd_error_arg(err, ARG1, errbuf);
+	snprintf(buf, sizeof(buf), "%d", errcode);
+	set_schd_error_arg(err, ARG2, buf);
+	update_job_can_not_run(pbs_sd, rjob, err);
+	free_schd_error(err);
+}
+
 #ifdef NAS_CLUSTER /* localmod 125 */
 /**
  * @brief
@@ -1416,6 +1687,8 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 	int pbsrc;				/* return codes from pbs IFL calls */
 	char buf[COMMENT_BUF_SIZE] = {'\0'};		/* generic buffer - comments & logging*/
 	int num_nspec;			/* number of nspecs in node solution */
+	double prof_ts;			/* cycle profile timestamp */
+	enum runjob_mode mode = RUNJOB_WAIT;	/* how to send the run request */
 
 	/* used for jobs with nodes resource */
 	nspec **ns = NULL;			/* the nodes to run the job on */
@@ -1572,7 +1845,12 @@ run_update_resresv(status *policy, int pbs_sd, server_info *sinfo,
 					fflush(stdout);
 #endif /* localmod 031 */
 
-					pbsrc = run_job(pbs_sd, rr, execvnode, sinfo->throughput_mode, err);
+					if (sinfo->throughput_mode)
+						mode = (flags & RURR_PIPELINE) ? RUNJOB_PIPELINED : RUNJOB_ASYNC;
+
+					prof_ts = profile_begin();
+					pbsrc = run_job(pbs_sd, rr, execvnode, mode, err);
+					profile_end(PROF_RUN_JOB, rr, prof_ts);
 
 #ifdef NAS_CLUSTER /* localmod 125 */
 					ret = translate_runjob_return_code(pbsrc, resresv);
@@ -1876,6 +2154,7 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 	resource_resv *bjob;		/* job pointer which becomes the topjob*/
 	resource_resv *tjob;		/* temporary job pointer for job arrays */
 	time_t start_time;		/* calculated start time of topjob */
+	time_t earliest;		/* topjob can't fit on the hosts before this */
 	char *exec;			/* used to hold execvnode for topjob */
 	timed_event *te_start;	/* start event for topjob */
 	timed_event *te_end;		/* end event for topjob */
@@ -1895,6 +2174,12 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 		if (find_timed_event(nexte, topjob->name, TIMED_NOEVENT, 0) != NULL)
 			return 1;
 	}
+	/* skip checking whether the job can run before enough resources can be
+	 * free.  Find that out before duplicating, the horizon lives on the
+	 * real calendar and is kept up to date across top jobs.
+	 */
+	earliest = start_horizon_earliest(sinfo, topjob);
+
 	if ((nsinfo = dup_server_info(sinfo)) == NULL)
 		return 0;
 
@@ -1912,10 +2197,17 @@ add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo,
 	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
 		topjob->name, "Estimating the start time for a top job.");
 #endif /* localmod 031 */
+	if (earliest > sinfo->server_time) {
+		sprintf(log_buf, "Not enough resources can be free for the job before %s",
+			ctime(&earliest));
+		log_buf[strlen(log_buf)-1] = '\0';	/* ctime adds a \n */
+		schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+			topjob->name, log_buf);
+	}
 	if(use_buckets)
-		start_time = calc_run_time(njob->name, nsinfo, SIM_RUN_JOB|USE_BUCKETS);
+		start_time = calc_run_time(njob->name, nsinfo, earliest, SIM_RUN_JOB|USE_BUCKETS);
 	else
-		start_time = calc_run_time(njob->name, nsinfo, SIM_RUN_JOB);
+		start_time = calc_run_time(njob->name, nsinfo, earliest, SIM_RUN_JOB);
 
 	if (start_time > 0) {
 		/* If our top job is a job array, we don't backfill around the
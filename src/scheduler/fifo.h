@@ -161,7 +161,7 @@ int update_job_can_not_run(int pbs_sd, resource_resv *job, schd_error *err);
 /*
  *	end_cycle_tasks - stuff which needs to happen at the end of a cycle
  */
-void end_cycle_tasks(server_info *sinfo);
+void end_cycle_tasks(int pbs_sd, server_info *sinfo);
 
 /*
  *	add_job_to_calendar - find the most top job and init all the
@@ -174,7 +174,13 @@ int add_job_to_calendar(int pbs_sd, status *policy, server_info *sinfo, resource
  *	       first move it to the local server and then run it.
  *	       if it's a local job, just run it.
  */
-int run_job(int pbs_sd, resource_resv *rjob, char *execvnode, int throughput, schd_error *err);
+int run_job(int pbs_sd, resource_resv *rjob, char *execvnode, enum runjob_mode mode, schd_error *err);
+
+/*
+ *	flush_run_jobs - send the queued run requests in one pbs_asyrunjobs()
+ *			 and undo the jobs the server refused to run
+ */
+int flush_run_jobs(int pbs_sd, server_info *sinfo);
 
 /*
  *	should_backfill_with_job - should we call add_job_to_calendar() with job
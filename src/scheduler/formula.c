@@ -0,0 +1,945 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    formula.c
+ *
+ * @brief
+ * 		formula.c - native evaluation of job_sort_formula and
+ *		fairshare_usage_res.
+ *
+ *		A formula is compiled once into a small stack program over
+ *		consumable resources, the job/fairshare keywords and numeric
+ *		constants with + - * / // % ** and parentheses.  The program
+ *		follows Python 2 arithmetic (integer division floors, ints
+ *		stay exact) so it gives the same answers as the embedded
+ *		interpreter did.  Formulas using anything else (function calls,
+ *		comparisons, unknown names...) are not compiled, and the caller
+ *		evaluates them through Python as before.
+ *
+ * Functions included are:
+ * 	find_formula()
+ * 	eval_formula()
+ * 	clear_formula_cache()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <limits.h>
+
+#include <log.h>
+#include <libutil.h>
+#include <pbs_share.h>
+#include "data_types.h"
+#include "constant.h"
+#include "globals.h"
+#include "resource_resv.h"
+#include "misc.h"
+#include "formula.h"
+
+/* largest magnitude an integer can have and still be exact in a double */
+#define FORMULA_MAX_EXACT_INT 9007199254740992.0	/* 2^53 */
+
+/* operations of a compiled formula, run on a value stack */
+enum formula_op
+{
+	FOP_CONST,		/* push a constant */
+	FOP_RES,		/* push a consumable resource of the job */
+	FOP_VAR,		/* push a job or fairshare keyword */
+	FOP_NEG,
+	FOP_POS,
+	FOP_ADD,
+	FOP_SUB,
+	FOP_MUL,
+	FOP_DIV,
+	FOP_FLOORDIV,
+	FOP_MOD,
+	FOP_POW
+};
+
+/* job and fairshare keywords of a formula */
+enum formula_var
+{
+	FVAR_ELIGIBLE_TIME,
+	FVAR_QUEUE_PRIO,
+	FVAR_JOB_PRIO,
+	FVAR_FSPERC,
+	FVAR_TREE_USAGE,
+	FVAR_FSFACTOR,
+	FVAR_ACCRUE_TYPE
+};
+
+/* a Python 2 number: an int or a float */
+struct formula_value
+{
+	double val;
+	int is_int;
+};
+
+struct formula_insn
+{
+	enum formula_op op;
+	struct formula_value cval;	/* FOP_CONST */
+	resdef *def;			/* FOP_RES */
+	enum formula_var var;		/* FOP_VAR */
+};
+
+struct formula_expr
+{
+	struct formula_insn *code;
+	int len;
+	int size;
+	int depth;			/* stack depth while compiling */
+	int max_depth;			/* stack needed to evaluate */
+};
+
+/* parser state */
+struct formula_parse
+{
+	char *p;			/* next character to parse */
+	int nest;			/* current nesting of the parse */
+	formula_expr *fexpr;
+};
+
+/* compiled formulas, including ones we could not compile (expr == NULL) */
+struct formula_cache_entry
+{
+	char *formula;
+	formula_expr *expr;
+};
+
+static struct formula_cache_entry formula_cache[FORMULA_CACHE_SIZE];
+static int formula_cache_next = 0;
+
+static int parse_expr(struct formula_parse *fp);
+
+/**
+ * @brief
+ * 		free a compiled formula
+ *
+ * @param[in]	fexpr	-	formula to free
+ *
+ * @return	void
+ */
+static void
+free_formula(formula_expr *fexpr)
+{
+	if (fexpr == NULL)
+		return;
+
+	free(fexpr->code);
+	free(fexpr);
+}
+
+/**
+ * @brief
+ * 		append an instruction to a formula being compiled
+ *
+ * @param[in]	fexpr	-	formula being compiled
+ * @param[in]	insn	-	instruction to add
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+emit(formula_expr *fexpr, struct formula_insn *insn)
+{
+	struct formula_insn *code;
+
+	if (fexpr->len == fexpr->size) {
+		code = realloc(fexpr->code, (fexpr->size * 2 + 8) * sizeof(struct formula_insn));
+		if (code == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		fexpr->code = code;
+		fexpr->size = fexpr->size * 2 + 8;
+	}
+	fexpr->code[fexpr->len++] = *insn;
+
+	switch (insn->op) {
+		case FOP_CONST:
+		case FOP_RES:
+		case FOP_VAR:
+			fexpr->depth++;
+			break;
+		case FOP_NEG:
+		case FOP_POS:
+			break;
+		default:
+			fexpr->depth--;
+	}
+	if (fexpr->depth > fexpr->max_depth)
+		fexpr->max_depth = fexpr->depth;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		emit an instruction with no operands
+ *
+ * @param[in]	fexpr	-	formula being compiled
+ * @param[in]	op	-	operation
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+static int
+emit_op(formula_expr *fexpr, enum formula_op op)
+{
+	struct formula_insn insn;
+
+	memset(&insn, 0, sizeof(insn));
+	insn.op = op;
+	return emit(fexpr, &insn);
+}
+
+/**
+ * @brief
+ * 		skip white space
+ *
+ * @param[in,out]	fp	-	parser state
+ *
+ * @return	void
+ */
+static void
+skip_space(struct formula_parse *fp)
+{
+	while (isspace((int) *fp->p))
+		fp->p++;
+}
+
+/**
+ * @brief
+ * 		parse a numeric literal the way Python 2 reads it.  Octal, hex
+ *		and long literals are left to Python.
+ *
+ * @param[in,out]	fp	-	parser state
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: unsupported
+ */
+static int
+parse_number(struct formula_parse *fp)
+{
+	struct formula_insn insn;
+	char *start = fp->p;
+	char *end;
+	int is_int = 1;
+
+	while (isdigit((int) *fp->p))
+		fp->p++;
+	if (*fp->p == '.') {
+		is_int = 0;
+		fp->p++;
+		while (isdigit((int) *fp->p))
+			fp->p++;
+	}
+	if (fp->p == start || (fp->p == start + 1 && *start == '.'))
+		return 0;
+	if (*fp->p == 'e' || *fp->p == 'E') {
+		is_int = 0;
+		fp->p++;
+		if (*fp->p == '+' || *fp->p == '-')
+			fp->p++;
+		if (!isdigit((int) *fp->p))
+			return 0;
+		while (isdigit((int) *fp->p))
+			fp->p++;
+	}
+	/* 0x10, 10L, 010 (octal) and 1j */
+	if (isalnum((int) *fp->p) || *fp->p == '_')
+		return 0;
+	if (is_int && *start == '0' && fp->p - start > 1)
+		return 0;
+
+	memset(&insn, 0, sizeof(insn));
+	insn.op = FOP_CONST;
+	insn.cval.val = strtod(start, &end);
+	insn.cval.is_int = is_int;
+	if (end != fp->p)
+		return 0;
+	if (is_int && insn.cval.val >= FORMULA_MAX_EXACT_INT)
+		return 0;
+
+	return emit(fp->fexpr, &insn);
+}
+
+/**
+ * @brief
+ * 		parse a name: a consumable resource or a formula keyword
+ *
+ * @param[in,out]	fp	-	parser state
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: unsupported
+ */
+static int
+parse_name(struct formula_parse *fp)
+{
+	static const struct {
+		char *name;
+		enum formula_var var;
+	} keywords[] = {
+		{FORMULA_ELIGIBLE_TIME, FVAR_ELIGIBLE_TIME},
+		{FORMULA_QUEUE_PRIO, FVAR_QUEUE_PRIO},
+		{FORMULA_JOB_PRIO, FVAR_JOB_PRIO},
+		{FORMULA_FSPERC, FVAR_FSPERC},
+		{FORMULA_FSPERC_DEP, FVAR_FSPERC},
+		{FORMULA_TREE_USAGE, FVAR_TREE_USAGE},
+		{FORMULA_FSFACTOR, FVAR_FSFACTOR},
+		{FORMULA_ACCRUE_TYPE, FVAR_ACCRUE_TYPE},
+		{NULL, FVAR_ELIGIBLE_TIME}
+	};
+	struct formula_insn insn;
+	char *name = fp->p;
+	size_t len;
+	int i;
+
+	while (isalnum((int) *fp->p) || *fp->p == '_')
+		fp->p++;
+	len = fp->p - name;
+
+	memset(&insn, 0, sizeof(insn));
+
+	/* keywords come after resources in the globals Python sees */
+	for (i = 0; keywords[i].name != NULL; i++) {
+		if (strncmp(name, keywords[i].name, len) == 0 &&
+			keywords[i].name[len] == '\0') {
+			insn.op = FOP_VAR;
+			insn.var = keywords[i].var;
+			return emit(fp->fexpr, &insn);
+		}
+	}
+	for (i = 0; consres[i] != NULL; i++) {
+		if (strncmp(name, consres[i]->name, len) == 0 &&
+			consres[i]->name[len] == '\0') {
+			insn.op = FOP_RES;
+			insn.def = consres[i];
+			return emit(fp->fexpr, &insn);
+		}
+	}
+
+	/* a builtin, a function call or an unknown name */
+	return 0;
+}
+
+/**
+ * @brief
+ * 		atom := NUMBER | NAME | '(' expr ')'
+ *
+ * @param[in,out]	fp	-	parser state
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: unsupported
+ */
+static int
+parse_atom(struct formula_parse *fp)
+{
+	skip_space(fp);
+
+	if (*fp->p == '(') {
+		fp->p++;
+		if (++fp->nest > FORMULA_MAX_NEST)
+			return 0;
+		if (!parse_expr(fp))
+			return 0;
+		skip_space(fp);
+		if (*fp->p != ')')
+			return 0;
+		fp->p++;
+		fp->nest--;
+		return 1;
+	}
+	if (isdigit((int) *fp->p) || *fp->p == '.')
+		return parse_number(fp);
+	if (isalpha((int) *fp->p) || *fp->p == '_')
+		return parse_name(fp);
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		factor := ('+' | '-') factor | atom ['**' factor]
+ *
+ * @param[in,out]	fp	-	parser state
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: unsupported
+ */
+static int
+parse_factor(struct formula_parse *fp)
+{
+	char c;
+
+	skip_space(fp);
+	c = *fp->p;
+	if (c == '+' || c == '-') {
+		fp->p++;
+		if (++fp->nest > FORMULA_MAX_NEST)
+			return 0;
+		if (!parse_factor(fp))
+			return 0;
+		fp->nest--;
+		return emit_op(fp->fexpr, c == '-' ? FOP_NEG : FOP_POS);
+	}
+
+	if (!parse_atom(fp))
+		return 0;
+
+	skip_space(fp);
+	if (fp->p[0] == '*' && fp->p[1] == '*') {
+		fp->p += 2;
+		if (++fp->nest > FORMULA_MAX_NEST)
+			return 0;
+		if (!parse_factor(fp))
+			return 0;
+		fp->nest--;
+		return emit_op(fp->fexpr, FOP_POW);
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		term := factor (('*' | '/' | '//' | '%') factor)*
+ *
+ * @param[in,out]	fp	-	parser state
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: unsupported
+ */
+static int
+parse_term(struct formula_parse *fp)
+{
+	enum formula_op op;
+
+	if (!parse_factor(fp))
+		return 0;
+
+	while (1) {
+		skip_space(fp);
+		if (fp->p[0] == '*' && fp->p[1] != '*' && fp->p[1] != '=') {
+			op = FOP_MUL;
+			fp->p++;
+		} else if (fp->p[0] == '/' && fp->p[1] == '/' && fp->p[2] != '=') {
+			op = FOP_FLOORDIV;
+			fp->p += 2;
+		} else if (fp->p[0] == '/' && fp->p[1] != '/' && fp->p[1] != '=') {
+			op = FOP_DIV;
+			fp->p++;
+		} else if (fp->p[0] == '%' && fp->p[1] != '=') {
+			op = FOP_MOD;
+			fp->p++;
+		} else
+			return 1;
+
+		if (!parse_factor(fp) || !emit_op(fp->fexpr, op))
+			return 0;
+	}
+}
+
+/**
+ * @brief
+ * 		expr := term (('+' | '-') term)*
+ *
+ * @param[in,out]	fp	-	parser state
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: unsupported
+ */
+static int
+parse_expr(struct formula_parse *fp)
+{
+	enum formula_op op;
+
+	if (!parse_term(fp))
+		return 0;
+
+	while (1) {
+		skip_space(fp);
+		if (fp->p[0] == '+' && fp->p[1] != '=')
+			op = FOP_ADD;
+		else if (fp->p[0] == '-' && fp->p[1] != '=')
+			op = FOP_SUB;
+		else
+			return 1;
+		fp->p++;
+
+		if (!parse_term(fp) || !emit_op(fp->fexpr, op))
+			return 0;
+	}
+}
+
+/**
+ * @brief
+ * 		compile a formula
+ *
+ * @param[in]	formula	-	formula to compile
+ *
+ * @return	formula_expr *
+ * @retval	NULL	: the formula can't be compiled and must be
+ *			  evaluated through Python
+ */
+static formula_expr *
+compile_formula(char *formula)
+{
+	struct formula_parse fp;
+	formula_expr *fexpr;
+
+	if (formula == NULL || consres == NULL)
+		return NULL;
+
+	if ((fexpr = calloc(1, sizeof(formula_expr))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	fp.p = formula;
+	fp.nest = 0;
+	fp.fexpr = fexpr;
+
+	if (!parse_expr(&fp)) {
+		free_formula(fexpr);
+		return NULL;
+	}
+	skip_space(&fp);
+	if (*fp.p != '\0' || fexpr->max_depth > FORMULA_MAX_NEST) {
+		free_formula(fexpr);
+		return NULL;
+	}
+
+	return fexpr;
+}
+
+/**
+ * @brief
+ * 		find_formula - return the compiled version of a formula,
+ *		compiling it the first time it is seen
+ *
+ * @param[in]	formula	-	formula to find
+ *
+ * @return	formula_expr *
+ * @retval	NULL	: the formula must be evaluated through Python
+ */
+formula_expr *
+find_formula(char *formula)
+{
+	struct formula_cache_entry *ent;
+	int i;
+
+	if (formula == NULL)
+		return NULL;
+
+	for (i = 0; i < FORMULA_CACHE_SIZE; i++) {
+		if (formula_cache[i].formula != NULL &&
+			strcmp(formula_cache[i].formula, formula) == 0)
+			return formula_cache[i].expr;
+	}
+
+	ent = &formula_cache[formula_cache_next];
+	formula_cache_next = (formula_cache_next + 1) % FORMULA_CACHE_SIZE;
+	free(ent->formula);
+	free_formula(ent->expr);
+	ent->expr = NULL;
+
+	if ((ent->formula = strdup(formula)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	ent->expr = compile_formula(formula);
+	if (ent->expr == NULL)
+		schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG, __func__,
+			"Formula will be evaluated through Python");
+
+	return ent->expr;
+}
+
+/**
+ * @brief
+ * 		clear_formula_cache - forget all compiled formulas.  Compiled
+ *		formulas reference the consumable resource definitions, so this
+ *		is called when they are freed.
+ *
+ * @return	void
+ */
+void
+clear_formula_cache(void)
+{
+	int i;
+
+	for (i = 0; i < FORMULA_CACHE_SIZE; i++) {
+		free(formula_cache[i].formula);
+		free_formula(formula_cache[i].expr);
+		formula_cache[i].formula = NULL;
+		formula_cache[i].expr = NULL;
+	}
+	formula_cache_next = 0;
+}
+
+/**
+ * @brief
+ * 		the value Python sees for a number the scheduler printed with
+ *		"%.*f" into the formula's globals
+ *
+ * @param[in]	amount	-	number to print
+ * @param[in]	digits	-	digits after the decimal point
+ * @param[out]	fv	-	Python value
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: value is too big for an exact int, use Python
+ */
+static int
+printed_value(double amount, int digits, struct formula_value *fv)
+{
+	char buf[128];
+
+	if (digits == 0) {
+		fv->is_int = 1;
+		fv->val = rint(amount);
+		return fabs(fv->val) < FORMULA_MAX_EXACT_INT;
+	}
+
+	snprintf(buf, sizeof(buf), "%.*f", digits, amount);
+	fv->is_int = 0;
+	fv->val = strtod(buf, NULL);
+	return 1;
+}
+
+/**
+ * @brief
+ * 		the value of a keyword for a job
+ *
+ * @param[in]	resresv	-	job
+ * @param[in]	var	-	keyword
+ * @param[out]	fv	-	value
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: use Python
+ */
+static int
+var_value(resource_resv *resresv, enum formula_var var, struct formula_value *fv)
+{
+	job_info *job = resresv->job;
+	group_info *ginfo = job->ginfo;
+
+	switch (var) {
+		case FVAR_ELIGIBLE_TIME:
+			return printed_value(job->eligible_time, 0, fv);
+		case FVAR_QUEUE_PRIO:
+			return printed_value(job->queue != NULL ? job->queue->priority : 0, 0, fv);
+		case FVAR_JOB_PRIO:
+			return printed_value(job->priority, 0, fv);
+		case FVAR_ACCRUE_TYPE:
+			return printed_value(job->accrue_type, 0, fv);
+		case FVAR_FSPERC:
+			return printed_value(ginfo != NULL ? ginfo->tree_percentage : 0, 6, fv);
+		case FVAR_TREE_USAGE:
+			return printed_value(ginfo != NULL ? ginfo->usage_factor : 0, 6, fv);
+		case FVAR_FSFACTOR:
+			if (ginfo == NULL || ginfo->tree_percentage == 0)
+				return printed_value(0, 6, fv);
+			return printed_value(pow(2, -(ginfo->usage_factor / ginfo->tree_percentage)), 6, fv);
+	}
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		Python 2 floor division and modulo of two ints
+ *
+ * @param[in]	a	-	dividend
+ * @param[in]	b	-	divisor (not 0)
+ * @param[out]	div	-	a // b
+ * @param[out]	mod	-	a % b
+ *
+ * @return	void
+ */
+static void
+int_divmod(double a, double b, double *div, double *mod)
+{
+	long long x = (long long) a;
+	long long y = (long long) b;
+	long long q = x / y;
+	long long r = x % y;
+
+	if (r != 0 && ((r < 0) != (y < 0))) {
+		r += y;
+		q--;
+	}
+	*div = (double) q;
+	*mod = (double) r;
+}
+
+/**
+ * @brief
+ * 		Python 2 floor division and modulo of two floats
+ *
+ * @param[in]	a	-	dividend
+ * @param[in]	b	-	divisor (not 0)
+ * @param[out]	div	-	a // b
+ * @param[out]	mod	-	a % b
+ *
+ * @return	void
+ */
+static void
+float_divmod(double a, double b, double *div, double *mod)
+{
+	double m;
+	double d;
+	double floordiv;
+
+	m = fmod(a, b);
+	d = (a - m) / b;
+	if (m != 0) {
+		if ((b < 0) != (m < 0)) {
+			m += b;
+			d -= 1.0;
+		}
+	} else
+		m = copysign(0.0, b);
+	if (d != 0) {
+		floordiv = floor(d);
+		if (d - floordiv > 0.5)
+			floordiv += 1.0;
+	} else
+		floordiv = copysign(0.0, a / b);
+
+	*div = floordiv;
+	*mod = m;
+}
+
+/**
+ * @brief
+ * 		Python 2 binary arithmetic
+ *
+ * @param[in]	op	-	operation
+ * @param[in]	a	-	left operand
+ * @param[in]	b	-	right operand
+ * @param[out]	res	-	result
+ * @param[out]	errmsg	-	Python's exception message on error
+ *
+ * @return	int
+ * @retval	FORMULA_OK	: success
+ * @retval	FORMULA_ERROR	: Python would raise errmsg
+ * @retval	FORMULA_PYTHON	: the result would be a long, use Python
+ */
+static int
+binary_op(enum formula_op op, struct formula_value *a, struct formula_value *b,
+	struct formula_value *res, char **errmsg)
+{
+	struct formula_value r;
+	int is_int = a->is_int && b->is_int;
+	double div;
+	double mod;
+	double p;
+	double base;
+	long long e;
+
+	r.is_int = is_int;
+	switch (op) {
+		case FOP_ADD:
+			r.val = a->val + b->val;
+			break;
+		case FOP_SUB:
+			r.val = a->val - b->val;
+			break;
+		case FOP_MUL:
+			r.val = a->val * b->val;
+			break;
+		case FOP_DIV:
+		case FOP_FLOORDIV:
+		case FOP_MOD:
+			if (b->val == 0) {
+				if (is_int)
+					*errmsg = "integer division or modulo by zero";
+				else if (op == FOP_DIV)
+					*errmsg = "float division by zero";
+				else if (op == FOP_MOD)
+					*errmsg = "float modulo";
+				else
+					*errmsg = "float divmod()";
+				return FORMULA_ERROR;
+			}
+			if (op == FOP_DIV && !is_int) {
+				r.val = a->val / b->val;
+				break;
+			}
+			if (is_int)
+				int_divmod(a->val, b->val, &div, &mod);
+			else
+				float_divmod(a->val, b->val, &div, &mod);
+			r.val = op == FOP_MOD ? mod : div;
+			break;
+		case FOP_POW:
+			if (is_int && b->val >= 0) {
+				/* exact int power by squaring */
+				p = 1;
+				base = a->val;
+				for (e = (long long) b->val; e > 0; e >>= 1) {
+					if (e & 1) {
+						p *= base;
+						if (fabs(p) >= FORMULA_MAX_EXACT_INT)
+							return FORMULA_PYTHON;
+					}
+					if (e > 1) {
+						base *= base;
+						if (fabs(base) >= FORMULA_MAX_EXACT_INT)
+							return FORMULA_PYTHON;
+					}
+				}
+				r.val = p;
+				break;
+			}
+			r.is_int = 0;
+			if (a->val == 0 && b->val < 0) {
+				*errmsg = "0.0 cannot be raised to a negative power";
+				return FORMULA_ERROR;
+			}
+			if (a->val < 0 && b->val != floor(b->val)) {
+				*errmsg = "negative number cannot be raised to a fractional power";
+				return FORMULA_ERROR;
+			}
+			r.val = pow(a->val, b->val);
+			if (isinf(r.val) && !isinf(a->val) && !isinf(b->val)) {
+				*errmsg = "(34, 'Numerical result out of range')";
+				return FORMULA_ERROR;
+			}
+			break;
+		default:
+			return FORMULA_PYTHON;
+	}
+
+	/* Python ints don't overflow, they become longs */
+	if (r.is_int && fabs(r.val) >= FORMULA_MAX_EXACT_INT)
+		return FORMULA_PYTHON;
+
+	*res = r;
+	return FORMULA_OK;
+}
+
+/**
+ * @brief
+ * 		eval_formula - evaluate a compiled formula for a job
+ *
+ * @param[in]	fexpr	-	compiled formula from find_formula()
+ * @param[in]	resresv	-	job for the keywords
+ * @param[in]	resreq	-	resources to use
+ * @param[out]	ans	-	the answer
+ * @param[out]	errmsg	-	the error on FORMULA_ERROR
+ *
+ * @return	int
+ * @retval	FORMULA_OK	: success
+ * @retval	FORMULA_ERROR	: evaluation failed, the answer is 0
+ * @retval	FORMULA_PYTHON	: evaluate this job's formula through Python
+ *
+ * @par MT-safe: yes
+ */
+int
+eval_formula(formula_expr *fexpr, resource_resv *resresv, resource_req *resreq,
+	sch_resource_t *ans, char **errmsg)
+{
+	struct formula_value stack[FORMULA_MAX_NEST + 1];
+	struct formula_insn *insn;
+	resource_req *req;
+	int sp = 0;
+	int rc;
+	int i;
+
+	if (fexpr == NULL || resresv == NULL || resresv->job == NULL || ans == NULL)
+		return FORMULA_PYTHON;
+
+	*ans = 0;
+	for (i = 0; i < fexpr->len; i++) {
+		insn = &fexpr->code[i];
+		switch (insn->op) {
+			case FOP_CONST:
+				stack[sp++] = insn->cval;
+				break;
+			case FOP_RES:
+				req = find_resource_req(resreq, insn->def);
+				if (req == NULL) {
+					stack[sp].val = 0;
+					stack[sp].is_int = 1;
+				} else if (!printed_value(req->amount,
+					float_digits(req->amount, FLOAT_NUM_DIGITS), &stack[sp]))
+					return FORMULA_PYTHON;
+				sp++;
+				break;
+			case FOP_VAR:
+				if (!var_value(resresv, insn->var, &stack[sp]))
+					return FORMULA_PYTHON;
+				sp++;
+				break;
+			case FOP_NEG:
+				stack[sp - 1].val = -stack[sp - 1].val;
+				break;
+			case FOP_POS:
+				break;
+			default:
+				rc = binary_op(insn->op, &stack[sp - 2], &stack[sp - 1], &stack[sp - 2], errmsg);
+				if (rc != FORMULA_OK)
+					return rc;
+				sp--;
+		}
+	}
+
+	*ans = stack[0].val;
+	return FORMULA_OK;
+}
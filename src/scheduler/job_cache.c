@@ -0,0 +1,457 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    job_cache.c
+ *
+ * @brief
+ * 		job_cache.c - cross-cycle cache of the job status sent by the server.
+ *
+ *		Instead of fetching the status of every job every cycle, the
+ *		scheduler keeps the batch_status of each job from the previous
+ *		cycle and only asks the server for the jobs which changed since
+ *		then (a delta Select-Status request, see req_selectjobs()).  The
+ *		server stamps each job with a change sequence number and publishes
+ *		the current value in the job_change_seq server attribute.
+ *
+ *		The server_info universe is still built from scratch each cycle, but
+ *		from the cached statuses, which saves encoding, transferring and
+ *		decoding the status of every unchanged job.  If the server restarted,
+ *		does not support deltas, or can no longer report all changes, the
+ *		cache is rebuilt from a full query.
+ *
+ * Functions included are:
+ * 	jcache_refresh()
+ * 	jcache_select()
+ * 	jcache_free_select()
+ * 	jcache_invalidate()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pbs_ifl.h>
+#include <pbs_error.h>
+#include <pbs_internal.h>
+#include <libutil.h>
+#include <log.h>
+#include <avltree.h>
+#include "data_types.h"
+#include "constant.h"
+#include "job_cache.h"
+#include "job_info.h"
+#include "misc.h"
+
+
+/* the cached status of one job */
+typedef struct jcache_entry jcache_entry;
+struct jcache_entry {
+	struct batch_status *bs;	/* job status as last sent by the server */
+	char *queue;			/* queue of the job, points into bs */
+	time_t stamp;			/* time bs was valid, for eligible_time */
+	jcache_entry *prev;
+	jcache_entry *next;
+};
+
+static struct {
+	int in_use;			/* cache is current for this cycle */
+	long epoch;			/* server start time of seq */
+	long seq;			/* server job_change_seq cache is current to */
+	jcache_entry *head;		/* entries in the order the server sent them */
+	jcache_entry *tail;
+	AVL_IX_DESC *index;		/* job name -> jcache_entry */
+} jcache = { 0, 0, 0, NULL, NULL, NULL };
+
+/**
+ * @brief
+ * 		find the value of an attribute in a batch_status
+ *
+ * @param[in]	bs	-	batch_status to search
+ * @param[in]	name	-	name of the attribute
+ *
+ * @return	attrl *
+ * @retval	the attribute
+ * @retval	NULL	: attribute not found
+ */
+static struct attrl *
+jcache_find_attr(struct batch_status *bs, char *name)
+{
+	struct attrl *attrp;
+
+	for (attrp = bs->attribs; attrp != NULL; attrp = attrp->next)
+		if (!strcmp(attrp->name, name))
+			return attrp;
+
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		replace the status of a cache entry
+ *
+ * @param[in,out]	je	-	cache entry
+ * @param[in]	bs	-	new status, the entry takes ownership of it
+ * @param[in]	stamp	-	time the status is valid for
+ */
+static void
+jcache_set_status(jcache_entry *je, struct batch_status *bs, time_t stamp)
+{
+	struct attrl *attrp;
+
+	if (je->bs != NULL)
+		pbs_statfree(je->bs);
+	je->bs = bs;
+	je->stamp = stamp;
+
+	attrp = jcache_find_attr(bs, ATTR_queue);
+	je->queue = (attrp != NULL) ? attrp->value : NULL;
+}
+
+/**
+ * @brief
+ * 		add a job status to the end of the cache
+ *
+ * @param[in]	bs	-	job status, the cache takes ownership of it
+ * @param[in]	stamp	-	time the status is valid for
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure, bs is freed
+ */
+static int
+jcache_add(struct batch_status *bs, time_t stamp)
+{
+	jcache_entry *je;
+
+	je = calloc(1, sizeof(jcache_entry));
+	if (je == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		pbs_statfree(bs);
+		return 0;
+	}
+
+	jcache_set_status(je, bs, stamp);
+	if (tree_add_del(jcache.index, bs->name, je, TREE_OP_ADD) != 0) {
+		pbs_statfree(bs);
+		free(je);
+		return 0;
+	}
+
+	je->prev = jcache.tail;
+	if (jcache.tail != NULL)
+		jcache.tail->next = je;
+	else
+		jcache.head = je;
+	jcache.tail = je;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		remove an entry from the cache and free it
+ *
+ * @param[in]	je	-	entry to remove
+ */
+static void
+jcache_remove(jcache_entry *je)
+{
+	tree_add_del(jcache.index, je->bs->name, NULL, TREE_OP_DEL);
+
+	if (je->prev != NULL)
+		je->prev->next = je->next;
+	else
+		jcache.head = je->next;
+	if (je->next != NULL)
+		je->next->prev = je->prev;
+	else
+		jcache.tail = je->prev;
+
+	pbs_statfree(je->bs);
+	free(je);
+}
+
+/**
+ * @brief
+ * 		throw away the cache.  The next refresh will do a full query.
+ */
+void
+jcache_invalidate(void)
+{
+	while (jcache.head != NULL)
+		jcache_remove(jcache.head);
+
+	if (jcache.index != NULL) {
+		avl_destroy_index(jcache.index);
+		free(jcache.index);
+		jcache.index = NULL;
+	}
+	jcache.in_use = 0;
+	jcache.epoch = 0;
+	jcache.seq = 0;
+}
+
+/**
+ * @brief
+ * 		apply a delta Select-Status reply to the cache.  A status without
+ *		attributes means the job was purged or is no longer selectable.
+ *
+ * @param[in]	delta	-	the reply, it is consumed
+ * @param[in]	stamp	-	time the reply is valid for
+ *
+ * @return	int
+ * @retval	number of jobs added, changed or removed
+ * @retval	-1	: error, the cache is inconsistent
+ */
+static int
+jcache_apply(struct batch_status *delta, time_t stamp)
+{
+	struct batch_status *bs;
+	struct batch_status *bs_next;
+	jcache_entry *je;
+	int ct = 0;
+	int err = 0;
+
+	for (bs = delta; bs != NULL; bs = bs_next) {
+		bs_next = bs->next;
+		bs->next = NULL;
+
+		if (err) {
+			pbs_statfree(bs);
+			continue;
+		}
+
+		je = find_tree(jcache.index, bs->name);
+		if (bs->attribs == NULL) {
+			if (je != NULL)
+				jcache_remove(je);
+			pbs_statfree(bs);
+		} else if (je != NULL)
+			jcache_set_status(je, bs, stamp);
+		else if (!jcache_add(bs, stamp))
+			err = 1;
+		ct++;
+	}
+
+	return err ? -1 : ct;
+}
+
+/**
+ * @brief
+ * 		the server calculates eligible_time on the fly when it sends a job's
+ *		status, so a cached value is too old by the time since it was sent.
+ *		Advance eligible_time of cached jobs which are accruing it.
+ *
+ * @param[in]	now	-	the current time
+ */
+static void
+jcache_advance_eligible_time(time_t now)
+{
+	jcache_entry *je;
+	struct attrl *atype;
+	struct attrl *etime;
+	char timebuf[128];
+	char *newval;
+
+	for (je = jcache.head; je != NULL; je = je->next) {
+		if (je->stamp >= now)
+			continue;
+		atype = jcache_find_attr(je->bs, ATTR_accrue_type);
+		if (atype == NULL || atoi(atype->value) != JOB_ELIGIBLE)
+			continue;
+		etime = jcache_find_attr(je->bs, ATTR_eligible_time);
+		if (etime == NULL)
+			continue;
+
+		convert_duration_to_str((time_t) res_to_num(etime->value, NULL) +
+			(now - je->stamp), timebuf, sizeof(timebuf));
+		if ((newval = string_dup(timebuf)) == NULL)
+			continue;
+		free(etime->value);
+		etime->value = newval;
+		je->stamp = now;
+	}
+}
+
+/**
+ * @brief
+ * 		bring the job status cache up to date for this cycle
+ *
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	sinfo	-	server for this cycle, the job_change_seq it
+ *				reported is what the cache will be current to
+ *
+ * @return	int
+ * @retval	1	: the cache can be used by query_jobs() this cycle
+ * @retval	0	: query_jobs() must query the server itself
+ */
+int
+jcache_refresh(int pbs_sd, server_info *sinfo)
+{
+	struct batch_status *bs;
+	long epoch;
+	long seq;
+	char extend[64];
+	char *errmsg;
+	int ct;
+
+	jcache.in_use = 0;
+
+	/* server does not support delta queries */
+	if (sinfo->job_chgseq == NULL ||
+		sscanf(sinfo->job_chgseq, "%ld:%ld", &epoch, &seq) != 2) {
+		if (jcache.index != NULL)
+			jcache_invalidate();
+		return 0;
+	}
+
+	if (jcache.index != NULL && jcache.epoch == epoch) {
+		sprintf(extend, "SD%ld:%ld", jcache.epoch, jcache.seq);
+		bs = pbs_selstat(pbs_sd, NULL, sched_job_attrs(), extend);
+		if (bs == NULL && pbs_errno != 0) {
+			errmsg = pbs_geterrmsg(pbs_sd);
+			sprintf(log_buffer, "Delta job query failed, doing a full query: %s (%d)",
+				errmsg == NULL ? "" : errmsg, pbs_errno);
+			schdlog(PBSEVENT_DEBUG, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__, log_buffer);
+			jcache_invalidate();
+		} else if ((ct = jcache_apply(bs, sinfo->server_time)) < 0)
+			jcache_invalidate();
+		else {
+			sprintf(log_buffer, "Applied %d job changes since change sequence %ld", ct, jcache.seq);
+			schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SERVER, LOG_DEBUG, __func__, log_buffer);
+		}
+	} else if (jcache.index != NULL)
+		jcache_invalidate();
+
+	if (jcache.index == NULL) {
+		if ((jcache.index = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		bs = pbs_selstat(pbs_sd, NULL, sched_job_attrs(), "S");
+		if (bs == NULL && pbs_errno != 0) {
+			errmsg = pbs_geterrmsg(pbs_sd);
+			sprintf(log_buffer, "pbs_selstat failed: %s (%d)",
+				errmsg == NULL ? "" : errmsg, pbs_errno);
+			schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_NOTICE, __func__, log_buffer);
+			jcache_invalidate();
+			return 0;
+		}
+		if (jcache_apply(bs, sinfo->server_time) < 0) {
+			jcache_invalidate();
+			return 0;
+		}
+	}
+
+	jcache_advance_eligible_time(sinfo->server_time);
+
+	jcache.epoch = epoch;
+	jcache.seq = seq;
+	jcache.in_use = 1;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		build a list of the cached status of the jobs in a queue.  The list
+ *		is made of shallow copies, which share the attributes of the cache.
+ *
+ * @param[in]	queue_name	-	name of the queue
+ * @param[out]	jobs	-	the list of job statuses, NULL if none
+ *
+ * @return	int
+ * @retval	1	: jobs is set
+ * @retval	0	: cache not in use this cycle, or error
+ */
+int
+jcache_select(char *queue_name, struct batch_status **jobs)
+{
+	jcache_entry *je;
+	struct batch_status *head = NULL;
+	struct batch_status *tail = NULL;
+	struct batch_status *bs;
+
+	if (!jcache.in_use || queue_name == NULL || jobs == NULL)
+		return 0;
+
+	for (je = jcache.head; je != NULL; je = je->next) {
+		if (je->queue == NULL || strcmp(je->queue, queue_name))
+			continue;
+
+		if ((bs = malloc(sizeof(struct batch_status))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			jcache_free_select(head);
+			return 0;
+		}
+		*bs = *je->bs;
+		bs->next = NULL;
+		if (tail != NULL)
+			tail->next = bs;
+		else
+			head = bs;
+		tail = bs;
+	}
+
+	*jobs = head;
+	return 1;
+}
+
+/**
+ * @brief
+ * 		free a list returned by jcache_select().  The attributes belong
+ *		to the cache and are not freed.
+ *
+ * @param[in]	jobs	-	list to free
+ */
+void
+jcache_free_select(struct batch_status *jobs)
+{
+	struct batch_status *bs_next;
+
+	while (jobs != NULL) {
+		bs_next = jobs->next;
+		free(jobs);
+		jobs = bs_next;
+	}
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+#ifndef	_JOB_CACHE_H
+#define	_JOB_CACHE_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include "data_types.h"
+#include <pbs_ifl.h>
+
+/*
+ *	jcache_refresh - bring the cross-cycle job status cache up to date,
+ *			 either by applying the jobs changed since the last
+ *			 cycle or by a full query of all jobs
+ *
+ *	returns 1 if the cache can be used by query_jobs() this cycle
+ *		0 if query_jobs() must query the server itself
+ */
+int jcache_refresh(int pbs_sd, server_info *sinfo);
+
+/*
+ *	jcache_select - return the cached status of the jobs in a queue
+ *
+ *	returns 1 and sets *jobs (which may be NULL if the queue is empty)
+ *		  the list must be freed with jcache_free_select()
+ *		0 if the cache is not in use this cycle
+ */
+int jcache_select(char *queue_name, struct batch_status **jobs);
+
+/* free a list returned by jcache_select() */
+void jcache_free_select(struct batch_status *jobs);
+
+/* throw away the cache, the next refresh does a full query */
+void jcache_invalidate(void);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _JOB_CACHE_H */
@@ -42,6 +42,7 @@
  * 		job_info.c - This file contains functions related to job_info structure.
  *
  * Functions included are:
+ * 	sched_job_attrs()
  * 	query_jobs()
  * 	query_job()
  * 	new_job_info()
@@ -49,6 +50,8 @@
  * 	set_job_state()
  * 	update_job_attr()
  * 	send_job_updates()
+ * 	flush_job_updates()
+ * 	log_attr_update_error()
  * 	send_attr_updates()
  * 	unset_job_attr()
  * 	update_job_comment()
@@ -60,6 +63,9 @@
  * 	preempt_job()
  * 	find_and_preempt_jobs()
  * 	find_jobs_to_preempt()
+ * 	preempt_node_can_fit()
+ * 	create_preempt_node_map()
+ * 	preempt_candidate_filter()
  * 	select_index_to_preempt()
  * 	preempt_level()
  * 	set_preempt_prio()
@@ -122,7 +128,11 @@
 #include "simulate.h"
 #include "resource.h"
 #include "server_info.h"
+#include "job_cache.h"
 #include "attribute.h"
+#include "formula.h"
+#include "cycle_profile.h"
+#include "snapshot.h"
 
 #ifdef NAS
 #include "site_code.h"
@@ -132,6 +142,14 @@
 
 extern char *pbse_to_txt(int err);
 
+static void log_attr_update_error(int pbs_sd, char *job_name,
+	struct attrl *pattr, int errcode, char *errbuf);
+
+/* job attribute updates queued by send_job_updates() for flush_job_updates() */
+static struct batch_status *pending_updates = NULL;
+static struct batch_status *pending_updates_tail = NULL;
+static int num_pending_updates = 0;
+
 /**
  *	This table contains job comment and information messages that correspond
  *	to the sched_error enums in "constant.h".  The order of the strings in
@@ -494,6 +512,51 @@ static struct fc_translation_table fctt[] = {
 #define	ERR2COMMENT(code)	(fctt[(code) - RET_BASE].fc_comment)
 #define	ERR2INFO(code)		(fctt[(code) - RET_BASE].fc_info)
 
+/**
+ * @brief
+ * 		the job attributes the scheduler reads out of a job's status.  Jobs
+ *		are statused with this list so the server neither encodes nor
+ *		sends the rest, like Variable_List, which are never looked at.
+ *		Reading a new attribute in query_job() means adding it here.
+ *
+ * @return	struct attrl *
+ * @retval	list of attributes to pass to pbs_selstat()
+ * @retval	NULL	: ask for all the attributes
+ * @par MT-safe: No
+ */
+struct attrl *
+sched_job_attrs(void)
+{
+	static char *names[] = {
+		ATTR_N, ATTR_SchedSelect, ATTR_A, ATTR_accrue_type, ATTR_altid,
+		ATTR_array, ATTR_array_id, ATTR_array_index,
+		ATTR_array_indices_remaining, ATTR_c, ATTR_comment, ATTR_egroup,
+		ATTR_eligible_time, ATTR_estimated, ATTR_etime, ATTR_euser,
+		ATTR_execvnode, ATTR_l, ATTR_node_set, ATTR_p, ATTR_project,
+		ATTR_qrank, ATTR_qtime, ATTR_queue, ATTR_r, ATTR_rel_list,
+		ATTR_released, ATTR_resv_ID, ATTR_sched_preempted, ATTR_state,
+		ATTR_stime, ATTR_substate, ATTR_topjob_ineligible, ATTR_used,
+		NULL
+	};
+	static struct attrl attrs[sizeof(names) / sizeof(names[0])];
+	int i;
+
+#ifdef NAS
+	/* site code reads attributes of its own */
+	return NULL;
+#else
+	if (attrs[0].name == NULL) {
+		for (i = 0; names[i] != NULL; i++) {
+			attrs[i].name = names[i];
+			attrs[i].resource = NULL;
+			attrs[i].value = "";
+			attrs[i].next = (names[i + 1] != NULL) ? &attrs[i + 1] : NULL;
+		}
+	}
+	return attrs;
+#endif
+}
+
 /**
  * @brief
  * 		create an array of jobs in a specified queue
@@ -525,6 +588,8 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 
 	/* linked list of jobs returned from pbs_selstat() */
 	struct batch_status *jobs;
+	/* frees jobs, depends on where it came from */
+	void (*jobs_free)(struct batch_status *) = pbs_statfree;
 
 	/* current job in jobs linked list */
 	struct batch_status *cur_job;
@@ -574,8 +639,15 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 
 	server_time = qinfo->server->server_time;
 
-	/* get jobs from PBS server */
-	if ((jobs = pbs_selstat(pbs_sd, &opl, NULL, "S")) == NULL) {
+	/* get jobs from a replayed snapshot, the job cache or the PBS server */
+	if (snapshot_replaying()) {
+		if ((jobs = snapshot_jobs(queue_name)) == NULL)
+			return pjobs;
+	} else if (!qinfo->is_peer_queue && jcache_select(queue_name, &jobs)) {
+		if (jobs == NULL)
+			return pjobs;
+		jobs_free = jcache_free_select;
+	} else if ((jobs = pbs_selstat(pbs_sd, &opl, sched_job_attrs(), "S")) == NULL) {
 		if (pbs_errno > 0) {
 			errmsg = pbs_geterrmsg(pbs_sd);
 			if (errmsg == NULL)
@@ -586,6 +658,9 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 		return pjobs;
 	}
 
+	if (!qinfo->is_peer_queue)
+		snapshot_record(SNAP_JOBS, queue_name, jobs);
+
 	/* count the number of new jobs */
 	cur_job = jobs;
 	while (cur_job != NULL) {
@@ -608,7 +683,7 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 
 	if (resresv_arr == NULL) {
 		log_err(errno, "query_jobs", "Error allocating memory");
-		pbs_statfree(jobs);
+		jobs_free(jobs);
 		return NULL;
 	}
 	resresv_arr[num_prev_jobs] = NULL;
@@ -622,7 +697,7 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 		char *selectspec = NULL;
 		if ((resresv = query_job(cur_job, qinfo->server, err)) ==NULL) {
 			free_schd_error(err);
-			pbs_statfree(jobs);
+			jobs_free(jobs);
 			free_resource_resv_array(resresv_arr);
 			return NULL;
 		}
@@ -897,7 +972,7 @@ query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs,
 	}
 	resresv_arr[i] = NULL;
 
-	pbs_statfree(jobs);
+	jobs_free(jobs);
 	free_schd_error(err);
 
 	return resresv_arr;
@@ -1261,6 +1336,8 @@ new_job_info()
 
 
 	jinfo->formula_value = 0.0;
+	jinfo->sort_key = NULL;
+	jinfo->sort_pos = -1;
 
 #ifdef RESC_SPEC
 	jinfo->rspec = NULL;
@@ -1506,32 +1583,184 @@ update_job_attr(int pbs_sd, resource_resv *resresv, char *attr_name,
 
 /**
  * @brief
- * 		send delayed job attribute updates for job using send_attr_updates().
+ * 		queue a job's delayed attribute updates to be sent to the server
+ *		along with those of the other jobs of the cycle by flush_job_updates()
  *
  * @par
  * 		The main reason to use this function over a direct send_attr_update()
- *      call is so that the job's attr_updates list gets free'd and NULL'd.
+ *      call is so that the job's attr_updates list gets handed off and NULL'd.
  *      We don't want to send the attr updates multiple times
  *
  * @param[in]	pbs_sd	-	server connection descriptor
  * @param[in]	job	-	job to send attributes to
  *
- * @return	int(ret val from send_attr_updates)
+ * @return	int
  * @retval	1	- success
  * @retval	0	- failure to update
  */
 int send_job_updates(int pbs_sd, resource_resv *job) {
-	int rc;
+	struct batch_status *bs;
 
-	if(job == NULL)
+	if (job == NULL || job->job == NULL)
 		return 0;
 
-	rc = send_attr_updates(pbs_sd, job->name, job->job->attr_updates) ;
+	if (job->job->attr_updates == NULL)
+		return 0;
+
+	if (pbs_sd == SIMULATE_SD || got_sigpipe) {
+		free_attrl_list(job->job->attr_updates);
+		job->job->attr_updates = NULL;
+		return pbs_sd == SIMULATE_SD;
+	}
 
-	free_attrl_list(job->job->attr_updates);
+	bs = calloc(1, sizeof(struct batch_status));
+	if (bs == NULL || (bs->name = string_dup(job->name)) == NULL) {
+		free(bs);
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_attrl_list(job->job->attr_updates);
+		job->job->attr_updates = NULL;
+		return 0;
+	}
+	bs->attribs = job->job->attr_updates;
 	job->job->attr_updates = NULL;
-	return rc;
+
+	if (pending_updates_tail != NULL)
+		pending_updates_tail->next = bs;
+	else
+		pending_updates = bs;
+	pending_updates_tail = bs;
+
+	if (++num_pending_updates >= MAX_ATTR_UPDATES_BATCH)
+		flush_job_updates(pbs_sd, job->server);
+
+	return 1;
+	}
+
+/**
+ * @brief
+ * 		send all queued job attribute updates to the server in one
+ *		Modify Jobs request.  A server which does not list the request
+ *		in its multijob_requests attribute would close the connection on
+ *		it, so its jobs are updated with one pbs_alterjob() each.  If the
+ *		whole request fails, the jobs are also sent one at a time, so any
+ *		failure is logged against its job.
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor
+ * @param[in]	sinfo	-	the server of the jobs, or NULL if not known
+ *
+ * @return	int
+ * @retval	number of jobs which could not be updated
+ */
+int
+flush_job_updates(int pbs_sd, server_info *sinfo)
+{
+	struct batch_status *jobs;
+	struct batch_status *failed;
+	struct batch_status *bs;
+	struct attrl *pattr;
+	char *errbuf;
+	int errcode;
+	int nfailed = 0;
+	double prof_ts;
+
+	jobs = pending_updates;
+	pending_updates = pending_updates_tail = NULL;
+	num_pending_updates = 0;
+
+	if (jobs == NULL)
+		return 0;
+
+	prof_ts = profile_begin();
+	if (!got_sigpipe && sinfo != NULL && sinfo->has_modifyjobs) {
+		failed = pbs_alterjobs(pbs_sd, jobs, NULL);
+		if (failed == NULL && pbs_errno != PBSE_NONE) {
+			/* The whole request failed.  Send each job on its own so a
+			 * failure is logged against the job, as in the per-job path.
+			 */
+			errcode = pbs_errno;
+			errbuf = string_dup(pbs_geterrmsg(pbs_sd));
+			snprintf(log_buffer, sizeof(log_buffer),
+				"Modify Jobs request failed: %s (%d), updating jobs one at a time",
+				errbuf != NULL ? errbuf : "", errcode);
+			schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING,
+				__func__, log_buffer);
+			for (bs = jobs; bs != NULL; bs = bs->next) {
+				if (got_sigpipe) {
+					/* the connection is gone, say which jobs were not updated */
+					log_attr_update_error(pbs_sd, bs->name, bs->attribs,
+						errcode, errbuf);
+					nfailed++;
+				} else if (send_attr_updates(pbs_sd, bs->name, bs->attribs) == 0)
+					nfailed++;
+			}
+			free(errbuf);
+		}
+		for (bs = failed; bs != NULL; bs = bs->next) {
+			errcode = PBSE_SYSTEM;
+			errbuf = NULL;
+			for (pattr = bs->attribs; pattr != NULL; pattr = pattr->next) {
+				if (strcmp(pattr->name, MULTIJOB_ERRCODE) == 0)
+					errcode = atoi(pattr->value);
+				else if (strcmp(pattr->name, MULTIJOB_ERRTEXT) == 0)
+					errbuf = pattr->value;
+			}
+			log_attr_update_error(pbs_sd, bs->name, NULL, errcode, errbuf);
+			nfailed++;
+		}
+		pbs_statfree(failed);
+	} else {
+		for (bs = jobs; bs != NULL && !got_sigpipe; bs = bs->next)
+			if (send_attr_updates(pbs_sd, bs->name, bs->attribs) == 0)
+				nfailed++;
+	}
+	profile_end(PROF_SEND_UPDATES, NULL, prof_ts);
+
+	pbs_statfree(jobs);
+	return nfailed;
+}
+
+/**
+ * @brief
+ * 		log an attribute update which the server refused
+ *
+ * @param[in]	pbs_sd	-	server connection descriptor
+ * @param[in]	job_name	-	name of the job
+ * @param[in]	pattr	-	the attributes, to name the attribute if only one
+ * @param[in]	errcode	-	PBS error code of the failure
+ * @param[in]	errbuf	-	error message, or NULL
+ *
+ * @return	void
+ */
+static void
+log_attr_update_error(int pbs_sd, char *job_name, struct attrl *pattr,
+	int errcode, char *errbuf)
+{
+	char logbuf[MAX_LOG_SIZE];
+	int one_attr = 0;
+
+	if (pattr != NULL && pattr->next == NULL)
+		one_attr = 1;
+
+	if (is_finished_job(errcode) == 1) {
+		if (one_attr)
+			snprintf(logbuf, MAX_LOG_SIZE, "Failed to update attr \'%s\' = %s, Job already finished", pattr->name, pattr->value);
+		else
+			snprintf(logbuf, MAX_LOG_SIZE, "Failed to update job attributes, Job already finished");
+		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO,
+			job_name, logbuf);
+		return;
 	}
+	if (errbuf == NULL)
+		errbuf = "";
+	if (one_attr)
+		snprintf(logbuf, MAX_LOG_SIZE, "Failed to update attr \'%s\' = %s: %s (%d)", pattr->name, pattr->value, errbuf, errcode);
+	else
+		snprintf(logbuf, MAX_LOG_SIZE, "Failed to update job attributes: %s (%d)", errbuf, errcode);
+
+	schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING,
+		job_name, logbuf);
+}
+
 /**
  * @brief
  * 		send delayed attributes to the server for a job
@@ -1545,46 +1774,17 @@ int send_job_updates(int pbs_sd, resource_resv *job) {
  * @retval	0	failure to update
  */
 int send_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr) {
-	char *errbuf;
-	char logbuf[MAX_LOG_SIZE];
-	int one_attr = 0;
-
 	if (job_name == NULL || pattr == NULL)
 		return 0;
 
 	if (pbs_sd == SIMULATE_SD)
 		return 1; /* simulation always successful */
 
+	if (pbs_alterjob(pbs_sd, job_name, pattr, NULL) == 0)
+		return 1;
 
-		if (pattr->next == NULL)
-			one_attr = 1;
-
-		if (pbs_alterjob(pbs_sd, job_name, pattr, NULL) == 0)
-			return 1;
-		else {
-			if (is_finished_job(pbs_errno) == 1) {
-				if (one_attr)
-					snprintf(logbuf, MAX_LOG_SIZE, "Failed to update attr \'%s\' = %s, Job already finished", pattr->name, pattr->value);
-				else
-					snprintf(logbuf, MAX_LOG_SIZE, "Failed to update job attributes, Job already finished");
-				schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO,
-					job_name, logbuf);
-				return 0;
-			}
-			errbuf = pbs_geterrmsg(pbs_sd);
-			if (errbuf == NULL)
-				errbuf = "";
-			if (one_attr)
-				snprintf(logbuf, MAX_LOG_SIZE, "Failed to update attr \'%s\' = %s: %s (%d)", pattr->name, pattr->value, errbuf, pbs_errno);
-
-			else
-				snprintf(logbuf, MAX_LOG_SIZE, "Failed to update job attributes: %s (%d)", errbuf, pbs_errno);
-
-			schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING,
-				job_name, logbuf);
-			return 0;
-		}
-
+	log_attr_update_error(pbs_sd, job_name, pattr, pbs_errno,
+		pbs_geterrmsg(pbs_sd));
 	return 0;
 }
 
@@ -1973,6 +2173,10 @@ new_resresv_set(void)
 	rset->qinfo = NULL;
 	rset->resresv_arr = NULL;
 	rset->num_resresvs = 0;
+	rset->memo_gen = UNSPECIFIED;
+	rset->memo_nofit = NULL;
+	rset->memo_np_nofit = NULL;
+	rset->memo_np_ct = 0;
 
 	return rset;
 }
@@ -1993,6 +2197,8 @@ free_resresv_set(resresv_set *rset) {
 	free_place(rset->place_spec);
 	free_resource_req_list(rset->req);
 	free(rset->resresv_arr);
+	pbs_bitmap_free(rset->memo_nofit);
+	free(rset->memo_np_nofit);
 	free(rset);
 }
 /**
@@ -2054,12 +2260,12 @@ dup_resresv_set(resresv_set *oset, server_info *nsinfo)
 		free_resresv_set(rset);
 		return NULL;
 	}
-	rset->select_spec = dup_selspec(oset->select_spec);
+	rset->select_spec = share_selspec(oset->select_spec);
 	if (rset->select_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
 	}
-	rset->place_spec = dup_place(oset->place_spec);
+	rset->place_spec = share_place(oset->place_spec);
 	if (rset->place_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
@@ -2308,12 +2514,12 @@ create_resresv_set_by_resresv(status *policy, server_info *sinfo, resource_resv
 			rset->partition = string_dup(resresv->job->queue->partition);
 	}
 
-	rset->select_spec = dup_selspec(resresv_set_which_selspec(resresv));
+	rset->select_spec = share_selspec(resresv_set_which_selspec(resresv));
 	if (rset->select_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
 	}
-	rset->place_spec = dup_place(resresv->place_spec);
+	rset->place_spec = share_place(resresv->place_spec);
 	if (rset->place_spec == NULL) {
 		free_resresv_set(rset);
 		return NULL;
@@ -2569,6 +2775,7 @@ dup_job_info(job_info *ojinfo, queue_info *nqinfo, server_info *nsinfo)
 	njinfo->job_id = ojinfo->job_id;
 	njinfo->est_start_time = ojinfo->est_start_time;
 	njinfo->formula_value = ojinfo->formula_value;
+	njinfo->sort_pos = ojinfo->sort_pos;
 	njinfo->est_execvnode = string_dup(ojinfo->est_execvnode);
 	njinfo->job_name = string_dup(ojinfo->job_name);
 	njinfo->comment = string_dup(ojinfo->comment);
@@ -2790,7 +2997,10 @@ preempt_job(status *policy, int pbs_sd, resource_resv *pjob, server_info *sinfo)
 			/* Set resources_released and execselect on the job */
 			create_res_released(policy, pjob);
 
-			ret = pbs_sigjob(pbs_sd, pjob->name, "suspend", NULL);
+			if (pbs_sd == SIMULATE_SD)
+				ret = 0;
+			else
+				ret = pbs_sigjob(pbs_sd, pjob->name, "suspend", NULL);
 			if ((ret != 0) && (is_finished_job(pbs_errno) == 1)) {
 				histjob = 1;
 				ret = 0;
@@ -2806,7 +3016,17 @@ preempt_job(status *policy, int pbs_sd, resource_resv *pjob, server_info *sinfo)
 		}
 
 		/* try only if checkpointing is enabled */
-		if (po->order[i] == PREEMPT_METHOD_CHECKPOINT && pjob->job->can_checkpoint) {
+		if (po->order[i] == PREEMPT_METHOD_CHECKPOINT && pjob->job->can_checkpoint &&
+			pbs_sd == SIMULATE_SD) {
+			/* there is no server to ask whether the checkpoint worked, assume it did */
+			ret = 0;
+			pjob->job->is_checkpointed = 1;
+			update_universe_on_end(policy, pjob, "Q", NO_FLAGS);
+			schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO,
+				pjob->name, "Job preempted by checkpointing");
+			job_preempted = 1;
+		}
+		else if (po->order[i] == PREEMPT_METHOD_CHECKPOINT && pjob->job->can_checkpoint) {
 				ret = pbs_holdjob(pbs_sd, pjob->name, "s", NULL);
 				if ((ret != 0) && (is_finished_job(pbs_errno) == 1)) {
 					histjob = 1;
@@ -2838,7 +3058,10 @@ preempt_job(status *policy, int pbs_sd, resource_resv *pjob, server_info *sinfo)
 
 		/* try only of requeueing is enabled */
 		if (po->order[i] == PREEMPT_METHOD_REQUEUE && pjob->job->can_requeue) {
-			ret = pbs_rerunjob(pbs_sd, pjob->name, NULL);
+			if (pbs_sd == SIMULATE_SD)
+				ret = 0;
+			else
+				ret = pbs_rerunjob(pbs_sd, pjob->name, NULL);
 			if ((ret != 0) && (is_finished_job(pbs_errno) == 1)) {
 				histjob = 1;
 				ret = 0;
@@ -2867,7 +3090,7 @@ preempt_job(status *policy, int pbs_sd, resource_resv *pjob, server_info *sinfo)
 	} else {
 		/* we're prematurely ending a job.  We need to correct our calendar */
 		if (sinfo->calendar != NULL) {
-			te = find_timed_event(sinfo->calendar->events, pjob->name, TIMED_END_EVENT, 0);
+			te = find_calendar_event(sinfo->calendar, pjob->name, TIMED_END_EVENT, 0);
 			if (te != NULL) {
 				if (delete_event(sinfo, te, DE_NO_FLAGS) == 0)
 					schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, pjob->name, "Failed to delete end event for job.");
@@ -3059,6 +3282,12 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	resource_resv **prjobs = NULL;
 	int rjobs_count = 0;
 
+	resource_resv **cjobs = NULL;	/* preemption candidates */
+	pbs_bitmap *node_map = NULL;	/* nodes which could hold a chunk of hjob */
+	int num_useful_nodes = 0;
+	long num_examined = 0;		/* running jobs looked at by select_index_to_preempt() */
+	int num_simulated = 0;		/* simulated runs of the high priority job */
+
 
 	if (hjob == NULL || sinfo == NULL)
 		return NULL;
@@ -3219,6 +3448,32 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 		rjobs_count = nsinfo->sc.running;
 	}
 
+	/* Only jobs of a lower preemption priority can ever be selected.  Drop the
+	 * rest now rather than rejecting them on every call to select_index_to_preempt()
+	 */
+	cjobs = resource_resv_filter(rjobs, rjobs_count, preempt_candidate_filter,
+		(void *) njob, NO_FLAGS);
+	if (cjobs == NULL) {
+		free_server(nsinfo, 1);
+		free_schd_error_list(full_err);
+		free(pjobs);
+		free(prjobs);
+		return NULL;
+	}
+	free(prjobs);
+	prjobs = cjobs;
+	rjobs = cjobs;
+	rjobs_count = count_array((void **) cjobs);
+	if (rjobs_count == 0) {
+		schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, njob->name,
+			"No running jobs of a lower preemption priority to preempt");
+		free_server(nsinfo, 1);
+		free_schd_error_list(full_err);
+		free(pjobs);
+		free(prjobs);
+		return NULL;
+	}
+
 	/* sort jobs in ascending preemption priority and starttime... we want to preempt them
 	 * from lowest prio to highest
 	 */
@@ -3244,10 +3499,17 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 		return NULL;
 	}
 
+	/* if this fails, select_index_to_preempt() checks each candidate's nodes */
+	node_map = create_preempt_node_map(npolicy, njob, rjobs, nsinfo->num_nodes,
+		&num_useful_nodes);
+
 	skipto=0;
-	while ((indexfound = select_index_to_preempt(npolicy, njob, rjobs, skipto, err, fail_list)) != NO_JOB_FOUND) {
+	while ((indexfound = select_index_to_preempt(npolicy, njob, rjobs, skipto, err, fail_list, node_map)) != NO_JOB_FOUND) {
+		if (indexfound != ERR_IN_SELECT)
+			num_examined += indexfound - skipto + 1;
 		if (indexfound == ERR_IN_SELECT) {
 			/* System error occurred, no need to proceed */
+			pbs_bitmap_free(node_map);
 			free_server(nsinfo, 1);
 			free(pjobs);
 			free(prjobs);
@@ -3267,7 +3529,7 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 
 			update_universe_on_end(npolicy, pjob,  "S", NO_ALLPART);
 			if ( nsinfo->calendar != NULL ) {
-				te = find_timed_event(nsinfo->calendar->events, pjob->name, TIMED_END_EVENT, 0);
+				te = find_calendar_event(nsinfo->calendar, pjob->name, TIMED_END_EVENT, 0);
 				if (te != NULL) {
 					if (delete_event(nsinfo, te, DE_NO_FLAGS) == 0)
 						schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_JOB, LOG_INFO, pjob->name, "Failed to delete end event for job.");
@@ -3309,6 +3571,7 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 
 
 			clear_schd_error(err);
+			num_simulated++;
 			if ((ns_arr = is_ok_to_run(npolicy, nsinfo,
 				njob->job->queue, njob, NO_ALLPART, err)) != NULL) {
 
@@ -3321,6 +3584,7 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 					nj = queue_subjob(njob, nsinfo, njob->job->queue);
 
 					if (nj == NULL) {
+						pbs_bitmap_free(node_map);
 						free_server(nsinfo, 1);
 						free(pjobs);
 						free(prjobs);
@@ -3382,8 +3646,20 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 		schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB,
 			LOG_DEBUG, njob->name, buf);
 	}
+	if (indexfound == NO_JOB_FOUND)
+		num_examined += rjobs_count - skipto;
 
 	pjobs[j] = NULL;
+	pbs_bitmap_free(node_map);
+
+	if (node_map != NULL)
+		snprintf(log_buf, sizeof(log_buf), "%d useful nodes", num_useful_nodes);
+	else
+		snprintf(log_buf, sizeof(log_buf), "nodes checked per job");
+	snprintf(buf, sizeof(buf), "Preemption work: %d of %d running jobs were candidates, "
+		"%ld examined, %d simulated runs, %d jobs selected, %s",
+		rjobs_count, sinfo->sc.running, num_examined, num_simulated, j, log_buf);
+	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG, njob->name, buf);
 
 	/* check to see if we lowered our preempt priority in our simulation
 	 * if we have, then punt and don't
@@ -3460,6 +3736,192 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 	return pjobs_list;
 }
 
+/**
+ * @brief
+ *		check if a node could hold a chunk of a high priority job if all of
+ *		its resources were free
+ *
+ * @param[in] policy - policy info
+ * @param[in] node - the node to check
+ * @param[in] hjob - the high priority job
+ * @param[in,out] prdtc_non_consumable - non-consumable resources to check on
+ *			  vnodes of multi-vnoded hosts.  Created on first use, caller frees.
+ *
+ * @return int
+ * @retval 1 the node could hold a chunk of hjob
+ * @retval 0 the node could not hold a chunk of hjob
+ */
+int
+preempt_node_can_fit(status *policy, node_info *node, resource_resv *hjob,
+	resdef ***prdtc_non_consumable)
+{
+	resdef **rdtc_here = NULL; /* at first assume all resources (including consumables) need to be checked */
+	schd_error *err;
+	int node_good = 0;
+	int k;
+
+	if (policy == NULL || node == NULL || hjob == NULL || prdtc_non_consumable == NULL)
+		return 0;
+
+	if (node->is_multivnoded) {
+		/* unsafe to consider vnodes from multivnoded hosts "no good" when "not enough" of some consumable
+		 * resource can be found in the vnode, since rest may be provided by other vnodes on the same host
+		 * restrict check on these vnodes to check only against non consumable resources
+		 */
+		if (*prdtc_non_consumable == NULL) {
+			long max_resdefs = 0;
+			max_resdefs = count_array((void **) policy->resdef_to_check);
+			if (max_resdefs > 0) {
+				resdef **rdtc_non_consumable;
+
+				rdtc_non_consumable = (resdef **) calloc(sizeof(resdef *), (size_t) max_resdefs + 1);
+				if (rdtc_non_consumable != NULL) {
+					long resdef_index = 0;
+					long rdtc_nc_index = 0;
+					for (; policy->resdef_to_check[resdef_index] != NULL; resdef_index++) {
+						if (policy->resdef_to_check[resdef_index]->type.is_non_consumable) {
+							rdtc_non_consumable[rdtc_nc_index] = policy->resdef_to_check[resdef_index];
+							rdtc_nc_index++;
+						}
+						rdtc_non_consumable[rdtc_nc_index] = NULL;
+					}
+				}
+				*prdtc_non_consumable = rdtc_non_consumable;
+			}
+		}
+		rdtc_here = *prdtc_non_consumable;
+	}
+
+	err = new_schd_error();
+	if (err == NULL)
+		return 0;
+
+	for (k = 0; hjob->select->chunks[k] != NULL; k++) {
+		long num_chunks_returned = 0;
+		/* if only non consumables are checked, infinite number of chunks can be satisfied,
+		 * and SCHD_INFINITY is negative, so don't be tempted to check on positive value
+		 */
+		clear_schd_error(err);
+		num_chunks_returned = check_avail_resources(node->res, hjob->select->chunks[k]->req,
+					COMPARE_TOTAL | CHECK_ALL_BOOLS | UNSET_RES_ZERO,
+					rdtc_here, INSUFFICIENT_RESOURCE, err);
+		if ( (num_chunks_returned > 0) || (num_chunks_returned == SCHD_INFINITY) ) {
+			node_good = 1;
+			break;
+		}
+	}
+	free_schd_error(err);
+
+	return node_good;
+}
+
+/**
+ * @brief
+ *		create the bitmap of the nodes which could hold a chunk of a high
+ *		priority job if all of their resources were free.  Only jobs
+ *		running on these nodes free node resources useful to the job.
+ *		Only the nodes the candidate jobs run on are checked, each once.
+ *		Node totals do not change while preemption is simulated, so the
+ *		map is created once per preemption attempt.
+ *
+ * @param[in] policy - policy info
+ * @param[in] hjob - the high priority job
+ * @param[in] cjobs - the running jobs which may be preempted
+ * @param[in] num_nodes - number of nodes on the server (sizes the maps)
+ * @param[out] num_useful - number of nodes in the map
+ *
+ * @return pbs_bitmap *
+ * @retval bitmap of useful nodes by node_ind
+ * @retval NULL on error
+ */
+pbs_bitmap *
+create_preempt_node_map(status *policy, resource_resv *hjob,
+	resource_resv **cjobs, int num_nodes, int *num_useful)
+{
+	pbs_bitmap *node_map;
+	pbs_bitmap *checked;	/* nodes already checked for an earlier job */
+	resdef **rdtc_non_consumable = NULL;
+	node_info *node;
+	int ct = 0;
+	int i;
+	int j;
+
+	if (policy == NULL || hjob == NULL || hjob->select == NULL || cjobs == NULL)
+		return NULL;
+
+	node_map = pbs_bitmap_alloc(NULL, num_nodes + 1);
+	checked = pbs_bitmap_alloc(NULL, num_nodes + 1);
+	if (node_map == NULL || checked == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		pbs_bitmap_free(node_map);
+		pbs_bitmap_free(checked);
+		return NULL;
+	}
+
+	for (i = 0; cjobs[i] != NULL; i++) {
+		if (cjobs[i]->ninfo_arr == NULL)
+			continue;
+
+		for (j = 0; cjobs[i]->ninfo_arr[j] != NULL; j++) {
+			node = cjobs[i]->ninfo_arr[j];
+			if (node->node_ind < 0) {
+				/* can't index the node, let select_index_to_preempt() check it */
+				pbs_bitmap_free(node_map);
+				pbs_bitmap_free(checked);
+				free(rdtc_non_consumable);
+				return NULL;
+			}
+			if (pbs_bitmap_get_bit(checked, node->node_ind))
+				continue;
+			pbs_bitmap_bit_on(checked, node->node_ind);
+
+			if (preempt_node_can_fit(policy, node, hjob, &rdtc_non_consumable)) {
+				pbs_bitmap_bit_on(node_map, node->node_ind);
+				ct++;
+			}
+		}
+	}
+	pbs_bitmap_free(checked);
+	free(rdtc_non_consumable);
+
+	if (num_useful != NULL)
+		*num_useful = ct;
+
+	return node_map;
+}
+
+/**
+ * @brief
+ *		filter function used with resource_resv_filter() to select the
+ *		running jobs which have a lower preemption priority than a high
+ *		priority job and can be preempted at all
+ *
+ * @see	resource_resv_filter()
+ *
+ * @param[in]	job	-	job to consider to include
+ * @param[in]	arg	-	the high priority job
+ *
+ * @retval	int
+ * @return	1	: the job is a preemption candidate
+ * @return	0	: the job is not a preemption candidate
+ */
+int
+preempt_candidate_filter(resource_resv *job, void *arg)
+{
+	resource_resv *hjob = (resource_resv *) arg;
+
+	if (job == NULL || hjob == NULL || job->job == NULL || job->ninfo_arr == NULL)
+		return 0;
+
+	if (!job->job->is_running || job->job->is_provisioning || job->job->can_not_preempt)
+		return 0;
+
+	if (job->job->preempt >= hjob->job->preempt)
+		return 0;
+
+	return 1;
+}
+
 /**
  * @brief
  *		select a good candidate for preemption
@@ -3471,6 +3933,9 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
  * @param[in] err    - reason the high prio job isn't running
  * @param[in] fail_list - list of jobs to skip. They previously failed to be preempted.
  *			  Do not select them again.
+ * @param[in] node_map - nodes which could hold a chunk of hjob
+ *			 (see create_preempt_node_map()).  If NULL, the nodes of
+ *			 each candidate are checked.
  *
  * @return long
  * @retval index of the job to preempt
@@ -3480,9 +3945,9 @@ find_jobs_to_preempt(status *policy, resource_resv *hjob, server_info *sinfo, in
 long
 select_index_to_preempt(status *policy, resource_resv *hjob,
 	resource_resv **rjobs, long skipto, schd_error *err,
-	int *fail_list)
+	int *fail_list, pbs_bitmap *node_map)
 {
-	int i, j, k;
+	int i, j;
 	resource_req *req;
 	int good = 1, certainlygood = 0;		/* good boolean: Is job eligible to be preempted */
 	struct preempt_ordering *po;
@@ -3780,60 +4245,16 @@ select_index_to_preempt(status *policy, resource_resv *hjob,
 			}
 		}
 		if (good) {
-			schd_error *err;
 			node_good = 0;
 
-			err = new_schd_error();
-			if(err == NULL)
-				return NO_JOB_FOUND;
-
 			for (j = 0; rjobs[i]->ninfo_arr[j] != NULL && !node_good; j++) {
-				resdef **rdtc_here = NULL; /* at first assume all resources (including consumables) need to be checked */
 				node_info *node = rjobs[i]->ninfo_arr[j];
-				if (node->is_multivnoded) {
-					/* unsafe to consider vnodes from multivnoded hosts "no good" when "not enough" of some consumable
-					 * resource can be found in the vnode, since rest may be provided by other vnodes on the same host
-					 * restrict check on these vnodes to check only against non consumable resources
-					 */
-					if (rdtc_non_consumable == NULL) {
-						long max_resdefs = 0;
-						if (policy != NULL) {
-							max_resdefs = count_array( (void **) policy->resdef_to_check);
-						}
-						if (max_resdefs > 0)    {
-							rdtc_non_consumable = (resdef **) calloc(sizeof(resdef *),(size_t) max_resdefs + 1);
-							if (rdtc_non_consumable != NULL) {
-								long resdef_index = 0;
-								long rdtc_nc_index = 0;
-								for (; policy->resdef_to_check[resdef_index] != NULL; resdef_index++) {
-									if (policy->resdef_to_check[resdef_index]->type.is_non_consumable) {
-										rdtc_non_consumable[rdtc_nc_index] = policy->resdef_to_check[resdef_index];
-										rdtc_nc_index++;
-									}
-									rdtc_non_consumable[rdtc_nc_index] = NULL;
-								}
-							}
-						}
-					}
-					rdtc_here = rdtc_non_consumable;
-				}
-				for (k = 0; hjob->select->chunks[k] != NULL; k++) {
-					long num_chunks_returned = 0;
-					/* if only non consumables are checked, infinite number of chunks can be satisfied,
-					 * and SCHD_INFINITY is negative, so don't be tempted to check on positive value
-					 */
-					clear_schd_error(err);
-					num_chunks_returned = check_avail_resources(node->res, hjob->select->chunks[k]->req,
-								COMPARE_TOTAL | CHECK_ALL_BOOLS | UNSET_RES_ZERO,
-								rdtc_here, INSUFFICIENT_RESOURCE, err);
-					if ( (num_chunks_returned > 0) || (num_chunks_returned == SCHD_INFINITY) ) {
-						node_good = 1;
-						break;
-					}
 
-				}
+				if (node_map != NULL && node->node_ind >= 0)
+					node_good = pbs_bitmap_get_bit(node_map, node->node_ind);
+				else
+					node_good = preempt_node_can_fit(policy, node, hjob, &rdtc_non_consumable);
 			}
-			free_schd_error(err);
 
 			if (node_good == 0) {
 				svr_res_good = 0;
@@ -4294,8 +4715,8 @@ queue_subjob(resource_resv *array, server_info *sinfo,
 
 /**
  * @brief
- * 		evaluate a math formula for jobs based on their resources
- *		NOTE: currently done through embedded python interpreter
+ * 		evaluate a math formula for jobs through the embedded python
+ *		interpreter.  Used for formulas eval_formula() can't handle.
  *
  * @param[in]	formula	-	formula to evaluate
  * @param[in]	resresv	-	job for special case key words
@@ -4306,8 +4727,8 @@ queue_subjob(resource_resv *array, server_info *sinfo,
  */
 
 #ifdef PYTHON
-sch_resource_t
-formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
+static sch_resource_t
+formula_evaluate_python(char *formula, resource_resv *resresv, resource_req *resreq)
 {
 	char buf[1024];
 	char *globals;
@@ -4429,13 +4850,56 @@ formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
 	return ans;
 }
 #else
-sch_resource_t
-formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
+static sch_resource_t
+formula_evaluate_python(char *formula, resource_resv *resresv, resource_req *resreq)
 {
 	return 0;
 }
 #endif
 
+/**
+ * @brief
+ * 		evaluate a math formula for jobs based on their resources
+ *		NOTE: the formula is compiled once and evaluated natively.
+ *		Formulas which can't be compiled are evaluated through the
+ *		embedded python interpreter.
+ *
+ * @param[in]	formula	-	formula to evaluate
+ * @param[in]	resresv	-	job for special case key words
+ * @param[in]	resreq	-	resources to use when evaluating
+ *
+ * @return	evaluated formula answer or 0 on exception
+ *
+ */
+sch_resource_t
+formula_evaluate(char *formula, resource_resv *resresv, resource_req *resreq)
+{
+	char errbuf[MAX_LOG_SIZE];
+	formula_expr *fexpr;
+	sch_resource_t ans = 0;
+	char *errmsg = NULL;
+
+	if (formula == NULL || resresv == NULL ||
+		resresv->job == NULL || consres == NULL)
+		return 0;
+
+	if ((fexpr = find_formula(formula)) != NULL) {
+		switch (eval_formula(fexpr, resresv, resreq, &ans, &errmsg)) {
+			case FORMULA_OK:
+				return ans;
+			case FORMULA_ERROR:
+				snprintf(errbuf, sizeof(errbuf),
+					"Formula evaluation for job had an error.  Zero value will be used: %s",
+					errmsg);
+				schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+					resresv->name, errbuf);
+				return 0;
+		}
+	}
+
+	return formula_evaluate_python(formula, resresv, resreq);
+}
+
 /**
  * @brief
  * 		Set the job accrue type to eligible time.
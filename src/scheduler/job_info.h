@@ -49,6 +49,9 @@ extern "C" {
  */
 resource_resv *query_job(struct batch_status *job, server_info *sinfo, schd_error *err);
 
+/* the job attributes the scheduler asks the server for */
+struct attrl *sched_job_attrs(void);
+
 /* create an array of jobs for a particular queue */
 resource_resv **query_jobs(status *policy, int pbs_sd, queue_info *qinfo, resource_resv **pjobs, char *queue_name);
 
@@ -79,9 +82,12 @@ int
 update_job_attr(int pbs_sd, resource_resv *resresv, char *attr_name,
 	char *attr_resc, char *attr_value, struct attrl *extra, unsigned int flags );
 
-/* send delayed job attribute updates for job using send_attr_updates() */
+/* queue delayed job attribute updates for job for flush_job_updates() */
 int send_job_updates(int pbs_sd, resource_resv *job);
 
+/* send all queued job attribute updates to the server in one request */
+int flush_job_updates(int pbs_sd, server_info *sinfo);
+
 /* send delayed attributes to the server for a job */
 int send_attr_updates(int pbs_sd, char *job_name, struct attrl *pattr);
 
@@ -159,7 +165,27 @@ find_jobs_to_preempt(status *policy, resource_resv *jinfo,
 long
 select_index_to_preempt(status *policy, resource_resv *hjob,
 	resource_resv **rjobs, long skipto, schd_error *err,
-	int *fail_list);
+	int *fail_list, pbs_bitmap *node_map);
+
+/*
+ *	preempt_node_can_fit - check if a node could hold a chunk of a high
+ *			       priority job if all of its resources were free
+ */
+int preempt_node_can_fit(status *policy, node_info *node, resource_resv *hjob,
+	resdef ***prdtc_non_consumable);
+
+/*
+ *	create_preempt_node_map - create the bitmap of nodes which could hold a
+ *				  chunk of a high priority job
+ */
+pbs_bitmap *create_preempt_node_map(status *policy, resource_resv *hjob,
+	resource_resv **cjobs, int num_nodes, int *num_useful);
+
+/*
+ *	preempt_candidate_filter - resource_resv_filter() function selecting
+ *				   running jobs preemptable by a job
+ */
+int preempt_candidate_filter(resource_resv *job, void *arg);
 
 /*
  *      preempt_level - take a preemption priority and return a preemption
@@ -54,6 +54,9 @@
  * 	new_limcounts()
  * 	free_limcounts()
  * 	make_limcounts()
+ * 	replay_limcounts_max()
+ * 	dup_entity_counts()
+ * 	make_resresv_limcounts()
  * 	check_limits()
  * 	check_soft_limits()
  * 	check_server_max_user_run()
@@ -128,6 +131,7 @@
 #include	"simulate.h"
 #include	"resource.h"
 #include	"globals.h"
+#include	"usage_profile.h"
 
 struct limcounts
 {
@@ -819,260 +823,454 @@ make_limcounts(counts *user, counts *group, counts *project, counts *all)
 
 /**
  * @brief
- *		check_limits - hard limit checking function.
- *		This is table-driven limit checking, against limfuncs[]
- *		array.
+ *		replay_limcounts_max - find the most each count will reach by end
+ *			by replaying the job run and end events of the calendar
+ *			on copies of the current counts.  Used when rr has its own
+ *			events in the calendar, which must not be counted.
  *
  * @param[in]	si	-	server_info structure to use for limit evaluation
  * @param[in]	qi	-	queue_info structure to use for limit evaluation
  * @param[in]	rr	-	resource_resv structure to use for limit evaluation
- * @param[out]	err	-	sched_error structure to return error information
- * @param[in]	flags	-	CHECK_LIMITS - check real limits
- *                      CHECK_CUMULATIVE_LIMIT - check limits against total counts
- *                      RETURN_ALL_ERR - check all limits and return an err for all failed limits *
+ * @param[in]	end	-	events before this time are replayed
+ * @param[out]	svr_max	-	max server counts if the server has hard limits
+ * @param[out]	que_max	-	max queue counts if the queue has hard limits
  *
- * @return	integer indicating failing limit test if limit is exceeded,
- *				along with error 'err'.
- * @retval	0	: if limit is not exceeded.
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
  */
-
-int
-check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err, unsigned int flags)
+static int
+replay_limcounts_max(server_info *si, queue_info *qi, resource_resv *rr,
+	time_t end, limcounts **svr_max, limcounts **que_max)
 {
-	int	rc;
-	int	any_fail_rc = 0;
-	int	i;
 	limcounts *svr_counts = NULL;
 	limcounts *que_counts = NULL;
 	limcounts *svr_counts_max = NULL;
 	limcounts *que_counts_max = NULL;
-	limcounts *server_lim = NULL;
-	limcounts *queue_lim = NULL;
 	timed_event *te;
 	resource_resv *te_rr;
-	long time_left;
-	long end;
 	int error = 0;
 	unsigned int event_mask;
 	counts *cts;
-	schd_error *prev_err = NULL;
 
-	if (si == NULL || qi == NULL || rr == NULL)
-		return 0;
+	*svr_max = NULL;
+	*que_max = NULL;
 
-	/*
-	 * Check for  CHECK_CUMULATIVE_LIMIT is needed because we  must have
-	 * already run through the same loop before while calling check_limits
-	 * from is_ok_to_run.
-	 * We do not need to run into the same loop again.
-	 */
-	if (si->calendar != NULL && !(flags & CHECK_CUMULATIVE_LIMIT)) {
-		if (rr->duration != rr->hard_duration &&
-		   exists_resv_event(si->calendar, si->server_time + rr->hard_duration))
-			time_left = calc_time_left(rr, 1);
-		else
-			time_left = calc_time_left(rr, 0);
-		end = si->server_time + time_left;
-		if (exists_run_event(si->calendar, end)) {
-			if (si->has_hard_limit) {
-				svr_counts_max = make_limcounts(si->user_counts,
-					si->group_counts,
-					si->project_counts,
-					si->alljobcounts);
-				if (svr_counts_max == NULL)
-					return 0;
+	if (si->has_hard_limit) {
+		svr_counts_max = make_limcounts(si->user_counts,
+			si->group_counts,
+			si->project_counts,
+			si->alljobcounts);
+		if (svr_counts_max == NULL)
+			return 0;
 
-				svr_counts = make_limcounts(si->user_counts,
-					si->group_counts,
-					si->project_counts,
-					si->alljobcounts);
-				if (svr_counts == NULL) {
-					free_limcounts(svr_counts_max);
-					return 0;
-				}
-			}
+		svr_counts = make_limcounts(si->user_counts,
+			si->group_counts,
+			si->project_counts,
+			si->alljobcounts);
+		if (svr_counts == NULL) {
+			free_limcounts(svr_counts_max);
+			return 0;
+		}
+	}
 
-			if (qi->has_hard_limit) {
-				que_counts_max = make_limcounts(qi->user_counts,
-					qi->group_counts,
-					qi->project_counts,
-					qi->alljobcounts);
-				if (que_counts_max == NULL) {
-					free_limcounts(svr_counts_max);
-					free_limcounts(svr_counts);
-					return 0;
-				}
+	if (qi->has_hard_limit) {
+		que_counts_max = make_limcounts(qi->user_counts,
+			qi->group_counts,
+			qi->project_counts,
+			qi->alljobcounts);
+		if (que_counts_max == NULL) {
+			free_limcounts(svr_counts_max);
+			free_limcounts(svr_counts);
+			return 0;
+		}
 
-				que_counts = make_limcounts(qi->user_counts,
-					qi->group_counts,
-					qi->project_counts,
-					qi->alljobcounts);
+		que_counts = make_limcounts(qi->user_counts,
+			qi->group_counts,
+			qi->project_counts,
+			qi->alljobcounts);
 
-				if (que_counts == NULL) {
-					free_limcounts(svr_counts_max);
-					free_limcounts(que_counts_max);
-					free_limcounts(svr_counts);
-					return 0;
+		if (que_counts == NULL) {
+			free_limcounts(svr_counts_max);
+			free_limcounts(que_counts_max);
+			free_limcounts(svr_counts);
+			return 0;
+		}
+	}
+
+	te = get_next_event(si->calendar);
+	event_mask = TIMED_RUN_EVENT|TIMED_END_EVENT;
+	for (te = find_init_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask);
+		te != NULL && te->event_time < end;
+		te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask)) {
+		te_rr = (resource_resv *) te->event_ptr;
+		if ((te_rr != rr) && te_rr->is_job) {
+			if (te->event_type == TIMED_RUN_EVENT) {
+				if (svr_counts != NULL) {
+					cts = find_alloc_counts(svr_counts->user, te_rr->user);
+					if (svr_counts->user == NULL)
+						svr_counts->user = cts;
+					update_counts_on_run(cts, te_rr->resreq);
+					svr_counts_max->user =
+						counts_max(svr_counts_max->user, cts);
+					if (svr_counts_max->user == NULL) {
+						error = 1;
+						break;
+					}
+
+					cts = find_alloc_counts(svr_counts->group, te_rr->group);
+					if (svr_counts->group == NULL)
+						svr_counts->group = cts;
+					update_counts_on_run(cts, te_rr->resreq);
+					svr_counts_max->group =
+						counts_max(svr_counts_max->group, cts);
+					if (svr_counts_max->group == NULL) {
+						error = 1;
+						break;
+					}
+
+					cts = find_alloc_counts(svr_counts->project, te_rr->project);
+					if (svr_counts->project == NULL)
+						svr_counts->project = cts;
+					update_counts_on_run(cts, te_rr->resreq);
+					svr_counts_max->project =
+						counts_max(svr_counts_max->project, cts);
+					if (svr_counts_max->project == NULL) {
+						error = 1;
+						break;
+					}
+
+					update_counts_on_run(svr_counts->all, te_rr->resreq);
+					svr_counts_max->all =
+						counts_max(svr_counts_max->all, svr_counts->all);
+					if (svr_counts_max->all == NULL) {
+						error = 1;
+						break;
+					}
 				}
-			}
 
-			te = get_next_event(si->calendar);
-			event_mask = TIMED_RUN_EVENT|TIMED_END_EVENT;
-			for (te = find_init_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask);
-				te != NULL && te->event_time < end;
-				te = find_next_timed_event(te, IGNORE_DISABLED_EVENTS, event_mask)) {
-				te_rr = (resource_resv *) te->event_ptr;
-				if ((te_rr != rr) && te_rr->is_job) {
-					if (te->event_type == TIMED_RUN_EVENT) {
-						if (svr_counts != NULL) {
-							cts = find_alloc_counts(svr_counts->user, te_rr->user);
-							if (svr_counts->user == NULL)
-								svr_counts->user = cts;
+				if (que_counts != NULL) {
+					if (te_rr->is_job && te_rr->job != NULL) {
+						if (te_rr->job->queue == qi) {
+							cts = find_alloc_counts(que_counts->user, te_rr->user);
+							if (que_counts->user == NULL)
+								que_counts->user = cts;
 							update_counts_on_run(cts, te_rr->resreq);
-							svr_counts_max->user =
-								counts_max(svr_counts_max->user, cts);
-							if (svr_counts_max->user == NULL) {
+							que_counts_max->user =
+								counts_max(que_counts_max->user, cts);
+							if (que_counts_max->user == NULL) {
 								error = 1;
 								break;
 							}
 
-							cts = find_alloc_counts(svr_counts->group, te_rr->group);
-							if (svr_counts->group == NULL)
-								svr_counts->group = cts;
+							cts = find_alloc_counts(que_counts->group, te_rr->group);
+							if (que_counts->group == NULL)
+								que_counts->group = cts;
 							update_counts_on_run(cts, te_rr->resreq);
-							svr_counts_max->group =
-								counts_max(svr_counts_max->group, cts);
-							if (svr_counts_max->group == NULL) {
+							que_counts_max->group =
+								counts_max(que_counts_max->group, cts);
+							if (que_counts_max->group == NULL) {
 								error = 1;
 								break;
 							}
 
-							cts = find_alloc_counts(svr_counts->project, te_rr->project);
-							if (svr_counts->project == NULL)
-								svr_counts->project = cts;
+							cts = find_alloc_counts(que_counts->project, te_rr->project);
+							if (que_counts->project == NULL)
+								que_counts->project = cts;
 							update_counts_on_run(cts, te_rr->resreq);
-							svr_counts_max->project =
-								counts_max(svr_counts_max->project, cts);
-							if (svr_counts_max->project == NULL) {
+							que_counts_max->project =
+								counts_max(que_counts_max->project, cts);
+							if (que_counts_max->project == NULL) {
 								error = 1;
 								break;
 							}
 
-							update_counts_on_run(svr_counts->all, te_rr->resreq);
-							svr_counts_max->all =
-								counts_max(svr_counts_max->all, svr_counts->all);
-							if (svr_counts_max->all == NULL) {
+							update_counts_on_run(que_counts->all, te_rr->resreq);
+							que_counts_max->all =
+								counts_max(que_counts_max->all, que_counts->all);
+							if (que_counts_max->all == NULL) {
 								error = 1;
 								break;
 							}
 						}
-
-						if (que_counts != NULL) {
-							if (te_rr->is_job && te_rr->job != NULL) {
-								if (te_rr->job->queue == qi) {
-									cts = find_alloc_counts(que_counts->user, te_rr->user);
-									if (que_counts->user == NULL)
-										que_counts->user = cts;
-									update_counts_on_run(cts, te_rr->resreq);
-									que_counts_max->user =
-										counts_max(que_counts_max->user, cts);
-									if (que_counts_max->user == NULL) {
-										error = 1;
-										break;
-									}
-
-									cts = find_alloc_counts(que_counts->group, te_rr->group);
-									if (que_counts->group == NULL)
-										que_counts->group = cts;
-									update_counts_on_run(cts, te_rr->resreq);
-									que_counts_max->group =
-										counts_max(que_counts_max->group, cts);
-									if (que_counts_max->group == NULL) {
-										error = 1;
-										break;
-									}
-
-									cts = find_alloc_counts(que_counts->project, te_rr->project);
-									if (que_counts->project == NULL)
-										que_counts->project = cts;
-									update_counts_on_run(cts, te_rr->resreq);
-									que_counts_max->project =
-										counts_max(que_counts_max->project, cts);
-									if (que_counts_max->project == NULL) {
-										error = 1;
-										break;
-									}
-
-									update_counts_on_run(que_counts->all, te_rr->resreq);
-									que_counts_max->all =
-										counts_max(que_counts_max->all, que_counts->all);
-									if (que_counts_max->all == NULL) {
-										error = 1;
-										break;
-									}
-								}
-							}
-						}
 					}
-					else if (te->event_type == TIMED_END_EVENT) {
-						if (svr_counts != NULL) {
-							cts = find_alloc_counts(svr_counts->user, te_rr->user);
-							if (svr_counts->user == NULL)
-								svr_counts->user = cts;
+				}
+			}
+			else if (te->event_type == TIMED_END_EVENT) {
+				if (svr_counts != NULL) {
+					cts = find_alloc_counts(svr_counts->user, te_rr->user);
+					if (svr_counts->user == NULL)
+						svr_counts->user = cts;
+					update_counts_on_end(cts, te_rr->resreq);
+					cts = find_alloc_counts(svr_counts->group, te_rr->group);
+					if (svr_counts->group == NULL)
+						svr_counts->group = cts;
+					update_counts_on_end(cts, te_rr->resreq);
+					cts = find_alloc_counts(svr_counts->project, te_rr->project);
+					if (svr_counts->project == NULL)
+						svr_counts->project = cts;
+					update_counts_on_end(cts, te_rr->resreq);
+
+					update_counts_on_end(svr_counts->all, te_rr->resreq);
+				}
+				if (que_counts != NULL) {
+					if (te_rr->is_job && te_rr->job != NULL) {
+						if (te_rr->job->queue == qi) {
+							cts = find_alloc_counts(que_counts->user, te_rr->user);
+							if (que_counts->user == NULL)
+								que_counts->user = cts;
 							update_counts_on_end(cts, te_rr->resreq);
-							cts = find_alloc_counts(svr_counts->group, te_rr->group);
-							if (svr_counts->group == NULL)
-								svr_counts->group = cts;
+							cts = find_alloc_counts(que_counts->group, te_rr->group);
+							if (que_counts->group == NULL)
+								que_counts->group = cts;
 							update_counts_on_end(cts, te_rr->resreq);
-							cts = find_alloc_counts(svr_counts->project, te_rr->project);
-							if (svr_counts->project == NULL)
-								svr_counts->project = cts;
+							cts = find_alloc_counts(que_counts->project, te_rr->project);
+							if (que_counts->project == NULL)
+								que_counts->project = cts;
 							update_counts_on_end(cts, te_rr->resreq);
 
-							update_counts_on_end(svr_counts->all, te_rr->resreq);
-						}
-						if (que_counts != NULL) {
-							if (te_rr->is_job && te_rr->job != NULL) {
-								if (te_rr->job->queue == qi) {
-									cts = find_alloc_counts(que_counts->user, te_rr->user);
-									if (que_counts->user == NULL)
-										que_counts->user = cts;
-									update_counts_on_end(cts, te_rr->resreq);
-									cts = find_alloc_counts(que_counts->group, te_rr->group);
-									if (que_counts->group == NULL)
-										que_counts->group = cts;
-									update_counts_on_end(cts, te_rr->resreq);
-									cts = find_alloc_counts(que_counts->project, te_rr->project);
-									if (que_counts->project == NULL)
-										que_counts->project = cts;
-									update_counts_on_end(cts, te_rr->resreq);
-
-									update_counts_on_end(que_counts->all, te_rr->resreq);
-								}
-							}
+							update_counts_on_end(que_counts->all, te_rr->resreq);
 						}
 					}
 				}
 			}
-			free_limcounts(svr_counts);
-			free_limcounts(que_counts);
-			if (error) {
-				free_limcounts(svr_counts_max);
-				free_limcounts(que_counts_max);
+		}
+	}
+	free_limcounts(svr_counts);
+	free_limcounts(que_counts);
+	if (error) {
+		free_limcounts(svr_counts_max);
+		free_limcounts(que_counts_max);
+		return 0;
+	}
+
+	*svr_max = svr_counts_max;
+	*que_max = que_counts_max;
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		dup_entity_counts - duplicate the counts of one entity, grown by
+ *			the most its usage grows from the calendar's next event
+ *			up to end
+ *
+ * @param[in]	ctslist	-	counts list of the entity type
+ * @param[in]	name	-	entity name
+ * @param[in]	calendar -	calendar or NULL to take the counts as they are
+ * @param[in]	qname	-	queue of the counts or NULL for the server
+ * @param[in]	type	-	entity type
+ * @param[in]	end	-	end of the calendar window
+ * @param[out]	cts	-	the duplicated counts, NULL if the entity has none
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
+ */
+static int
+dup_entity_counts(counts *ctslist, char *name, event_list *calendar,
+	char *qname, enum usage_entity type, time_t end, counts **cts)
+{
+	counts *found;
+	counts *ncts;
+	resource_req *req;
+	schd_resource *res;
+	sch_resource_t *peak = NULL;
+	int grows = 0;
+	int i;
+
+	*cts = NULL;
+	if (name == NULL)
+		return 1;
+
+	if (calendar != NULL) {
+		for (i = 1, res = limres; res != NULL; res = res->next)
+			i++;
+		if ((peak = malloc(i * sizeof(sch_resource_t))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		if (!usage_profile_peak(calendar, qname, type, name, end, peak)) {
+			free(peak);
+			return 0;
+		}
+		while (--i >= 0)
+			if (peak[i] != 0)
+				grows = 1;
+	}
+
+	found = find_counts(ctslist, name);
+	if (found == NULL && !grows) {
+		free(peak);
+		return 1;
+	}
+
+	if (found != NULL)
+		ncts = dup_counts(found);
+	else if ((ncts = new_counts()) != NULL)
+		ncts->name = string_dup(name);
+	if (ncts == NULL || ncts->name == NULL) {
+		free_counts(ncts);
+		free(peak);
+		return 0;
+	}
+
+	if (grows) {
+		ncts->running += peak[0];
+		for (i = 1, res = limres; res != NULL; res = res->next, i++) {
+			if (peak[i] == 0)
+				continue;
+			if ((req = find_alloc_resource_req(ncts->rescts, res->def)) == NULL) {
+				free_counts(ncts);
+				free(peak);
 				return 0;
 			}
+			if (ncts->rescts == NULL)
+				ncts->rescts = req;
+			req->amount += peak[i];
 		}
+	}
+	free(peak);
+	*cts = ncts;
+
+	return 1;
+}
+
+/**
+ * @brief
+ *		make_resresv_limcounts - create a limcounts structure with only
+ *			the counts the limit functions read for rr: those of its
+ *			user, group and project, and the overall counts.  If a
+ *			calendar is passed in, each is the most it will be before
+ *			end from the calendar's usage profile.
+ *
+ * @param[in]	user	-	user counts
+ * @param[in]	group	-	group counts
+ * @param[in]	project -	project counts
+ * @param[in]	all	-	alljob counts
+ * @param[in]	rr	-	resource_resv the limits are checked for
+ * @param[in]	calendar -	calendar or NULL for the current counts
+ * @param[in]	qname	-	queue of the counts or NULL for the server
+ * @param[in]	end	-	end of the calendar window
+ *
+ * @return	pointer to newly-created limcounts structure
+ * @retval	NULL	: on error
+ */
+static limcounts *
+make_resresv_limcounts(counts *user, counts *group, counts *project, counts *all,
+	resource_resv *rr, event_list *calendar, char *qname, time_t end)
+{
+	limcounts *lc;
+
+	if ((lc = new_limcounts()) == NULL)
+		return NULL;
+
+	if (!dup_entity_counts(user, rr->user, calendar, qname, USAGE_USER, end, &lc->user) ||
+		!dup_entity_counts(group, rr->group, calendar, qname, USAGE_GROUP, end, &lc->group) ||
+		!dup_entity_counts(project, rr->project, calendar, qname, USAGE_PROJECT, end, &lc->project)) {
+		free_limcounts(lc);
+		return NULL;
+	}
+	/* no overall counts means no overall limits are checked */
+	if (all != NULL &&
+		!dup_entity_counts(all, "o:" PBS_ALL_ENTITY, calendar, qname, USAGE_ALL, end, &lc->all)) {
+		free_limcounts(lc);
+		return NULL;
+	}
+
+	return lc;
+}
+
+/**
+ * @brief
+ *		check_limits - hard limit checking function.
+ *		This is table-driven limit checking, against limfuncs[]
+ *		array.
+ *
+ * @param[in]	si	-	server_info structure to use for limit evaluation
+ * @param[in]	qi	-	queue_info structure to use for limit evaluation
+ * @param[in]	rr	-	resource_resv structure to use for limit evaluation
+ * @param[out]	err	-	sched_error structure to return error information
+ * @param[in]	flags	-	CHECK_LIMITS - check real limits
+ *                      CHECK_CUMULATIVE_LIMIT - check limits against total counts
+ *                      RETURN_ALL_ERR - check all limits and return an err for all failed limits *
+ *
+ * @return	integer indicating failing limit test if limit is exceeded,
+ *				along with error 'err'.
+ * @retval	0	: if limit is not exceeded.
+ */
+
+int
+check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err, unsigned int flags)
+{
+	int	rc;
+	int	any_fail_rc = 0;
+	int	i;
+	limcounts *svr_counts_max = NULL;
+	limcounts *que_counts_max = NULL;
+	limcounts *server_lim = NULL;
+	limcounts *queue_lim = NULL;
+	long time_left;
+	long end;
+	schd_error *prev_err = NULL;
+
+	if (si == NULL || qi == NULL || rr == NULL)
+		return 0;
+
+	/*
+	 * Check for  CHECK_CUMULATIVE_LIMIT is needed because we  must have
+	 * already run through the same loop before while calling check_limits
+	 * from is_ok_to_run.
+	 * We do not need to run into the same loop again.
+	 */
+	if (si->calendar != NULL && !(flags & CHECK_CUMULATIVE_LIMIT)) {
+		if (rr->duration != rr->hard_duration &&
+		   exists_resv_event(si->calendar, si->server_time + rr->hard_duration))
+			time_left = calc_time_left(rr, 1);
+		else
+			time_left = calc_time_left(rr, 0);
+		end = si->server_time + time_left;
+		if (exists_run_event(si->calendar, end)) {
+			/* rr's own events are not counted, but the usage profile has them */
+			if (find_calendar_event(si->calendar, rr->name, TIMED_NOEVENT, 0) != NULL) {
+				if (!replay_limcounts_max(si, qi, rr, end, &svr_counts_max, &que_counts_max))
+					return 0;
+			} else {
+				if (si->has_hard_limit) {
+					svr_counts_max = make_resresv_limcounts(si->user_counts,
+						si->group_counts,
+						si->project_counts,
+						si->alljobcounts,
+						rr, si->calendar, NULL, end);
+					if (svr_counts_max == NULL)
+						return 0;
+				}
 
+				if (qi->has_hard_limit) {
+					que_counts_max = make_resresv_limcounts(qi->user_counts,
+						qi->group_counts,
+						qi->project_counts,
+						qi->alljobcounts,
+						rr, si->calendar, qi->name, end);
+					if (que_counts_max == NULL) {
+						free_limcounts(svr_counts_max);
+						return 0;
+					}
+				}
+			}
+		}
 	}
 	if ((flags & CHECK_LIMIT)) {
 		if (svr_counts_max != NULL) {
 			server_lim = svr_counts_max;
 		}
 		else {
-			server_lim = make_limcounts(si->user_counts,
+			server_lim = make_resresv_limcounts(si->user_counts,
 				si->group_counts,
 				si->project_counts,
-				si->alljobcounts);
+				si->alljobcounts,
+				rr, NULL, NULL, 0);
 			if (server_lim == NULL)
 				return 0;
 		}
@@ -1080,10 +1278,11 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 			queue_lim = que_counts_max;
 		}
 		else {
-			queue_lim = make_limcounts(qi->user_counts,
+			queue_lim = make_resresv_limcounts(qi->user_counts,
 				qi->group_counts,
 				qi->project_counts,
-				qi->alljobcounts);
+				qi->alljobcounts,
+				rr, NULL, NULL, 0);
 			if (queue_lim == NULL) {
 				free_limcounts(server_lim);
 				return 0;
@@ -1093,16 +1292,18 @@ check_limits(server_info *si, queue_info *qi, resource_resv *rr, schd_error *err
 	else if ((flags & CHECK_CUMULATIVE_LIMIT)) {
 		if (!si->has_hard_limit && !qi->has_hard_limit)
 			return 0;
-		server_lim = make_limcounts(si->total_user_counts,
+		server_lim = make_resresv_limcounts(si->total_user_counts,
 			si->total_group_counts,
 			si->total_project_counts,
-			si->total_alljobcounts);
+			si->total_alljobcounts,
+			rr, NULL, NULL, 0);
 		if (server_lim == NULL)
 			return 0;
-		queue_lim = make_limcounts(qi->total_user_counts,
+		queue_lim = make_resresv_limcounts(qi->total_user_counts,
 			qi->total_group_counts,
 			qi->total_project_counts,
-			qi->total_alljobcounts);
+			qi->total_alljobcounts,
+			rr, NULL, NULL, 0);
 		if (queue_lim == NULL) {
 			free_limcounts(server_lim);
 			return 0;
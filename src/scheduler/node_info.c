@@ -54,6 +54,7 @@
  * 	add_node_state()
  * 	talk_with_mom()
  * 	node_filter()
+ * 	create_node_name_index()
  * 	find_node_info()
  * 	find_node_by_host()
  * 	dup_nodes()
@@ -73,14 +74,25 @@
  * 	free_nspecs()
  * 	find_nspec()
  * 	find_nspec_by_rank()
+ * 	get_placement_memo()
+ * 	apply_placement_memo()
+ * 	record_placement_memo()
+ * 	placement_memo_has_nodepart()
+ * 	add_placement_memo_nodepart()
  * 	eval_selspec()
  * 	eval_placement()
  * 	eval_complex_selspec()
+ * 	precheck_nodes_slice()
+ * 	precheck_nodes()
+ * 	start_precheck()
+ * 	end_precheck()
  * 	eval_simple_selspec()
  * 	is_vnode_eligible()
  * 	is_vnode_eligible_chunk()
  * 	resources_avail_on_vnode()
+ * 	log_no_nspec_event()
  * 	check_resources_for_node()
+ * 	count_node_chunks()
  * 	parse_placespec()
  * 	parse_selspec()
  * 	create_execvnode()
@@ -149,6 +161,8 @@
 #include "server_info.h"
 #include "pbs_share.h"
 #include "pbs_bitmap.h"
+#include "thread_pool.h"
+#include "snapshot.h"
 #ifdef NAS
 #include "site_code.h"
 #endif
@@ -181,7 +195,7 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	int nidx;
 
 	/* get nodes from PBS server */
-	if ((nodes = pbs_statvnode(pbs_sd, NULL, NULL, NULL)) == NULL) {
+	if ((nodes = snapshot_stat(pbs_sd, SNAP_NODES)) == NULL) {
 		err = pbs_geterrmsg(pbs_sd);
 		sprintf(errbuf, "Error getting nodes: %s", err);
 		schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_NODE, LOG_INFO, "", errbuf);
@@ -252,6 +266,8 @@ query_nodes(int pbs_sd, server_info *sinfo)
 	site_vnode_inherit(ninfo_arr);
 #endif /* localmod 062 */
 	resolve_indirect_resources(ninfo_arr);
+	for (i = 0; ninfo_arr[i] != NULL; i++)
+		index_resource_list(ninfo_arr[i]->res);
 	sinfo->num_nodes = nidx;
 	pbs_statfree(nodes);
 	return ninfo_arr;
@@ -877,7 +893,8 @@ talk_with_mom(node_info *ninfo)
 	char errbuf[MAX_LOG_SIZE];
 	int i;
 
-	if (!should_talk_with_mom(ninfo))
+	/* a replayed snapshot has no moms to talk to */
+	if (snapshot_replaying() || !should_talk_with_mom(ninfo))
 		return 0;
 
 	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_NODE, LOG_DEBUG, ninfo->name,
@@ -1028,10 +1045,49 @@ node_filter(node_info **nodes, int size,
 	return new_nodes;
 }
 
+/**
+ * @brief
+ *		create_node_name_index - index a server's nodes by name
+ *
+ * @param[in]	ninfo_arr	-	the server's nodes
+ *
+ * @return	the index
+ * @retval	NULL	: on error
+ *
+ */
+AVL_IX_DESC *
+create_node_name_index(node_info **ninfo_arr)
+{
+	AVL_IX_DESC *idx;
+	int i;
+
+	if (ninfo_arr == NULL)
+		return NULL;
+
+	if ((idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	for (i = 0; ninfo_arr[i] != NULL; i++) {
+		if (tree_add_del(idx, ninfo_arr[i]->name, ninfo_arr[i], TREE_OP_ADD) != 0) {
+			avl_destroy_index(idx);
+			free(idx);
+			return NULL;
+		}
+	}
+
+	return idx;
+}
+
 /**
  * @brief
  *		find_node_info - find a node in a node array
  *
+ * @par	The server's full node arrays (nodes and unordered_nodes) are
+ *		looked up through the server's node name index.  Any other array
+ *		is searched linearly.
+ *
  * @param[in]	nodename	-	the node to find
  * @param[in]	ninfo_arr	-	the array of nodes to look in
  *
@@ -1043,10 +1099,16 @@ node_info *
 find_node_info(node_info **ninfo_arr, char *nodename)
 {
 	int i;
+	server_info *sinfo;
 
 	if (nodename == NULL || ninfo_arr == NULL)
 		return NULL;
 
+	if (ninfo_arr[0] != NULL && (sinfo = ninfo_arr[0]->server) != NULL &&
+		sinfo->node_idx != NULL &&
+		(ninfo_arr == sinfo->nodes || ninfo_arr == sinfo->unordered_nodes))
+		return find_tree(sinfo->node_idx, nodename);
+
 	for (i = 0; ninfo_arr[i] != NULL &&
 		strcmp(nodename, ninfo_arr[i]->name) ; i++)
 		;
@@ -2141,6 +2203,179 @@ find_nspec_by_rank(nspec **nspec_arr, unsigned int rank)
 	return nspec_arr[i];
 }
 
+/**
+ * @brief
+ *		get the placement memo of the equivalence class of a job.  The memo
+ *		is the resume position left by the last job of the class that was
+ *		placed: the nodes and node partitions the job was searched past
+ *		because they were full.  Identical jobs start their search after
+ *		them.  A job which is not placed ends the class for the cycle, so
+ *		only successful placements are remembered.  It is only used
+ *		where the equivalence class is: not ignored by the caller, for
+ *		single chunk jobs on single vnode hosts (a failed vnode can not hold
+ *		the whole chunk), and for jobs which search the normal node pools.
+ *		The memo is reset whenever resources have been released since it
+ *		was made.
+ *
+ * @param[in]	resresv	-	the job
+ * @param[in]	spec	-	the select spec being evaluated
+ * @param[in]	flags	-	flags passed to eval_selspec()
+ *
+ * @return	resresv_set *
+ * @retval	the job's equivalence class
+ * @retval	NULL	: if the memo can not be used
+ */
+static resresv_set *
+get_placement_memo(resource_resv *resresv, selspec *spec, unsigned int flags)
+{
+	server_info *sinfo;
+	resresv_set *rset;
+
+	if (resresv == NULL || spec == NULL || !resresv->is_job || resresv->job == NULL)
+		return NULL;
+
+	sinfo = resresv->server;
+	if (sinfo == NULL || sinfo->equiv_classes == NULL ||
+		resresv->ec_index == UNSPECIFIED)
+		return NULL;
+
+	if (flags & (IGNORE_EQUIV_CLASS | RETURN_ALL_ERR))
+		return NULL;
+
+	if (spec->total_chunks != 1 || sinfo->has_multi_vnode)
+		return NULL;
+
+	if (resresv->job->resv != NULL || resresv->ninfo_arr != NULL ||
+		resresv->node_set_str != NULL)
+		return NULL;
+
+	rset = sinfo->equiv_classes[resresv->ec_index];
+	if (rset->memo_gen != sinfo->release_gen) {
+		pbs_bitmap_free(rset->memo_nofit);
+		rset->memo_nofit = NULL;
+		rset->memo_np_ct = 0;
+		rset->memo_gen = sinfo->release_gen;
+	}
+
+	return rset;
+}
+
+/**
+ * @brief
+ *		mark the nodes an equivalence class did not fit on as visited so
+ *		the node search skips them
+ *
+ * @param[in]	rset	-	equivalence class
+ * @param[in]	ninfo_arr	-	nodes being searched
+ *
+ * @return	int
+ * @retval	number of nodes skipped
+ */
+static int
+apply_placement_memo(resresv_set *rset, node_info **ninfo_arr)
+{
+	int i;
+	int ct = 0;
+
+	if (rset == NULL || rset->memo_nofit == NULL || ninfo_arr == NULL)
+		return 0;
+
+	for (i = 0; ninfo_arr[i] != NULL; i++) {
+		if (ninfo_arr[i]->node_ind >= 0 &&
+			pbs_bitmap_get_bit(rset->memo_nofit, ninfo_arr[i]->node_ind)) {
+			ninfo_arr[i]->nscr.visited = 1;
+			ct++;
+		}
+	}
+
+	return ct;
+}
+
+/**
+ * @brief
+ *		remember where the next identical job resumes its node search.
+ *		Called after a job was placed: the nodes the search marked visited
+ *		could not hold the chunk, and they only fill up further until
+ *		resources are released.
+ *
+ * @param[in,out]	rset	-	equivalence class of the job
+ * @param[in]	ninfo_arr	-	nodes which were searched
+ *
+ * @return	nothing
+ */
+static void
+record_placement_memo(resresv_set *rset, node_info **ninfo_arr)
+{
+	int i;
+
+	if (rset == NULL || ninfo_arr == NULL)
+		return;
+
+	for (i = 0; ninfo_arr[i] != NULL; i++) {
+		if (!ninfo_arr[i]->nscr.visited || ninfo_arr[i]->node_ind < 0)
+			continue;
+
+		if (rset->memo_nofit == NULL) {
+			rset->memo_nofit = pbs_bitmap_alloc(NULL, ninfo_arr[i]->node_ind + 1);
+			if (rset->memo_nofit == NULL)
+				return;
+		}
+		pbs_bitmap_bit_on(rset->memo_nofit, ninfo_arr[i]->node_ind);
+	}
+}
+
+/**
+ * @brief
+ *		check if an equivalence class is known not to fit in a node partition
+ *
+ * @param[in]	rset	-	equivalence class
+ * @param[in]	rank	-	rank of the node partition
+ *
+ * @return	int
+ * @retval	1	: the class did not fit in the node partition
+ * @retval	0	: unknown
+ */
+static int
+placement_memo_has_nodepart(resresv_set *rset, int rank)
+{
+	int i;
+
+	if (rset == NULL)
+		return 0;
+
+	for (i = 0; i < rset->memo_np_ct; i++)
+		if (rset->memo_np_nofit[i] == rank)
+			return 1;
+
+	return 0;
+}
+
+/**
+ * @brief
+ *		remember that an equivalence class did not fit in a node partition
+ *
+ * @param[in,out]	rset	-	equivalence class
+ * @param[in]	rank	-	rank of the node partition
+ *
+ * @return	nothing
+ */
+static void
+add_placement_memo_nodepart(resresv_set *rset, int rank)
+{
+	int *tmp_arr;
+
+	if (rset == NULL || placement_memo_has_nodepart(rset, rank))
+		return;
+
+	tmp_arr = realloc(rset->memo_np_nofit, (rset->memo_np_ct + 1) * sizeof(int));
+	if (tmp_arr == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return;
+	}
+	tmp_arr[rset->memo_np_ct++] = rank;
+	rset->memo_np_nofit = tmp_arr;
+}
+
 /**
  *	@brief
  *		eval a select spec to see if it is satisfiable
@@ -2177,9 +2412,16 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 	char				reason[MAX_LOG_SIZE] = {0};
 	int				i = 0;
 	static struct schd_error	*failerr = NULL;
+	resresv_set			*memo;
+	int				memo_np_ct = 0;
 
 	if (spec == NULL || ninfo_arr == NULL || resresv == NULL || placespec == NULL || nspec_arr == NULL)
 		return 0;
+
+	memo = get_placement_memo(resresv, spec, flags);
+	if (memo != NULL)
+		memo_np_ct = memo->memo_np_ct;
+
 	/* Unsetting RETURN_ALL_ERR flag, because with this flag set resresv_can_fit_nodepart can return
 	 * with multiple errors and the function only needs to see the first error it encounters.
 	 */
@@ -2224,6 +2466,18 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 		move_schd_error(failerr, err);
 	clear_schd_error(err);
 
+	if (memo != NULL) {
+		int skipped;
+
+		skipped = apply_placement_memo(memo, ninfo_arr);
+		if (skipped > 0) {
+			snprintf(logbuf, MAX_LOG_SIZE,
+				"Skipping %d nodes an identical job did not fit on", skipped);
+			schdlog(PBSEVENT_DEBUG3, PBS_EVENTCLASS_JOB, LOG_DEBUG,
+				resresv->name, logbuf);
+		}
+	}
+
 	/* If we are not node grouping or we only have 1 chunk packed onto a single
 	 * host, then we should try and satisfy over all nodes in the list
 	 *
@@ -2239,6 +2493,9 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 			free_nspecs(*nspec_arr);
 			*nspec_arr = NULL;
 		}
+		/* the job was placed, the next identical job resumes past the full nodes */
+		if (rc > 0 && memo != NULL)
+			record_placement_memo(memo, ninfo_arr);
 		if (pass_flags & EVAL_EXCLSET)
 			alloc_rest_nodepart(*nspec_arr, ninfo_arr);
 
@@ -2252,6 +2509,16 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 
 	for (i = 0; nodepart[i] != NULL && rc == 0; i++) {
 		clear_schd_error(err);
+		if (placement_memo_has_nodepart(memo, nodepart[i]->rank)) {
+			/* An identical job fit in the placement set's free resources, but
+			 * no node solution was found.  It fits in the total resources.
+			 */
+			can_fit = 1;
+			set_schd_error_codes(err, NOT_RUN, NO_NODE_RESOURCES);
+			if (failerr->status_code == SCHD_UNKWN)
+				move_schd_error(failerr, err);
+			continue;
+		}
 		if (resresv_can_fit_nodepart(policy, nodepart[i], resresv, flags, err)) {
 			snprintf(logbuf, MAX_LOG_SIZE, "Evaluating placement set: %s",
 				nodepart[i]->name);
@@ -2277,6 +2544,7 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 				empty_nspec_array(*nspec_arr);
 				if (failerr->status_code == SCHD_UNKWN)
 					move_schd_error(failerr, err);
+				add_placement_memo_nodepart(memo, nodepart[i]->rank);
 			}
 		}
 		else {
@@ -2325,6 +2593,17 @@ eval_selspec(status *policy, selspec *spec, place *placespec,
 		*nspec_arr = NULL;
 	}
 
+	if (memo != NULL) {
+		/* Only a placed job leaves a resume position: the full nodes and the
+		 * placement sets it was searched past.  A job which was not placed
+		 * ends its class for the cycle.
+		 */
+		if (rc > 0)
+			record_placement_memo(memo, ninfo_arr);
+		else
+			memo->memo_np_ct = memo_np_ct;
+	}
+
 	if (err->status_code == SCHD_UNKWN && failerr->status_code != SCHD_UNKWN)
 		move_schd_error(err, failerr);
 
@@ -2942,6 +3221,226 @@ eval_complex_selspec(status *policy, selspec *spec, node_info **ninfo_arr, place
 	return eval_complex_selspec(policy, spec, ninfo_arr, pl, resresv, flags, nspec_arr, err);
 }
 
+/*
+ * Results of check_resources_for_node() for a window of nodes, computed by
+ * the node evaluation threads ahead of the serial node walk in
+ * eval_simple_selspec().  The walk itself is unchanged: when it reaches a
+ * node, check_resources_for_node() returns the saved result instead of
+ * redoing the work.
+ */
+static struct {
+	resource_req *specreq_noncons;	/* non-consumable resources of the chunk */
+	resource_req *specreq_cons;	/* consumable resources of the chunk */
+	resource_resv *resresv;		/* the job/resv being placed */
+	node_info **ninfo_arr;		/* the nodes being walked */
+	int num_nodes;			/* number of nodes in ninfo_arr */
+	int size;			/* allocated size of the arrays below */
+	long long *chunks;		/* chunks which fit on each node */
+	char *valid;			/* 1 if chunks[i]/errs[i] were computed */
+	schd_error **errs;		/* error left by each node's check */
+	timed_event **no_nspec;		/* run/end event w/o nspec array found by
+					 * each node's check, logged by the walk */
+	resource_req *req;		/* request results are for (NULL if none) */
+	int lo;				/* first node of the computed window */
+	int hi;				/* one past the last node of the window */
+	int window;			/* size of the next window */
+	int cur;			/* node the serial walk is on */
+} precheck;
+
+static long long count_node_chunks(resource_req *resreq, node_info *ninfo,
+	resource_resv *resresv, schd_error *err, timed_event **no_nspec);
+
+/**
+ * @brief
+ * 		check a slice of the current precheck window.  Run from the
+ *		node evaluation threads, so only read-only checks are done.
+ *
+ * @param[in]	arg	-	unused
+ * @param[in]	start	-	start of the slice (relative to precheck.lo)
+ * @param[in]	end	-	end of the slice (relative to precheck.lo)
+ *
+ * @return	void
+ */
+static void
+precheck_nodes_slice(void *arg, int start, int end)
+{
+	schd_error *err;
+	node_info *node;
+	int i;
+	int k;
+
+	err = new_schd_error();
+
+	for (i = start; i < end; i++) {
+		k = precheck.lo + i;
+		node = precheck.ninfo_arr[k];
+		precheck.valid[k] = 0;
+		precheck.no_nspec[k] = NULL;
+
+		if (err == NULL || node->nscr.visited || node->nscr.scattered ||
+			node->nscr.ineligible)
+			continue;
+
+		clear_schd_error(err);
+		if (!is_vnode_eligible_chunk(precheck.specreq_noncons, node,
+			precheck.resresv, err))
+			continue;
+
+		/* the threads must not log, the walk logs what is left in no_nspec */
+		precheck.chunks[k] = count_node_chunks(precheck.specreq_cons,
+			node, precheck.resresv, err, &precheck.no_nspec[k]);
+
+		if (err->status_code != SCHD_UNKWN) {
+			if (precheck.errs[k] == NULL)
+				precheck.errs[k] = new_schd_error();
+			else
+				clear_schd_error(precheck.errs[k]);
+
+			if (precheck.errs[k] == NULL)
+				continue;
+			copy_schd_error(precheck.errs[k], err);
+		}
+		else if (precheck.errs[k] != NULL)
+			clear_schd_error(precheck.errs[k]);
+
+		precheck.valid[k] = 1;
+	}
+
+	free_schd_error(err);
+}
+
+/**
+ * @brief
+ * 		compute the next precheck window starting at node lo
+ *
+ * @param[in]	lo	-	index of the first node of the window
+ *
+ * @return	void
+ */
+static void
+precheck_nodes(int lo)
+{
+	int n;
+
+	n = precheck.num_nodes - lo;
+	if (n > precheck.window)
+		n = precheck.window;
+
+	/* no saved results can be used while the window is being computed */
+	precheck.req = NULL;
+	precheck.lo = lo;
+	run_in_thread_pool(precheck_nodes_slice, NULL, n);
+	precheck.hi = lo + n;
+	precheck.req = precheck.specreq_cons;
+
+	/* the further the walk gets, the more likely it will keep going */
+	if (precheck.window < precheck.num_nodes)
+		precheck.window *= 2;
+}
+
+/**
+ * @brief
+ * 		set up parallel prechecking of nodes for a chunk
+ *
+ * @param[in]	ninfo_arr	-	the nodes to walk
+ * @param[in]	specreq_noncons	-	non-consumable resources of the chunk
+ * @param[in]	specreq_cons	-	consumable resources of the chunk
+ * @param[in]	resresv	-	the job/resv being placed
+ *
+ * @return	int
+ * @retval	1	: prechecking is set up
+ * @retval	0	: not worth it or error - walk the nodes serially
+ */
+static int
+start_precheck(node_info **ninfo_arr, resource_req *specreq_noncons,
+	resource_req *specreq_cons, resource_resv *resresv)
+{
+	int num_nodes;
+	int window;
+	long long *chunks;
+	char *valid;
+	schd_error **errs;
+	timed_event **no_nspec;
+	int i;
+
+	window = thread_pool_size() * NODE_EVAL_CHUNK;
+	num_nodes = count_array((void **) ninfo_arr);
+	if (num_nodes <= window)
+		return 0;
+
+	if (num_nodes > precheck.size) {
+		chunks = realloc(precheck.chunks, num_nodes * sizeof(long long));
+		if (chunks == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		precheck.chunks = chunks;
+
+		valid = realloc(precheck.valid, num_nodes * sizeof(char));
+		if (valid == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		precheck.valid = valid;
+
+		errs = realloc(precheck.errs, num_nodes * sizeof(schd_error *));
+		if (errs == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		for (i = precheck.size; i < num_nodes; i++)
+			errs[i] = NULL;
+		precheck.errs = errs;
+
+		no_nspec = realloc(precheck.no_nspec, num_nodes * sizeof(timed_event *));
+		if (no_nspec == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		precheck.no_nspec = no_nspec;
+		precheck.size = num_nodes;
+	}
+
+	/* these are created on first use; create them before the threads can */
+	if (false_res() == NULL || zero_res() == NULL || unset_str_res() == NULL)
+		return 0;
+	/* likewise the calendar's cached run event */
+	exists_run_event(ninfo_arr[0]->server->calendar, 0);
+
+	precheck.specreq_noncons = specreq_noncons;
+	precheck.specreq_cons = specreq_cons;
+	precheck.resresv = resresv;
+	precheck.ninfo_arr = ninfo_arr;
+	precheck.num_nodes = num_nodes;
+	precheck.window = window;
+	precheck.lo = 0;
+	precheck.hi = 0;
+	precheck.cur = -1;
+	precheck.req = NULL;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		stop using prechecked node results
+ *
+ * @return	void
+ */
+static void
+end_precheck(void)
+{
+	precheck.req = NULL;
+	precheck.specreq_noncons = NULL;
+	precheck.specreq_cons = NULL;
+	precheck.resresv = NULL;
+	precheck.ninfo_arr = NULL;
+	precheck.num_nodes = 0;
+	precheck.lo = 0;
+	precheck.hi = 0;
+	precheck.cur = -1;
+}
+
 /**
  * @brief
  * 		eval a non-plused select spec for satisfiability
@@ -2978,6 +3477,7 @@ eval_simple_selspec(status *policy, chunk *chk, node_info **pninfo_arr,
 	resource_req	*tmpreq = NULL;		/* used to unlink and free */
 	char		logbuf[MAX_LOG_SIZE];
 	int		need_new_nspec = 1;	/* need to allocate a new nspec for node solution */
+	int		use_precheck = 0;	/* nodes are prechecked in parallel */
 
 	int		allocated = 0;		/* did we allocate resources to a vnode */
 	int		nspecs_allocated = 0;	/* number of nodes allocated */
@@ -3091,11 +3591,25 @@ eval_simple_selspec(status *policy, chunk *chk, node_info **pninfo_arr,
 	cur_flt_lic = flt_lic;
 	nsa = *nspec_arr;
 
+	/* When the whole chunk goes onto one vnode, the nodes are not modified
+	 * while they are walked, so the expensive per-node resource check can be
+	 * done ahead of time in parallel.  The walk below stays serial so the
+	 * nodes are still considered in order.
+	 */
+	if (!(flags & EVAL_OKBREAK) && specreq_cons != NULL && thread_pool_size() > 1)
+		use_precheck = start_precheck(ninfo_arr, specreq_noncons, specreq_cons, resresv);
+
 	for (i = 0, j = 0; ninfo_arr[i] != NULL && chunks_found == 0; i++) {
 		if (ninfo_arr[i]->nscr.visited || ninfo_arr[i]->nscr.scattered  ||
 			ninfo_arr[i]->nscr.ineligible)
 			continue;
 
+		if (use_precheck) {
+			if (i >= precheck.hi)
+				precheck_nodes(i);
+			precheck.cur = i;
+		}
+
 		allocated = 0;
 		licenses_allocated = 0;
 		clear_schd_error(err);
@@ -3104,6 +3618,8 @@ eval_simple_selspec(status *policy, chunk *chk, node_info **pninfo_arr,
 				need_new_nspec = 0;
 				nsa[j] = new_nspec();
 				if (nsa[j] == NULL) {
+					if (use_precheck)
+						end_precheck();
 					if (specreq_cons != NULL)
 						free_resource_req_list(specreq_cons);
 					if (specreq_noncons != NULL)
@@ -3242,6 +3758,9 @@ eval_simple_selspec(status *policy, chunk *chk, node_info **pninfo_arr,
 
 	nsa[j] = NULL;
 
+	if (use_precheck)
+		end_precheck();
+
 	if (specreq_cons != NULL)
 		free_resource_req_list(specreq_cons);
 	if (specreq_noncons != NULL)
@@ -3730,6 +4249,28 @@ resources_avail_on_vnode(resource_req *specreq_cons, node_info *node,
 	return 0;
 }
 
+/**
+ * @brief
+ * 		log a timed run/end event which has no nspec array, so it is
+ *		ignored when checking nodes for a job
+ *
+ * @param[in]	resresv	-	the resource resv being checked
+ * @param[in]	event	-	the event
+ *
+ * @return	void
+ */
+static void
+log_no_nspec_event(resource_resv *resresv, timed_event *event)
+{
+	char logbuf[MAX_LOG_SIZE];
+
+	snprintf(logbuf, MAX_LOG_SIZE,
+		"Event %s is a run/end event w/o nspec array, ignoring event",
+		event->name);
+	schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING,
+		resresv->name, logbuf);
+}
+
 /**
  * @brief
  * 		check to see how many chunks can fit on a
@@ -3753,6 +4294,46 @@ resources_avail_on_vnode(resource_req *specreq_cons, node_info *node,
 long long
 check_resources_for_node(resource_req *resreq, node_info *ninfo,
 	resource_resv *resresv, schd_error *err)
+{
+	if (resreq == NULL || ninfo == NULL || err == NULL || resresv == NULL)
+		return -1;
+
+	/* already checked by the node evaluation threads */
+	if (precheck.req != NULL && precheck.req == resreq &&
+		precheck.cur >= precheck.lo && precheck.cur < precheck.hi &&
+		precheck.ninfo_arr[precheck.cur] == ninfo &&
+		precheck.valid[precheck.cur]) {
+		if (precheck.no_nspec[precheck.cur] != NULL)
+			log_no_nspec_event(resresv, precheck.no_nspec[precheck.cur]);
+		if (precheck.errs[precheck.cur] != NULL &&
+			precheck.errs[precheck.cur]->status_code != SCHD_UNKWN)
+			copy_schd_error(err, precheck.errs[precheck.cur]);
+		return precheck.chunks[precheck.cur];
+	}
+
+	return count_node_chunks(resreq, ninfo, resresv, err, NULL);
+}
+
+/**
+ * @brief
+ * 		the work of check_resources_for_node().  Also run from the node
+ *		evaluation threads, which must not log: a run/end event without
+ *		an nspec array is then left in no_nspec for the serial walk to log.
+ *
+ * @param[in]	resreq	-	requested resources
+ * @param[in]	node    -	node to check for
+ * @param[in]	resresv -	the resource resv to check for
+ * @param[out]	err    -	schd_error reply if there aren't enough resources
+ * @param[out]	no_nspec	-	if not NULL, set to the first run/end event
+ *				without an nspec array instead of logging it
+ *
+ * @retval
+ * 		number of chunks which can be satisifed during the duration
+ * @retval	-1	: on error
+ */
+static long long
+count_node_chunks(resource_req *resreq, node_info *ninfo,
+	resource_resv *resresv, schd_error *err, timed_event **no_nspec)
 {
 	/* the minimum number of chunks which can be satisified for the duration
 	 * of the request
@@ -3778,7 +4359,6 @@ check_resources_for_node(resource_req *resreq, node_info *ninfo,
 	timed_event *event;
 	unsigned int event_mask;
 	int i;
-	char logbuf[MAX_LOG_SIZE];
 
 	if (resreq == NULL || ninfo == NULL || err == NULL || resresv == NULL)
 		return -1;
@@ -3865,11 +4445,10 @@ check_resources_for_node(resource_req *resreq, node_info *ninfo,
 				}
 				else {
 					ns = NULL;
-					snprintf(logbuf, MAX_LOG_SIZE,
-						"Event %s is a run/end event w/o nspec array, ignoring event",
-						event->name);
-					schdlog(PBSEVENT_SCHED, PBS_EVENTCLASS_SCHED, LOG_WARNING,
-						resresv->name, logbuf);
+					if (no_nspec == NULL)
+						log_no_nspec_event(resresv, event);
+					else if (*no_nspec == NULL)
+						*no_nspec = event;
 				}
 
 				is_run_event = (event->event_type == TIMED_RUN_EVENT);
@@ -5346,6 +5925,7 @@ node_up_event(node_info *node, void *arg)
 		set_node_info_state(node, ND_free);
 
 	sinfo = node->server;
+	sinfo->release_gen++;
 	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
 		node_info *arr[2];
 		arr[0] = node;
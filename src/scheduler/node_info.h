@@ -109,6 +109,11 @@ node_filter(node_info **nodes, int size,
  */
 int is_node_timeshared(node_info *node, void *arg);
 
+/*
+ *      create_node_name_index - index a server's nodes by name
+ */
+AVL_IX_DESC *create_node_name_index(node_info **ninfo_arr);
+
 /*
  *      find_node_info - find a node in the node array
  */
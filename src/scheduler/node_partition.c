@@ -51,6 +51,10 @@
  * 	find_node_partition()
  * 	find_node_partition_by_rank()
  * 	create_node_partitions()
+ * 	create_node_map()
+ * 	create_persistent_node_partitions()
+ * 	purge_persistent_node_partitions()
+ * 	nodepart_has_nodes()
  * 	node_partition_update_array()
  * 	node_partition_update()
  * 	new_np_cache()
@@ -118,6 +122,7 @@ new_node_partition()
 	np->res = NULL;
 	np->ninfo_arr = NULL;
 	np->bkts = NULL;
+	np->node_map = NULL;
 
 	np->rank = -1;
 
@@ -177,6 +182,9 @@ free_node_partition(node_partition *np)
 	if (np->bkts != NULL)
 		free_node_bucket_array(np->bkts);
 
+	if (np->node_map != NULL)
+		pbs_bitmap_free(np->node_map);
+
 	free(np);
 }
 
@@ -268,6 +276,15 @@ dup_node_partition(node_partition *onp, server_info *nsinfo)
 	nnp->bkts = dup_node_bucket_array(onp->bkts, nsinfo);
 	nnp->rank = onp->rank;
 
+	if (onp->node_map != NULL) {
+		nnp->node_map = pbs_bitmap_alloc(NULL, onp->node_map->num_bits);
+		if (nnp->node_map == NULL ||
+			!pbs_bitmap_assign(nnp->node_map, onp->node_map)) {
+			free_node_partition(nnp);
+			return NULL;
+		}
+	}
+
 	/* validity check */
 	if (onp->name == NULL || onp->res_val == NULL ||
 		nnp->res == NULL || nnp->ninfo_arr == NULL) {
@@ -550,6 +567,7 @@ create_node_partitions(status *policy, node_info **nodes, char **resnames, unsig
 		 */
 		np_arr[np_i]->tot_nodes = count_array((void **) np_arr[np_i]->ninfo_arr);
 		np_arr[np_i]->bkts = create_node_buckets(policy, np_arr[np_i]->ninfo_arr, NULL, 0);
+		create_node_map(np_arr[np_i]);
 		node_partition_update(policy, np_arr[np_i]);
 	}
 
@@ -557,6 +575,577 @@ create_node_partitions(status *policy, node_info **nodes, char **resnames, unsig
 	return np_arr;
 }
 
+/**
+ * @brief
+ * 		create the bitmap of the nodes in a node partition.  The bitmap
+ *		is indexed by node_ind.  If any node does not have a node_ind,
+ *		no bitmap is created and the partition is treated as containing
+ *		every node.
+ *
+ * @param[in,out]	np	-	node partition
+ *
+ * @return	int
+ * @retval	1	: bitmap created
+ * @retval	0	: no bitmap created
+ */
+int
+create_node_map(node_partition *np)
+{
+	int i;
+
+	if (np == NULL || np->ninfo_arr == NULL)
+		return 0;
+
+	if (np->node_map != NULL) {
+		pbs_bitmap_free(np->node_map);
+		np->node_map = NULL;
+	}
+
+	for (i = 0; np->ninfo_arr[i] != NULL; i++)
+		if (np->ninfo_arr[i]->node_ind < 0)
+			return 0;
+
+	np->node_map = pbs_bitmap_alloc(NULL, i > 0 ? i : 1);
+	if (np->node_map == NULL)
+		return 0;
+
+	for (i = 0; np->ninfo_arr[i] != NULL; i++) {
+		if (!pbs_bitmap_bit_on(np->node_map, np->ninfo_arr[i]->node_ind)) {
+			pbs_bitmap_free(np->node_map);
+			np->node_map = NULL;
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/* Node partition layouts kept across cycles.  Entries not used in the
+ * current cycle are freed by purge_persistent_node_partitions()
+ */
+static np_persist **np_persist_arr = NULL;
+static int np_persist_generation = 0;
+
+/**
+ * @brief
+ * 		free the per node data and layouts of a np_persist
+ *
+ * @param[in,out]	npp	-	np_persist to clear
+ */
+static void
+clear_np_persist(np_persist *npp)
+{
+	int i;
+
+	if (npp == NULL)
+		return;
+
+	for (i = 0; i < npp->num_nodes; i++) {
+		free(npp->node_sigs[i]);
+		free(npp->node_parts[i]);
+	}
+	free(npp->node_sigs);
+	free(npp->node_parts);
+	npp->node_sigs = NULL;
+	npp->node_parts = NULL;
+	npp->num_nodes = 0;
+
+	for (i = 0; i < npp->num_layouts; i++) {
+		free(npp->layouts[i]->name);
+		free(npp->layouts[i]->res_name);
+		free(npp->layouts[i]->res_val);
+		free(npp->layouts[i]);
+	}
+	free(npp->layouts);
+	npp->layouts = NULL;
+	npp->num_layouts = 0;
+
+	free_string_array(npp->resnames);
+	npp->resnames = NULL;
+}
+
+/**
+ * @brief
+ * 		find the persistent layout for key.  If it does not exist or it
+ *		was created with different resources, flags, or number of nodes,
+ *		(re)initialize it.
+ *
+ * @param[in]	key	-	owner of the layout
+ * @param[in]	resnames	-	node grouping resource names
+ * @param[in]	flags	-	NP_* flags
+ * @param[in]	num_nodes	-	number of nodes the partitions are created from
+ *
+ * @return	np_persist *
+ * @retval	NULL	: on error
+ */
+static np_persist *
+find_alloc_np_persist(char *key, char **resnames, unsigned int flags, int num_nodes)
+{
+	np_persist *npp = NULL;
+	np_persist **tmp_arr;
+	int ct;
+	int i;
+
+	ct = count_array((void **) np_persist_arr);
+	for (i = 0; i < ct; i++) {
+		if (strcmp(np_persist_arr[i]->key, key) == 0) {
+			npp = np_persist_arr[i];
+			break;
+		}
+	}
+
+	if (npp == NULL) {
+		if ((npp = calloc(1, sizeof(np_persist))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return NULL;
+		}
+		if ((npp->key = string_dup(key)) == NULL) {
+			free(npp);
+			return NULL;
+		}
+		/* ct+2: 1 for new element 1 for NULL ptr */
+		tmp_arr = realloc(np_persist_arr, (ct + 2) * sizeof(np_persist *));
+		if (tmp_arr == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(npp->key);
+			free(npp);
+			return NULL;
+		}
+		tmp_arr[ct] = npp;
+		tmp_arr[ct + 1] = NULL;
+		np_persist_arr = tmp_arr;
+	}
+	else if (npp->flags != flags || npp->num_nodes != num_nodes ||
+		match_string_array(npp->resnames, resnames) != SA_FULL_MATCH)
+		clear_np_persist(npp);
+
+	npp->generation = np_persist_generation;
+
+	if (npp->resnames == NULL) {
+		npp->flags = flags;
+		npp->resnames = dup_string_array(resnames);
+		npp->node_sigs = calloc(num_nodes + 1, sizeof(char *));
+		npp->node_parts = calloc(num_nodes + 1, sizeof(int *));
+		if (npp->resnames == NULL || npp->node_sigs == NULL || npp->node_parts == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			clear_np_persist(npp);
+			return NULL;
+		}
+		npp->num_nodes = num_nodes;
+	}
+
+	return npp;
+}
+
+/**
+ * @brief
+ * 		create the signature of the values which decide which node
+ *		partitions a node belongs to: its name, whether it is stale, its
+ *		host, and the values of the node grouping resources.
+ *
+ * @param[in]	node	-	the node
+ * @param[in]	defs	-	resource definitions of the node grouping resources
+ * @param[in]	num_defs	-	number of entries in defs
+ * @param[in]	flags	-	NP_* flags
+ *
+ * @return	char *	(caller frees)
+ * @retval	NULL	: on error
+ */
+static char *
+create_np_node_signature(node_info *node, resdef **defs, int num_defs, unsigned int flags)
+{
+	char *sig = NULL;
+	int size = 0;
+	int err = 0;
+	schd_resource *res;
+	int i, j;
+
+	err |= pbs_strcat(&sig, &size, node->name) == NULL;
+	if (node->is_stale)
+		err |= pbs_strcat(&sig, &size, "\n!") == NULL;
+	else {
+		res = find_resource(node->res, getallres(RES_HOST));
+		err |= pbs_strcat(&sig, &size, "\n") == NULL;
+		if (res != NULL)
+			err |= pbs_strcat(&sig, &size, res->str_avail[0]) == NULL;
+
+		for (i = 0; i < num_defs; i++) {
+			err |= pbs_strcat(&sig, &size, "\n") == NULL;
+			res = find_resource(node->res, defs[i]);
+			if (res == NULL) {
+				if (flags & NP_CREATE_REST)
+					err |= pbs_strcat(&sig, &size, "\t\"\"") == NULL;
+				continue;
+			}
+			for (j = 0; res->str_avail[j] != NULL; j++) {
+				err |= pbs_strcat(&sig, &size, "\t") == NULL;
+				err |= pbs_strcat(&sig, &size, res->str_avail[j]) == NULL;
+			}
+		}
+	}
+
+	if (err) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(sig);
+		return NULL;
+	}
+
+	return sig;
+}
+
+/**
+ * @brief
+ * 		add a node to the layouts of one node grouping resource.  A
+ *		layout is created for each value not seen before.
+ *
+ * @param[in,out]	npp	-	the persistent layout
+ * @param[in]	node_i	-	index of the node in the node array
+ * @param[in]	node	-	the node
+ * @param[in]	resname	-	node grouping resource name
+ * @param[in]	def	-	node grouping resource definition
+ * @param[in]	flags	-	NP_* flags
+ *
+ * @return	int
+ * @retval	1	: on success
+ * @retval	0	: on error
+ */
+static int
+add_node_to_np_persist(np_persist *npp, int node_i, node_info *node,
+	char *resname, resdef *def, unsigned int flags)
+{
+	char *unsetarr[] = {"\"\"", NULL};
+	char **vals;
+	schd_resource *res;
+	np_layout *npl;
+	np_layout **tmp_layouts;
+	int *parts;
+	int *tmp_parts;
+	char *name;
+	int num_parts;
+	int val_i;
+	int i, j;
+
+	res = find_resource(node->res, def);
+	if (res != NULL)
+		vals = res->str_avail;
+	else if (flags & NP_CREATE_REST)
+		vals = unsetarr;
+	else
+		return 1;
+
+	parts = npp->node_parts[node_i];
+	for (num_parts = 0; parts != NULL && parts[num_parts] != -1; num_parts++)
+		;
+
+	for (val_i = 0; vals[val_i] != NULL; val_i++) {
+		name = concat_str(resname, "=", vals[val_i], 0);
+		if (name == NULL)
+			return 0;
+
+		for (i = 0; i < npp->num_layouts && strcmp(npp->layouts[i]->name, name); i++)
+			;
+
+		if (i == npp->num_layouts) {
+			tmp_layouts = realloc(npp->layouts, (i + 1) * sizeof(np_layout *));
+			if (tmp_layouts == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				free(name);
+				return 0;
+			}
+			npp->layouts = tmp_layouts;
+			if ((npl = calloc(1, sizeof(np_layout))) == NULL) {
+				log_err(errno, __func__, MEM_ERR_MSG);
+				free(name);
+				return 0;
+			}
+			npl->name = name;
+			npl->res_name = string_dup(resname);
+			npl->res_val = string_dup(vals[val_i]);
+			npl->ok_break = 1;
+			npp->layouts[i] = npl;
+			npp->num_layouts++;
+			if (npl->res_name == NULL || npl->res_val == NULL)
+				return 0;
+		}
+		else
+			free(name);
+
+		npp->layouts[i]->dirty = 1;
+
+		/* the same value may be listed more than once on a node */
+		for (j = 0; j < num_parts && parts[j] != i; j++)
+			;
+		if (j < num_parts)
+			continue;
+
+		/* +2: 1 for the new index 1 for the -1 terminator */
+		tmp_parts = realloc(parts, (num_parts + 2) * sizeof(int));
+		if (tmp_parts == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		parts = tmp_parts;
+		parts[num_parts++] = i;
+		parts[num_parts] = -1;
+		npp->node_parts[node_i] = parts;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		create the node partitions described by a persistent layout
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in,out]	npp	-	the persistent layout
+ * @param[in]	nodes	-	the nodes the layout was created from
+ * @param[out]	num_parts	-	the number of partitions created
+ *
+ * @return	node_partition ** (NULL terminated node_partition array)
+ * @retval	NULL	: on error
+ */
+static node_partition **
+np_persist_to_node_partitions(status *policy, np_persist *npp, node_info **nodes, int *num_parts)
+{
+	node_partition **np_arr;
+	node_partition **np_by_layout;
+	node_partition *np;
+	np_layout *npl;
+	schd_resource *hostres;
+	schd_resource *tmpres;
+	int *counts;
+	int *parts;
+	int np_i;
+	int node_i;
+	int i;
+
+	counts = calloc(npp->num_layouts + 1, sizeof(int));
+	np_by_layout = calloc(npp->num_layouts + 1, sizeof(node_partition *));
+	np_arr = malloc((npp->num_layouts + 1) * sizeof(node_partition *));
+	if (counts == NULL || np_by_layout == NULL || np_arr == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(counts);
+		free(np_by_layout);
+		free(np_arr);
+		return NULL;
+	}
+	np_arr[0] = NULL;
+
+	for (node_i = 0; node_i < npp->num_nodes; node_i++)
+		for (parts = npp->node_parts[node_i]; parts != NULL && *parts != -1; parts++)
+			counts[*parts]++;
+
+	/* layouts whose nodes all moved elsewhere are kept, but have no partition */
+	np_i = 0;
+	for (i = 0; i < npp->num_layouts; i++) {
+		if (counts[i] == 0)
+			continue;
+
+		npl = npp->layouts[i];
+		np = new_node_partition();
+		np_arr[np_i] = np;
+		np_arr[np_i + 1] = NULL;
+		if (np == NULL)
+			goto np_persist_err;
+		np_i++;
+
+		np->name = string_dup(npl->name);
+		np->res_val = string_dup(npl->res_val);
+		np->def = find_resdef(allres, npl->res_name);
+		np->rank = get_sched_rank();
+		np->ninfo_arr = malloc((counts[i] + 1) * sizeof(node_info *));
+		if (np->name == NULL || np->res_val == NULL || np->ninfo_arr == NULL)
+			goto np_persist_err;
+		np->ninfo_arr[0] = NULL;
+		np_by_layout[i] = np;
+	}
+
+	for (node_i = 0; node_i < npp->num_nodes; node_i++) {
+		for (parts = npp->node_parts[node_i]; parts != NULL && *parts != -1; parts++) {
+			np = np_by_layout[*parts];
+			np->ninfo_arr[np->tot_nodes++] = nodes[node_i];
+		}
+	}
+
+	for (i = 0; i < npp->num_layouts; i++) {
+		np = np_by_layout[i];
+		if (np == NULL)
+			continue;
+
+		npl = npp->layouts[i];
+		np->ninfo_arr[np->tot_nodes] = NULL;
+
+		/* only recalculate ok_break if the partition's membership changed */
+		if (npl->dirty) {
+			npl->ok_break = 1;
+			hostres = NULL;
+			for (node_i = 0; np->ninfo_arr[node_i] != NULL; node_i++) {
+				tmpres = find_resource(np->ninfo_arr[node_i]->res, getallres(RES_HOST));
+				if (tmpres == NULL)
+					continue;
+				if (hostres == NULL)
+					hostres = tmpres;
+				else if (!compare_res_to_str(hostres, tmpres->str_avail[0], CMP_CASELESS)) {
+					npl->ok_break = 0;
+					break;
+				}
+			}
+			npl->dirty = 0;
+		}
+		np->ok_break = npl->ok_break;
+
+		np->bkts = create_node_buckets(policy, np->ninfo_arr, NULL, 0);
+		create_node_map(np);
+		node_partition_update(policy, np);
+	}
+
+	free(counts);
+	free(np_by_layout);
+	*num_parts = np_i;
+	return np_arr;
+
+np_persist_err:
+	free(counts);
+	free(np_by_layout);
+	free_node_partition_array(np_arr);
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		create node partitions like create_node_partitions(), but keep the
+ *		partition layout across cycles.  A node's partition membership is
+ *		only recomputed if its signature (name, stale state, host, and
+ *		node grouping resource values) changed since the last cycle.
+ *		The metadata (free nodes and resource totals) of every partition
+ *		is still recalculated.
+ *
+ * @param[in]	policy	-	policy info
+ * @param[in]	key	-	unique owner of the partitions (e.g., "server")
+ * @param[in]	nodes	-	the nodes which to create partitions from
+ * @param[in]	resnames	-	node grouping resource names
+ * @param[in]	flags	-	flags which change operations of node partition creation
+ * @param[out]	num_parts	-	the number of partitions created
+ *
+ * @return	node_partition ** (NULL terminated node_partition array)
+ * @retval	NULL	: on error
+ */
+node_partition **
+create_persistent_node_partitions(status *policy, char *key, node_info **nodes,
+	char **resnames, unsigned int flags, int *num_parts)
+{
+	np_persist *npp;
+	resdef **defs;
+	char *sig;
+	char *changed;
+	int num_changed = 0;
+	int num_nodes;
+	int num_defs;
+	int node_i;
+	int res_i;
+	int *parts;
+
+	if (key == NULL || nodes == NULL || resnames == NULL || num_parts == NULL)
+		return NULL;
+
+	num_nodes = count_array((void **) nodes);
+	num_defs = count_array((void **) resnames);
+
+	if ((npp = find_alloc_np_persist(key, resnames, flags, num_nodes)) == NULL)
+		return create_node_partitions(policy, nodes, resnames, flags, num_parts);
+
+	defs = malloc((num_defs + 1) * sizeof(resdef *));
+	changed = calloc(num_nodes + 1, sizeof(char));
+	if (defs == NULL || changed == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(defs);
+		free(changed);
+		return NULL;
+	}
+	for (res_i = 0; res_i < num_defs; res_i++)
+		defs[res_i] = find_resdef(allres, resnames[res_i]);
+
+	for (node_i = 0; node_i < num_nodes; node_i++) {
+		sig = create_np_node_signature(nodes[node_i], defs, num_defs, flags);
+		if (sig == NULL)
+			break;
+
+		if (npp->node_sigs[node_i] != NULL && strcmp(npp->node_sigs[node_i], sig) == 0) {
+			free(sig);
+			continue;
+		}
+
+		/* the partitions the node leaves need their ok_break recalculated */
+		for (parts = npp->node_parts[node_i]; parts != NULL && *parts != -1; parts++)
+			npp->layouts[*parts]->dirty = 1;
+		free(npp->node_parts[node_i]);
+		npp->node_parts[node_i] = NULL;
+		free(npp->node_sigs[node_i]);
+		npp->node_sigs[node_i] = sig;
+		changed[node_i] = 1;
+		num_changed++;
+	}
+
+	/* Nodes are added resource by resource to create partitions in the same
+	 * order as create_node_partitions() does
+	 */
+	for (res_i = 0; node_i == num_nodes && res_i < num_defs; res_i++) {
+		for (node_i = 0; node_i < num_nodes; node_i++) {
+			if (!changed[node_i] || nodes[node_i]->is_stale)
+				continue;
+			if (!add_node_to_np_persist(npp, node_i, nodes[node_i],
+				resnames[res_i], defs[res_i], flags))
+				break;
+		}
+	}
+
+	free(defs);
+	free(changed);
+
+	if (node_i != num_nodes) {
+		/* start over next cycle */
+		clear_np_persist(npp);
+		return create_node_partitions(policy, nodes, resnames, flags, num_parts);
+	}
+
+	snprintf(log_buffer, sizeof(log_buffer),
+		"Node partitions: %d of %d nodes changed since last cycle",
+		num_changed, num_nodes);
+	schdlog(PBSEVENT_DEBUG3, PBS_EVENTCLASS_NODE, LOG_DEBUG, key, log_buffer);
+
+	return np_persist_to_node_partitions(policy, npp, nodes, num_parts);
+}
+
+/**
+ * @brief
+ * 		free the persistent node partition layouts which were not used
+ *		since the last call to this function.
+ *
+ * @return	nothing
+ */
+void
+purge_persistent_node_partitions(void)
+{
+	int i, j;
+
+	if (np_persist_arr == NULL)
+		return;
+
+	for (i = 0, j = 0; np_persist_arr[i] != NULL; i++) {
+		if (np_persist_arr[i]->generation != np_persist_generation) {
+			clear_np_persist(np_persist_arr[i]);
+			free(np_persist_arr[i]->key);
+			free(np_persist_arr[i]);
+		}
+		else
+			np_persist_arr[j++] = np_persist_arr[i];
+	}
+	np_persist_arr[j] = NULL;
+
+	np_persist_generation++;
+}
+
 /**
  * @brief update the node buckets associated with a node partition on
  *        job/resv run/end
@@ -606,6 +1195,37 @@ update_buckets_for_node_array(node_bucket **bkts, node_info **ninfo_arr) {
 
 }
 
+/**
+ * @brief
+ * 		check if any of an array of nodes is in a node partition
+ *
+ * @param[in]	np	-	node partition
+ * @param[in]	ninfo_arr	-	nodes to check
+ *
+ * @return	int
+ * @retval	1	: a node is in the partition, or the partition has no node map
+ * @retval	0	: none of the nodes are in the partition
+ */
+int
+nodepart_has_nodes(node_partition *np, node_info **ninfo_arr)
+{
+	int i;
+
+	if (np == NULL || ninfo_arr == NULL)
+		return 0;
+
+	if (np->node_map == NULL)
+		return 1;
+
+	for (i = 0; ninfo_arr[i] != NULL; i++) {
+		if (ninfo_arr[i]->node_ind < 0 ||
+			pbs_bitmap_get_bit(np->node_map, ninfo_arr[i]->node_ind))
+			return 1;
+	}
+
+	return 0;
+}
+
 /**
  * @brief
  * 		update metadata for an entire array of node partitions
@@ -613,6 +1233,8 @@ update_buckets_for_node_array(node_bucket **bkts, node_info **ninfo_arr) {
  * @param[in] policy	-	policy info
  * @param[in] nodepart	-	partition array to update
  * @param[in] ninfo_arr - 	nodes being updated (may be NULL)
+ *			  	If not NULL, only partitions containing one of
+ *			  	these nodes are updated
  *
  * @return	int
  * @retval	1	: on all success
@@ -635,6 +1257,8 @@ node_partition_update_array(status *policy, node_partition **nodepart, node_info
 		return 0;
 
 	for (i = 0; nodepart[i] != NULL; i++) {
+		if (ninfo_arr != NULL && !nodepart_has_nodes(nodepart[i], ninfo_arr))
+			continue;
 		cur_rc = node_partition_update(policy, nodepart[i]);
 		if (cur_rc == 0)
 			rc = 0;
@@ -1110,6 +1734,7 @@ create_specific_nodepart(status *policy, char *name, node_info **nodes)
 
 
 	np->ninfo_arr[np->tot_nodes] = NULL;
+	create_node_map(np);
 
 	if (node_partition_update(policy, np) == 0) {
 		free_node_partition(np);
@@ -1138,11 +1763,13 @@ create_placement_sets(status *policy, server_info *sinfo)
 	int is_success = 1;
 	char *resstr[] = {"host", NULL};
 	int num;
+	char key[256];
 
 	sinfo->allpart = create_specific_nodepart(policy, "all", sinfo->unassoc_nodes);
 	if (sinfo->has_multi_vnode) {
-		sinfo->hostsets = create_node_partitions(policy, sinfo->nodes,
-			resstr, policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST, &num);
+		sinfo->hostsets = create_persistent_node_partitions(policy, "hostsets",
+			sinfo->nodes, resstr,
+			policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST, &num);
 		if (sinfo->hostsets != NULL) {
 			sinfo->num_hostsets = num;
 			for (i = 0; sinfo->nodes[i] != NULL; i++) {
@@ -1170,8 +1797,8 @@ create_placement_sets(status *policy, server_info *sinfo)
 	}
 
 	if (sinfo->node_group_enable && sinfo->node_group_key != NULL) {
-		sinfo->nodepart = create_node_partitions(policy, sinfo->unassoc_nodes,
-			sinfo->node_group_key,
+		sinfo->nodepart = create_persistent_node_partitions(policy, "server",
+			sinfo->unassoc_nodes, sinfo->node_group_key,
 			policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST,
 			&sinfo->num_parts);
 
@@ -1205,8 +1832,10 @@ create_placement_sets(status *policy, server_info *sinfo)
 			else
 				ngkey = sinfo->node_group_key;
 
-			qinfo->nodepart = create_node_partitions(policy, ngroup_nodes,
-				ngkey, policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST,
+			snprintf(key, sizeof(key), "queue:%s", qinfo->name);
+			qinfo->nodepart = create_persistent_node_partitions(policy, key,
+				ngroup_nodes, ngkey,
+				policy->only_explicit_psets ? NO_FLAGS : NP_CREATE_REST,
 				&(qinfo->num_parts));
 			if (qinfo->nodepart != NULL) {
 				qsort(qinfo->nodepart, qinfo->num_parts,
@@ -1219,6 +1848,10 @@ create_placement_sets(status *policy, server_info *sinfo)
 			}
 		}
 	}
+
+	/* free the layouts of queues which no longer exist or use node grouping */
+	purge_persistent_node_partitions();
+
 	return is_success;
 }
 
@@ -1276,8 +1909,21 @@ update_all_nodepart(status *policy, server_info *sinfo, resource_resv *resresv,
 		}
 	}
 
-	/* Update and resort the hostsets */
-	node_partition_update_array(policy, sinfo->hostsets, NULL);
+	/* Update and resort the hostsets.  Only the hosts of resresv's nodes changed */
+	if (resresv->ninfo_arr != NULL && sinfo->hostsets != NULL) {
+		node_partition *prev_hostset = NULL;
+
+		for (i = 0; resresv->ninfo_arr[i] != NULL; i++) {
+			node_partition *hostset = resresv->ninfo_arr[i]->hostset;
+
+			/* vnodes of a host are usually next to each other */
+			if (hostset != NULL && hostset != prev_hostset)
+				node_partition_update(policy, hostset);
+			prev_hostset = hostset;
+		}
+	}
+	else
+		node_partition_update_array(policy, sinfo->hostsets, NULL);
 	if (policy->node_sort[0].res_name != NULL &&
 	    conf.node_sort_unused && sinfo->hostsets != NULL) {
 		/* Resort the nodes in host sets to correctly reflect unused resources */
@@ -120,6 +120,36 @@ node_partition **
 create_node_partitions(status *policy, node_info **nodes, char **resnames,
 	unsigned int flags, int *num_parts);
 
+/*
+ *	create_node_map - create the bitmap of the nodes in a node partition
+ *	returns 1 if the bitmap was created - 0 if not
+ */
+int create_node_map(node_partition *np);
+
+/*
+ *	create_persistent_node_partitions - create node partitions reusing the
+ *			partition layout of the previous cycle for nodes whose
+ *			membership signature did not change
+ *
+ *	  key - unique owner of the partitions (e.g., "server")
+ *
+ *	returns node_partition array or NULL on error
+ */
+node_partition **
+create_persistent_node_partitions(status *policy, char *key, node_info **nodes,
+	char **resnames, unsigned int flags, int *num_parts);
+
+/*
+ *	purge_persistent_node_partitions - free the persistent partition layouts
+ *			which were not used since the last purge
+ */
+void purge_persistent_node_partitions(void);
+
+/*
+ *	nodepart_has_nodes - check if any of an array of nodes is in a node partition
+ */
+int nodepart_has_nodes(node_partition *np, node_info **ninfo_arr);
+
 /*
  *
  *      find_node_partition - find a node partition by name in an array
@@ -276,6 +276,9 @@ parse_config(char *fname)
 				else if (!strcmp(config_name, PARSE_UPDATE_COMMENTS)) {
 					conf.update_comments = num ? 1 : 0;
 				}
+				else if (!strcmp(config_name, PARSE_CYCLE_PROFILE)) {
+					conf.cycle_profile = num ? 1 : 0;
+				}
 				else if (!strcmp(config_name, PARSE_BACKFILL_PRIME)) {
 					if (prime == PRIME || prime == ALL)
 						conf.prime_bp = num ? 1 : 0;
@@ -352,6 +355,10 @@ parse_config(char *fname)
 				}
 				else if (!strcmp(config_name, PARSE_FAIRSHARE_RES))
 					conf.fairshare_res = string_dup(config_value);
+				else if (!strcmp(config_name, PARSE_CYCLE_PROFILE_TRACE))
+					conf.cycle_profile_trace = string_dup(config_value);
+				else if (!strcmp(config_name, PARSE_SNAPSHOT_CAPTURE))
+					conf.snapshot_capture = string_dup(config_value);
 				else if (!strcmp(config_name, PARSE_FAIRSHARE_ENT)) {
 					if (strcmp(config_value, ATTR_euser) &&
 						strcmp(config_value, ATTR_egroup) &&
@@ -850,6 +857,15 @@ parse_config(char *fname)
 					else
 						conf.max_jobs_to_check = num;
 				}
+				else if (!strcmp(config_name, PARSE_NODE_EVAL_THREADS)) {
+					if (num < 1) {
+						error = 1;
+						sprintf(errbuf, "%s: Invalid value: %s.  Must be at least 1.",
+							PARSE_NODE_EVAL_THREADS, config_value);
+					}
+					else
+						conf.node_eval_threads = num;
+				}
 				else if (!strcmp(config_name, PARSE_CPUS_PER_SSINODE) ||
 					!strcmp(config_name, PARSE_MEM_PER_SSINODE)
 					) {
@@ -1068,6 +1084,7 @@ init_config()
 
 	conf.max_preempt_attempts = SCHD_INFINITY;
 	conf.max_jobs_to_check = SCHD_INFINITY;
+	conf.node_eval_threads = 1;
 
 	/* default value for ignore_res is the pseudo resources */
 	conf.ignore_res = ignore;
@@ -38,11 +38,126 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
 #include "pbs_bitmap.h"
 
 #define BYTES_TO_BITS(x) ((x) * 8)
 
+/* number of bits in one word of the bits array */
+#define BITS_PER_WORD BYTES_TO_BITS(sizeof(unsigned long))
+
+/* number of words needed to hold num_bits */
+#define BITS_TO_WORDS(num_bits) (((num_bits) + BITS_PER_WORD - 1) / BITS_PER_WORD)
+
+/* mask of bits at or above bit in a word (bit is 0 .. BITS_PER_WORD-1) */
+#define WORD_MASK_FROM(bit) (~0UL << (bit))
+
+/* mask of bits below bit in a word (bit is 0 .. BITS_PER_WORD-1) */
+#define WORD_MASK_BELOW(bit) ((1UL << (bit)) - 1)
+
+#if defined(__AVX2__)
+/* number of words in one 256 bit vector */
+#define WORDS_PER_VEC (32 / sizeof(unsigned long))
+#endif
+
+/**
+ * @brief count the on bits in a word
+ * @param w - the word
+ * @return int - number of on bits
+ */
+static int
+word_popcount(unsigned long w)
+{
+#if defined(__GNUC__)
+	return __builtin_popcountl(w);
+#else
+	int c;
+
+	for (c = 0; w != 0; c++)
+		w &= w - 1;
+	return c;
+#endif
+}
+
+/**
+ * @brief find the lowest on bit in a word
+ * @param w - the word (must not be 0)
+ * @return int - index of the lowest on bit
+ */
+static int
+word_first_on(unsigned long w)
+{
+#if defined(__GNUC__)
+	return __builtin_ctzl(w);
+#else
+	int i;
+
+	for (i = 0; !(w & 1UL); i++)
+		w >>= 1;
+	return i;
+#endif
+}
+
+/**
+ * @brief L[i] |= R[i] for n words
+ */
+static void
+words_or(unsigned long *L, unsigned long *R, long n)
+{
+	long i = 0;
+
+#if defined(__AVX2__)
+	for (; i + WORDS_PER_VEC <= n; i += WORDS_PER_VEC) {
+		__m256i l = _mm256_loadu_si256((__m256i *) (L + i));
+		__m256i r = _mm256_loadu_si256((__m256i *) (R + i));
+		_mm256_storeu_si256((__m256i *) (L + i), _mm256_or_si256(l, r));
+	}
+#endif
+	for (; i < n; i++)
+		L[i] |= R[i];
+}
+
+/**
+ * @brief L[i] &= R[i] for n words
+ */
+static void
+words_and(unsigned long *L, unsigned long *R, long n)
+{
+	long i = 0;
+
+#if defined(__AVX2__)
+	for (; i + WORDS_PER_VEC <= n; i += WORDS_PER_VEC) {
+		__m256i l = _mm256_loadu_si256((__m256i *) (L + i));
+		__m256i r = _mm256_loadu_si256((__m256i *) (R + i));
+		_mm256_storeu_si256((__m256i *) (L + i), _mm256_and_si256(l, r));
+	}
+#endif
+	for (; i < n; i++)
+		L[i] &= R[i];
+}
+
+/**
+ * @brief L[i] &= ~R[i] for n words
+ */
+static void
+words_andnot(unsigned long *L, unsigned long *R, long n)
+{
+	long i = 0;
+
+#if defined(__AVX2__)
+	for (; i + WORDS_PER_VEC <= n; i += WORDS_PER_VEC) {
+		__m256i l = _mm256_loadu_si256((__m256i *) (L + i));
+		__m256i r = _mm256_loadu_si256((__m256i *) (R + i));
+		/* _mm256_andnot_si256(a, b) is ~a & b */
+		_mm256_storeu_si256((__m256i *) (L + i), _mm256_andnot_si256(r, l));
+	}
+#endif
+	for (; i < n; i++)
+		L[i] &= ~R[i];
+}
 
 /**
  * @brief allocate space for a pbs_bitmap (and possibly the bitmap itself)
@@ -72,12 +187,14 @@ pbs_bitmap_alloc(pbs_bitmap *pbm, long num_bits)
 	
 	/* shrinking bitmap, clear previously used bits */
 	if (num_bits < bm->num_bits) {
-		int i;
-		i = num_bits / BYTES_TO_BITS(sizeof(unsigned long)) + 1;
+		long i;
+		i = num_bits / BITS_PER_WORD;
+		if (num_bits % BITS_PER_WORD) {
+			bm->bits[i] &= WORD_MASK_BELOW(num_bits % BITS_PER_WORD);
+			i++;
+		}
 		for ( ; i < bm->num_longs; i++)
 			bm->bits[i] = 0;
-		for (i = pbs_bitmap_next_on_bit(bm, num_bits); i != -1; i = pbs_bitmap_next_on_bit(bm, i))
-			pbs_bitmap_bit_off(bm, i);
 	}
 
 	/* If we have enough unused bits available, we don't need to allocate */
@@ -215,44 +332,29 @@ pbs_bitmap_next_on_bit(pbs_bitmap *pbm, long start_bit)
 {
 	long long_ind;
 	long bit;
-	int i;
-	
+	unsigned long w;
+
 	if (pbm == NULL)
 		return -1;
-	
+
 	if (start_bit >= pbm->num_bits)
 		return -1;
-	
-	long_ind = start_bit / BYTES_TO_BITS(sizeof(unsigned long));
-	bit = start_bit % BYTES_TO_BITS(sizeof(unsigned long));
-
-	/* special case - look at first long that contains start_bit */
-	if (pbm->bits[long_ind] != 0) {
-		for (i = bit + 1; i < BYTES_TO_BITS(sizeof(unsigned long)); i++) {
-			if (pbm->bits[long_ind] & (1UL << i)) {
-				return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-			}
-		}
-
-		/* didn't find an on bit after start_bit_index in the long that contained start_bit */
-		if (long_ind < pbm->num_longs) {
-			long_ind++;
-		}
-	}
 
-	for( ; long_ind < pbm->num_longs && pbm->bits[long_ind] == 0; long_ind++)
-		;
-
-	if (long_ind == pbm->num_longs)
+	bit = start_bit + 1;
+	long_ind = bit / BITS_PER_WORD;
+	if (long_ind >= pbm->num_longs)
 		return -1;
 
-	for (i = 0 ; i < BYTES_TO_BITS(sizeof(unsigned long)) ; i++) {
-		if (pbm->bits[long_ind] & (1UL << i)) {
-			return (long_ind * BYTES_TO_BITS(sizeof(unsigned long)) + i);
-		}
+	/* first word: ignore start_bit and the bits before it */
+	w = pbm->bits[long_ind] & WORD_MASK_FROM(bit % BITS_PER_WORD);
+
+	while (w == 0) {
+		if (++long_ind >= pbm->num_longs)
+			return -1;
+		w = pbm->bits[long_ind];
 	}
 
-	return -1;
+	return (long_ind * BITS_PER_WORD + word_first_on(w));
 }
 
 /**
@@ -318,17 +420,251 @@ pbs_bitmap_assign(pbs_bitmap *L, pbs_bitmap *R)
 int
 pbs_bitmap_is_equal(pbs_bitmap *L, pbs_bitmap *R)
 {
-	int i;
-	
+	long i;
+	long n;
+
 	if(L == NULL || R == NULL)
 		return 0;
-	
+
 	if (L->num_bits != R->num_bits)
 		return 0;
-	
-	for(i = 0; i < L->num_longs; i++)
+
+	/* only the words holding num_bits matter, either may have more allocated */
+	n = BITS_TO_WORDS(L->num_bits);
+	for(i = 0; i < n; i++)
 		if(L->bits[i] != R->bits[i])
 			return 0;
-	
+
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L |= R.  L is grown to the size of R if needed.
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_or(pbs_bitmap *L, pbs_bitmap *R)
+{
+	if (L == NULL || R == NULL)
+		return 0;
+
+	if (R->num_bits > L->num_bits)
+		if (pbs_bitmap_alloc(L, R->num_bits) == NULL)
+			return 0;
+
+	words_or(L->bits, R->bits, BITS_TO_WORDS(R->num_bits));
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L &= R.  Bits of L past the end of R are turned off.
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_and(pbs_bitmap *L, pbs_bitmap *R)
+{
+	long n;
+	long i;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	n = BITS_TO_WORDS(R->num_bits);
+	if (n > L->num_longs)
+		n = L->num_longs;
+
+	words_and(L->bits, R->bits, n);
+	for (i = n; i < L->num_longs; i++)
+		L->bits[i] = 0;
+
+	return 1;
+}
+
+/**
+ * @brief pbs_bitmap version of L &= ~R (turn off in L all the bits on in R)
+ * @param L - bitmap lvalue
+ * @param R - bitmap rvalue
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_andnot(pbs_bitmap *L, pbs_bitmap *R)
+{
+	long n;
+
+	if (L == NULL || R == NULL)
+		return 0;
+
+	n = BITS_TO_WORDS(R->num_bits);
+	if (n > L->num_longs)
+		n = L->num_longs;
+
+	words_andnot(L->bits, R->bits, n);
+	return 1;
+}
+
+/**
+ * @brief count the number of on bits in a bitmap
+ * @param pbm - the bitmap
+ * @return long
+ * @retval number of on bits
+ */
+long
+pbs_bitmap_count_on_bits(pbs_bitmap *pbm)
+{
+	long i;
+	long n;
+	long count = 0;
+
+	if (pbm == NULL)
+		return 0;
+
+	n = BITS_TO_WORDS(pbm->num_bits);
+	for (i = 0; i < n; i++)
+		count += word_popcount(pbm->bits[i]);
+
+	return count;
+}
+
+/**
+ * @brief set out to the first (lowest) n on bits of pbm
+ * @param pbm - the bitmap to take the bits from
+ * @param n - number of on bits wanted
+ * @param out - bitmap to set (may not be pbm)
+ * @return long
+ * @retval number of bits found (less than n if pbm doesn't have n on bits)
+ * @retval -1 on error
+ */
+long
+pbs_bitmap_first_n_on_bits(pbs_bitmap *pbm, long n, pbs_bitmap *out)
+{
+	long i;
+	long words;
+	long found = 0;
+	int c;
+	unsigned long w;
+	unsigned long take;
+
+	if (pbm == NULL || out == NULL || pbm == out)
+		return -1;
+
+	if (out->num_bits < pbm->num_bits)
+		if (pbs_bitmap_alloc(out, pbm->num_bits) == NULL)
+			return -1;
+
+	words = BITS_TO_WORDS(pbm->num_bits);
+	for (i = 0; i < words && found < n; i++) {
+		w = pbm->bits[i];
+		c = word_popcount(w);
+		if (found + c <= n) {
+			out->bits[i] = w;
+			found += c;
+		}
+		else {
+			/* only part of this word is needed: peel off its low bits */
+			take = 0;
+			for (; found < n; found++) {
+				take |= w & (~w + 1);
+				w &= w - 1;
+			}
+			out->bits[i] = take;
+		}
+	}
+	for (; i < out->num_longs; i++)
+		out->bits[i] = 0;
+
+	return found;
+}
+
+/**
+ * @brief turn on the bits in [start, end).  The bitmap is grown if needed.
+ * @param pbm - the bitmap
+ * @param start - first bit to turn on
+ * @param end - one past the last bit to turn on
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_range_on(pbs_bitmap *pbm, long start, long end)
+{
+	long first;
+	long last;
+	long i;
+
+	if (pbm == NULL || start < 0)
+		return 0;
+
+	if (start >= end)
+		return 1;
+
+	if (end > pbm->num_bits)
+		if (pbs_bitmap_alloc(pbm, end) == NULL)
+			return 0;
+
+	first = start / BITS_PER_WORD;
+	last = (end - 1) / BITS_PER_WORD;
+	if (first == last) {
+		pbm->bits[first] |= WORD_MASK_FROM(start % BITS_PER_WORD) &
+			(~0UL >> (BITS_PER_WORD - 1 - (end - 1) % BITS_PER_WORD));
+		return 1;
+	}
+
+	pbm->bits[first] |= WORD_MASK_FROM(start % BITS_PER_WORD);
+	for (i = first + 1; i < last; i++)
+		pbm->bits[i] = ~0UL;
+	pbm->bits[last] |= ~0UL >> (BITS_PER_WORD - 1 - (end - 1) % BITS_PER_WORD);
+
+	return 1;
+}
+
+/**
+ * @brief turn off the bits in [start, end)
+ * @param pbm - the bitmap
+ * @param start - first bit to turn off
+ * @param end - one past the last bit to turn off
+ * @return int
+ * @retval 1 success
+ * @retval 0 failure
+ */
+int
+pbs_bitmap_range_off(pbs_bitmap *pbm, long start, long end)
+{
+	long first;
+	long last;
+	long i;
+
+	if (pbm == NULL || start < 0)
+		return 0;
+
+	/* bits past the end are already off */
+	if (end > pbm->num_bits)
+		end = pbm->num_bits;
+
+	if (start >= end)
+		return 1;
+
+	first = start / BITS_PER_WORD;
+	last = (end - 1) / BITS_PER_WORD;
+	if (first == last) {
+		pbm->bits[first] &= ~(WORD_MASK_FROM(start % BITS_PER_WORD) &
+			(~0UL >> (BITS_PER_WORD - 1 - (end - 1) % BITS_PER_WORD)));
+		return 1;
+	}
+
+	pbm->bits[first] &= ~WORD_MASK_FROM(start % BITS_PER_WORD);
+	for (i = first + 1; i < last; i++)
+		pbm->bits[i] = 0;
+	pbm->bits[last] &= ~(~0UL >> (BITS_PER_WORD - 1 - (end - 1) % BITS_PER_WORD));
+
 	return 1;
 }
@@ -78,6 +78,25 @@ int pbs_bitmap_assign(pbs_bitmap *L, pbs_bitmap *R);
 /* pbs_bitmap's version of L == R */
 int pbs_bitmap_is_equal(pbs_bitmap *L, pbs_bitmap *R);
 
+/* pbs_bitmap's version of L |= R */
+int pbs_bitmap_or(pbs_bitmap *L, pbs_bitmap *R);
+
+/* pbs_bitmap's version of L &= R */
+int pbs_bitmap_and(pbs_bitmap *L, pbs_bitmap *R);
+
+/* pbs_bitmap's version of L &= ~R */
+int pbs_bitmap_andnot(pbs_bitmap *L, pbs_bitmap *R);
+
+/* Count the on bits in a bitmap */
+long pbs_bitmap_count_on_bits(pbs_bitmap *pbm);
+
+/* Set out to the first n on bits of a bitmap */
+long pbs_bitmap_first_n_on_bits(pbs_bitmap *pbm, long n, pbs_bitmap *out);
+
+/* Turn on/off the bits in [start, end) */
+int pbs_bitmap_range_on(pbs_bitmap *pbm, long start, long end);
+int pbs_bitmap_range_off(pbs_bitmap *pbm, long start, long end);
+
 #ifdef	__cplusplus
 }
 #endif
@@ -0,0 +1,198 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+/**
+ * @file    pbs_sched_replay.c
+ *
+ * @brief
+ * 		pbs_sched_replay.c - run scheduling cycles on a snapshot captured
+ *		by pbs_sched (see snapshot_capture in sched_config), without a
+ *		server.
+ *
+ *		The cycles use the sched_config, fairshare and other files of the
+ *		given sched_priv directory, so a copy of it can be changed to
+ *		compare configurations on the same snapshot.  Nothing is sent to
+ *		a server or to the moms: jobs are run and preempted and
+ *		reservations confirmed in the scheduler's simulation only.
+ *		For each cycle the decisions of the main loop, their totals and
+ *		the cycle profile are printed.
+ *
+ * Functions included are:
+ * 	main()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <libpbs.h>
+#include <pbs_ifl.h>
+#include "data_types.h"
+#include "constant.h"
+#include "fifo.h"
+#include "globals.h"
+#include "cycle_profile.h"
+#include "snapshot.h"
+#include "pbs_share.h"
+#include "pbs_version.h"
+#include "log.h"
+
+extern int	second_connection;
+
+/**
+ * @brief
+ * 		The entry point of pbs_sched_replay
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	1	: something is wrong!
+ */
+int
+main(int argc, char *argv[])
+{
+	char path_buf[MAXPATHLEN + 1];
+	char errbuf[MAX_LOG_SIZE];
+	char *priv_dir = NULL;
+	char *logfile = NULL;
+	char *sched_name = NULL;
+	int num_cycles = 1;
+	int quiet = 0;
+	int errflg = 0;
+	int c;
+	int i;
+
+	/* the real deal or output version and exit? */
+	execution_mode(argc, argv);
+	set_msgdaemonname("pbs_sched_replay");
+
+	pbs_client_thread_set_single_threaded_mode();
+	if (pbs_client_thread_init_thread_context() != 0) {
+		fprintf(stderr, "%s: Unable to initialize thread context\n", argv[0]);
+		return 1;
+	}
+
+	if (pbs_loadconf(0) == 0)
+		return 1;
+
+	while ((c = getopt(argc, argv, "d:I:L:n:q")) != -1)
+		switch (c) {
+			case 'd':
+				priv_dir = optarg;
+				break;
+			case 'I':
+				sched_name = optarg;
+				break;
+			case 'L':
+				logfile = optarg;
+				break;
+			case 'n':
+				num_cycles = atoi(optarg);
+				if (num_cycles <= 0)
+					errflg = 1;
+				break;
+			case 'q':
+				quiet = 1;
+				break;
+			default:
+				errflg = 1;
+		}
+
+	if (errflg || optind != argc - 1) {
+		fprintf(stderr, "usage: %s [-d sched_priv] [-I sched_name] [-L logfile] "
+			"[-n cycles] [-q] snapshot\n", argv[0]);
+		fprintf(stderr, "       %s --version\n", argv[0]);
+		return 1;
+	}
+
+	if (!snapshot_load(argv[optind], quiet ? NULL : stdout, errbuf, sizeof(errbuf))) {
+		fprintf(stderr, "%s: %s\n", argv[0], errbuf);
+		return 1;
+	}
+
+	/* schedule as the scheduler which captured the snapshot */
+	if (sched_name == NULL)
+		sched_name = snapshot_sched_name();
+	if (sched_name == NULL || !strcmp(sched_name, PBS_DFLT_SCHED_NAME)) {
+		sc_name = PBS_DFLT_SCHED_NAME;
+		dflt_sched = 1;
+	} else
+		sc_name = sched_name;
+
+	if (priv_dir == NULL) {
+		if (dflt_sched)
+			snprintf(path_buf, sizeof(path_buf), "%s/sched_priv",
+				pbs_conf.pbs_home_path);
+		else
+			snprintf(path_buf, sizeof(path_buf), "%s/sched_priv_%s",
+				pbs_conf.pbs_home_path, sc_name);
+		priv_dir = path_buf;
+	}
+	if (chdir(priv_dir) == -1) {
+		perror(priv_dir);
+		return 1;
+	}
+
+	if (logfile != NULL && log_open(logfile, ".") == -1) {
+		fprintf(stderr, "%s: logfile %s could not be opened "
+			"(it must be an absolute path)\n", argv[0], logfile);
+		return 1;
+	}
+
+	/* there is no server to ask us to restart a cycle */
+	second_connection = -1;
+
+	if (schedinit() != 0) {
+		fprintf(stderr, "%s: failed to initialize the scheduler\n", argv[0]);
+		return 1;
+	}
+	/* the phase times are part of the report */
+	conf.cycle_profile = 1;
+
+	for (i = 0; i < num_cycles; i++) {
+		printf("cycle %d\n", i + 1);
+		scheduling_cycle(SIMULATE_SD, NULL);
+		snapshot_report(stdout);
+		profile_report(stdout);
+		fflush(stdout);
+	}
+
+	log_close(0);
+	return 0;
+}
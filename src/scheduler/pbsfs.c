@@ -214,8 +214,10 @@ main(int argc, char *argv[])
 
 	if (flags & FS_TRIM_TREE)
 		read_usage(USAGE_FILE, FS_TRIM, conf.fairshare);
-	else
+	else if (flags & FS_WRITE_FILE)
 		read_usage(USAGE_FILE, 0, conf.fairshare);
+	else
+		read_usage(USAGE_FILE, FS_READ_ONLY, conf.fairshare);
 
 	calc_fair_share_perc(conf.fairshare->root->child, UNSPECIFIED);
 	calc_usage_factor(conf.fairshare);
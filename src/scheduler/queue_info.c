@@ -86,6 +86,7 @@
 #include "limits_if.h"
 #include "pbs_internal.h"
 #include "fifo.h"
+#include "snapshot.h"
 
 /**
  * @brief
@@ -148,7 +149,7 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 		return NULL;
 
 	/* get queue info from PBS server */
-	if ((queues = pbs_statque(pbs_sd, NULL, NULL, NULL)) == NULL) {
+	if ((queues = snapshot_stat(pbs_sd, SNAP_QUEUES)) == NULL) {
 		errmsg = pbs_geterrmsg(pbs_sd);
 		if (errmsg == NULL)
 			errmsg = "";
@@ -234,7 +235,11 @@ query_queues(status *policy, int pbs_sd, server_info *sinfo)
 
 					if (!strcmp(conf.peer_queues[j].local_queue, qinfo->name)) {
 						/* Locally-peered queues reuse the scheduler's connection */
-						if (conf.peer_queues[j].remote_server == NULL) {
+						if (snapshot_replaying()) {
+							/* peer servers are not part of a snapshot */
+							peer_on = 0;
+						}
+						else if (conf.peer_queues[j].remote_server == NULL) {
 							peer_sd = pbs_sd;
 						}
 						else if ((peer_sd = pbs_connect_noblk(conf.peer_queues[j].remote_server, 2)) < 0) {
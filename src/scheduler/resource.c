@@ -89,7 +89,9 @@
 #include "pbs_internal.h"
 #include "limits_if.h"
 #include "sort.h"
+#include "snapshot.h"
 #include "parse.h"
+#include "formula.h"
 #include "limits_if.h"
 
 
@@ -126,7 +128,7 @@ query_resources(int pbs_sd)
 	char *errmsg;
 	int error = 0;
 
-	if ((bs = pbs_statrsc(pbs_sd, NULL, NULL, "p")) == NULL) {
+	if ((bs = snapshot_stat(pbs_sd, SNAP_RESOURCES)) == NULL) {
 		errmsg = pbs_geterrmsg(pbs_sd);
 		if (errmsg == NULL)
 			errmsg = "";
@@ -223,6 +225,11 @@ query_resources(int pbs_sd)
 		free_resdef_array(defarr);
 		return NULL;
 	}
+
+	/* resource lists use this ordinal to index their resources */
+	for (i = 0; defarr[i] != NULL; i++)
+		defarr[i]->ind = i;
+
 	return defarr;
 }
 
@@ -329,6 +336,7 @@ new_resdef(void)
 	}
 
 	newdef->name = NULL;
+	newdef->ind = -1;
 	/* calloc will have zeroed flags and the type structure */
 
 	return newdef;
@@ -354,6 +362,7 @@ dup_resdef(resdef *olddef)
 
 	newdef->type = olddef->type;
 	newdef->flags = olddef->flags;
+	newdef->ind = olddef->ind;
 	newdef->name = string_dup(olddef->name);
 
 	if (newdef->name == NULL) {
@@ -574,6 +583,8 @@ reset_global_resource_ptrs(void)
 		free(consres);
 		consres = NULL;
 	}
+	/* compiled formulas reference consres */
+	clear_formula_cache();
 	if (boolres != NULL) {
 		free(boolres);
 		boolres = NULL;
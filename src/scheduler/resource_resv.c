@@ -76,6 +76,7 @@
  * 	new_place()
  * 	free_place()
  * 	dup_place()
+ * 	share_place()
  * 	new_chunk()
  * 	dup_chunk_array()
  * 	dup_chunk()
@@ -83,6 +84,7 @@
  * 	free_chunk()
  * 	new_selspec()
  * 	dup_selspec()
+ * 	share_selspec()
  * 	free_selspec()
  * 	compare_res_to_str()
  * 	compare_non_consumable()
@@ -373,8 +375,8 @@ dup_resource_resv(resource_resv *oresresv,
 	nresresv->project = string_dup(oresresv->project);
 
 	nresresv->nodepart_name = string_dup(oresresv->nodepart_name);
-	nresresv->select = dup_selspec(oresresv->select);
-	nresresv->execselect = dup_selspec(oresresv->execselect);
+	nresresv->select = share_selspec(oresresv->select);
+	nresresv->execselect = share_selspec(oresresv->execselect);
 
 	nresresv->is_invalid = oresresv->is_invalid;
 	nresresv->can_not_fit = oresresv->can_not_fit;
@@ -400,7 +402,7 @@ dup_resource_resv(resource_resv *oresresv,
 
 	nresresv->resreq = dup_resource_req_list(oresresv->resreq);
 
-	nresresv->place_spec = dup_place(oresresv->place_spec);
+	nresresv->place_spec = share_place(oresresv->place_spec);
 
 	nresresv->aoename = string_dup(oresresv->aoename);
 	nresresv->eoename = string_dup(oresresv->eoename);
@@ -1618,13 +1620,15 @@ new_place()
 	pl->exclhost = 0;
 
 	pl->group = NULL;
+	pl->refct = 1;
 
 	return pl;
 }
 
 /**
  * @brief
- *		free_place - free a placement spec
+ *		free_place - free a placement spec.  Only the last reference
+ *			     taken by share_place() frees the spec
  *
  * @param[in,out]	pl	-	the placement spec to free
  *
@@ -1637,6 +1641,9 @@ free_place(place *pl)
 	if (pl == NULL)
 		return;
 
+	if (--pl->refct > 0)
+		return;
+
 	if (pl->group != NULL)
 		free(pl->group);
 
@@ -1678,6 +1685,29 @@ dup_place(place *pl)
 	return newpl;
 }
 
+/**
+ * @brief
+ *		share_place - take another reference to a placement spec.
+ *
+ * @par	A place is never modified once it is parsed, so copies of a
+ *		resource_resv can point at the same one.  The spec is freed when
+ *		the last owner calls free_place().  Use dup_place() for a
+ *		private copy that will be modified.
+ *
+ * @param[in]	pl	-	the place structure to share
+ *
+ * @return	pl
+ *
+ */
+place *
+share_place(place *pl)
+{
+	if (pl != NULL)
+		pl->refct++;
+
+	return pl;
+}
+
 /**
  * @brief
  *		new_chunk - constructor for chunk
@@ -1844,6 +1874,7 @@ new_selspec()
 	spec->total_cpus = 0;
 	spec->defs = NULL;
 	spec->chunks = NULL;
+	spec->refct = 1;
 
 	return spec;
 }
@@ -1885,7 +1916,30 @@ dup_selspec(selspec *oldspec)
 
 /**
  * @brief
- *		free_selspec - destructor for selspec
+ *		share_selspec - take another reference to a selspec.
+ *
+ * @par	Select specs are read only after parse_selspec(), so the copies
+ *		made by dup_server_info() for simulation and preemption share
+ *		them instead of copying every chunk.  Callers that need to
+ *		modify a spec must use dup_selspec() instead.
+ *
+ * @param[in]	spec	-	selspec to share
+ *
+ * @return	spec
+ */
+selspec *
+share_selspec(selspec *spec)
+{
+	if (spec != NULL)
+		spec->refct++;
+
+	return spec;
+}
+
+/**
+ * @brief
+ *		free_selspec - destructor for selspec.  Only the last reference
+ *			       taken by share_selspec() frees the spec
  *
  * @param[in,out]	spec	-	selspec to be freed.
  */
@@ -1895,6 +1949,9 @@ free_selspec(selspec *spec)
 	if (spec == NULL)
 		return;
 
+	if (--spec->refct > 0)
+		return;
+
 	if (spec->defs != NULL)
 		free(spec->defs);
 
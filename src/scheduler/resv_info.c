@@ -85,6 +85,7 @@
 #include "constant.h"
 #include "node_partition.h"
 #include "pbs_internal.h"
+#include "snapshot.h"
 
 
 /**
@@ -103,7 +104,7 @@ stat_resvs(int pbs_sd)
 	char *errmsg;
 
 	/* get the reservation info from the PBS server */
-	if ((resvs = pbs_statresv(pbs_sd, NULL, NULL, NULL)) == NULL) {
+	if ((resvs = snapshot_stat(pbs_sd, SNAP_RESVS)) == NULL) {
 		if (pbs_errno) {
 			errmsg = pbs_geterrmsg(pbs_sd);
 			if (errmsg == NULL)
@@ -1157,7 +1158,7 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
  * 		mark the timed event associated to a resource reservation at a given time as
  * 		disabled.
  *
- * @param[in]	events	-	the event which to be disabled in the calendar.
+ * @param[in]	calendar	-	the calendar holding the events to disable
  * @param[in]	resv	-	the resource reservation being disabled
  *
  * @return	int
@@ -1165,18 +1166,18 @@ check_new_reservations(status *policy, int pbs_sd, resource_resv **resvs, server
  * @retval	0	: on failure
  */
 static int
-disable_reservation_occurrence(timed_event *events,
+disable_reservation_occurrence(event_list *calendar,
 	resource_resv *resv)
 {
 	timed_event *te;
 
-	te = find_timed_event(events, resv->name, TIMED_RUN_EVENT, resv->start);
+	te = find_calendar_event(calendar, resv->name, TIMED_RUN_EVENT, resv->start);
 	if (te != NULL)
 		set_timed_event_disabled(te, 1);
 	else
 		return 0;
 
-	te = find_timed_event(events, resv->name, TIMED_END_EVENT, resv->end);
+	te = find_calendar_event(calendar, resv->name, TIMED_END_EVENT, resv->end);
 	if (te != NULL)
 		set_timed_event_disabled(te, 1);
 	else
@@ -1424,7 +1425,7 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 				}
 				continue;
 			}
-			if (disable_reservation_occurrence(nsinfo->calendar->events, nresv)
+			if (disable_reservation_occurrence(nsinfo->calendar, nresv)
 				!= 1) {
 				schdlog(PBSEVENT_RESV, PBS_EVENTCLASS_RESV, LOG_INFO, nresv->name,
 					"Error determining if reservation can be confirmed: "
@@ -1437,7 +1438,7 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 			nresv->resv->resv_state = RESV_UNCONFIRMED;
 		}
 		if (nresv->resv->req_start ==PBS_RESV_FUTURE_SCH) { /* ASAP Resv */
-			resv_start_time = calc_run_time(nresv->name, nsinfo, NO_FLAGS);
+			resv_start_time = calc_run_time(nresv->name, nsinfo, 0, NO_FLAGS);
 			/* Update occr_start_arr used to update the real sinfo structure */
 			occr_start_arr[j] = resv_start_time;
 		}
@@ -1537,8 +1538,9 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 		/* Send a reservation confirm message, if anything goes wrong pbsrc
 		 * will return an error
 		 */
-		pbsrc = pbs_confirmresv(pbs_sd, nresv_parent->name, short_xc,
-			resv_start_time, PBS_RESV_CONFIRM_SUCCESS);
+		if (pbs_sd != SIMULATE_SD)
+			pbsrc = pbs_confirmresv(pbs_sd, nresv_parent->name, short_xc,
+				resv_start_time, PBS_RESV_CONFIRM_SUCCESS);
 	}
 	else {
 		/* This message is sent to inform that we could not confirm the reservation.
@@ -1546,8 +1548,9 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 		 * "null" is used satisfy the API but any string would do because we've
 		 * failed to confirm the reservation and no execvnodes were determined
 		 */
-		pbsrc = pbs_confirmresv(pbs_sd, nresv_parent->name, "null",
-			resv_start_time, PBS_RESV_CONFIRM_FAIL);
+		if (pbs_sd != SIMULATE_SD)
+			pbsrc = pbs_confirmresv(pbs_sd, nresv_parent->name, "null",
+				resv_start_time, PBS_RESV_CONFIRM_FAIL);
 	}
 
 	/* Error handling first checks for the return code from the server and the
@@ -1555,7 +1558,7 @@ confirm_reservation(status *policy, int pbs_sd, resource_resv *unconf_resv, serv
 	 * we print success
 	 */
 	if (pbsrc > 0 || rconf == RESV_CONFIRM_FAIL) {
-		errmsg = pbs_geterrmsg(pbs_sd);
+		errmsg = (pbs_sd == SIMULATE_SD) ? NULL : pbs_geterrmsg(pbs_sd);
 		if (errmsg == NULL)
 			errmsg = "";
 
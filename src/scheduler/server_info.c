@@ -143,6 +143,8 @@
 #include "pbs_sched.h"
 #include "fifo.h"
 #include "buckets.h"
+#include "job_cache.h"
+#include "snapshot.h"
 #ifdef NAS
 #include "site_code.h"
 #endif
@@ -195,7 +197,7 @@ query_server(status *pol, int pbs_sd)
 	}
 
 	/* get server information from pbs server */
-	if ((server = pbs_statserver(pbs_sd, NULL, NULL)) == NULL) {
+	if ((server = snapshot_stat(pbs_sd, SNAP_SERVER)) == NULL) {
 		errmsg = pbs_geterrmsg(pbs_sd);
 		if (errmsg == NULL)
 			errmsg = "";
@@ -223,8 +225,9 @@ query_server(status *pol, int pbs_sd)
 		free_server( sinfo, 0 );
 		return NULL;
 	}
+	index_resource_list(sinfo->res);
 
-	sched = pbs_statsched(pbs_sd, NULL, NULL);
+	sched = snapshot_stat(pbs_sd, SNAP_SCHED);
 	sched = bs_find(sched, sc_name);
 
 	if (sched == NULL) {
@@ -267,12 +270,19 @@ query_server(status *pol, int pbs_sd)
 		free_server(sinfo, 0);
 		return NULL;
 	}
+	sinfo->node_idx = create_node_name_index(sinfo->nodes);
 
 	/* sort the nodes before we filter them down to more useful lists */
 	if (policy->node_sort[0].res_name != NULL)
 		qsort(sinfo->nodes, sinfo->num_nodes, sizeof(node_info *),
 			multi_node_sort);
 
+	/* bring the cross-cycle job status cache up to date before the
+	 * queues query their jobs out of it
+	 */
+	if (!snapshot_replaying())
+		jcache_refresh(pbs_sd, sinfo);
+
 	/* get the queues */
 	if ((sinfo->queues = query_queues(policy, pbs_sd, sinfo)) == NULL) {
 		pbs_statfree(server);
@@ -646,6 +656,17 @@ query_server_info(status *pol, struct batch_status *server)
 			if (count == 0)
 				sinfo->policy->backfill = 0;
 		}
+		else if (!strcmp(attrp->name, ATTR_job_chgseq))
+			sinfo->job_chgseq = string_dup(attrp->value);
+		else if (!strcmp(attrp->name, ATTR_multijob_reqs)) {
+			char **reqs;
+			reqs = break_comma_list(attrp->value);
+			if (reqs != NULL) {
+				sinfo->has_modifyjobs = find_string(reqs, MULTIJOB_REQ_MODIFY);
+				sinfo->has_runjobs = find_string(reqs, MULTIJOB_REQ_RUN);
+				free_string_array(reqs);
+			}
+		}
 		else if(!strcmp(attrp->name, ATTR_restrict_res_to_release_on_suspend)) {
 			char **resl;
 			resl = break_comma_list(attrp->value);
@@ -880,8 +901,15 @@ find_alloc_resource(schd_resource *resplist, resdef *def)
 	if (def == NULL)
 		return NULL;
 
-	for (resp = resplist; resp != NULL && resp->def != def; resp = resp->next) {
-		prev = resp;
+	if (resplist != NULL && resplist->def_ind != NULL) {
+		if ((resp = find_resource(resplist, def)) != NULL)
+			return resp;
+		for (prev = resplist; prev->next != NULL; prev = prev->next)
+			;
+	} else {
+		for (resp = resplist; resp != NULL && resp->def != def; resp = resp->next) {
+			prev = resp;
+		}
 	}
 
 	if (resp == NULL) {
@@ -892,8 +920,10 @@ find_alloc_resource(schd_resource *resplist, resdef *def)
 		resp->type = def->type;
 		resp->name = def->name;
 
-		if (prev != NULL)
+		if (prev != NULL) {
 			prev->next = resp;
+			add_resource_to_index(resplist, resp);
+		}
 	}
 
 	return resp;
@@ -930,8 +960,10 @@ find_alloc_resource_by_str(schd_resource *resplist, char *name)
 		if ((resp = create_resource(name, NULL, RF_NONE)) == NULL)
 			return NULL;
 
-		if (prev != NULL)
+		if (prev != NULL) {
 			prev->next = resp;
+			add_resource_to_index(resplist, resp);
+		}
 	}
 
 	return resp;
@@ -982,6 +1014,14 @@ find_resource(schd_resource *reslist, resdef *def)
 	if (reslist == NULL || def == NULL)
 		return NULL;
 
+	if (reslist->def_ind != NULL && def->ind >= 0 &&
+		def->ind < reslist->def_ind_size) {
+		resp = reslist->def_ind[def->ind];
+		/* the slot should always match; if not, fall back to the list walk */
+		if (resp == NULL || resp->def == def)
+			return resp;
+	}
+
 	resp = reslist;
 
 	while (resp != NULL && resp->def != def)
@@ -1049,6 +1089,8 @@ free_server_info(server_info *sinfo)
 		free_string_array(sinfo->node_group_key);
 	if (sinfo->job_formula != NULL)
 		free(sinfo->job_formula);
+	if (sinfo->job_chgseq != NULL)
+		free(sinfo->job_chgseq);
 	if (sinfo->calendar != NULL)
 		free_event_list(sinfo->calendar);
 	if (sinfo->policy != NULL)
@@ -1071,6 +1113,11 @@ free_server_info(server_info *sinfo)
 	if(sinfo->unordered_nodes != NULL)
 		free(sinfo->unordered_nodes);
 
+	if (sinfo->node_idx != NULL) {
+		avl_destroy_index(sinfo->node_idx);
+		free(sinfo->node_idx);
+	}
+
 	free_resource_list(sinfo->res);
 #ifdef NAS
 	/* localmod 034 */
@@ -1083,6 +1130,73 @@ free_server_info(server_info *sinfo)
 	free(sinfo);
 }
 
+/**
+ * @brief
+ * 		index_resource_list - index a resource list by resource definition.
+ *		The index lives on the head of the list and is used by
+ *		find_resource().  Resources added through find_alloc_resource(),
+ *		find_alloc_resource_by_str() and add_resource_list() are added to
+ *		the index.  A list which is linked by hand must be reindexed.
+ *
+ * @param[in,out]	reslist	-	the resource list to index
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure, the list can still be searched linearly
+ *
+ * @par MT-Safe:	no
+ */
+int
+index_resource_list(schd_resource *reslist)
+{
+	schd_resource *resp;
+	int size;
+
+	if (reslist == NULL || allres == NULL)
+		return 0;
+
+	size = count_array((void **) allres);
+
+	if (reslist->def_ind != NULL)
+		free(reslist->def_ind);
+	reslist->def_ind_size = 0;
+
+	if ((reslist->def_ind = calloc(size, sizeof(schd_resource *))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	reslist->def_ind_size = size;
+
+	for (resp = reslist; resp != NULL; resp = resp->next)
+		add_resource_to_index(reslist, resp);
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		add_resource_to_index - add a resource to the index of the
+ *		resource list it was just appended to
+ *
+ * @param[in,out]	reslist	-	the head of the resource list
+ * @param[in]	res	-	the resource which was appended
+ *
+ * @return	void
+ *
+ * @par MT-Safe:	no
+ */
+void
+add_resource_to_index(schd_resource *reslist, schd_resource *res)
+{
+	if (reslist == NULL || reslist->def_ind == NULL ||
+		res == NULL || res->def == NULL)
+		return;
+
+	if (res->def->ind >= 0 && res->def->ind < reslist->def_ind_size &&
+		reslist->def_ind[res->def->ind] == NULL)
+		reslist->def_ind[res->def->ind] = res;
+}
+
 /**
  * @brief
  *		free_resource_list - frees the memory used by a resource list
@@ -1135,6 +1249,9 @@ free_resource(schd_resource *resp)
 	if (resp->str_assigned != NULL)
 		free(resp->str_assigned);
 
+	if (resp->def_ind != NULL)
+		free(resp->def_ind);
+
 	free(resp);
 }
 
@@ -1182,6 +1299,8 @@ new_server_info(int limallocflag)
 	sinfo->has_nonCPU_licenses = 0;
 	sinfo->enforce_prmptd_job_resumption = 0;
 	sinfo->use_hard_duration = 0;
+	sinfo->has_modifyjobs = 0;
+	sinfo->has_runjobs = 0;
 	sinfo->sched_cycle_len = 0;
 	sinfo->num_parts = 0;
 	sinfo->partitions = NULL;
@@ -1215,16 +1334,19 @@ new_server_info(int limallocflag)
 	sinfo->npc_arr = NULL;
 	sinfo->qrun_job = NULL;
 	sinfo->job_formula = NULL;
+	sinfo->job_chgseq = NULL;
 	sinfo->policy = NULL;
 	sinfo->fairshare = NULL;
 	sinfo->equiv_classes = NULL;
 	sinfo->buckets = NULL;
 	sinfo->unordered_nodes = NULL;
+	sinfo->node_idx = NULL;
 	sinfo->num_queues = 0;
 	sinfo->num_nodes = 0;
 	sinfo->num_resvs = 0;
 	sinfo->num_hostsets = 0;
 	sinfo->flt_lic = 0;
+	sinfo->release_gen = 0;
 	sinfo->server_time = 0;
 
 	if ((limallocflag != 0))
@@ -1378,6 +1500,7 @@ add_resource_list(status *policy, schd_resource *r1, schd_resource *r2, unsigned
 				if (end_r1->next == NULL)
 					return 0;
 				end_r1 = end_r1->next;
+				add_resource_to_index(r1, end_r1);
 			}
 		} else if (cur_r1->type.is_consumable) {
 			if ((flags & ADD_AVAIL_ASSIGNED)) {
@@ -1419,6 +1542,7 @@ add_resource_list(status *policy, schd_resource *r1, schd_resource *r2, unsigned
 								;
 						end_r1->next = nres;
 						end_r1 = nres;
+						add_resource_to_index(r1, nres);
 					} else {
 						nres = false_res();
 						nres->name = boolres[i]->name;
@@ -2108,6 +2232,8 @@ dup_server_info(server_info *osinfo)
 	nsinfo->has_nonCPU_licenses = osinfo->has_nonCPU_licenses;
 	nsinfo->enforce_prmptd_job_resumption = osinfo->enforce_prmptd_job_resumption;
 	nsinfo->use_hard_duration = osinfo->use_hard_duration;
+	nsinfo->has_modifyjobs = osinfo->has_modifyjobs;
+	nsinfo->has_runjobs = osinfo->has_runjobs;
 	nsinfo->sched_cycle_len = osinfo->sched_cycle_len;
 	nsinfo->partitions = dup_string_array(osinfo->partitions);
 	nsinfo->opt_backfill_fuzzy_time = osinfo->opt_backfill_fuzzy_time;
@@ -2116,6 +2242,7 @@ dup_server_info(server_info *osinfo)
 	nsinfo->liminfo = lim_dup_liminfo(osinfo->liminfo);
 	nsinfo->server_time = osinfo->server_time;
 	nsinfo->flt_lic = osinfo->flt_lic;
+	nsinfo->release_gen = osinfo->release_gen;
 	nsinfo->res = dup_resource_list(osinfo->res);
 	nsinfo->alljobcounts = dup_counts_list(osinfo->alljobcounts);
 	nsinfo->group_counts = dup_counts_list(osinfo->group_counts);
@@ -2127,6 +2254,7 @@ dup_server_info(server_info *osinfo)
 	nsinfo->total_user_counts = dup_counts_list(osinfo->total_user_counts);
 	nsinfo->node_group_key = dup_string_array(osinfo->node_group_key);
 	nsinfo->job_formula = string_dup(osinfo->job_formula);
+	nsinfo->job_chgseq = string_dup(osinfo->job_chgseq);
 	nsinfo->nodesigs = dup_string_array(osinfo->nodesigs);
 
 	nsinfo->policy = dup_status(osinfo->policy);
@@ -2147,6 +2275,7 @@ dup_server_info(server_info *osinfo)
 		nsinfo->unassoc_nodes = nsinfo->nodes;
 	
 	nsinfo->unordered_nodes = dup_unordered_nodes(osinfo->unordered_nodes, nsinfo->nodes);
+	nsinfo->node_idx = create_node_name_index(nsinfo->nodes);
 
 	/* dup the reservations */
 	nsinfo->resvs = dup_resource_resv_array(osinfo->resvs, nsinfo, NULL);
@@ -2265,7 +2394,7 @@ dup_server_info(server_info *osinfo)
 			copy_resresv_array(osinfo->nodes[i]->run_resvs_arr,
 			nsinfo->resvs);
 		if(nsinfo->calendar != NULL)
-			nsinfo->nodes[i]->node_events = dup_te_lists(osinfo->nodes[i]->node_events, nsinfo->calendar->next_event);
+			nsinfo->nodes[i]->node_events = dup_te_lists(osinfo->nodes[i]->node_events, nsinfo->calendar);
 
 	}
 	nsinfo->buckets = dup_node_bucket_array(osinfo->buckets, nsinfo);
@@ -2302,6 +2431,9 @@ dup_resource_list(schd_resource *res)
 		prev = nres;
 	}
 
+	if (res != NULL && res->def_ind != NULL)
+		index_resource_list(head);
+
 	return head;
 }
 /**
@@ -2365,6 +2497,10 @@ dup_selective_resource_list(schd_resource *res, resdef **deflist, unsigned flags
 			}
 		}
 	}
+
+	if (res != NULL && res->def_ind != NULL)
+		index_resource_list(head);
+
 	return head;
 }
 
@@ -2407,6 +2543,9 @@ dup_ind_resource_list(schd_resource *res)
 		prev = nres;
 	}
 
+	if (res != NULL && res->def_ind != NULL)
+		index_resource_list(head);
+
 	return head;
 }
 
@@ -2500,6 +2639,8 @@ new_counts(void)
 	cts->running = 0;
 	cts->rescts = NULL;
 	cts->next = NULL;
+	cts->name_idx = NULL;
+	cts->tail = NULL;
 
 	return cts;
 }
@@ -2526,6 +2667,11 @@ free_counts(counts *cts)
 	if (cts->rescts != NULL)
 		free_resource_req_list(cts->rescts);
 
+	if (cts->name_idx != NULL) {
+		avl_destroy_index(cts->name_idx);
+		free(cts->name_idx);
+	}
+
 	cts->next = NULL;
 
 	free(cts);
@@ -2623,6 +2769,46 @@ dup_counts_list(counts *ctslist)
 	return nhead;
 }
 
+/**
+ * @brief
+ * 		index_counts_list - build a name index on the head of a counts list.
+ *		The index and the tail pointer are kept up to date by
+ *		find_alloc_counts() as the list grows.
+ *
+ * @param[in,out]	ctslist - the counts list to index
+ *
+ * @return	int
+ * @retval	1	: index built
+ * @retval	0	: error, the list can still be searched linearly
+ *
+ * @par MT-Safe:	no
+ */
+static int
+index_counts_list(counts *ctslist)
+{
+	counts *cur;
+	AVL_IX_DESC *idx;
+
+	if ((idx = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+
+	for (cur = ctslist; cur != NULL; cur = cur->next) {
+		/* a duplicate name keeps the first entry, as a list walk would */
+		if (find_tree(idx, cur->name) == NULL &&
+			tree_add_del(idx, cur->name, cur, TREE_OP_ADD) != 0) {
+			avl_destroy_index(idx);
+			free(idx);
+			return 0;
+		}
+		ctslist->tail = cur;
+	}
+	ctslist->name_idx = idx;
+
+	return 1;
+}
+
 /**
  * @brief
  * 		find_counts - find a counts structure by name
@@ -2639,15 +2825,22 @@ counts *
 find_counts(counts *ctslist, char *name)
 {
 	counts *cur;
+	int i;
 
 	if (ctslist == NULL || name == NULL)
 		return NULL;
 
+	if (ctslist->name_idx != NULL)
+		return find_tree(ctslist->name_idx, name);
+
 	cur = ctslist;
 
-	while (cur != NULL && strcmp(cur->name, name))
+	for (i = 0; cur != NULL && strcmp(cur->name, name); i++)
 		cur = cur->next;
 
+	if (i > COUNTS_INDEX_MIN)
+		index_counts_list(ctslist);
+
 	return cur;
 }
 
@@ -2669,25 +2862,45 @@ find_alloc_counts(counts *ctslist, char *name)
 {
 	counts *cur, *prev;
 	counts *new;
+	int i;
 
 	if (name == NULL)
 		return NULL;
 
-	prev = cur = ctslist;
+	if (ctslist != NULL && ctslist->name_idx != NULL) {
+		cur = find_tree(ctslist->name_idx, name);
+		prev = ctslist->tail;
+	} else {
+		prev = cur = ctslist;
 
-	while (cur != NULL && strcmp(cur->name, name)) {
-		prev = cur;
-		cur = cur->next;
+		for (i = 0; cur != NULL && strcmp(cur->name, name); i++) {
+			prev = cur;
+			cur = cur->next;
+		}
+
+		if (i > COUNTS_INDEX_MIN)
+			index_counts_list(ctslist);
 	}
 
 	if (cur == NULL) {
 		new = new_counts();
 
-		if (new != NULL)
+		if (new != NULL) {
 			new->name = string_dup(name);
 
-		if (prev != NULL)
-			prev->next = new;
+			if (prev != NULL) {
+				prev->next = new;
+				if (ctslist->name_idx != NULL) {
+					ctslist->tail = new;
+					if (tree_add_del(ctslist->name_idx, new->name, new, TREE_OP_ADD) != 0) {
+						/* fall back to walking the list */
+						avl_destroy_index(ctslist->name_idx);
+						free(ctslist->name_idx);
+						ctslist->name_idx = NULL;
+					}
+				}
+			}
+		}
 
 		return new;
 	}
@@ -2909,6 +3122,8 @@ update_universe_on_end(status *policy, resource_resv *resresv, char *job_state,
 		for (i = 0; resresv->ninfo_arr[i] != NULL; i++)
 			update_node_on_end(resresv->ninfo_arr[i], resresv, job_state);
 	}
+	/* resources were freed, remembered placement failures no longer hold */
+	sinfo->release_gen++;
 
 
 	update_server_on_end(policy, sinfo, qinfo, resresv, job_state);
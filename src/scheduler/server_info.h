@@ -92,6 +92,16 @@ schd_resource *find_resource_by_str(schd_resource *reslist, const char *name);
  */
 schd_resource *find_resource(schd_resource *reslist, resdef *def);
 
+/*
+ *	index_resource_list - index a resource list by resource definition
+ */
+int index_resource_list(schd_resource *reslist);
+
+/*
+ *	add_resource_to_index - add an appended resource to its list's index
+ */
+void add_resource_to_index(schd_resource *reslist, schd_resource *res);
+
 /*
  *	free_server_info - free the space used by a server_info structure
  */
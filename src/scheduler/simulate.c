@@ -53,6 +53,7 @@
  * 	find_prev_timed_event()
  * 	set_timed_event_disabled()
  * 	find_timed_event()
+ * 	find_calendar_event()
  * 	perform_event()
  * 	exists_run_event()
  * 	calc_run_time()
@@ -107,6 +108,8 @@
 #include "globals.h"
 #include "check.h"
 #include "buckets.h"
+#include "usage_profile.h"
+#include "start_horizon.h"
 #ifdef NAS /* localmod 030 */
 #include "site_code.h"
 #endif /* localmod 030 */
@@ -130,6 +133,15 @@ static const struct policy_change_func_name policy_change_func_name[] =
 	{NULL, NULL}
 };
 
+/* bumped whenever an event is added to, removed from, enabled or disabled
+ * in any calendar.  Used to validate the cached run event of a calendar.
+ */
+static unsigned long calendar_generation = 1;
+
+static void event_time_key(time_t t, unsigned char *key);
+static int link_calendar_event(event_list *calendar, timed_event *te, int append);
+static void unlink_calendar_event(event_list *calendar, timed_event *te);
+
 
 /**
  * @brief
@@ -470,6 +482,7 @@ set_timed_event_disabled(timed_event *te, int disabled)
 		return;
 
 	te->disabled = disabled ? 1 : 0;
+	calendar_generation++;
 }
 
 /**
@@ -521,6 +534,73 @@ find_timed_event(timed_event *te_list, char *name,
 
 	return te;
 }
+
+/**
+ * @brief
+ * 		find a timed_event in a calendar.  Works like find_timed_event()
+ *		over the whole calendar, but uses the calendar's name and time
+ *		indexes instead of walking the event list.
+ *
+ * @param[in]	calendar	- calendar to search in
+ * @param[in] 	name    	- name of timed_event to search or NULL to ignore
+ * @param[in] 	event_type 	- event_type or TIMED_NOEVENT to ignore
+ * @param[in] 	event_time 	- time or 0 to ignore
+ *
+ * @par NOTE:
+ *			If more than one event matches, the first one in the
+ *			calendar is returned
+ *
+ * @return	found timed_event
+ * @retval	NULL	: not found or on error
+ *
+ */
+timed_event *
+find_calendar_event(event_list *calendar, char *name,
+	enum timed_event_types event_type, time_t event_time)
+{
+	timed_event *te;
+	timed_event *cur;
+	timed_event *found = NULL;
+	event_time_slot *slot;
+	unsigned char key[EVENT_TIME_KEY_LEN];
+
+	if (calendar == NULL || calendar->events == NULL)
+		return NULL;
+
+	if (name != NULL) {
+		for (te = find_tree(calendar->name_index, name); te != NULL; te = te->name_next) {
+			if (event_type != TIMED_NOEVENT && te->event_type != event_type)
+				continue;
+			if (event_time != 0 && te->event_time != event_time)
+				continue;
+			if (found == NULL || te->event_time < found->event_time)
+				found = te;
+			else if (te->event_time == found->event_time) {
+				/* same time, keep whichever comes first in the calendar */
+				for (cur = found->next; cur != NULL && cur != te &&
+					cur->event_time == found->event_time; cur = cur->next)
+					;
+				if (cur != te)
+					found = te;
+			}
+		}
+		return found;
+	}
+
+	if (event_time != 0) {
+		event_time_key(event_time, key);
+		slot = find_tree(calendar->time_index, key);
+		if (slot == NULL)
+			return NULL;
+		for (te = slot->first; te != slot->last->next; te = te->next) {
+			if (event_type == TIMED_NOEVENT || te->event_type == event_type)
+				return te;
+		}
+		return NULL;
+	}
+
+	return find_timed_event(calendar->events, NULL, event_type, 0);
+}
 /**
  * @brief
  * 		takes a timed_event and performs any actions
@@ -612,6 +692,9 @@ perform_event(status *policy, timed_event *event)
  * @retval	1	: there exists a run event
  * @retval	0	: there doesn't exist a run event
  *
+ * @par MT-safe: only once the run event of the calendar has been cached
+ *		by a call since the calendar last changed
+ *
  */
 int
 exists_run_event(event_list *calendar, time_t end)
@@ -626,7 +709,17 @@ exists_run_event(event_list *calendar, time_t end)
 	if (te == NULL) /* no events in our calendar */
 		return 0;
 
-	te = find_init_timed_event(te, IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT);
+	/* This is called for every node a job is checked against.  The first
+	 * run event only changes when the calendar does, so cache it.
+	 */
+	if (calendar->run_event_from != te ||
+		calendar->run_event_gen != calendar_generation) {
+		calendar->run_event = find_init_timed_event(te,
+			IGNORE_DISABLED_EVENTS, TIMED_RUN_EVENT);
+		calendar->run_event_from = te;
+		calendar->run_event_gen = calendar_generation;
+	}
+	te = calendar->run_event;
 
 	if (te == NULL) /* no run event */
 		return 0;
@@ -680,6 +773,10 @@ exists_resv_event(event_list *calendar, time_t end)
  * @param[in] name 	- the name of the resresv to find the start time of
  * @param[in] sinfo - the pbs environment
  * 					  NOTE: sinfo will be modified, it should be a copy
+ * @param[in] earliest - the resresv can not run before the events at this
+ *			 time (see start_horizon_earliest()), so whether it
+ *			 can run is not checked until then.  0 to check at
+ *			 every event
  * @param[in] flags - some flags to control the function
  *						SIM_RUN_JOB - simulate running the resresv
  *
@@ -690,7 +787,7 @@ exists_resv_event(event_list *calendar, time_t end)
  *
  */
 time_t
-calc_run_time(char *name, server_info *sinfo, int flags)
+calc_run_time(char *name, server_info *sinfo, time_t earliest, int flags)
 {
 	time_t event_time = (time_t) 0;	/* time of the simulated event */
 	event_list *calendar;		/* calendar we are simulating in */
@@ -706,6 +803,7 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 	nspec **ns = NULL;
 	unsigned int ok_flags = NO_ALLPART;
 	queue_info *qinfo = NULL;
+	int skipped = 0;		/* a check was skipped since the last one */
 
 	if (name == NULL || sinfo == NULL)
 		return (time_t) -1;
@@ -735,7 +833,10 @@ calc_run_time(char *name, server_info *sinfo, int flags)
 		 */
 
 		desc = describe_simret(ret);
-		if (desc > 0 || (desc == 0 && policy_change_info(sinfo, resresv))) {
+		if (event_time < earliest)
+			skipped = 1;	/* not enough resources can be free yet */
+		else if (skipped || desc > 0 || (desc == 0 && policy_change_info(sinfo, resresv))) {
+			skipped = 0;
 			clear_schd_error(err);
 			ns = is_ok_to_run(sinfo->policy, sinfo, qinfo, resresv, ok_flags, err);
 		}
@@ -825,7 +926,12 @@ create_event_list(server_info *sinfo)
 	if (elist == NULL)
 		return NULL;
 
-	elist->events = create_events(sinfo);
+	if (create_events(sinfo, elist) == 0) {
+		/* start over with an empty calendar */
+		free_event_list(elist);
+		if ((elist = new_event_list()) == NULL)
+			return NULL;
+	}
 
 	elist->next_event = elist->events;
 	elist->current_time = &sinfo->server_time;
@@ -836,18 +942,20 @@ create_event_list(server_info *sinfo)
 
 /**
  * @brief
- *		create_events - creates an timed_event list from running jobs
- *			    and confirmed reservations
+ *		create_events - creates the timed_events of a calendar from
+ *			    running jobs and confirmed reservations
  *
  * @param[in] sinfo - server universe to act upon
+ * @param[in,out] elist - calendar to add the events to
  *
- * @return	timed_event list
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
  *
  */
-timed_event *
-create_events(server_info *sinfo)
+int
+create_events(server_info *sinfo, event_list *elist)
 {
-	timed_event	*events = NULL;
 	timed_event	*te = NULL;
 	resource_resv	**all = NULL;
 	int		errflag = 0;
@@ -871,11 +979,11 @@ create_events(server_info *sinfo)
 		 */
 		if (in_runnable_state(all[i])) {
 			te = create_event(TIMED_RUN_EVENT, all[i]->start, all[i], NULL, NULL);
-			if (te == NULL) {
+			if (te == NULL || link_calendar_event(elist, te, 0) == 0) {
+				free_timed_event(te);
 				errflag++;
 				break;
 			}
-			events = add_timed_event(events, te);
 		}
 
 		if (sinfo->use_hard_duration)
@@ -883,11 +991,11 @@ create_events(server_info *sinfo)
 		else
 			end = all[i]->end;
 		te = create_event(TIMED_END_EVENT, end, all[i], NULL, NULL);
-		if (te == NULL) {
+		if (te == NULL || link_calendar_event(elist, te, 0) == 0) {
+			free_timed_event(te);
 			errflag++;
 			break;
 		}
-		events = add_timed_event(events, te);
 	}
 
 	/* for nodes that are in state=sleep add a timed event */
@@ -896,19 +1004,18 @@ create_events(server_info *sinfo)
 		if (node->is_sleeping) {
 			te = create_event(TIMED_NODE_UP_EVENT, sinfo->server_time + PROVISION_DURATION,
 					(event_ptr_t *) node, (event_func_t) node_up_event, NULL);
-			if (te == NULL)
+			if (te == NULL || link_calendar_event(elist, te, 0) == 0) {
+				free_timed_event(te);
 				return 0;
-			events = add_timed_event(events, te);
+			}
 		}
 	}
 
-	/* A malloc error was encountered, free all allocated memory and return */
-	if (errflag > 0) {
-		free_timed_event_list(events);
+	/* A malloc error was encountered, the caller frees the calendar */
+	if (errflag > 0)
 		return 0;
-	}
 
-	return events;
+	return 1;
 }
 
 /**
@@ -931,7 +1038,21 @@ new_event_list()
 	elist->eol = 0;
 	elist->events = NULL;
 	elist->next_event = NULL;
+	elist->last_event = NULL;
 	elist->current_time = NULL;
+	elist->run_event_from = NULL;
+	elist->run_event = NULL;
+	elist->run_event_gen = 0;
+	elist->gen = 0;
+	elist->usage_prof = NULL;
+	elist->horizon = NULL;
+	elist->time_index = create_tree(AVL_NO_DUP_KEYS, EVENT_TIME_KEY_LEN);
+	elist->name_index = create_tree(AVL_NO_DUP_KEYS, 0);
+	if (elist->time_index == NULL || elist->name_index == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_event_list(elist);
+		return NULL;
+	}
 
 	return elist;
 }
@@ -950,6 +1071,8 @@ event_list *
 dup_event_list(event_list *oelist, server_info *nsinfo)
 {
 	event_list *nelist;
+	timed_event *ote;
+	timed_event *nte;
 
 	if (oelist == NULL || nsinfo == NULL)
 		return NULL;
@@ -962,16 +1085,18 @@ dup_event_list(event_list *oelist, server_info *nsinfo)
 	nelist->eol = oelist->eol;
 	nelist->current_time = &nsinfo->server_time;
 
-	if (oelist->events != NULL) {
-		nelist->events = dup_timed_event_list(oelist->events, nsinfo);
-		if (nelist->events == NULL) {
+	/* the old calendar is already sorted, so append in order */
+	for (ote = oelist->events; ote != NULL; ote = ote->next) {
+		nte = dup_timed_event(ote, nsinfo);
+		if (nte == NULL || link_calendar_event(nelist, nte, 1) == 0) {
+			free_timed_event(nte);
 			free_event_list(nelist);
 			return NULL;
 		}
 	}
 
 	if (oelist->next_event != NULL) {
-		nelist->next_event = find_timed_event(nelist->events,
+		nelist->next_event = find_calendar_event(nelist,
 			oelist->next_event->name,
 			oelist->next_event->event_type,
 			oelist->next_event->event_time);
@@ -996,13 +1121,256 @@ dup_event_list(event_list *oelist, server_info *nsinfo)
 void
 free_event_list(event_list *elist)
 {
+	AVL_IX_REC *rec;
+
 	if (elist == NULL)
 		return;
 
+	if (elist->time_index != NULL) {
+		rec = avlkey_create(elist->time_index, NULL);
+		if (rec != NULL) {
+			avl_first_key(elist->time_index);
+			while (avl_next_key(rec, elist->time_index) == AVL_IX_OK)
+				free(rec->recptr);
+			free(rec);
+		}
+		avl_destroy_index(elist->time_index);
+		free(elist->time_index);
+	}
+	/* the name index only references the events */
+	if (elist->name_index != NULL) {
+		avl_destroy_index(elist->name_index);
+		free(elist->name_index);
+	}
+	free_usage_profile(elist->usage_prof);
+	free_start_horizon(elist->horizon);
+
 	free_timed_event_list(elist->events);
 	free(elist);
 }
 
+/**
+ * @brief
+ * 		encode an event time as a key of a calendar's time index.  The
+ *		key is big endian with the sign bit flipped so that the byte
+ *		comparison of keys orders them the same way as the times.
+ *
+ * @param[in]	t	- time to encode
+ * @param[out]	key	- EVENT_TIME_KEY_LEN bytes of key
+ *
+ * @return	void
+ */
+static void
+event_time_key(time_t t, unsigned char *key)
+{
+	unsigned long long v;
+	int i;
+
+	v = ((unsigned long long) (long long) t) ^ (1ULL << 63);
+	for (i = EVENT_TIME_KEY_LEN - 1; i >= 0; i--) {
+		key[i] = v & 0xff;
+		v >>= 8;
+	}
+}
+
+/**
+ * @brief
+ * 		link a timed_event into a calendar's event list and indexes.
+ *		The event is placed by the same rule as add_timed_event():
+ *		after all events of an earlier or the same time, except end
+ *		events which go before all other events of the same time.
+ *
+ * @note
+ *		This does not touch the calendar's next_event.
+ *
+ * @param[in,out] calendar - calendar to link the event into
+ * @param[in] te	- event to link
+ * @param[in] append	- te is known to go at the end of the calendar
+ *			  (e.g. when copying an already sorted calendar)
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure, te is not linked
+ */
+static int
+link_calendar_event(event_list *calendar, timed_event *te, int append)
+{
+	unsigned char key[EVENT_TIME_KEY_LEN];
+	AVL_IX_REC *rec;
+	event_time_slot *slot = NULL;
+	timed_event *before = NULL;	/* te is linked in before this event */
+	timed_event *head = NULL;
+	int rc;
+
+	event_time_key(te->event_time, key);
+	rec = avlkey_create(calendar->time_index, key);
+	if (rec == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return 0;
+	}
+	rc = avl_locate_key(rec, calendar->time_index);
+	if (rc == AVL_IX_OK) {
+		slot = (event_time_slot *) rec->recptr;
+		if (append)
+			before = NULL;
+		else if (te->event_type == TIMED_END_EVENT)
+			before = slot->first;
+		else
+			before = slot->last->next;
+	} else if (rc == AVL_IX_FAIL && !append) /* rec is the next later slot */
+		before = ((event_time_slot *) rec->recptr)->first;
+	free(rec);
+
+	if (te->name != NULL) {
+		head = find_tree(calendar->name_index, te->name);
+		if (head == NULL &&
+			tree_add_del(calendar->name_index, te->name, te, TREE_OP_ADD) != 0) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+	}
+
+	if (slot == NULL) {
+		if ((slot = malloc(sizeof(event_time_slot))) == NULL ||
+			tree_add_del(calendar->time_index, key, slot, TREE_OP_ADD) != 0) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(slot);
+			if (te->name != NULL && head == NULL)
+				tree_add_del(calendar->name_index, te->name, NULL, TREE_OP_DEL);
+			return 0;
+		}
+		slot->first = te;
+		slot->last = te;
+	} else if (before == slot->first)
+		slot->first = te;
+	else
+		slot->last = te;
+
+	/* events of the same name are chained after the indexed one */
+	te->name_prev = head;
+	te->name_next = NULL;
+	if (head != NULL) {
+		te->name_next = head->name_next;
+		if (head->name_next != NULL)
+			head->name_next->name_prev = te;
+		head->name_next = te;
+	}
+
+	te->next = before;
+	if (before != NULL) {
+		te->prev = before->prev;
+		before->prev = te;
+	} else {
+		te->prev = calendar->last_event;
+		calendar->last_event = te;
+	}
+	if (te->prev != NULL)
+		te->prev->next = te;
+	else
+		calendar->events = te;
+
+	calendar->gen++;
+	calendar_generation++;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		unlink a timed_event from a calendar's event list and indexes
+ *
+ * @note
+ *		This does not touch the calendar's next_event.
+ *
+ * @param[in,out] calendar - calendar te is linked into
+ * @param[in] te	- event to unlink
+ *
+ * @return	void
+ */
+static void
+unlink_calendar_event(event_list *calendar, timed_event *te)
+{
+	unsigned char key[EVENT_TIME_KEY_LEN];
+	event_time_slot *slot;
+
+	event_time_key(te->event_time, key);
+	slot = find_tree(calendar->time_index, key);
+	if (slot != NULL) {
+		if (slot->first == te && slot->last == te) {
+			tree_add_del(calendar->time_index, key, NULL, TREE_OP_DEL);
+			free(slot);
+		} else if (slot->first == te)
+			slot->first = te->next;
+		else if (slot->last == te)
+			slot->last = te->prev;
+	}
+
+	if (te->name != NULL) {
+		if (te->name_prev != NULL)
+			te->name_prev->name_next = te->name_next;
+		else {
+			/* te is the indexed event of its name, index the next one */
+			tree_add_del(calendar->name_index, te->name, NULL, TREE_OP_DEL);
+			if (te->name_next != NULL &&
+				tree_add_del(calendar->name_index, te->name, te->name_next, TREE_OP_ADD) != 0)
+				log_err(errno, __func__, MEM_ERR_MSG);
+		}
+		if (te->name_next != NULL)
+			te->name_next->name_prev = te->name_prev;
+	}
+	te->name_next = NULL;
+	te->name_prev = NULL;
+
+	if (te->prev != NULL)
+		te->prev->next = te->next;
+	else
+		calendar->events = te->next;
+	if (te->next != NULL)
+		te->next->prev = te->prev;
+	else
+		calendar->last_event = te->prev;
+	te->next = NULL;
+	te->prev = NULL;
+
+	calendar->gen++;
+	calendar_generation++;
+}
+
+/**
+ * @brief
+ * 		check if a timed_event is linked into a calendar
+ *
+ * @param[in] calendar - calendar to check
+ * @param[in] te	- event to look for
+ *
+ * @return	int
+ * @retval	1	: te is in calendar
+ * @retval	0	: te is not in calendar
+ */
+static int
+calendar_has_event(event_list *calendar, timed_event *te)
+{
+	unsigned char key[EVENT_TIME_KEY_LEN];
+	event_time_slot *slot;
+	timed_event *cur;
+
+	if (te->name != NULL) {
+		for (cur = find_tree(calendar->name_index, te->name); cur != NULL; cur = cur->name_next)
+			if (cur == te)
+				return 1;
+		return 0;
+	}
+
+	event_time_key(te->event_time, key);
+	slot = find_tree(calendar->time_index, key);
+	if (slot == NULL)
+		return 0;
+	for (cur = slot->first; cur != slot->last->next; cur = cur->next)
+		if (cur == te)
+			return 1;
+	return 0;
+}
+
 /**
  * @brief
  * 		new_timed_event() - timed_event constructor
@@ -1030,6 +1398,8 @@ new_timed_event()
 	te->event_func_arg = NULL;
 	te->next = NULL;
 	te->prev = NULL;
+	te->name_next = NULL;
+	te->name_prev = NULL;
 
 	return te;
 }
@@ -1114,23 +1484,23 @@ free_te_list(te_list *tel) {
 /*
  * @brief te_list copy constructor
  * @param[in] ote - te_list to copy
- * @param[in] new_timed_even_list - new timed events
+ * @param[in] new_calendar - calendar with the new timed events
  * 
  * @return copied te_list
  */
 te_list *
-dup_te_list(te_list *ote, timed_event *new_timed_event_list)
+dup_te_list(te_list *ote, event_list *new_calendar)
 {
 	te_list *nte;
 
-	if(ote == NULL || new_timed_event_list == NULL)
+	if(ote == NULL || new_calendar == NULL)
 		return NULL;
 
 	nte = new_te_list();
 	if(nte == NULL)
 		return NULL;
 	
-	nte->event = find_timed_event(new_timed_event_list, ote->event->name, ote->event->event_type, ote->event->event_time);
+	nte->event = find_calendar_event(new_calendar, ote->event->name, ote->event->event_type, ote->event->event_time);
 	
 	return nte;
 }
@@ -1138,23 +1508,23 @@ dup_te_list(te_list *ote, timed_event *new_timed_event_list)
 /*
  * @brief copy constructor for a list of te_list structures
  * @param[in] ote - te_list to copy
- * @param[in] new_timed_even_list - new timed events
+ * @param[in] new_calendar - calendar with the new timed events
  * 
  * @return copied te_list list
  */
 
 te_list *
-dup_te_lists(te_list *ote, timed_event *new_timed_event_list) {
+dup_te_lists(te_list *ote, event_list *new_calendar) {
 	te_list *nte;
 	te_list *end_te = NULL;
 	te_list *cur;
 	te_list *nte_head = NULL;
 
-	if (ote == NULL || new_timed_event_list == NULL)
+	if (ote == NULL || new_calendar == NULL)
 		return NULL;
 	
 	for(cur = ote; cur != NULL; cur = cur->next) {
-		nte = dup_te_list(cur, new_timed_event_list);
+		nte = dup_te_list(cur, new_calendar);
 		if (nte == NULL) {
 			free_te_list(nte_head);
 			return NULL;
@@ -1396,7 +1766,11 @@ add_event(event_list *calendar, timed_event *te)
 	if (calendar->events == NULL)
 		events_is_null = 1;
 
-	calendar->events = add_timed_event(calendar->events, te);
+	if (link_calendar_event(calendar, te, 0) == 0)
+		return 0;
+
+	usage_profile_add_event(calendar, te);
+	start_horizon_add_event(calendar, te);
 
 	/* empty event list - the new event is the only event */
 	if (events_is_null)
@@ -1410,7 +1784,7 @@ add_event(event_list *calendar, timed_event *te)
 				calendar->next_event = te;
 			else if (te->event_time == calendar->next_event->event_time) {
 				calendar->next_event =
-					find_timed_event(calendar->events, NULL,
+					find_calendar_event(calendar, NULL,
 					TIMED_NOEVENT, te->event_time);
 			}
 		}
@@ -1494,37 +1868,25 @@ add_timed_event(timed_event *events, timed_event *te)
 int
 delete_event(server_info *sinfo, timed_event *e, unsigned int flags)
 {
-	timed_event *cur_e;
-	timed_event *prev_e = NULL;
 	event_list *calendar;
 
-	if (sinfo == NULL || e == NULL)
+	if (sinfo == NULL || sinfo->calendar == NULL || e == NULL)
 		return 0;
 
 	calendar = sinfo->calendar;
 
+	if (calendar_has_event(calendar, e) == 0)
+		return 0;
 
-	for (cur_e = calendar->events; cur_e != e && cur_e != NULL;
-		prev_e = cur_e, cur_e = cur_e->next)
-			;
-
-	/* found our event to delete */
-	if (cur_e != NULL) {
-		if (calendar->next_event == cur_e)
-			calendar->next_event = cur_e->next;
-
-		if (prev_e == NULL)
-			calendar->events = cur_e->next;
-		else
-			prev_e->next = cur_e->next;
+	if (calendar->next_event == e)
+		calendar->next_event = e->next;
 
-		if ((flags & DE_UNLINK) == 0)
-			free_timed_event(cur_e);
+	unlink_calendar_event(calendar, e);
 
-		return 1;
-	}
+	if ((flags & DE_UNLINK) == 0)
+		free_timed_event(e);
 
-	return 0;
+	return 1;
 }
 
 
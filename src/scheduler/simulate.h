@@ -135,6 +135,15 @@ timed_event *
 find_timed_event(timed_event *te_list, char *name,
 	enum timed_event_types event_type, time_t event_time);
 
+/*
+ *	find_calendar_event - find a timed_event in a calendar using its
+ *			      name and time indexes.  Same search parameters
+ *			      as find_timed_event()
+ */
+timed_event *
+find_calendar_event(event_list *calendar, char *name,
+	enum timed_event_types event_type, time_t event_time);
+
 
 
 
@@ -187,15 +196,15 @@ int exists_resv_event(event_list *calendar, time_t end);
 
 
 /*
- *      create_events - creates an timed_event list from running jobs
- *                          and confirmed reservations
+ *      create_events - creates the timed_events of a calendar from running
+ *                          jobs and confirmed reservations
  *
  *        \param sinfo - server universe to act upon
- *        \param flags -
+ *        \param elist - calendar to add the events to
  *
- *        \return timed_event list
+ *        \return 1 success / 0 failure
  */
-timed_event *create_events(server_info *sinfo);
+int create_events(server_info *sinfo, event_list *elist);
 
 /*
  * new_event_list() - event_list constructor
@@ -336,10 +345,12 @@ create_event(enum timed_event_types event_type,
 /*
  *	calc_run_time - calculate the run time of a job
  *
+ *	events before earliest are not checked, 0 to check every event
+ *
  *	returns time_t of when the job will run
  *		or -1 on error
  */
-time_t calc_run_time(char *job_name, server_info *sinfo, int flags);
+time_t calc_run_time(char *job_name, server_info *sinfo, time_t earliest, int flags);
 
 /*
  *
@@ -443,8 +454,8 @@ generic_sim(event_list *calendar, unsigned int event_mask, time_t end, int defau
 
 te_list *new_te_list();
 
-te_list *dup_te_list(te_list *ote, timed_event *new_timed_event_list);
-te_list *dup_te_lists(te_list *ote, timed_event *new_timed_event_list);
+te_list *dup_te_list(te_list *ote, event_list *new_calendar);
+te_list *dup_te_lists(te_list *ote, event_list *new_calendar);
 
 void free_te_list(te_list *tel);
 
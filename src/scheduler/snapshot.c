@@ -0,0 +1,793 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    snapshot.c
+ *
+ * @brief
+ * 		snapshot.c - capture the server status a cycle was scheduled from
+ *		and replay it without a server.
+ *
+ *		When snapshot_capture is set in sched_config, every batch_status
+ *		the scheduler queries from the server during a cycle is written
+ *		to the snapshot file.  The file is a text file, one line per
+ *		record with tab separated fields:
+ *
+ *		    #PBS scheduler snapshot <version>
+ *		    time <time of the cycle>
+ *		    sched <name of the scheduler>
+ *		    section <kind of object> [<queue the jobs were selected from>]
+ *		    object <name>
+ *		    attr <name> <resource> <value>
+ *		    end
+ *
+ *		Backslashes, tabs and newlines in fields are escaped as \\, \t
+ *		and \n.  pbs_sched_replay loads a snapshot with snapshot_load()
+ *		and runs scheduling cycles on it with SIMULATE_SD.  The queries
+ *		of the cycle are then answered from the snapshot.
+ *
+ * Functions included are:
+ * 	snapshot_cycle_start()
+ * 	snapshot_record()
+ * 	snapshot_cycle_end()
+ * 	snapshot_stat()
+ * 	snapshot_jobs()
+ * 	snapshot_load()
+ * 	snapshot_replaying()
+ * 	snapshot_time()
+ * 	snapshot_sched_name()
+ * 	snapshot_decision()
+ * 	snapshot_report()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <pbs_ifl.h>
+#include <pbs_error.h>
+#include <libutil.h>
+#include <log.h>
+#include "data_types.h"
+#include "constant.h"
+#include "globals.h"
+#include "misc.h"
+#include "node_info.h"
+#include "snapshot.h"
+
+/* most fields on a snapshot line (attr name resource value) */
+#define SNAPSHOT_MAX_FIELDS 4
+
+static const char *snap_obj_names[SNAP_NUM_OBJS] = {
+	"resources",
+	"server",
+	"sched",
+	"resvs",
+	"nodes",
+	"queues",
+	"jobs"
+};
+
+static const char *snap_decision_names[SNAP_NUM_DECISIONS] = {
+	"run",
+	"preempt",
+	"topjob",
+	"not_run"
+};
+
+/* the jobs selected from one queue in a loaded snapshot */
+typedef struct snap_queue_jobs snap_queue_jobs;
+struct snap_queue_jobs {
+	char *queue;
+	struct batch_status *jobs;
+	snap_queue_jobs *next;
+};
+
+/* capture of the current cycle */
+static struct {
+	FILE *fp;				/* NULL if not capturing */
+	char tmpname[MAXPATHLEN + 1];		/* written to, renamed at cycle end */
+	struct batch_status *resources;		/* resources are not queried every cycle */
+} capture = { NULL, "", NULL };
+
+/* snapshot being replayed */
+static struct {
+	int loaded;
+	time_t time;				/* time of the captured cycle */
+	char *sched_name;
+	struct batch_status *objs[SNAP_NUM_OBJS];	/* SNAP_JOBS is in jobs */
+	snap_queue_jobs *jobs;
+	snap_queue_jobs *jobs_tail;
+	FILE *report_fp;			/* decisions are printed here */
+	int decisions[SNAP_NUM_DECISIONS];	/* since the last snapshot_report() */
+} replay;
+
+/**
+ * @brief
+ * 		deep copy a batch_status list, so it can be freed by pbs_statfree()
+ *
+ * @param[in]	bs	-	list to copy
+ *
+ * @return	struct batch_status *
+ * @retval	the copy
+ * @retval	NULL	: bs is NULL or on error (pbs_errno is set)
+ */
+static struct batch_status *
+snapshot_dup_status(struct batch_status *bs)
+{
+	struct batch_status *head = NULL;
+	struct batch_status **bs_tail = &head;
+	struct batch_status *nbs;
+	struct attrl **at_tail;
+	struct attrl *attrp;
+	struct attrl *nattr;
+	int err = 0;
+
+	for (; bs != NULL && !err; bs = bs->next) {
+		if ((nbs = calloc(1, sizeof(struct batch_status))) == NULL) {
+			err = 1;
+			break;
+		}
+		*bs_tail = nbs;
+		bs_tail = &nbs->next;
+		nbs->name = string_dup(bs->name);
+		err = (bs->name != NULL && nbs->name == NULL);
+
+		at_tail = &nbs->attribs;
+		for (attrp = bs->attribs; attrp != NULL && !err; attrp = attrp->next) {
+			if ((nattr = calloc(1, sizeof(struct attrl))) == NULL) {
+				err = 1;
+				break;
+			}
+			*at_tail = nattr;
+			at_tail = &nattr->next;
+			nattr->op = attrp->op;
+			nattr->name = string_dup(attrp->name);
+			nattr->resource = string_dup(attrp->resource);
+			nattr->value = string_dup(attrp->value);
+			err = (attrp->name != NULL && nattr->name == NULL) ||
+				(attrp->resource != NULL && nattr->resource == NULL) ||
+				(attrp->value != NULL && nattr->value == NULL);
+		}
+	}
+
+	if (err) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		pbs_statfree(head);
+		pbs_errno = PBSE_SYSTEM;
+		return NULL;
+	}
+
+	return head;
+}
+
+/**
+ * @brief
+ * 		write a field of a snapshot line, escaping the field separators
+ *
+ * @param[in]	fp	-	snapshot file
+ * @param[in]	str	-	field (NULL is written as an empty field)
+ *
+ * @return	void
+ */
+static void
+snapshot_write_field(FILE *fp, char *str)
+{
+	char *p;
+
+	if (str == NULL)
+		return;
+
+	for (p = str; *p != '\0'; p++) {
+		switch (*p) {
+			case '\\':
+				fputs("\\\\", fp);
+				break;
+			case '\t':
+				fputs("\\t", fp);
+				break;
+			case '\n':
+				fputs("\\n", fp);
+				break;
+			default:
+				putc(*p, fp);
+		}
+	}
+}
+
+/**
+ * @brief
+ * 		write a section of the snapshot
+ *
+ * @param[in]	fp	-	snapshot file
+ * @param[in]	obj	-	kind of objects in bs
+ * @param[in]	queue_name	-	queue jobs were selected from (NULL for other kinds)
+ * @param[in]	bs	-	status of the objects
+ *
+ * @return	void
+ */
+static void
+snapshot_write_status(FILE *fp, enum snap_obj obj, char *queue_name,
+	struct batch_status *bs)
+{
+	struct attrl *attrp;
+
+	fprintf(fp, "section\t%s", snap_obj_names[obj]);
+	if (queue_name != NULL) {
+		putc('\t', fp);
+		snapshot_write_field(fp, queue_name);
+	}
+	putc('\n', fp);
+
+	for (; bs != NULL; bs = bs->next) {
+		fputs("object\t", fp);
+		snapshot_write_field(fp, bs->name);
+		putc('\n', fp);
+		for (attrp = bs->attribs; attrp != NULL; attrp = attrp->next) {
+			fputs("attr\t", fp);
+			snapshot_write_field(fp, attrp->name);
+			putc('\t', fp);
+			snapshot_write_field(fp, attrp->resource);
+			putc('\t', fp);
+			snapshot_write_field(fp, attrp->value);
+			putc('\n', fp);
+		}
+	}
+	fputs("end\n", fp);
+}
+
+/**
+ * @brief
+ * 		snapshot_cycle_start - start capturing the cycle if
+ *		snapshot_capture is set in sched_config
+ *
+ * @param[in]	cycle_time	-	time of the cycle
+ *
+ * @return	void
+ */
+void
+snapshot_cycle_start(time_t cycle_time)
+{
+	if (capture.fp != NULL) {
+		/* the last cycle did not finish its capture */
+		fclose(capture.fp);
+		capture.fp = NULL;
+		unlink(capture.tmpname);
+	}
+
+	if (conf.snapshot_capture == NULL || replay.loaded)
+		return;
+
+	snprintf(capture.tmpname, sizeof(capture.tmpname), "%s.new",
+		conf.snapshot_capture);
+	if ((capture.fp = fopen(capture.tmpname, "w")) == NULL) {
+		log_err(errno, __func__, "Failed to open snapshot file");
+		return;
+	}
+
+	fprintf(capture.fp, "%s\t%d\n", SNAPSHOT_MAGIC, SNAPSHOT_VERSION);
+	fprintf(capture.fp, "time\t%ld\n", (long) cycle_time);
+	fputs("sched\t", capture.fp);
+	snapshot_write_field(capture.fp, sc_name);
+	putc('\n', capture.fp);
+
+	/* the resources of an earlier cycle, replaced if they are queried again */
+	if (capture.resources != NULL)
+		snapshot_write_status(capture.fp, SNAP_RESOURCES, NULL, capture.resources);
+}
+
+/**
+ * @brief
+ * 		snapshot_record - add the status of a kind of object to the
+ *		capture of the cycle
+ *
+ * @param[in]	obj	-	kind of objects in bs
+ * @param[in]	queue_name	-	queue jobs were selected from (NULL for other kinds)
+ * @param[in]	bs	-	status of the objects
+ *
+ * @return	void
+ */
+void
+snapshot_record(enum snap_obj obj, char *queue_name, struct batch_status *bs)
+{
+	if (capture.fp == NULL)
+		return;
+
+	if (obj == SNAP_RESOURCES) {
+		pbs_statfree(capture.resources);
+		capture.resources = snapshot_dup_status(bs);
+	}
+
+	snapshot_write_status(capture.fp, obj, queue_name, bs);
+}
+
+/**
+ * @brief
+ * 		snapshot_cycle_end - finish the capture of the cycle and
+ *		replace the snapshot file with it
+ *
+ * @return	void
+ */
+void
+snapshot_cycle_end(void)
+{
+	int err;
+
+	if (capture.fp == NULL)
+		return;
+
+	err = ferror(capture.fp);
+	if (fclose(capture.fp) != 0)
+		err = 1;
+	capture.fp = NULL;
+
+	if (err || rename(capture.tmpname, conf.snapshot_capture) == -1) {
+		log_err(errno, __func__, "Failed to write snapshot file");
+		unlink(capture.tmpname);
+		return;
+	}
+
+	schdlog(PBSEVENT_DEBUG2, PBS_EVENTCLASS_SCHED, LOG_DEBUG,
+		conf.snapshot_capture, "Saved snapshot of cycle");
+}
+
+/**
+ * @brief
+ * 		snapshot_stat - status all objects of a kind.  The status comes
+ *		from the server and is added to the capture of the cycle, or
+ *		comes from the snapshot being replayed.
+ *
+ * @param[in]	pbs_sd	-	connection to the server
+ * @param[in]	obj	-	kind of objects (not SNAP_JOBS)
+ *
+ * @return	struct batch_status *
+ * @retval	status to be freed with pbs_statfree()
+ * @retval	NULL	: no objects or error (pbs_errno is set)
+ */
+struct batch_status *
+snapshot_stat(int pbs_sd, enum snap_obj obj)
+{
+	struct batch_status *bs;
+
+	if (replay.loaded) {
+		pbs_errno = PBSE_NONE;
+		return snapshot_dup_status(replay.objs[obj]);
+	}
+
+	switch (obj) {
+		case SNAP_RESOURCES:
+			bs = pbs_statrsc(pbs_sd, NULL, NULL, "p");
+			break;
+		case SNAP_SERVER:
+			bs = pbs_statserver(pbs_sd, NULL, NULL);
+			break;
+		case SNAP_SCHED:
+			bs = pbs_statsched(pbs_sd, NULL, NULL);
+			break;
+		case SNAP_RESVS:
+			bs = pbs_statresv(pbs_sd, NULL, NULL, NULL);
+			break;
+		case SNAP_NODES:
+			bs = pbs_statvnode(pbs_sd, NULL, NULL, NULL);
+			break;
+		case SNAP_QUEUES:
+			bs = pbs_statque(pbs_sd, NULL, NULL, NULL);
+			break;
+		default:
+			return NULL;
+	}
+
+	if (bs != NULL)
+		snapshot_record(obj, NULL, bs);
+
+	return bs;
+}
+
+/**
+ * @brief
+ * 		snapshot_jobs - the jobs selected from a queue in the snapshot
+ *		being replayed
+ *
+ * @param[in]	queue_name	-	name of the queue
+ *
+ * @return	struct batch_status *
+ * @retval	status to be freed with pbs_statfree()
+ * @retval	NULL	: no jobs or error (pbs_errno is set)
+ */
+struct batch_status *
+snapshot_jobs(char *queue_name)
+{
+	snap_queue_jobs *qj;
+
+	pbs_errno = PBSE_NONE;
+	if (queue_name == NULL)
+		return NULL;
+
+	for (qj = replay.jobs; qj != NULL; qj = qj->next)
+		if (!strcmp(qj->queue, queue_name))
+			return snapshot_dup_status(qj->jobs);
+
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		free the snapshot being replayed
+ *
+ * @return	void
+ */
+static void
+snapshot_free_replay(void)
+{
+	snap_queue_jobs *qj;
+	snap_queue_jobs *next;
+	int i;
+
+	for (i = 0; i < SNAP_NUM_OBJS; i++) {
+		pbs_statfree(replay.objs[i]);
+		replay.objs[i] = NULL;
+	}
+	for (qj = replay.jobs; qj != NULL; qj = next) {
+		next = qj->next;
+		free(qj->queue);
+		pbs_statfree(qj->jobs);
+		free(qj);
+	}
+	replay.jobs = replay.jobs_tail = NULL;
+	free(replay.sched_name);
+	replay.sched_name = NULL;
+	replay.loaded = 0;
+}
+
+/**
+ * @brief
+ * 		split a snapshot line into its fields and unescape them in place
+ *
+ * @param[in,out]	line	-	line read from the snapshot
+ * @param[out]	fields	-	the fields
+ * @param[in]	max_fields	-	size of fields
+ *
+ * @return	int
+ * @retval	number of fields
+ * @retval	max_fields + 1	: too many fields
+ */
+static int
+snapshot_split(char *line, char **fields, int max_fields)
+{
+	char *p;
+	char *q;
+	int n = 0;
+
+	p = line;
+	if (*p == '\0' || *p == '\n')
+		return 0;
+
+	fields[n++] = q = p;
+	for (; *p != '\0' && *p != '\n'; p++) {
+		if (*p == '\t') {
+			*q = '\0';
+			if (n == max_fields)
+				return max_fields + 1;
+			fields[n++] = q = p + 1;
+		} else if (*p == '\\' && p[1] != '\0' && p[1] != '\n') {
+			p++;
+			*q++ = (*p == 't') ? '\t' : (*p == 'n') ? '\n' : *p;
+		} else
+			*q++ = *p;
+	}
+	*q = '\0';
+
+	return n;
+}
+
+/**
+ * @brief
+ * 		snapshot_load - load a snapshot written by snapshot_cycle_end().
+ *		From now on the queries of the scheduling cycle are answered
+ *		from the snapshot.
+ *
+ * @param[in]	fname	-	snapshot file
+ * @param[in]	report_fp	-	where snapshot_decision() prints the
+ *					decisions (NULL to only count them)
+ * @param[out]	errbuf	-	reason the snapshot could not be loaded
+ * @param[in]	errbuf_size	-	size of errbuf
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure
+ */
+int
+snapshot_load(char *fname, FILE *report_fp, char *errbuf, int errbuf_size)
+{
+	FILE *fp;
+	char *buf = NULL;
+	int buf_size = 0;
+	char *fields[SNAPSHOT_MAX_FIELDS + 1];
+	int nfields;
+	int lineno = 0;
+	int have[SNAP_NUM_OBJS] = {0};
+	struct batch_status **bs_tail = NULL;	/* NULL outside of a section */
+	struct batch_status *bs;
+	struct attrl **at_tail = NULL;		/* NULL outside of an object */
+	struct attrl *attrp;
+	snap_queue_jobs *qj;
+	int obj;
+	int err = 0;
+
+	if (fname == NULL || errbuf == NULL)
+		return 0;
+	errbuf[0] = '\0';
+
+	snapshot_free_replay();
+
+	if ((fp = fopen(fname, "r")) == NULL) {
+		snprintf(errbuf, errbuf_size, "%s: %s", fname, strerror(errno));
+		return 0;
+	}
+
+	while (!err && pbs_fgets(&buf, &buf_size, fp) != NULL) {
+		lineno++;
+		nfields = snapshot_split(buf, fields, SNAPSHOT_MAX_FIELDS);
+
+		if (lineno == 1) {
+			if (nfields != 2 || strcmp(fields[0], SNAPSHOT_MAGIC) ||
+				atoi(fields[1]) != SNAPSHOT_VERSION) {
+				snprintf(errbuf, errbuf_size,
+					"%s: not a version %d scheduler snapshot",
+					fname, SNAPSHOT_VERSION);
+				err = 1;
+			}
+			continue;
+		}
+		if (nfields == 0)
+			continue;
+
+		if (!strcmp(fields[0], "time") && nfields == 2)
+			replay.time = (time_t) strtol(fields[1], NULL, 10);
+		else if (!strcmp(fields[0], "sched") && nfields == 2) {
+			free(replay.sched_name);
+			err = (replay.sched_name = string_dup(fields[1])) == NULL;
+		}
+		else if (!strcmp(fields[0], "section") && (nfields == 2 || nfields == 3)) {
+			for (obj = 0; obj < SNAP_NUM_OBJS; obj++)
+				if (!strcmp(fields[1], snap_obj_names[obj]))
+					break;
+
+			if (obj == SNAP_NUM_OBJS || (obj == SNAP_JOBS) != (nfields == 3)) {
+				snprintf(errbuf, errbuf_size, "%s:%d: bad section", fname, lineno);
+				err = 1;
+			}
+			else if (obj == SNAP_JOBS) {
+				if ((qj = calloc(1, sizeof(snap_queue_jobs))) == NULL ||
+					(qj->queue = string_dup(fields[2])) == NULL) {
+					free(qj);
+					err = 1;
+				} else {
+					if (replay.jobs_tail != NULL)
+						replay.jobs_tail->next = qj;
+					else
+						replay.jobs = qj;
+					replay.jobs_tail = qj;
+					bs_tail = &qj->jobs;
+				}
+			}
+			else {
+				/* a later section replaces an earlier one (resources) */
+				pbs_statfree(replay.objs[obj]);
+				replay.objs[obj] = NULL;
+				bs_tail = &replay.objs[obj];
+			}
+			have[obj] = 1;
+			at_tail = NULL;
+		}
+		else if (!strcmp(fields[0], "object") && nfields == 2 && bs_tail != NULL) {
+			if ((bs = calloc(1, sizeof(struct batch_status))) == NULL ||
+				(bs->name = string_dup(fields[1])) == NULL) {
+				free(bs);
+				err = 1;
+			} else {
+				*bs_tail = bs;
+				bs_tail = &bs->next;
+				at_tail = &bs->attribs;
+			}
+		}
+		else if (!strcmp(fields[0], "attr") && nfields == 4 && at_tail != NULL) {
+			if ((attrp = calloc(1, sizeof(struct attrl))) == NULL)
+				err = 1;
+			else {
+				*at_tail = attrp;
+				at_tail = &attrp->next;
+				attrp->op = SET;
+				attrp->name = string_dup(fields[1]);
+				if (fields[2][0] != '\0')
+					attrp->resource = string_dup(fields[2]);
+				attrp->value = string_dup(fields[3]);
+				err = attrp->name == NULL || attrp->value == NULL ||
+					(fields[2][0] != '\0' && attrp->resource == NULL);
+			}
+		}
+		else if (!strcmp(fields[0], "end") && nfields == 1) {
+			bs_tail = NULL;
+			at_tail = NULL;
+		}
+		else {
+			snprintf(errbuf, errbuf_size, "%s:%d: syntax error", fname, lineno);
+			err = 1;
+		}
+
+		if (err && errbuf[0] == '\0')
+			snprintf(errbuf, errbuf_size, "%s", MEM_ERR_MSG);
+	}
+	free(buf);
+	fclose(fp);
+
+	if (!err && lineno == 0) {
+		snprintf(errbuf, errbuf_size, "%s: empty snapshot", fname);
+		err = 1;
+	}
+
+	/* the cycle can't be built without these */
+	for (obj = 0; obj < SNAP_NUM_OBJS && !err; obj++) {
+		if (obj == SNAP_RESVS || obj == SNAP_JOBS)
+			continue;
+		if (!have[obj] || replay.objs[obj] == NULL) {
+			snprintf(errbuf, errbuf_size, "%s: no %s in snapshot",
+				fname, snap_obj_names[obj]);
+			err = 1;
+		}
+	}
+
+	if (err) {
+		snapshot_free_replay();
+		return 0;
+	}
+
+	replay.report_fp = report_fp;
+	memset(replay.decisions, 0, sizeof(replay.decisions));
+	replay.loaded = 1;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		snapshot_replaying - are we replaying a snapshot?
+ *
+ * @return	int
+ * @retval	1	: replaying
+ * @retval	0	: talking to a server
+ */
+int
+snapshot_replaying(void)
+{
+	return replay.loaded;
+}
+
+/**
+ * @brief
+ * 		snapshot_time - the time the replayed snapshot was captured at
+ *
+ * @return	time_t
+ * @retval	time of the captured cycle
+ * @retval	0	: not replaying
+ */
+time_t
+snapshot_time(void)
+{
+	return replay.loaded ? replay.time : 0;
+}
+
+/**
+ * @brief
+ * 		snapshot_sched_name - the name of the scheduler the replayed
+ *		snapshot was captured by
+ *
+ * @return	char *
+ * @retval	scheduler name
+ * @retval	NULL	: not replaying or no name in the snapshot
+ */
+char *
+snapshot_sched_name(void)
+{
+	return replay.loaded ? replay.sched_name : NULL;
+}
+
+/**
+ * @brief
+ * 		snapshot_decision - count a decision of the main loop and print
+ *		it if we are replaying a snapshot
+ *
+ * @param[in]	resresv	-	job the decision is about
+ * @param[in]	dec	-	the decision
+ * @param[in]	detail	-	why the job did not run (may be NULL).  Where
+ *				a job ran and its start time are filled in
+ *
+ * @return	void
+ */
+void
+snapshot_decision(resource_resv *resresv, enum snap_decision dec, char *detail)
+{
+	char buf[MAX_LOG_SIZE];
+
+	if (!replay.loaded || resresv == NULL)
+		return;
+
+	replay.decisions[dec]++;
+	if (replay.report_fp == NULL)
+		return;
+
+	if (detail == NULL) {
+		if ((dec == SNAP_DEC_RUN || dec == SNAP_DEC_PREEMPT) &&
+			resresv->nspec_arr != NULL)
+			detail = create_execvnode(resresv->nspec_arr);
+		else if (dec == SNAP_DEC_TOPJOB) {
+			snprintf(buf, sizeof(buf), "start=%ld", (long) resresv->start);
+			detail = buf;
+		}
+	}
+
+	fprintf(replay.report_fp, "%s\t%s\t%s\n", snap_decision_names[dec],
+		resresv->name, detail != NULL ? detail : "");
+}
+
+/**
+ * @brief
+ * 		snapshot_report - print the number of each decision made since
+ *		the last report and start counting again
+ *
+ * @param[in]	fp	-	where to print
+ *
+ * @return	void
+ */
+void
+snapshot_report(FILE *fp)
+{
+	int i;
+
+	fputs("decisions", fp);
+	for (i = 0; i < SNAP_NUM_DECISIONS; i++)
+		fprintf(fp, " %s=%d", snap_decision_names[i], replay.decisions[i]);
+	putc('\n', fp);
+
+	memset(replay.decisions, 0, sizeof(replay.decisions));
+}
@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+#ifndef	_SNAPSHOT_H
+#define	_SNAPSHOT_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include <stdio.h>
+#include <time.h>
+#include <pbs_ifl.h>
+#include "data_types.h"
+#include "constant.h"
+
+#define SNAPSHOT_MAGIC "#PBS scheduler snapshot"
+#define SNAPSHOT_VERSION 1
+
+/*
+ *	snapshot_cycle_start - start capturing the cycle if snapshot_capture
+ *			       is set in sched_config
+ */
+void snapshot_cycle_start(time_t cycle_time);
+
+/*
+ *	snapshot_record - add the status of a kind of object to the capture
+ *			  queue_name is the queue jobs were selected from
+ */
+void snapshot_record(enum snap_obj obj, char *queue_name, struct batch_status *bs);
+
+/*
+ *	snapshot_cycle_end - finish the capture of the cycle
+ */
+void snapshot_cycle_end(void);
+
+/*
+ *	snapshot_stat - status all objects of a kind, from the server or
+ *			from the snapshot being replayed
+ *
+ *	returns a batch_status list to be freed with pbs_statfree()
+ */
+struct batch_status *snapshot_stat(int pbs_sd, enum snap_obj obj);
+
+/*
+ *	snapshot_jobs - the jobs of a queue in the snapshot being replayed
+ *
+ *	returns a batch_status list to be freed with pbs_statfree()
+ */
+struct batch_status *snapshot_jobs(char *queue_name);
+
+/*
+ *	snapshot_load - load a snapshot and replay it instead of querying
+ *			the server
+ *
+ *	returns 1 on success, 0 on failure with the reason in errbuf
+ */
+int snapshot_load(char *fname, FILE *report_fp, char *errbuf, int errbuf_size);
+
+/* are we replaying a snapshot? */
+int snapshot_replaying(void);
+
+/* the time a replayed snapshot was captured at, 0 if not replaying */
+time_t snapshot_time(void);
+
+/* the name of the scheduler a replayed snapshot was captured by */
+char *snapshot_sched_name(void);
+
+/*
+ *	snapshot_decision - report a decision of the main loop if replaying
+ */
+void snapshot_decision(resource_resv *resresv, enum snap_decision dec, char *detail);
+
+/*
+ *	snapshot_report - print the number of each decision made since the
+ *			  last report
+ */
+void snapshot_report(FILE *fp);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _SNAPSHOT_H */
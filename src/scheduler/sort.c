@@ -68,6 +68,10 @@
  * 	cmp_aoe()
  * 	cmp_job_preemption_time_asc()
  * 	cmp_starving_jobs()
+ * 	cmp_job_sort_key()
+ * 	make_job_sort_keys()
+ * 	sort_job_array()
+ * 	save_job_sort_order()
  * 	sort_jobs()
  * 	swapfunc()
  * 	med3()
@@ -93,12 +97,29 @@
 #include "constant.h"
 #include "server_info.h"
 #include "resource.h"
+#include "cycle_profile.h"
 #include "constant.h"
 
 #ifdef NAS
 #include "site_code.h"
 #endif
 
+/* a job's place in the job order of the last cycle */
+struct job_sort_order
+{
+	long qrank;
+	char *name;
+	int pos;
+};
+
+/* the job order at the end of the last cycle, sorted by qrank and name */
+static struct job_sort_order *last_order = NULL;
+static int last_order_len = 0;
+static char *last_order_names = NULL;
+
+/* policy the current job sort keys were made for */
+static int sort_help_starving_jobs = 0;
+static int sort_fair_share = 0;
 
 
 /**
@@ -1263,6 +1284,493 @@ cmp_resv_state(const void *r1, const void *r2)
 		return 0;
 }
 
+/**
+ * @brief
+ * 		compare two jobs on their precomputed job_sort_key.  This is
+ *		cmp_sort() without reevaluating anything per comparison.
+ *		Jobs without a key are compared with cmp_sort()
+ *
+ * @param[in]	v1	-	resource_resv 1
+ * @param[in]	v2	-	resource_resv 2
+ *
+ * @return	-1,0,1 : based on sorting function.
+ */
+int
+cmp_job_sort_key(const void *v1, const void *v2)
+{
+	resource_resv *r1;
+	resource_resv *r2;
+	job_sort_key *k1;
+	job_sort_key *k2;
+	int i;
+
+	r1 = *((resource_resv **) v1);
+	r2 = *((resource_resv **) v2);
+
+	if (r1 == NULL || r2 == NULL || r1->job == NULL || r2->job == NULL ||
+		r1->job->sort_key == NULL || r2->job->sort_key == NULL)
+		return cmp_sort(v1, v2);
+
+	k1 = r1->job->sort_key;
+	k2 = r2->job->sort_key;
+
+	if (k1->runnable != k2->runnable)
+		return k1->runnable ? -1 : 1;
+
+	/* preemption priority, highest first */
+	if (k1->preempt != k2->preempt)
+		return k1->preempt < k2->preempt ? 1 : -1;
+
+	/* preempted jobs first, in the order they were preempted */
+	if (k1->time_preempted != k2->time_preempted) {
+		if (k2->time_preempted == UNSPECIFIED)
+			return -1;
+		if (k1->time_preempted == UNSPECIFIED)
+			return 1;
+		return k1->time_preempted < k2->time_preempted ? -1 : 1;
+	}
+#ifndef NAS /* localmod 041 */
+	if (sort_help_starving_jobs) {
+		if (k1->starving != k2->starving)
+			return k1->starving ? -1 : 1;
+		if (k1->starving && k1->sch_priority != k2->sch_priority)
+			return k1->sch_priority > k2->sch_priority ? -1 : 1;
+	}
+#endif /* localmod 041 */
+	if (k1->formula_value != k2->formula_value)
+		return k1->formula_value < k2->formula_value ? 1 : -1;
+#ifndef NAS /* localmod 041 */
+	if (sort_fair_share && k1->fairshare_rank != -1 &&
+		k2->fairshare_rank != -1 && k1->fairshare_rank != k2->fairshare_rank)
+		return k1->fairshare_rank < k2->fairshare_rank ? -1 : 1;
+#endif /* localmod 041 */
+
+	for (i = 0; i <= MAX_SORTS && cstat.sort_by[i].res_name != NULL; i++) {
+		if (k1->res[i] != k2->res[i]) {
+			if (cstat.sort_by[i].order == ASC)
+				return k1->res[i] < k2->res[i] ? -1 : 1;
+			else
+				return k1->res[i] < k2->res[i] ? 1 : -1;
+		}
+	}
+
+	/* stabilize the sort */
+	if (k1->qrank != k2->qrank)
+		return k1->qrank < k2->qrank ? -1 : 1;
+	if (k1->rank != k2->rank)
+		return k1->rank < k2->rank ? -1 : 1;
+
+	return 0;
+}
+
+/**
+ * @brief
+ * 		qsort() compare function for group_info pointers on their
+ *		fairshare path
+ *
+ * @param[in]	g1	-	group_info 1
+ * @param[in]	g2	-	group_info 2
+ *
+ * @return	-1,0,1 : compare_path()
+ */
+static int
+cmp_group_path(const void *g1, const void *g2)
+{
+	return compare_path((*(group_info **) g1)->gpath, (*(group_info **) g2)->gpath);
+}
+
+/**
+ * @brief
+ * 		make_job_sort_keys - evaluate everything the job sort compares
+ *		once for each job, instead of once per comparison.  The keys are
+ *		only valid until free_job_sort_keys() is called.
+ *
+ * @param[in]	policy	-	policy the jobs are sorted for
+ * @param[in]	jobs	-	the jobs to make keys for
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: failure, the jobs have no keys
+ */
+static int
+make_job_sort_keys(status *policy, resource_resv **jobs)
+{
+	static job_sort_key *keys = NULL;
+	static int keys_size = 0;
+	static sch_resource_t *key_res = NULL;
+	static int key_res_size = 0;
+	static group_info **groups = NULL;
+	static int groups_size = 0;
+	job_sort_key *tkeys;
+	sch_resource_t *tres;
+	group_info **tgroups;
+	group_info *ginfo;
+	int num_jobs;
+	int num_sorts;
+	int num_groups = 0;
+	int rank = 0;
+	int i;
+	int j;
+
+	if (policy == NULL || jobs == NULL)
+		return 0;
+
+	num_jobs = count_array((void **) jobs);
+	for (num_sorts = 0; num_sorts <= MAX_SORTS &&
+		cstat.sort_by[num_sorts].res_name != NULL; num_sorts++)
+		;
+
+	if (num_jobs > keys_size) {
+		if ((tkeys = realloc(keys, num_jobs * sizeof(job_sort_key))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		keys = tkeys;
+		keys_size = num_jobs;
+	}
+	if (num_jobs * num_sorts > key_res_size) {
+		if ((tres = realloc(key_res, num_jobs * num_sorts * sizeof(sch_resource_t))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		key_res = tres;
+		key_res_size = num_jobs * num_sorts;
+	}
+
+	/* compare_path() is only called once per pair of fairshare groups
+	 * ordering the groups the jobs belong to
+	 */
+	if (policy->fair_share) {
+		for (i = 0; i < num_jobs; i++)
+			if (jobs[i]->job != NULL && jobs[i]->job->ginfo != NULL)
+				jobs[i]->job->ginfo->sort_rank = -1;
+		for (i = 0; i < num_jobs; i++) {
+			if (jobs[i]->job == NULL || (ginfo = jobs[i]->job->ginfo) == NULL ||
+				ginfo->sort_rank != -1)
+				continue;
+			if (num_groups == groups_size) {
+				tgroups = realloc(groups, (groups_size * 2 + 16) * sizeof(group_info *));
+				if (tgroups == NULL) {
+					log_err(errno, __func__, MEM_ERR_MSG);
+					return 0;
+				}
+				groups = tgroups;
+				groups_size = groups_size * 2 + 16;
+			}
+			ginfo->sort_rank = 0;
+			groups[num_groups++] = ginfo;
+		}
+		qsort(groups, num_groups, sizeof(group_info *), cmp_group_path);
+		for (i = 0; i < num_groups; i++) {
+			if (i > 0 && compare_path(groups[i - 1]->gpath, groups[i]->gpath) != 0)
+				rank++;
+			groups[i]->sort_rank = rank;
+		}
+	}
+
+	for (i = 0; i < num_jobs; i++) {
+		resource_resv *resresv = jobs[i];
+		job_sort_key *key = &keys[i];
+
+		if (resresv->job == NULL)
+			continue;
+
+		key->runnable = in_runnable_state(resresv) ? 1 : 0;
+		key->starving = resresv->job->is_starving ? 1 : 0;
+		key->preempt = resresv->job->preempt;
+		key->time_preempted = resresv->job->time_preempted;
+		key->sch_priority = resresv->sch_priority;
+		key->formula_value = resresv->job->formula_value;
+		if (resresv->job->ginfo != NULL)
+			key->fairshare_rank = resresv->job->ginfo->sort_rank;
+		else
+			key->fairshare_rank = -1;
+		key->res = &key_res[i * num_sorts];
+		for (j = 0; j < num_sorts; j++)
+			key->res[j] = find_resresv_amount(resresv,
+				cstat.sort_by[j].res_name, cstat.sort_by[j].def);
+		key->qrank = resresv->qrank;
+		key->rank = resresv->rank;
+
+		resresv->job->sort_key = key;
+	}
+
+	sort_help_starving_jobs = policy->help_starving_jobs;
+	sort_fair_share = policy->fair_share;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		free_job_sort_keys - forget the keys from make_job_sort_keys()
+ *
+ * @param[in]	jobs	-	the jobs with keys
+ *
+ * @return	void
+ */
+static void
+free_job_sort_keys(resource_resv **jobs)
+{
+	int i;
+
+	if (jobs == NULL)
+		return;
+
+	for (i = 0; jobs[i] != NULL; i++)
+		if (jobs[i]->job != NULL)
+			jobs[i]->job->sort_key = NULL;
+}
+
+/**
+ * @brief
+ * 		compare two job_sort_order entries by qrank and name
+ *
+ * @param[in]	o1	-	job_sort_order 1
+ * @param[in]	o2	-	job_sort_order 2
+ *
+ * @return	-1,0,1 : standard qsort() cmp
+ */
+static int
+cmp_job_sort_order(const void *o1, const void *o2)
+{
+	const struct job_sort_order *s1 = o1;
+	const struct job_sort_order *s2 = o2;
+
+	if (s1->qrank != s2->qrank)
+		return s1->qrank < s2->qrank ? -1 : 1;
+	return strcmp(s1->name, s2->name);
+}
+
+/**
+ * @brief
+ * 		put a freshly queried array of jobs into the order they had at
+ *		the end of the last cycle.  Jobs new since then go last in the
+ *		order they were queried.
+ *
+ * @param[in,out]	jobs	-	jobs to order
+ * @param[in]	num_jobs	-	number of jobs
+ *
+ * @return	void
+ */
+static void
+seed_job_order(resource_resv **jobs, int num_jobs)
+{
+	static int *pos = NULL;
+	static int pos_size = 0;
+	static int *count = NULL;
+	static int count_size = 0;
+	static resource_resv **tmp = NULL;
+	static int tmp_size = 0;
+	struct job_sort_order key;
+	struct job_sort_order *found;
+	void *p;
+	int i;
+
+	if (last_order_len == 0)
+		return;
+
+	if (num_jobs > pos_size) {
+		if ((p = realloc(pos, num_jobs * sizeof(int))) == NULL)
+			return;
+		pos = p;
+		pos_size = num_jobs;
+	}
+	if (num_jobs > tmp_size) {
+		if ((p = realloc(tmp, num_jobs * sizeof(resource_resv *))) == NULL)
+			return;
+		tmp = p;
+		tmp_size = num_jobs;
+	}
+	if (last_order_len + 1 > count_size) {
+		if ((p = realloc(count, (last_order_len + 1) * sizeof(int))) == NULL)
+			return;
+		count = p;
+		count_size = last_order_len + 1;
+	}
+
+	for (i = 0; i < num_jobs; i++) {
+		key.qrank = jobs[i]->qrank;
+		key.name = jobs[i]->name;
+		found = bsearch(&key, last_order, last_order_len,
+			sizeof(struct job_sort_order), cmp_job_sort_order);
+		pos[i] = found != NULL ? found->pos : last_order_len;
+	}
+
+	/* counting sort on the old position, new jobs are at last_order_len */
+	memset(count, 0, (last_order_len + 1) * sizeof(int));
+	for (i = 0; i < num_jobs; i++)
+		count[pos[i]]++;
+	for (i = 1; i <= last_order_len; i++)
+		count[i] += count[i - 1];
+	for (i = num_jobs - 1; i >= 0; i--)
+		tmp[--count[pos[i]]] = jobs[i];
+	memcpy(jobs, tmp, num_jobs * sizeof(resource_resv *));
+}
+
+/**
+ * @brief
+ * 		sort a nearly sorted array of jobs by sorting only the jobs out
+ *		of place and merging them back in.
+ *
+ * @param[in,out]	jobs	-	jobs to sort
+ * @param[in]	num_jobs	-	number of jobs
+ *
+ * @return	int
+ * @retval	1	: jobs are sorted
+ * @retval	0	: too many jobs are out of place, jobs are untouched
+ */
+static int
+resort_job_array(resource_resv **jobs, int num_jobs)
+{
+	static resource_resv **kept = NULL;
+	static resource_resv **moved = NULL;
+	static int buf_size = 0;
+	void *p;
+	int nkept = 0;
+	int nmoved = 0;
+	int i;
+	int k;
+	int m;
+
+	if (num_jobs > buf_size) {
+		if ((p = realloc(kept, num_jobs * sizeof(resource_resv *))) == NULL)
+			return 0;
+		kept = p;
+		if ((p = realloc(moved, num_jobs * sizeof(resource_resv *))) == NULL)
+			return 0;
+		moved = p;
+		buf_size = num_jobs;
+	}
+
+	/* Keep the longest ordered run we can find greedily.  When a job is
+	 * greater than the one after it, one of the two is out of place; if
+	 * the next one is also less than the last kept job, it is the next one.
+	 */
+	for (i = 0; i < num_jobs; i++) {
+		if ((nkept == 0 || cmp_job_sort_key(&kept[nkept - 1], &jobs[i]) <= 0) &&
+			(i + 1 == num_jobs || cmp_job_sort_key(&jobs[i], &jobs[i + 1]) <= 0 ||
+			(nkept > 0 && cmp_job_sort_key(&kept[nkept - 1], &jobs[i + 1]) > 0)))
+			kept[nkept++] = jobs[i];
+		else {
+			if (nmoved >= num_jobs / JOB_RESORT_MOVED_DIV)
+				return 0;
+			moved[nmoved++] = jobs[i];
+		}
+	}
+
+	if (nmoved == 0)
+		return 1;
+
+	qsort(moved, nmoved, sizeof(resource_resv *), cmp_job_sort_key);
+
+	for (i = 0, k = 0, m = 0; k < nkept && m < nmoved; i++) {
+		if (cmp_job_sort_key(&moved[m], &kept[k]) < 0)
+			jobs[i] = moved[m++];
+		else
+			jobs[i] = kept[k++];
+	}
+	while (k < nkept)
+		jobs[i++] = kept[k++];
+	while (m < nmoved)
+		jobs[i++] = moved[m++];
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		sort_job_array - sort an array of jobs with job_sort_keys.
+ *		The array is usually close to sorted: either it was sorted
+ *		earlier in the cycle, or it is put in the last cycle's order.
+ *		Only the jobs which moved are then sorted.
+ *
+ * @param[in,out]	jobs	-	jobs to sort
+ * @param[in]	num_jobs	-	number of jobs
+ *
+ * @return	void
+ */
+static void
+sort_job_array(resource_resv **jobs, int num_jobs)
+{
+	int i;
+
+	if (jobs == NULL || num_jobs < 2)
+		return;
+
+	if (jobs[0]->job != NULL && jobs[0]->job->sort_pos == -1)
+		seed_job_order(jobs, num_jobs);
+
+	if (num_jobs < JOB_RESORT_MOVED_DIV || resort_job_array(jobs, num_jobs) == 0)
+		qsort(jobs, num_jobs, sizeof(resource_resv *), cmp_job_sort_key);
+
+	for (i = 0; i < num_jobs; i++)
+		if (jobs[i]->job != NULL)
+			jobs[i]->job->sort_pos = i;
+}
+
+/**
+ * @brief
+ * 		save_job_sort_order - remember the order of the jobs at the end
+ *		of a cycle so the next cycle's sort can start from it
+ *
+ * @param[in]	sinfo	-	server whose jobs to remember
+ *
+ * @return	void
+ */
+void
+save_job_sort_order(server_info *sinfo)
+{
+	struct job_sort_order *order;
+	char *names;
+	size_t len = 0;
+	int num_jobs;
+	int n = 0;
+	int i;
+
+	free(last_order);
+	free(last_order_names);
+	last_order = NULL;
+	last_order_names = NULL;
+	last_order_len = 0;
+
+	if (sinfo == NULL || sinfo->jobs == NULL)
+		return;
+
+	num_jobs = count_array((void **) sinfo->jobs);
+	for (i = 0; i < num_jobs; i++)
+		len += strlen(sinfo->jobs[i]->name) + 1;
+	if (num_jobs == 0)
+		return;
+
+	order = malloc(num_jobs * sizeof(struct job_sort_order));
+	names = malloc(len);
+	if (order == NULL || names == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(order);
+		free(names);
+		return;
+	}
+
+	len = 0;
+	for (i = 0; i < num_jobs; i++) {
+		resource_resv *resresv = sinfo->jobs[i];
+
+		if (resresv->job == NULL || resresv->job->sort_pos == -1)
+			continue;
+		order[n].qrank = resresv->qrank;
+		order[n].name = strcpy(&names[len], resresv->name);
+		order[n].pos = resresv->job->sort_pos;
+		len += strlen(resresv->name) + 1;
+		n++;
+	}
+	qsort(order, n, sizeof(struct job_sort_order), cmp_job_sort_order);
+
+	last_order = order;
+	last_order_names = names;
+	last_order_len = n;
+}
+
 /**
  * @brief
  * 		sort_jobs - This function sorts all jobs according to their preemption
@@ -1283,6 +1791,14 @@ sort_jobs(status *policy, server_info *sinfo)
 	int job_index = 0;
 	int index = 0;
 	int count = 0;
+	double prof_ts;
+
+	prof_ts = profile_begin();
+
+	/* evaluate what the jobs are sorted on once, rather than on each
+	 * comparison.  Without keys, cmp_job_sort_key() falls back to cmp_sort()
+	 */
+	make_job_sort_keys(policy, sinfo->jobs);
 
 	/** sort jobs in such a way that Higher Priority jobs come on top
 	 * followed by preempted jobs and then starving jobs and normal jobs
@@ -1297,8 +1813,8 @@ sort_jobs(status *policy, server_info *sinfo)
 			 */
 			for (; i < sinfo->num_queues; i++) {
 				if (sinfo->queues[i]->sc.total > 0) {
-					qsort(sinfo->queues[i]->jobs, sinfo->queues[i]->sc.total,
-						sizeof(resource_resv*), cmp_sort);
+					sort_job_array(sinfo->queues[i]->jobs,
+						sinfo->queues[i]->sc.total);
 				}
 			}
 			for (count = 0; count != sinfo->num_queues; count++) {
@@ -1311,16 +1827,15 @@ sort_jobs(status *policy, server_info *sinfo)
 		}
 		/** Sort on entire complex **/
 		else if (!policy->by_queue && !policy->round_robin) {
-			qsort(sinfo->jobs, count_array((void **)sinfo->jobs),
-				sizeof(resource_resv *), cmp_sort);
+			sort_job_array(sinfo->jobs, count_array((void **)sinfo->jobs));
 		}
 	}
 	else if (policy->by_queue) {
 		for (i = 0; i < sinfo->num_queues; i++) {
-			qsort(sinfo->queues[i]->jobs, count_array((void **)sinfo->queues[i]->jobs),
-				sizeof(resource_resv *), cmp_sort);
+			sort_job_array(sinfo->queues[i]->jobs,
+				count_array((void **)sinfo->queues[i]->jobs));
 		}
-		qsort(sinfo->jobs, count_array((void **)sinfo->jobs), sizeof(resource_resv*), cmp_sort);
+		sort_job_array(sinfo->jobs, count_array((void **)sinfo->jobs));
 	}
 	else if (policy->round_robin) {
 		if (sinfo -> queue_list != NULL) {
@@ -1331,15 +1846,18 @@ sort_jobs(status *policy, server_info *sinfo)
 				int queue_index_size = count_array((void **)sinfo->queue_list[i]);
 				for (j = 0; j < queue_index_size; j++)
 				{
-				    qsort(sinfo->queue_list[i][j]->jobs, count_array((void **)sinfo->queue_list[i][j]->jobs),
-					    sizeof(resource_resv *), cmp_sort);
+				    sort_job_array(sinfo->queue_list[i][j]->jobs,
+					    count_array((void **)sinfo->queue_list[i][j]->jobs));
 				}
 			}
 
 		}
 	}
 	else
-		qsort(sinfo->jobs, count_array((void **)sinfo->jobs), sizeof(resource_resv*), cmp_sort);
+		sort_job_array(sinfo->jobs, count_array((void **)sinfo->jobs));
+
+	free_job_sort_keys(sinfo->jobs);
+	profile_end(PROF_SORT, NULL, prof_ts);
 }
 
 /*
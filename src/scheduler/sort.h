@@ -117,6 +117,11 @@ int cmp_job_sort_formula(const void *j1, const void *j2);
  */
 int cmp_sort(const void *v1, const void *v2);
 
+/*
+ *      cmp_job_sort_key - cmp_sort() on the keys precomputed by sort_jobs()
+ */
+int cmp_job_sort_key(const void *v1, const void *v2);
+
 /*
  *      find_resresv_amount - find resource amount for jobs + special cases
  */
@@ -204,6 +209,12 @@ int cmp_resv_state(const void *r1, const void *r2);
  */
 void sort_jobs(status *policy, server_info *sinfo);
 
+/*
+ * save_job_sort_order - remember the job order at the end of a cycle
+ *			 to start the next cycle's sort from
+ */
+void save_job_sort_order(server_info *sinfo);
+
 #ifdef	__cplusplus
 }
 #endif
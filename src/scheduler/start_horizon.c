@@ -0,0 +1,651 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    start_horizon.c
+ *
+ * @brief
+ * 		start_horizon.c - free resource timelines of the hosts built from a
+ *		calendar, used to bound the start time search of top jobs.
+ *
+ *		The horizon holds the amount of each tracked consumable resource
+ *		free on each host now, one column of hosts per resource, and the
+ *		changes the calendar's run and end events make to it, sorted by
+ *		time.  A sweep over the changes finds the first event time after
+ *		which every chunk of a select spec could fit on the hosts.
+ *		calc_run_time() does not need to check if the job can run at any
+ *		event before it.
+ *
+ *		The free amounts are never less than what eval_selspec() could
+ *		find: the vnodes of a host are summed since a chunk may span
+ *		them, and what can't be modeled (indirect resources, unset
+ *		resources in resource_unset_infinite) is taken to be unlimited.
+ *		Jobs in reservations are left out since they don't use the
+ *		hosts' resources.
+ *
+ *		The horizon is built the first time it is needed and kept up to
+ *		date as events are added to the calendar with add_event().  Any
+ *		other change to the calendar or resources being released on the
+ *		nodes makes it be rebuilt on next use.
+ *
+ * Functions included are:
+ * 	free_start_horizon()
+ * 	start_horizon_add_event()
+ * 	start_horizon_earliest()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+
+#include <log.h>
+#include "data_types.h"
+#include "constant.h"
+#include "check.h"
+#include "globals.h"
+#include "misc.h"
+#include "node_info.h"
+#include "resource.h"
+#include "server_info.h"
+#include "simulate.h"
+#include "start_horizon.h"
+
+/* slack for rounding when dividing free amounts by requested amounts */
+#define HORIZON_EPSILON 1e-6
+
+/* a change to the free amount of one resource on one host */
+struct horizon_step
+{
+	time_t time;
+	timed_event *te;		/* [reference] event making the change */
+	int host;
+	int col;
+	sch_resource_t amount;
+};
+
+struct start_horizon
+{
+	int num_cols;
+	resdef **cols;			/* [reference] resource of each column */
+	int num_nodes;
+	int *node_host;			/* host of each node by node_ind */
+	int num_hosts;
+	sch_resource_t *free;		/* num_cols rows of num_hosts free amounts */
+	unsigned char *unlimited;	/* same shape: the free amount is not bounded */
+	struct horizon_step *steps;	/* changes sorted by time */
+	int num_steps;
+	int size;
+	unsigned long gen;		/* calendar gen the horizon is up to date with */
+	int release_gen;		/* server release_gen the free amounts are from */
+};
+
+typedef struct horizon_step horizon_step;
+
+/**
+ * @brief
+ * 		free_start_horizon - start_horizon destructor
+ *
+ * @param[in]	hz	-	horizon to free
+ *
+ * @return	void
+ */
+void
+free_start_horizon(start_horizon *hz)
+{
+	if (hz == NULL)
+		return;
+
+	free(hz->cols);
+	free(hz->node_host);
+	free(hz->free);
+	free(hz->unlimited);
+	free(hz->steps);
+	free(hz);
+}
+
+/**
+ * @brief
+ * 		find the column of a resource
+ *
+ * @param[in]	hz	-	horizon
+ * @param[in]	def	-	resource
+ *
+ * @return	int
+ * @retval	column index
+ * @retval	-1	: the resource is not tracked
+ */
+static int
+horizon_col(start_horizon *hz, resdef *def)
+{
+	int i;
+
+	for (i = 0; i < hz->num_cols; i++)
+		if (hz->cols[i] == def)
+			return i;
+
+	return -1;
+}
+
+/**
+ * @brief
+ * 		insert a change after all changes at the same or an earlier time
+ *
+ * @param[in]	hz	-	horizon
+ * @param[in]	te	-	event making the change
+ * @param[in]	host	-	host index
+ * @param[in]	col	-	column index
+ * @param[in]	amount	-	change to the free amount
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
+ */
+static int
+add_step(start_horizon *hz, timed_event *te, int host, int col, sch_resource_t amount)
+{
+	horizon_step *tmp;
+	int pos;
+
+	if (hz->num_steps == hz->size) {
+		int size = hz->size == 0 ? 64 : hz->size * 2;
+
+		tmp = realloc(hz->steps, size * sizeof(horizon_step));
+		if (tmp == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		hz->steps = tmp;
+		hz->size = size;
+	}
+
+	/* events are almost always added at or near the end */
+	for (pos = hz->num_steps; pos > 0 && hz->steps[pos - 1].time > te->event_time; pos--)
+		;
+	if (pos < hz->num_steps)
+		memmove(&hz->steps[pos + 1], &hz->steps[pos],
+			(hz->num_steps - pos) * sizeof(horizon_step));
+
+	hz->steps[pos].time = te->event_time;
+	hz->steps[pos].te = te;
+	hz->steps[pos].host = host;
+	hz->steps[pos].col = col;
+	hz->steps[pos].amount = amount;
+	hz->num_steps++;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		add the changes an event makes to the free amounts on the hosts
+ *
+ * @param[in]	hz	-	horizon
+ * @param[in]	te	-	the event
+ *
+ * @return	int
+ * @retval	1	: success (including events which change nothing)
+ * @retval	0	: error
+ */
+static int
+horizon_event(start_horizon *hz, timed_event *te)
+{
+	resource_resv *resresv;
+	resource_req *req;
+	sch_resource_t sign;
+	int host;
+	int col;
+	int i;
+
+	if (!(te->event_type & (TIMED_RUN_EVENT | TIMED_END_EVENT)))
+		return 1;
+
+	resresv = (resource_resv *) te->event_ptr;
+	if (resresv == NULL || resresv->nspec_arr == NULL)
+		return 1;
+
+	/* jobs in a reservation use the reservation's resources */
+	if (resresv->is_job && resresv->job != NULL && resresv->job->resv != NULL)
+		return 1;
+
+	sign = (te->event_type == TIMED_RUN_EVENT) ? -1 : 1;
+
+	for (i = 0; resresv->nspec_arr[i] != NULL; i++) {
+		node_info *ninfo = resresv->nspec_arr[i]->ninfo;
+
+		if (ninfo == NULL || ninfo->node_ind < 0 || ninfo->node_ind >= hz->num_nodes)
+			continue;
+		host = hz->node_host[ninfo->node_ind];
+
+		for (req = resresv->nspec_arr[i]->resreq; req != NULL; req = req->next) {
+			if ((col = horizon_col(hz, req->def)) == -1)
+				continue;
+			if (hz->unlimited[col * hz->num_hosts + host])
+				continue;
+			if (!add_step(hz, te, host, col, sign * req->amount))
+				return 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		build the horizon of a calendar from the server's nodes and the
+ *		calendar's events which are still to be simulated
+ *
+ * @param[in]	sinfo	-	server the calendar belongs to
+ * @param[in]	calendar	-	calendar
+ *
+ * @return	start_horizon *
+ * @retval	new horizon
+ * @retval	NULL	: error
+ */
+static start_horizon *
+build_start_horizon(server_info *sinfo, event_list *calendar)
+{
+	start_horizon *hz;
+	resdef **rdtc;
+	timed_event *te;
+	int i;
+	int j;
+	int c;
+
+	if ((hz = calloc(1, sizeof(start_horizon))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+
+	/* a column for each consumable resource the scheduler checks */
+	rdtc = sinfo->policy->resdef_to_check;
+	hz->cols = malloc((count_array((void **) rdtc) + 2) * sizeof(resdef *));
+	if (hz->cols == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_start_horizon(hz);
+		return NULL;
+	}
+	for (i = 0; rdtc != NULL && rdtc[i] != NULL; i++)
+		if (rdtc[i]->type.is_consumable)
+			hz->cols[hz->num_cols++] = rdtc[i];
+	if (hz->num_cols == 0) {
+		hz->cols[hz->num_cols++] = getallres(RES_NCPUS);
+		hz->cols[hz->num_cols++] = getallres(RES_MEM);
+	}
+
+	/* vnodes of a host share a column entry: a chunk may span them */
+	hz->num_nodes = sinfo->num_nodes;
+	hz->node_host = malloc((hz->num_nodes + 1) * sizeof(int));
+	if (hz->node_host == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_start_horizon(hz);
+		return NULL;
+	}
+	for (i = 0; i < hz->num_nodes; i++)
+		hz->node_host[i] = -1;
+	for (i = 0; sinfo->hostsets != NULL && sinfo->hostsets[i] != NULL; i++) {
+		node_info **ninfo_arr = sinfo->hostsets[i]->ninfo_arr;
+
+		for (j = 0; ninfo_arr != NULL && ninfo_arr[j] != NULL; j++) {
+			int ind = ninfo_arr[j]->node_ind;
+
+			if (ind >= 0 && ind < hz->num_nodes && hz->node_host[ind] == -1)
+				hz->node_host[ind] = hz->num_hosts;
+		}
+		hz->num_hosts++;
+	}
+	for (i = 0; i < hz->num_nodes; i++)
+		if (hz->node_host[i] == -1)
+			hz->node_host[i] = hz->num_hosts++;
+
+	hz->free = calloc(hz->num_cols * hz->num_hosts + 1, sizeof(sch_resource_t));
+	hz->unlimited = calloc(hz->num_cols * hz->num_hosts + 1, sizeof(unsigned char));
+	if (hz->free == NULL || hz->unlimited == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_start_horizon(hz);
+		return NULL;
+	}
+
+	for (i = 0; i < hz->num_nodes; i++) {
+		node_info *ninfo = sinfo->unordered_nodes[i];
+		int host = hz->node_host[ninfo->node_ind];
+
+		for (c = 0; c < hz->num_cols; c++) {
+			int k = c * hz->num_hosts + host;
+			schd_resource *res;
+
+			res = find_resource(ninfo->res, hz->cols[c]);
+			if (res == NULL || res->orig_str_avail == NULL) {
+				if (match_string_to_array(hz->cols[c]->name, conf.ignore_res) != SA_NO_MATCH) {
+					hz->unlimited[k] = 1;
+					continue;
+				}
+				if (res == NULL)
+					continue;
+			}
+			if (res->indirect_res != NULL) {
+				node_info *target;
+
+				/* the amount is used and freed on the vnode it comes from */
+				hz->unlimited[k] = 1;
+				target = find_node_info(sinfo->nodes, res->indirect_vnode_name);
+				if (target != NULL && target->node_ind >= 0 && target->node_ind < hz->num_nodes)
+					hz->unlimited[c * hz->num_hosts + hz->node_host[target->node_ind]] = 1;
+				continue;
+			}
+			if (res->avail == SCHD_INFINITY) {
+				hz->unlimited[k] = 1;
+				continue;
+			}
+			hz->free[k] += dynamic_avail(res);
+		}
+	}
+
+	for (te = get_next_event(calendar); te != NULL; te = te->next) {
+		if (!horizon_event(hz, te)) {
+			free_start_horizon(hz);
+			return NULL;
+		}
+	}
+
+	hz->gen = calendar->gen;
+	hz->release_gen = sinfo->release_gen;
+
+	return hz;
+}
+
+/**
+ * @brief
+ * 		start_horizon_add_event - keep a calendar's start horizon up to
+ *		date with an event add_event() just added
+ *
+ * @param[in]	calendar	-	calendar te was added to
+ * @param[in]	te	-	the new event
+ *
+ * @return	void
+ */
+void
+start_horizon_add_event(event_list *calendar, timed_event *te)
+{
+	start_horizon *hz;
+
+	if (calendar == NULL || (hz = calendar->horizon) == NULL)
+		return;
+
+	/* only a horizon which was up to date before te was linked, and only
+	 * for an event which is still to be simulated
+	 */
+	if (hz->gen + 1 != calendar->gen || calendar->current_time == NULL ||
+		te->event_time <= *calendar->current_time || !horizon_event(hz, te)) {
+		free_start_horizon(hz);
+		calendar->horizon = NULL;
+		return;
+	}
+	hz->gen = calendar->gen;
+}
+
+/**
+ * @brief
+ * 		how many of a chunk fit on a host
+ *
+ * @param[in]	hz	-	horizon
+ * @param[in]	work	-	free amounts, shaped like hz->free
+ * @param[in]	req	-	requested amount of each column for one chunk
+ * @param[in]	num_chunks	-	number of chunks wanted, the most returned
+ * @param[in]	host	-	host index
+ *
+ * @return	int
+ */
+static int
+chunk_units(start_horizon *hz, sch_resource_t *work, sch_resource_t *req,
+	int num_chunks, int host)
+{
+	double units = num_chunks;
+	double n;
+	int c;
+
+	for (c = 0; c < hz->num_cols; c++) {
+		if (req[c] <= 0 || hz->unlimited[c * hz->num_hosts + host])
+			continue;
+		n = floor(work[c * hz->num_hosts + host] / req[c] + HORIZON_EPSILON);
+		if (n < units)
+			units = n;
+	}
+
+	return units > 0 ? (int) units : 0;
+}
+
+/**
+ * @brief
+ * 		check if a select spec could fit on the hosts
+ *
+ * @param[in]	hz	-	horizon
+ * @param[in]	spec	-	the select spec
+ * @param[in]	sum	-	how many of each chunk fit on all hosts
+ * @param[in]	need	-	total requested of each column
+ * @param[in]	total	-	total free of each column
+ * @param[in]	num_unlimited	-	hosts with the column unlimited
+ *
+ * @return	int
+ * @retval	1	: it could fit
+ * @retval	0	: it can not fit
+ */
+static int
+horizon_fits(start_horizon *hz, selspec *spec, int *sum, sch_resource_t *need,
+	sch_resource_t *total, int *num_unlimited)
+{
+	int i;
+
+	for (i = 0; spec->chunks[i] != NULL; i++)
+		if (sum[i] < spec->chunks[i]->num_chunks)
+			return 0;
+	for (i = 0; i < hz->num_cols; i++)
+		if (need[i] > 0 && num_unlimited[i] == 0 && total[i] + HORIZON_EPSILON < need[i])
+			return 0;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		start_horizon_earliest - find the time of the first calendar
+ *		events after which there can be enough free resources on the
+ *		hosts for a resresv to run.  No check of whether the resresv can
+ *		run at an earlier event can succeed.
+ *
+ * @param[in]	sinfo	-	server whose calendar to search
+ * @param[in]	resresv	-	the resresv to start
+ *
+ * @return	time_t
+ * @retval	time of the events
+ * @retval	0	: there is enough now, the resresv is not supported or
+ *			  error.  Every event has to be checked.
+ */
+time_t
+start_horizon_earliest(server_info *sinfo, resource_resv *resresv)
+{
+	event_list *calendar;
+	start_horizon *hz;
+	selspec *spec;
+	sch_resource_t *req = NULL;	/* num_chunks rows of num_cols */
+	sch_resource_t *need = NULL;	/* total requested of each column */
+	sch_resource_t *total = NULL;	/* total free of each column */
+	int *num_unlimited = NULL;	/* hosts with an unlimited column */
+	sch_resource_t *work = NULL;	/* free amounts as the sweep goes */
+	int *units = NULL;		/* num_chunks rows of num_hosts */
+	int *sum = NULL;		/* chunks which fit on all hosts */
+	int *changed = NULL;		/* hosts changed at the current time */
+	unsigned char *mark = NULL;
+	int num_chunks;
+	int constrained = 0;
+	time_t earliest = 0;
+	time_t t;
+	int i;
+	int k;
+	int c;
+	int h;
+
+	if (sinfo == NULL || resresv == NULL || (calendar = sinfo->calendar) == NULL)
+		return 0;
+
+	spec = resresv->select;
+	if (spec == NULL || spec->chunks == NULL)
+		return 0;
+	if (resresv->is_job && resresv->job != NULL && resresv->job->resv != NULL)
+		return 0;
+
+	hz = calendar->horizon;
+	if (hz != NULL && (hz->gen != calendar->gen || hz->release_gen != sinfo->release_gen)) {
+		free_start_horizon(hz);
+		hz = calendar->horizon = NULL;
+	}
+	if (hz == NULL) {
+		if ((hz = build_start_horizon(sinfo, calendar)) == NULL)
+			return 0;
+		calendar->horizon = hz;
+	}
+
+	num_chunks = count_array((void **) spec->chunks);
+
+	req = calloc(num_chunks * hz->num_cols + 1, sizeof(sch_resource_t));
+	need = calloc(hz->num_cols, sizeof(sch_resource_t));
+	total = calloc(hz->num_cols, sizeof(sch_resource_t));
+	num_unlimited = calloc(hz->num_cols, sizeof(int));
+	work = malloc((hz->num_cols * hz->num_hosts + 1) * sizeof(sch_resource_t));
+	units = calloc(num_chunks * hz->num_hosts + 1, sizeof(int));
+	sum = calloc(num_chunks + 1, sizeof(int));
+	changed = malloc((hz->num_hosts + 1) * sizeof(int));
+	mark = calloc(hz->num_hosts + 1, sizeof(unsigned char));
+	if (req == NULL || need == NULL || total == NULL || num_unlimited == NULL ||
+		work == NULL || units == NULL || sum == NULL || changed == NULL || mark == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		goto done;
+	}
+
+	for (k = 0; k < num_chunks; k++) {
+		resource_req *r;
+
+		for (r = spec->chunks[k]->req; r != NULL; r = r->next) {
+			if ((c = horizon_col(hz, r->def)) == -1 || r->amount <= 0)
+				continue;
+			req[k * hz->num_cols + c] = r->amount;
+			need[c] += spec->chunks[k]->num_chunks * r->amount;
+			constrained = 1;
+		}
+	}
+	/* nothing the horizon tracks is requested */
+	if (!constrained)
+		goto done;
+
+	memcpy(work, hz->free, hz->num_cols * hz->num_hosts * sizeof(sch_resource_t));
+	for (c = 0; c < hz->num_cols; c++) {
+		for (h = 0; h < hz->num_hosts; h++) {
+			if (hz->unlimited[c * hz->num_hosts + h])
+				num_unlimited[c]++;
+			else
+				total[c] += work[c * hz->num_hosts + h];
+		}
+	}
+	for (k = 0; k < num_chunks; k++) {
+		for (h = 0; h < hz->num_hosts; h++) {
+			units[k * hz->num_hosts + h] = chunk_units(hz, work,
+				&req[k * hz->num_cols], spec->chunks[k]->num_chunks, h);
+			sum[k] += units[k * hz->num_hosts + h];
+		}
+	}
+
+	if (horizon_fits(hz, spec, sum, need, total, num_unlimited))
+		goto done;	/* there is enough now: every event is checked */
+
+	i = 0;
+	while (i < hz->num_steps) {
+		int num_changed = 0;
+		int grew = 0;
+
+		/* apply every change at the next time */
+		t = hz->steps[i].time;
+		for (; i < hz->num_steps && hz->steps[i].time == t; i++) {
+			horizon_step *st = &hz->steps[i];
+
+			if (st->te->disabled)
+				continue;
+			work[st->col * hz->num_hosts + st->host] += st->amount;
+			total[st->col] += st->amount;
+			if (st->amount > 0)
+				grew = 1;
+			if (!mark[st->host]) {
+				mark[st->host] = 1;
+				changed[num_changed++] = st->host;
+			}
+		}
+		for (h = 0; h < num_changed; h++) {
+			int host = changed[h];
+
+			mark[host] = 0;
+			for (k = 0; k < num_chunks; k++) {
+				int u = chunk_units(hz, work, &req[k * hz->num_cols],
+					spec->chunks[k]->num_chunks, host);
+
+				sum[k] += u - units[k * hz->num_hosts + host];
+				units[k * hz->num_hosts + host] = u;
+			}
+		}
+
+		/* if there is never enough, the last events are still checked */
+		earliest = t;
+		if (grew && horizon_fits(hz, spec, sum, need, total, num_unlimited))
+			break;
+	}
+
+done:
+	free(req);
+	free(need);
+	free(total);
+	free(num_unlimited);
+	free(work);
+	free(units);
+	free(sum);
+	free(changed);
+	free(mark);
+
+	return earliest;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef	_START_HORIZON_H
+#define	_START_HORIZON_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include "data_types.h"
+#include "constant.h"
+
+/*
+ *	free_start_horizon - start_horizon destructor
+ */
+void free_start_horizon(start_horizon *hz);
+
+/*
+ *	start_horizon_add_event - keep a calendar's start horizon up to date
+ *				  with an event add_event() just added
+ */
+void start_horizon_add_event(event_list *calendar, timed_event *te);
+
+/*
+ *	start_horizon_earliest - the time of the first calendar events after
+ *				 which there can be enough free resources on
+ *				 the hosts for a resresv to run
+ *
+ *	returns 0 if no such bound could be found and every event has to be
+ *	checked
+ */
+time_t start_horizon_earliest(server_info *sinfo, resource_resv *resresv);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _START_HORIZON_H */
@@ -0,0 +1,324 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    thread_pool.c
+ *
+ * @brief
+ * 		thread_pool.c - a fixed pool of worker threads used to split
+ *		read-only per-node evaluation across cores.
+ *
+ *		The work is always split into contiguous slices in the same order
+ *		and the caller waits for every slice, so results land in the same
+ *		place no matter how many threads there are.  The calling thread
+ *		works on the first slice itself.  Workers block all signals so
+ *		signal handling stays on the main scheduler thread.  Workers
+ *		are only started when work is first run, so setting the size
+ *		before the scheduler forks into the background is safe.
+ *
+ *		Functions run in the pool must not modify the server universe,
+ *		log, or use static buffers.
+ *
+ * Functions included are:
+ * 	set_thread_pool_size()
+ * 	thread_pool_size()
+ * 	run_in_thread_pool()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#include <signal.h>
+#ifndef WIN32
+#include <pthread.h>
+#endif
+#include <log.h>
+#include "constant.h"
+#include "misc.h"
+#include "thread_pool.h"
+
+#ifndef WIN32
+static struct thread_pool {
+	int size;		/* requested number of threads, incl. the caller */
+	int nthreads;		/* threads work is split across, incl. the caller */
+	pthread_t *tids;	/* worker threads (nthreads - 1 of them) */
+	pthread_mutex_t lock;
+	pthread_cond_t work_cv;	/* signalled when a new batch is posted */
+	pthread_cond_t done_cv;	/* signalled when the last slice finishes */
+	unsigned long batch;	/* bumped for each batch of work */
+	unsigned long start_batch;	/* batch when the workers were started */
+	int pending;		/* worker slices of the batch not yet done */
+	int quit;		/* tell the workers to exit */
+	tp_work_func func;	/* the current batch */
+	void *arg;
+	int n;
+} pool = {1, 1, NULL, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER,
+	PTHREAD_COND_INITIALIZER, 0, 0, 0, 0, NULL, NULL, 0};
+
+/**
+ * @brief
+ * 		run slice number 'slice' of the current batch
+ *
+ * @param[in]	slice	-	slice to run
+ *
+ * @return	void
+ */
+static void
+run_slice(int slice)
+{
+	int start;
+	int end;
+
+	start = (int) (((long long) pool.n * slice) / pool.nthreads);
+	end = (int) (((long long) pool.n * (slice + 1)) / pool.nthreads);
+
+	if (start < end)
+		pool.func(pool.arg, start, end);
+}
+
+/**
+ * @brief
+ * 		worker thread main loop
+ *
+ * @param[in]	arg	-	the slice this worker runs (1 .. nthreads-1)
+ *
+ * @return	NULL
+ */
+static void *
+worker_main(void *arg)
+{
+	int slice = (int) (long) arg;
+	unsigned long seen;
+	sigset_t allsigs;
+
+	sigfillset(&allsigs);
+	pthread_sigmask(SIG_BLOCK, &allsigs, NULL);
+
+	pthread_mutex_lock(&pool.lock);
+	/* a batch may already be posted by the time we get here */
+	seen = pool.start_batch;
+	for (;;) {
+		while (pool.batch == seen && !pool.quit)
+			pthread_cond_wait(&pool.work_cv, &pool.lock);
+		if (pool.quit)
+			break;
+		seen = pool.batch;
+		pthread_mutex_unlock(&pool.lock);
+
+		run_slice(slice);
+
+		pthread_mutex_lock(&pool.lock);
+		if (--pool.pending == 0)
+			pthread_cond_signal(&pool.done_cv);
+	}
+	pthread_mutex_unlock(&pool.lock);
+
+	return NULL;
+}
+
+/**
+ * @brief
+ * 		stop and join all worker threads
+ *
+ * @return	void
+ */
+static void
+stop_workers(void)
+{
+	int i;
+
+	if (pool.tids == NULL)
+		return;
+
+	pthread_mutex_lock(&pool.lock);
+	pool.quit = 1;
+	pthread_cond_broadcast(&pool.work_cv);
+	pthread_mutex_unlock(&pool.lock);
+
+	for (i = 0; i < pool.nthreads - 1; i++)
+		pthread_join(pool.tids[i], NULL);
+
+	free(pool.tids);
+	pool.tids = NULL;
+	pool.quit = 0;
+	pool.nthreads = 1;
+}
+
+/**
+ * @brief
+ * 		start the worker threads for the requested pool size.  If not
+ *		all of them can be started, the pool shrinks to the ones which were.
+ *
+ * @return	void
+ */
+static void
+start_workers(void)
+{
+	int i;
+	int rc;
+
+	if ((pool.tids = malloc((pool.size - 1) * sizeof(pthread_t))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		pool.size = 1;
+		return;
+	}
+
+	pool.start_batch = pool.batch;
+	pool.nthreads = pool.size;
+	for (i = 0; i < pool.size - 1; i++) {
+		/* slices are fixed at start so the worker knows its slice */
+		rc = pthread_create(&pool.tids[i], NULL, worker_main,
+			(void *) (long) (i + 1));
+		if (rc != 0) {
+			/* pthread_create() returns its error, errno is not set */
+			log_err(rc, __func__, "pthread_create failed");
+			break;
+		}
+	}
+
+	/* keep the workers we could start, slices follow nthreads */
+	pool.nthreads = i + 1;
+	pool.size = pool.nthreads;
+	if (pool.nthreads == 1) {
+		free(pool.tids);
+		pool.tids = NULL;
+	}
+}
+
+/**
+ * @brief
+ * 		set_thread_pool_size - set the number of threads work is split
+ *		across, including the calling thread.  Running workers of a
+ *		different sized pool are stopped; new ones start on first use.
+ *
+ * @param[in]	nthreads	-	number of threads, 1 or less is serial
+ *
+ * @return	int
+ * @retval	the number of threads which will be used
+ */
+int
+set_thread_pool_size(int nthreads)
+{
+	if (nthreads < 1)
+		nthreads = 1;
+
+	if (nthreads != pool.size) {
+		stop_workers();
+		pool.size = nthreads;
+	}
+
+	return pool.size;
+}
+
+/**
+ * @brief
+ * 		thread_pool_size - the number of threads work is split across
+ *
+ * @return	int
+ */
+int
+thread_pool_size(void)
+{
+	return pool.size;
+}
+
+/**
+ * @brief
+ * 		run_in_thread_pool - run func over [0, n) split into one
+ *		contiguous slice per thread and wait for all of them
+ *
+ * @param[in]	func	-	work function
+ * @param[in]	arg	-	argument passed to func
+ * @param[in]	n	-	number of work items
+ *
+ * @return	void
+ */
+void
+run_in_thread_pool(tp_work_func func, void *arg, int n)
+{
+	if (func == NULL || n <= 0)
+		return;
+
+	if (pool.size > 1 && pool.nthreads != pool.size)
+		start_workers();
+
+	if (pool.nthreads <= 1) {
+		func(arg, 0, n);
+		return;
+	}
+
+	pthread_mutex_lock(&pool.lock);
+	pool.func = func;
+	pool.arg = arg;
+	pool.n = n;
+	pool.pending = pool.nthreads - 1;
+	pool.batch++;
+	pthread_cond_broadcast(&pool.work_cv);
+	pthread_mutex_unlock(&pool.lock);
+
+	run_slice(0);
+
+	pthread_mutex_lock(&pool.lock);
+	while (pool.pending > 0)
+		pthread_cond_wait(&pool.done_cv, &pool.lock);
+	pthread_mutex_unlock(&pool.lock);
+}
+#else
+/* Windows: the pool is always serial */
+int
+set_thread_pool_size(int nthreads)
+{
+	return 1;
+}
+
+int
+thread_pool_size(void)
+{
+	return 1;
+}
+
+void
+run_in_thread_pool(tp_work_func func, void *arg, int n)
+{
+	if (func != NULL && n > 0)
+		func(arg, 0, n);
+}
+#endif /* WIN32 */
@@ -0,0 +1,75 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+#ifndef	_THREAD_POOL_H
+#define	_THREAD_POOL_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+/*
+ *	work function run on a slice [start, end) of a range of work items
+ *	arg is passed through from run_in_thread_pool()
+ */
+typedef void (*tp_work_func)(void *arg, int start, int end);
+
+/*
+ *	set_thread_pool_size - set the number of threads work is split
+ *			       across (including the calling thread).  1 or
+ *			       less means serial.  Workers start on first use.
+ *
+ *	returns the number of threads which will be used
+ */
+int set_thread_pool_size(int nthreads);
+
+/*
+ *	thread_pool_size - the number of threads work is split across
+ */
+int thread_pool_size(void);
+
+/*
+ *	run_in_thread_pool - run func over [0, n) split into one contiguous
+ *			     slice per thread and wait for all slices to finish
+ */
+void run_in_thread_pool(tp_work_func func, void *arg, int n);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _THREAD_POOL_H */
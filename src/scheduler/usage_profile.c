@@ -0,0 +1,619 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+
+/**
+ * @file    usage_profile.c
+ *
+ * @brief
+ * 		usage_profile.c - step functions of future job usage built from a
+ *		calendar, used for calendar aware limit checks.
+ *
+ *		For each limit scope (the server or a queue) and entity (user,
+ *		group, project or all jobs), the profile holds the change in
+ *		running jobs and in each resource with a limit after each job
+ *		run and end event, in calendar order, along with the running
+ *		maximum of that change.  The peak usage of an entity between the
+ *		calendar's next event and a time is then its current counts plus
+ *		a lookup instead of a replay of the calendar.
+ *
+ *		The profile is built the first time it is needed and kept up to
+ *		date as events are added to the calendar with add_event().  Any
+ *		other change to the calendar makes it be rebuilt on next use.
+ *		Only job events are profiled.
+ *
+ * Functions included are:
+ * 	free_usage_profile()
+ * 	usage_profile_add_event()
+ * 	usage_profile_peak()
+ *
+ */
+#include <pbs_config.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <log.h>
+#include <avltree.h>
+#include "data_types.h"
+#include "constant.h"
+#include "resource_resv.h"
+#include "limits_if.h"
+#include "simulate.h"
+#include "usage_profile.h"
+
+/* usage changes of one entity in one scope */
+struct usage_series
+{
+	timed_event **te;		/* events in calendar order */
+	sch_resource_t *cum;		/* nsteps rows of the change since the start */
+	sch_resource_t *peak;		/* nsteps rows of the running max of cum and 0 */
+	int nsteps;
+	int size;
+};
+
+struct usage_profile
+{
+	AVL_IX_DESC *series;		/* series key -> usage_series */
+	schd_resource *limres;		/* [reference] resources with limits */
+	int width;			/* 1 (running jobs) + number of limres */
+	sch_resource_t *delta;		/* width scratch row for profile_event() */
+	unsigned long gen;		/* calendar gen the profile is up to date with */
+};
+
+typedef struct usage_series usage_series;
+
+static const char usage_entity_chars[] = "ugpo";
+
+/**
+ * @brief
+ * 		make the key of a series
+ *
+ * @param[in]	qname	-	queue of the scope or NULL for the server
+ * @param[in]	type	-	entity type
+ * @param[in]	name	-	entity name
+ *
+ * @return	char *
+ * @retval	malloc'd key
+ * @retval	NULL	: error
+ */
+static char *
+series_key(char *qname, enum usage_entity type, char *name)
+{
+	char *key;
+	size_t len;
+
+	if (qname == NULL)
+		qname = "";
+	/* queue names can't have a ':' in them, so keys are unique */
+	len = strlen(qname) + strlen(name) + 4;
+	if ((key = malloc(len)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	snprintf(key, len, "%s:%c:%s", qname, usage_entity_chars[type], name);
+
+	return key;
+}
+
+/**
+ * @brief
+ * 		free a usage series
+ *
+ * @param[in]	us	-	series to free
+ *
+ * @return	void
+ */
+static void
+free_usage_series(usage_series *us)
+{
+	if (us == NULL)
+		return;
+
+	free(us->te);
+	free(us->cum);
+	free(us->peak);
+	free(us);
+}
+
+/**
+ * @brief
+ * 		free_usage_profile - usage_profile destructor
+ *
+ * @param[in]	prof	-	profile to free
+ *
+ * @return	void
+ */
+void
+free_usage_profile(usage_profile *prof)
+{
+	AVL_IX_REC *rec;
+
+	if (prof == NULL)
+		return;
+
+	if (prof->series != NULL) {
+		rec = avlkey_create(prof->series, NULL);
+		if (rec != NULL) {
+			avl_first_key(prof->series);
+			while (avl_next_key(rec, prof->series) == AVL_IX_OK)
+				free_usage_series(rec->recptr);
+			free(rec);
+		}
+		avl_destroy_index(prof->series);
+		free(prof->series);
+	}
+	free(prof->delta);
+	free(prof);
+}
+
+/**
+ * @brief
+ * 		create an empty usage profile for the current limit resources
+ *
+ * @return	usage_profile *
+ * @retval	NULL	: error
+ */
+static usage_profile *
+new_usage_profile(void)
+{
+	usage_profile *prof;
+	schd_resource *res;
+
+	if ((prof = calloc(1, sizeof(usage_profile))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		return NULL;
+	}
+	if ((prof->series = create_tree(AVL_NO_DUP_KEYS, 0)) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free(prof);
+		return NULL;
+	}
+	prof->limres = query_limres();
+	prof->width = 1;
+	for (res = prof->limres; res != NULL; res = res->next)
+		prof->width++;
+	if ((prof->delta = malloc(prof->width * sizeof(sch_resource_t))) == NULL) {
+		log_err(errno, __func__, MEM_ERR_MSG);
+		free_usage_profile(prof);
+		return NULL;
+	}
+
+	return prof;
+}
+
+/**
+ * @brief
+ * 		find a series of a profile, creating it if it does not exist
+ *
+ * @param[in]	prof	-	profile
+ * @param[in]	qname	-	queue of the scope or NULL for the server
+ * @param[in]	type	-	entity type
+ * @param[in]	name	-	entity name
+ *
+ * @return	usage_series *
+ * @retval	NULL	: error
+ */
+static usage_series *
+find_alloc_series(usage_profile *prof, char *qname, enum usage_entity type, char *name)
+{
+	usage_series *us;
+	char *key;
+
+	if ((key = series_key(qname, type, name)) == NULL)
+		return NULL;
+
+	if ((us = find_tree(prof->series, key)) == NULL) {
+		if ((us = calloc(1, sizeof(usage_series))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(key);
+			return NULL;
+		}
+		if (tree_add_del(prof->series, key, us, TREE_OP_ADD) != 0) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			free(us);
+			free(key);
+			return NULL;
+		}
+	}
+	free(key);
+
+	return us;
+}
+
+/**
+ * @brief
+ * 		add a step to a series.  Steps at or after index pos move up
+ *		one, and pos and every later step change by delta.
+ *
+ * @param[in,out]	us	-	series
+ * @param[in]	width	-	row width of the series
+ * @param[in]	pos	-	index of the new step
+ * @param[in]	te	-	event of the step
+ * @param[in]	delta	-	change of the event
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
+ */
+static int
+insert_step(usage_series *us, int width, int pos, timed_event *te, sch_resource_t *delta)
+{
+	timed_event **tes;
+	sch_resource_t *cum;
+	sch_resource_t *peak;
+	sch_resource_t *row;
+	sch_resource_t *prev;
+	int nsize;
+	int i;
+	int j;
+
+	if (us->nsteps == us->size) {
+		nsize = us->size * 2 + 8;
+		if ((tes = realloc(us->te, nsize * sizeof(timed_event *))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		us->te = tes;
+		if ((cum = realloc(us->cum, nsize * width * sizeof(sch_resource_t))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		us->cum = cum;
+		if ((peak = realloc(us->peak, nsize * width * sizeof(sch_resource_t))) == NULL) {
+			log_err(errno, __func__, MEM_ERR_MSG);
+			return 0;
+		}
+		us->peak = peak;
+		us->size = nsize;
+	}
+
+	if (pos < us->nsteps) {
+		memmove(&us->te[pos + 1], &us->te[pos],
+			(us->nsteps - pos) * sizeof(timed_event *));
+		memmove(&us->cum[(pos + 1) * width], &us->cum[pos * width],
+			(us->nsteps - pos) * width * sizeof(sch_resource_t));
+	}
+	us->nsteps++;
+	us->te[pos] = te;
+
+	row = &us->cum[pos * width];
+	for (j = 0; j < width; j++)
+		row[j] = (pos > 0 ? row[j - width] : 0) + delta[j];
+	for (i = pos + 1; i < us->nsteps; i++) {
+		row = &us->cum[i * width];
+		for (j = 0; j < width; j++)
+			row[j] += delta[j];
+	}
+
+	for (i = pos; i < us->nsteps; i++) {
+		row = &us->peak[i * width];
+		prev = i > 0 ? &us->peak[(i - 1) * width] : NULL;
+		for (j = 0; j < width; j++) {
+			row[j] = us->cum[i * width + j];
+			if (prev != NULL) {
+				if (prev[j] > row[j])
+					row[j] = prev[j];
+			} else if (row[j] < 0)
+				row[j] = 0;
+		}
+	}
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		the first step of a series at or after a time
+ *
+ * @param[in]	us	-	series
+ * @param[in]	t	-	time
+ *
+ * @return	int	index of the step (nsteps if none)
+ */
+static int
+first_step_at(usage_series *us, time_t t)
+{
+	int lo = 0;
+	int hi = us->nsteps;
+	int mid;
+
+	while (lo < hi) {
+		mid = (lo + hi) / 2;
+		if (us->te[mid]->event_time < t)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+
+	return lo;
+}
+
+/**
+ * @brief
+ * 		add an event to a series of a profile
+ *
+ * @param[in]	prof	-	profile
+ * @param[in]	qname	-	queue of the scope or NULL for the server
+ * @param[in]	type	-	entity type
+ * @param[in]	name	-	entity name
+ * @param[in]	te	-	event
+ * @param[in]	delta	-	change of the event
+ * @param[in]	append	-	te is the last event of the calendar so far
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
+ */
+static int
+add_series_event(usage_profile *prof, char *qname, enum usage_entity type,
+	char *name, timed_event *te, sch_resource_t *delta, int append)
+{
+	usage_series *us;
+	int pos;
+
+	if (name == NULL)
+		return 1;
+
+	if ((us = find_alloc_series(prof, qname, type, name)) == NULL)
+		return 0;
+
+	if (append)
+		pos = us->nsteps;
+	else if (te->event_type == TIMED_END_EVENT)
+		/* add_event() puts end events first among events at the same time */
+		pos = first_step_at(us, te->event_time);
+	else
+		pos = first_step_at(us, te->event_time + 1);
+
+	return insert_step(us, prof->width, pos, te, delta);
+}
+
+/**
+ * @brief
+ * 		add a job event to every series it changes
+ *
+ * @param[in]	prof	-	profile
+ * @param[in]	te	-	event
+ * @param[in]	append	-	te is the last event of the calendar so far
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
+ */
+static int
+profile_event(usage_profile *prof, timed_event *te, int append)
+{
+	sch_resource_t *delta = prof->delta;
+	resource_resv *rr;
+	resource_req *req;
+	schd_resource *res;
+	char *qname;
+	int sign;
+	int i;
+
+	if (te->disabled ||
+		(te->event_type != TIMED_RUN_EVENT && te->event_type != TIMED_END_EVENT))
+		return 1;
+
+	rr = (resource_resv *) te->event_ptr;
+	if (rr == NULL || !rr->is_job)
+		return 1;
+
+	/* update_counts_on_end() does nothing for a job without resources */
+	if (te->event_type == TIMED_END_EVENT && rr->resreq == NULL)
+		return 1;
+
+	sign = te->event_type == TIMED_RUN_EVENT ? 1 : -1;
+	delta[0] = sign;
+	for (i = 1, res = prof->limres; res != NULL; res = res->next, i++) {
+		req = find_resource_req(rr->resreq, res->def);
+		delta[i] = req != NULL ? sign * req->amount : 0;
+	}
+
+	if (!add_series_event(prof, NULL, USAGE_USER, rr->user, te, delta, append) ||
+		!add_series_event(prof, NULL, USAGE_GROUP, rr->group, te, delta, append) ||
+		!add_series_event(prof, NULL, USAGE_PROJECT, rr->project, te, delta, append) ||
+		!add_series_event(prof, NULL, USAGE_ALL, "o:" PBS_ALL_ENTITY, te, delta, append))
+		return 0;
+
+	if (rr->job == NULL || rr->job->queue == NULL)
+		return 1;
+	qname = rr->job->queue->name;
+	if (!add_series_event(prof, qname, USAGE_USER, rr->user, te, delta, append) ||
+		!add_series_event(prof, qname, USAGE_GROUP, rr->group, te, delta, append) ||
+		!add_series_event(prof, qname, USAGE_PROJECT, rr->project, te, delta, append) ||
+		!add_series_event(prof, qname, USAGE_ALL, "o:" PBS_ALL_ENTITY, te, delta, append))
+		return 0;
+
+	return 1;
+}
+
+/**
+ * @brief
+ * 		build the usage profile of a calendar from all its events
+ *
+ * @param[in]	calendar	-	calendar
+ *
+ * @return	usage_profile *
+ * @retval	NULL	: error
+ */
+static usage_profile *
+build_usage_profile(event_list *calendar)
+{
+	usage_profile *prof;
+	timed_event *te;
+
+	if ((prof = new_usage_profile()) == NULL)
+		return NULL;
+
+	for (te = calendar->events; te != NULL; te = te->next) {
+		if (!profile_event(prof, te, 1)) {
+			free_usage_profile(prof);
+			return NULL;
+		}
+	}
+	prof->gen = calendar->gen;
+
+	return prof;
+}
+
+/**
+ * @brief
+ * 		usage_profile_add_event - keep a calendar's usage profile up to
+ *		date with an event add_event() just linked into the calendar
+ *
+ * @param[in]	calendar	-	calendar
+ * @param[in]	te	-	the new event
+ *
+ * @return	void
+ */
+void
+usage_profile_add_event(event_list *calendar, timed_event *te)
+{
+	usage_profile *prof;
+
+	if (calendar == NULL || (prof = calendar->usage_prof) == NULL)
+		return;
+
+	/* only a profile which was up to date before te was linked */
+	if (prof->gen + 1 != calendar->gen || prof->limres != query_limres() ||
+		!profile_event(prof, te, 0)) {
+		free_usage_profile(prof);
+		calendar->usage_prof = NULL;
+		return;
+	}
+	prof->gen = calendar->gen;
+}
+
+/**
+ * @brief
+ * 		usage_profile_peak - the most an entity's usage grows over its
+ *		current usage from the calendar's next event up to a time
+ *
+ * @param[in]	calendar	-	calendar
+ * @param[in]	qname	-	queue of the scope or NULL for the server
+ * @param[in]	type	-	entity type
+ * @param[in]	name	-	entity name
+ * @param[in]	end	-	events before this time are counted
+ * @param[out]	peak	-	growth of running jobs followed by each
+ *				  resource of query_limres(), all >= 0
+ *
+ * @return	int
+ * @retval	1	: success
+ * @retval	0	: error
+ */
+int
+usage_profile_peak(event_list *calendar, char *qname, enum usage_entity type,
+	char *name, time_t end, sch_resource_t *peak)
+{
+	usage_profile *prof;
+	usage_series *us;
+	timed_event *next;
+	timed_event *te;
+	sch_resource_t *base;
+	sch_resource_t *row;
+	char *key;
+	int pos;
+	int endpos;
+	int width;
+	int i;
+	int j;
+
+	if (calendar == NULL || peak == NULL)
+		return 0;
+
+	prof = calendar->usage_prof;
+	if (prof != NULL && (prof->gen != calendar->gen || prof->limres != query_limres())) {
+		free_usage_profile(prof);
+		prof = calendar->usage_prof = NULL;
+	}
+	if (prof == NULL) {
+		if ((prof = build_usage_profile(calendar)) == NULL)
+			return 0;
+		calendar->usage_prof = prof;
+	}
+
+	width = prof->width;
+	memset(peak, 0, width * sizeof(sch_resource_t));
+	if (name == NULL)
+		return 1;
+
+	if ((key = series_key(qname, type, name)) == NULL)
+		return 0;
+	us = find_tree(prof->series, key);
+	free(key);
+
+	next = get_next_event(calendar);
+	if (us == NULL || next == NULL)
+		return 1;
+
+	/* steps before the calendar's next event have already happened */
+	pos = first_step_at(us, next->event_time);
+	for (; pos < us->nsteps && us->te[pos]->event_time == next->event_time; pos++) {
+		if (us->te[pos] == next)
+			break;
+		for (te = us->te[pos]->next; te != NULL && te != next &&
+			te->event_time == next->event_time; te = te->next)
+			;
+		if (te != next)	/* the step comes after next */
+			break;
+	}
+
+	endpos = first_step_at(us, end);
+	if (endpos <= pos)
+		return 1;
+
+	if (pos == 0) {
+		memcpy(peak, &us->peak[(endpos - 1) * width], width * sizeof(sch_resource_t));
+		return 1;
+	}
+
+	base = &us->cum[(pos - 1) * width];
+	for (i = pos; i < endpos; i++) {
+		row = &us->cum[i * width];
+		for (j = 0; j < width; j++) {
+			if (row[j] - base[j] > peak[j])
+				peak[j] = row[j] - base[j];
+		}
+	}
+
+	return 1;
+}
@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+
+#ifndef	_USAGE_PROFILE_H
+#define	_USAGE_PROFILE_H
+#ifdef	__cplusplus
+extern "C" {
+#endif
+
+#include "data_types.h"
+#include "constant.h"
+
+/*
+ *	free_usage_profile - usage_profile destructor
+ */
+void free_usage_profile(usage_profile *prof);
+
+/*
+ *	usage_profile_add_event - keep a calendar's usage profile up to date
+ *				  with an event add_event() just added
+ */
+void usage_profile_add_event(event_list *calendar, timed_event *te);
+
+/*
+ *	usage_profile_peak - the most an entity's usage grows over its current
+ *			     usage from the calendar's next event up to end
+ *
+ *	peak is filled with the growth of running jobs followed by each
+ *	resource of query_limres()
+ *
+ *	returns 1 on success, 0 on error
+ */
+int usage_profile_peak(event_list *calendar, char *qname, enum usage_entity type,
+	char *name, time_t end, sch_resource_t *peak);
+
+#ifdef	__cplusplus
+}
+#endif
+#endif	/* _USAGE_PROFILE_H */
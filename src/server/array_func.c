@@ -363,6 +363,7 @@ set_subjob_tblstate(job *parent, int offset, int newstate)
 	/* set flags in attribute so stat_job will update the attr string */
 	parent->ji_wattr[(int)JOB_ATR_array_indices_remaining].at_flags |=
 		ATR_VFLAG_MODCACHE;
+	svr_job_changed(parent);
 
 }
 /**
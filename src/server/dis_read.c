@@ -690,6 +690,14 @@ dis_request_read(int sfds, struct batch_request *request)
 			decode_DIS_ModifyResv(sfds, request);
 			break;
 
+		case PBS_BATCH_ModifyJobs:
+			rc = decode_DIS_ModifyJobs(sfds, request);
+			break;
+
+		case PBS_BATCH_RunJobs:
+			rc = decode_DIS_RunJobs(sfds, request);
+			break;
+
 #else	/* yes PBS_MOM */
 
 		case PBS_BATCH_CopyHookFile:
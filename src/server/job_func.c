@@ -57,6 +57,7 @@
  *	 resc_resv_alloc			- functons for Reservation (resc_resv) structures
  *	 resv_free					- This just frees	any hanging substructures, deletes any attached work_tasks
  *	 								and frees the resc_resv	structure itself.
+ *	 svr_avlresv_oper			- add/delete a reservation to/from the reservation index
  *	 find_resv					- find resc_resv struct by reservation ID
  *	 resv_purge					- purge reservation from system
  *	 post_resv_purge			- handles the return reply from an internally generated request.
@@ -791,6 +792,7 @@ job_purge(job *pjob)
 					NULL, DECR);
 		}
 		svr_dequejob(pjob);
+		svr_chgseq_purged(MGR_OBJ_JOB, pjob->ji_qs.ji_jobid);
 	}
 #endif	/* PBS_MOM */
 
@@ -1541,12 +1543,68 @@ resv_free(resc_resv *presv)
 	free(presv);
 }
 
+/*
+ * Index of the reservations on svr_allresvs by reservation ID.  If an
+ * index operation fails, the index is dropped and find_resv() falls back
+ * to searching the list, the same way find_job() does for AVL_jctx.
+ * find_resv() also searches the list when a lookup finds nothing.
+ */
+static AVL_IX_DESC *resv_tree = NULL;
+static int resv_tree_off = 0;
+
+/**
+ * @brief
+ * 		svr_avlresv_oper - add a reservation to, or delete it from, the
+ *		index used by find_resv().  Called whenever a reservation is linked
+ *		into or unlinked from svr_allresvs.
+ *
+ * @param[in]	presv	-	reservation
+ * @param[in]	delkey	-	0 to add the reservation, 1 to delete it
+ *
+ * @return	void
+ */
+void
+svr_avlresv_oper(resc_resv *presv, int delkey)
+{
+	int rc;
+
+	if ((presv == NULL) || resv_tree_off)
+		return;
+
+	if (resv_tree == NULL) {
+		if (delkey)
+			return;
+		resv_tree = create_tree(AVL_NO_DUP_KEYS, 0);
+		if (resv_tree == NULL)
+			goto AVL_OP_FAIL;
+	}
+
+	rc = tree_add_del(resv_tree, presv->ri_qs.ri_resvID, presv,
+		delkey ? TREE_OP_DEL : TREE_OP_ADD);
+	/* deleting a reservation which was never indexed is not an error */
+	if (rc == 0 || (delkey && rc == 1))
+		return;
+
+AVL_OP_FAIL:
+	(void) sprintf(log_buffer, "AVL: reservation %s failed, using LinkedList.",
+		delkey ? "delete" : "insert");
+	log_event(PBSEVENT_DEBUG4, PBS_EVENTCLASS_RESV, LOG_DEBUG,
+		presv->ri_qs.ri_resvID, log_buffer);
+	if (resv_tree != NULL) {
+		avl_destroy_index(resv_tree);
+		free(resv_tree);
+		resv_tree = NULL;
+	}
+	resv_tree_off = 1;
+}
+
 /**
  * @brief
  * 		find_resv() - find resc_resv struct by reservation ID
  *
- *		Search list of all server resc_resv structs for one with same
- *		reservation ID as input "resvID"
+ *		Look up the reservation index.  If that finds nothing, search the
+ *		list of all server resc_resv structs for one with same reservation
+ *		ID as input "resvID", since a failed index lookup is not a miss.
  *
  * @param[in]	resvID - reservation ID
  *
@@ -1562,16 +1620,22 @@ find_resv(char *resvID)
 
 	if ((at = strchr(resvID, (int)'@')) != 0)
 		*at = '\0';	/* strip of @server_name */
-	presv = (resc_resv *)GET_NEXT(svr_allresvs);
-	while (presv != NULL) {
-		if (!strcmp(resvID, presv->ri_qs.ri_resvID))
-			return (presv);
-		presv = (resc_resv *)GET_NEXT(presv->ri_allresvs);
+	presv = NULL;
+	if (resv_tree != NULL)
+		presv = (resc_resv *)find_tree(resv_tree, resvID);
+	/* find_tree() also returns NULL if it can not allocate its key */
+	if (presv == NULL) {
+		presv = (resc_resv *)GET_NEXT(svr_allresvs);
+		while (presv != NULL) {
+			if (!strcmp(resvID, presv->ri_qs.ri_resvID))
+				break;
+			presv = (resc_resv *)GET_NEXT(presv->ri_allresvs);
+		}
 	}
 	if (at)
 		*at = '@';	/* restore @server_name */
 
-	return (presv);		/* pointer value is null */
+	return (presv);
 }
 
 
@@ -1682,6 +1746,8 @@ resv_purge(resc_resv *presv)
 	 *global lists (svr_allresvs or svr_newresvs) has it
 	 */
 	delete_link(&presv->ri_allresvs);
+	svr_avlresv_oper(presv, 1);
+	svr_chgseq_purged(MGR_OBJ_RESV, presv->ri_qs.ri_resvID);
 
 	/*Release any nodes that were associated to this reservation*/
 	free_resvNodes(presv);
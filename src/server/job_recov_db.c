@@ -340,6 +340,8 @@ job_save_db(job *pjob, int updatetype)
 	if (pjob->ji_newjob == 1 && updatetype != SAVEJOB_NEW)
 		return (0);
 
+	svr_job_changed(pjob);
+
 	/* if ji_modified is set, ie an attribute changed, then update mtime */
 	if (pjob->ji_modified) {
 		pjob->ji_wattr[JOB_ATR_mtime].at_val.at_long = time_now;
@@ -444,6 +446,8 @@ resv_save_db(resc_resv *presv, int updatetype)
 	pbs_db_obj_info_t obj;
 	pbs_db_conn_t *conn = svr_db_conn;
 
+	svr_resv_changed(presv);
+
 	/* if ji_modified is set, ie an attribute changed, then update mtime */
 	if (presv->ri_modified) {
 		presv->ri_wattr[RESV_ATR_mtime].at_val.at_long = time_now;
@@ -478,6 +478,7 @@ initialize_pbsnode(struct pbsnode *pnode, char *pname, int ntype)
 	pnode->nd_pque	  = NULL;
 	pnode->nd_nummoms = 0;
 	pnode->nd_modified = 0;
+	svr_node_changed(pnode);
 	pnode->nd_moms    = (struct mominfo **)calloc(1, sizeof(struct mominfo *));
 	if (pnode->nd_moms == NULL)
 		return (PBSE_SYSTEM);
@@ -777,6 +778,7 @@ effective_node_delete(struct pbsnode *pnode)
 		pbsndlist[iht - 1]->nd_arr_index--;
 	}
 	svr_totnodes--;
+	svr_chgseq_purged(MGR_OBJ_NODE, pnode->nd_name);
 	free_pnode(pnode);
 	if (socket_released)
 		license_more_nodes();
@@ -1475,6 +1475,7 @@ set_vnode_state(struct pbsnode *pnode, unsigned long state_bits, enum vnode_stat
 	}
 
 	if (nd_prev_state != pnode->nd_state) {
+		svr_node_changed(pnode);
 		snprintf(str_val, sizeof(str_val), "%d", time_int_val);
 		set_attr_svr(&(pnode->nd_attr[(int)ND_ATR_last_state_change_time]),
 			&node_attr_def[(int) ND_ATR_last_state_change_time], str_val);
@@ -2330,6 +2331,9 @@ stat_update(int stream)
 
 			long old_sid = 0;  /* used to save prior sid of job */
 
+			/* resources_used is not always saved, but has still changed */
+			svr_job_changed(pjob);
+
 			if (pjob->ji_wattr[(int)JOB_ATR_session_id].at_flags & ATR_VFLAG_SET)
 				old_sid = pjob->ji_wattr[(int)JOB_ATR_session_id].at_val.at_long;
 
@@ -2810,6 +2814,7 @@ deallocate_job_from_node(job *pjob, struct pbsnode *pnode)
 			np->inuse &= ~(INUSE_JOB|INUSE_JOBEXCL);
 		}
 	}
+	svr_node_changed(pnode);
 	if (still_has_jobs) {
 		/* if the vnode still has jobs, then don't clear */
 		/* JOBEXCL */
@@ -5675,6 +5680,8 @@ write_single_node_state(struct pbsnode *np)
 	if (np->nd_state & INUSE_DELETED)
 		return 0;
 
+	svr_node_changed(np);
+
 	hascomment = (np->nd_attr[(int) ND_ATR_Comment].at_flags &
 		(ATR_VFLAG_SET | ATR_VFLAG_DEFLT)) == ATR_VFLAG_SET;
 
@@ -7423,6 +7430,7 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 						pnode->nd_nsnfree))
 				}
 			}
+			svr_node_changed(pnode);
 			share_node = pnode->nd_attr[(int)ND_ATR_Sharing].at_val.at_long;
 			if (share_node == (int)VNS_FORCE_EXCL || share_node == (int)VNS_FORCE_EXCLHOST) {
 				set_vnode_state(pnode, INUSE_JOBEXCL, Nd_State_Or);
@@ -7537,6 +7545,7 @@ set_nodes(void *pobj, int objtype, char *execvnod_in, char **execvnod_out, char
 				rp->next = (phowl+i)->hw_pnd->nd_resvp;
 				(phowl+i)->hw_pnd->nd_resvp = rp;
 				rp->resvp = presv;
+				svr_node_changed((phowl+i)->hw_pnd);
 
 				/* create a backlink from the reservation to the vnode */
 				tmp_pl = malloc(sizeof(pbsnode_list_t));
@@ -7650,6 +7659,7 @@ free_nodes(job *pjob)
 					DBPRT(("Freeing node %s/%ld from job %s\n",
 						pnode->nd_name, np->index,
 						pjob->ji_qs.ji_jobid))
+					svr_node_changed(pnode);
 					if (prev == NULL)
 						np->jobs = next;
 					else
@@ -7762,6 +7772,7 @@ free_resvNodes(resc_resv *presv)
 			else
 				prev->next = rinfp->next;
 			free(rinfp);
+			svr_node_changed(pnode);
 			break;
 		}
 	}
@@ -7911,6 +7922,7 @@ adj_resc_on_node(char *noden, int aflag, enum batch_op op, resource_def *prdef,
 	if (op == DECR) {
 		check_for_negative_resource(prdef, presc, noden);
 	}
+	svr_node_changed(pnode);
 	return rc;
 }
 
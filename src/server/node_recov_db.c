@@ -333,6 +333,7 @@ node_save_db(struct pbsnode *pnode, int mode)
 	svrattrl     *psvrl;
 	pbs_list_head     wrtattr;
 
+	svr_node_changed(pnode);
 	svr_to_db_node(pnode, &dbnode);
 	obj.pbs_db_obj_type = PBS_DB_NODE;
 	obj.pbs_db_un.pbs_db_node = &dbnode;
@@ -766,6 +766,11 @@ pbsd_init(int type)
 		&server.sv_attr[(int)SRV_ATR_version], 0, 0,
 		PBS_VERSION);
 
+	/* tell clients which multi-job requests they may send */
+	(void)svr_attr_def[(int)SRV_ATR_MultiJobReqs].at_decode(
+		&server.sv_attr[(int)SRV_ATR_MultiJobReqs], 0, 0,
+		MULTIJOB_REQ_MODIFY "," MULTIJOB_REQ_RUN);
+
 	if (check_license(&licenses) < 0) {
 		printf("%s\n", badlicense);
 		log_event(PBSEVENT_ADMIN, PBS_EVENTCLASS_SERVER, LOG_ALERT,
@@ -914,6 +919,7 @@ pbsd_init(int type)
 			set_old_subUniverse(presv);
 
 			append_link(&svr_allresvs, &presv->ri_allresvs, presv);
+			svr_avlresv_oper(presv, 0);
 			if (attach_queue_to_reservation(presv)) {
 
 				/* reservation needed queue; failed to find it */
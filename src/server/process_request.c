@@ -68,6 +68,8 @@
  *	decode_DIS_PySpawn()
  *	free_br()
  *	freebr_manage()
+ *	freebr_modifyjobs()
+ *	freebr_runjobs()
  *	freebr_cpyfile()
  *	freebr_cpyfile_cred()
  *	parse_servername()
@@ -132,6 +134,10 @@ extern void   req_stat_hook(struct batch_request *);
 /* Private functions local to this file */
 
 static void freebr_manage(struct rq_manage *);
+#ifndef PBS_MOM
+static void freebr_modifyjobs(struct rq_modifyjobs *);
+static void freebr_runjobs(struct rq_runjobs *);
+#endif
 static void freebr_cpyfile(struct rq_cpyfile *);
 static void freebr_cpyfile_cred(struct rq_cpyfile_cred *);
 static void close_quejob(int sfds);
@@ -696,6 +702,7 @@ process_request(int sfds)
 			case PBS_BATCH_MoveJob:
 			case PBS_BATCH_QueueJob:
 			case PBS_BATCH_RunJob:
+			case PBS_BATCH_RunJobs:
 			case PBS_BATCH_StageIn:
 			case PBS_BATCH_jobscript:
 				req_reject(PBSE_SVRDOWN, 0, request);
@@ -979,6 +986,12 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_modifyjob(request);
 			break;
 
+#ifndef PBS_MOM
+		case PBS_BATCH_ModifyJobs:
+			req_modifyjobs(request);
+			break;
+#endif
+
 		case PBS_BATCH_Rerun:
 			req_rerunjob(request);
 			break;
@@ -1014,6 +1027,10 @@ dispatch_request(int sfds, struct batch_request *request)
 			req_runjob(request);
 			break;
 
+		case PBS_BATCH_RunJobs:
+			req_runjobs(request);
+			break;
+
 		case PBS_BATCH_DefSchReply:
 			req_defschedreply(request);
 			break;
@@ -1501,6 +1518,14 @@ free_br(struct batch_request *preq)
 		 * decrement the reference count in the parent and when it
 		 * goes to zero,  reply_send() it
 		 */
+#ifndef PBS_MOM
+		/* except a job of a Modify Jobs or Run Jobs request, which owns its data */
+		if (preq->rq_parentbr->rq_type == PBS_BATCH_ModifyJobs)
+			freebr_manage(&preq->rq_ind.rq_modify);
+		else if ((preq->rq_parentbr->rq_type == PBS_BATCH_RunJobs) &&
+			(preq->rq_ind.rq_run.rq_destin != NULL))
+			free(preq->rq_ind.rq_run.rq_destin);
+#endif
 		if (preq->rq_parentbr->rq_refct > 0) {
 			if (--preq->rq_parentbr->rq_refct == 0)
 				reply_send(preq->rq_parentbr);
@@ -1605,6 +1630,12 @@ free_br(struct batch_request *preq)
 		case PBS_BATCH_Manager:
 			freebr_manage(&preq->rq_ind.rq_manager);
 			break;
+		case PBS_BATCH_ModifyJobs:
+			freebr_modifyjobs(&preq->rq_ind.rq_modifyjobs);
+			break;
+		case PBS_BATCH_RunJobs:
+			freebr_runjobs(&preq->rq_ind.rq_runjobs);
+			break;
 		case PBS_BATCH_ReleaseJob:
 			freebr_manage(&preq->rq_ind.rq_release);
 			break;
@@ -1639,6 +1670,44 @@ freebr_manage(struct rq_manage *pmgr)
 {
 	free_attrlist(&pmgr->rq_attr);
 }
+#ifndef PBS_MOM
+/**
+ * @brief
+ * 		free the attributes of each job of a Modify Jobs request
+ *
+ * @param[in]	pmj - request modifyjobs structure.
+ */
+static void
+freebr_modifyjobs(struct rq_modifyjobs *pmj)
+{
+	int i;
+
+	for (i = 0; i < pmj->rq_count; i++)
+		free_attrlist(&pmj->rq_jobs[i].rq_attr);
+	free(pmj->rq_jobs);
+	pmj->rq_jobs = NULL;
+	pmj->rq_count = 0;
+}
+/**
+ * @brief
+ * 		free the destination of each job of a Run Jobs request
+ *
+ * @param[in]	prj - request runjobs structure.
+ */
+static void
+freebr_runjobs(struct rq_runjobs *prj)
+{
+	int i;
+
+	for (i = 0; i < prj->rq_count; i++) {
+		if (prj->rq_jobs[i].rq_destin)
+			free(prj->rq_jobs[i].rq_destin);
+	}
+	free(prj->rq_jobs);
+	prj->rq_jobs = NULL;
+	prj->rq_count = 0;
+}
+#endif
 /**
  * @brief
  * 		remove all the rqfpair and free their memory
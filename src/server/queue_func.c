@@ -45,6 +45,7 @@
  *	que_alloc()	- allocacte and initialize space for queue structure
  *	que_free()	- free queue structure
  *	que_purge()	- remove queue from server
+ *	svr_avlque_oper() - add/delete a queue to/from the queue index
  *	find_queuebyname() - find a queue with a given name
  #ifdef NAS localmod 075
  *	find_resvqueuebyname() - find a reservation queue, given resv name
@@ -78,6 +79,7 @@
 #include "pbs_nodes.h"
 #include <memory.h>
 #include "pbs_sched.h"
+#include "avltree.h"
 
 
 /* Global Data */
@@ -92,6 +94,19 @@ extern long	 svr_history_enable;
 extern pbs_db_conn_t	*svr_db_conn;
 #endif
 
+extern void advance_stat_cursors(job *, pbs_queue *);
+
+/*
+ * Index of the queues on svr_queues by name.  If an index operation fails,
+ * the index is dropped and find_queuebyname() falls back to searching
+ * the list.  find_queuebyname() also searches the list when a lookup finds
+ * nothing.
+ */
+static AVL_IX_DESC *queue_tree = NULL;
+static int queue_tree_off = 0;
+
+static void svr_avlque_oper(pbs_queue *, int);
+
 
 /**
  * @brief
@@ -123,6 +138,7 @@ que_alloc(char *name)
 
 	strncpy(pq->qu_qs.qu_name, name, PBS_MAXQUEUENAME);
 	append_link(&svr_queues, &pq->qu_link, pq);
+	svr_avlque_oper(pq, 0);
 	server.sv_qs.sv_numque++;
 
 	/* set the working attributes to "unspecified" */
@@ -174,6 +190,7 @@ que_free(pbs_queue *pq)
 
 	server.sv_qs.sv_numque--;
 	delete_link(&pq->qu_link);
+	svr_avlque_oper(pq, 1);
 	(void)free((char *)pq);
 }
 
@@ -240,6 +257,7 @@ que_purge(pbs_queue *pque)
 			pjob = (job *)GET_NEXT(pque->qu_jobs);
 			while (pjob) {
 				nxpjob = (job *)GET_NEXT(pjob->ji_jobque);
+				advance_stat_cursors(pjob, pque);
 				delete_link(&pjob->ji_jobque);
 				--pque->qu_numjobs;
 				--pque->qu_njstate[pjob->ji_qs.ji_state];
@@ -266,10 +284,57 @@ que_purge(pbs_queue *pque)
 	return (0);
 }
 
+/**
+ * @brief
+ * 		svr_avlque_oper - add a queue to, or delete it from, the index used
+ *		by find_queuebyname()
+ *
+ * @param[in]	pq	-	queue
+ * @param[in]	delkey	-	0 to add the queue, 1 to delete it
+ *
+ * @return	void
+ */
+static void
+svr_avlque_oper(pbs_queue *pq, int delkey)
+{
+	int rc;
+
+	if (queue_tree_off)
+		return;
+
+	if (queue_tree == NULL) {
+		if (delkey)
+			return;
+		queue_tree = create_tree(AVL_NO_DUP_KEYS, 0);
+		if (queue_tree == NULL)
+			goto AVL_OP_FAIL;
+	}
+
+	rc = tree_add_del(queue_tree, pq->qu_qs.qu_name, pq,
+		delkey ? TREE_OP_DEL : TREE_OP_ADD);
+	if (rc == 0)
+		return;
+
+AVL_OP_FAIL:
+	(void)sprintf(log_buffer, "AVL: queue %s failed, using LinkedList.",
+		delkey ? "delete" : "insert");
+	log_event(PBSEVENT_DEBUG4, PBS_EVENTCLASS_QUEUE, LOG_DEBUG,
+		pq->qu_qs.qu_name, log_buffer);
+	if (queue_tree != NULL) {
+		avl_destroy_index(queue_tree);
+		free(queue_tree);
+		queue_tree = NULL;
+	}
+	queue_tree_off = 1;
+}
+
 /**
  * @brief
  * 		find_queuebyname() - find a queue by its name
  *
+ *		Look up the queue index.  If that finds nothing, search the list
+ *		of queues, since a failed index lookup is not a miss.
+ *
  * @param[in]	quename	- queue name
  *
  * @return	pbs_queue *
@@ -287,14 +352,16 @@ find_queuebyname(char *quename)
 	pc = strchr(qname, (int)'@');	/* strip off server (fragment) */
 	if (pc)
 		*pc = '\0';
+	/* find_tree() also returns NULL if it can not allocate its key */
+	if ((queue_tree != NULL) &&
+		((pque = (pbs_queue *)find_tree(queue_tree, qname)) != NULL))
+		return (pque);
 	pque = (pbs_queue *)GET_NEXT(svr_queues);
 	while (pque != NULL) {
 		if (strcmp(qname, pque->qu_qs.qu_name) == 0)
 			break;
 		pque = (pbs_queue *)GET_NEXT(pque->qu_link);
 	}
-	if (pc)
-		*pc = '@';	/* restore '@' server portion */
 	return (pque);
 }
 #ifdef NAS /* localmod 075 */
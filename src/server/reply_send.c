@@ -51,6 +51,8 @@
  *	set_err_msg() - set a message relating to the error "code"
  *	dis_reply_write()	- reply is sent to a remote client
  *	reply_badattr()	- Create a reject (error) reply for a request including the name of the bad attribute/resource.
+ *	reply_multijob_error()	- add a job which failed to the reply of a multi-job request
+ *	reply_multijob_child()	- move the reply of a job of a multi-job request to the parent
  *
  */
 
@@ -240,6 +242,13 @@ reply_send(struct batch_request *request)
 	/* if this is a child request, just move the error to the parent */
 
 	if (request->rq_parentbr) {
+#ifndef PBS_MOM
+		if (request->rq_parentbr->rq_type == PBS_BATCH_ModifyJobs)
+			reply_multijob_child(request, request->rq_ind.rq_modify.rq_objname);
+		else if (request->rq_parentbr->rq_type == PBS_BATCH_RunJobs)
+			reply_multijob_child(request, request->rq_ind.rq_run.rq_jid);
+		else
+#endif	/* PBS_MOM */
 		if ((request->rq_parentbr->rq_reply.brp_choice == BATCH_REPLY_CHOICE_NULL) && (request->rq_parentbr->rq_reply.brp_code == 0)) {
 			request->rq_parentbr->rq_reply.brp_code = request->rq_reply.brp_code;
 			request->rq_parentbr->rq_reply.brp_auxcode = request->rq_reply.brp_auxcode;
@@ -552,3 +561,63 @@ reply_jobid(struct batch_request *preq, char *jobid, int which)
 	(void)strncpy(preq->rq_reply.brp_un.brp_jid, jobid, PBS_MAXSVRJOBID);
 	return (reply_send(preq));
 }
+#ifndef PBS_MOM
+/**
+ * @brief
+ * 		Add a job which failed to the reply of a multi-job request, such
+ * 		as Modify Jobs or Run Jobs.  The reply is a status reply with an
+ * 		entry for each job which failed.
+ *
+ * @param[in,out]	preq	-	the multi-job request
+ * @param[in]	jobid	-	the job which failed
+ * @param[in]	code	-	PBS error code
+ * @param[in]	text	-	error message, or NULL for the one of code
+ */
+void
+reply_multijob_error(struct batch_request *preq, char *jobid, int code, char *text)
+{
+	struct brp_status	*pstat;
+	char			 codebuf[20];
+
+	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+	if (pstat == NULL) {
+		log_err(errno, __func__, "Unable to allocate Memory!\n");
+		return;
+	}
+	pstat->brp_objtype = MGR_OBJ_JOB;
+	snprintf(pstat->brp_objname, sizeof(pstat->brp_objname), "%s", jobid);
+	CLEAR_LINK(pstat->brp_stlink);
+	CLEAR_HEAD(pstat->brp_attr);
+	append_link(&preq->rq_reply.brp_un.brp_status, &pstat->brp_stlink, pstat);
+
+	if (text == NULL)
+		text = pbse_to_txt(code);
+	snprintf(codebuf, sizeof(codebuf), "%d", code);
+	(void)add_to_svrattrl_list(&pstat->brp_attr, MULTIJOB_ERRCODE, NULL,
+		codebuf, 0, NULL);
+	if (text != NULL)
+		(void)add_to_svrattrl_list(&pstat->brp_attr, MULTIJOB_ERRTEXT,
+			NULL, text, 0, NULL);
+}
+
+/**
+ * @brief
+ * 		Called by reply_send() for a child request of a multi-job request.
+ * 		If the job failed, it is added to the parent's reply.
+ *
+ * @param[in]	preq	-	the child request
+ * @param[in]	jobid	-	the job of the child request
+ */
+void
+reply_multijob_child(struct batch_request *preq, char *jobid)
+{
+	struct batch_reply *prep = &preq->rq_reply;
+
+	if (prep->brp_code == PBSE_NONE)
+		return;
+
+	reply_multijob_error(preq->rq_parentbr, jobid, prep->brp_code,
+		(prep->brp_choice == BATCH_REPLY_CHOICE_Text) ?
+		prep->brp_un.brp_txt.brp_str : NULL);
+}
+#endif	/* PBS_MOM */
@@ -44,12 +44,15 @@
  * Included funtions are:
  *	post_modify_req()
  *	req_modifyjob()
+ *	req_modifyjobs()
  *	find_name_in_svrattrl()
  *	modify_job_attr()
  */
 #include <pbs_config.h>   /* the master config generated by configure */
 
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include "libpbs.h"
 #include <signal.h>
@@ -412,6 +415,73 @@ req_modifyjob(struct batch_request *preq)
 	reply_ack(preq);
 }
 
+/**
+ * @brief
+ * 		Service the Modify Jobs Request, which carries a Modify Job for each
+ * 		of a number of jobs (e.g. the scheduler's comment and estimated
+ * 		attribute updates at the end of a cycle).
+ *
+ * @par	Functionality:
+ *		Each job is modified by a child Modify Job request which is passed
+ *		to req_modifyjob(), so it is subject to the same checks and hooks
+ *		as if it had been sent on its own.  Each job is saved in its own
+ *		database transaction, as with Modify Job, so a failure to save one
+ *		job cannot roll back jobs already reported as modified.  The reply
+ *		is sent once all the child requests have replied, and carries a
+ *		status entry for each job which could not be modified (see
+ *		reply_multijob_child()).
+ *
+ * @param[in] preq - pointer to batch request from client
+ */
+void
+req_modifyjobs(struct batch_request *preq)
+{
+	struct rq_modifyjobs	*pmj = &preq->rq_ind.rq_modifyjobs;
+	struct batch_request	*pchild;
+	int			 i;
+
+	preq->rq_reply.brp_code = PBSE_NONE;
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_Status;
+	CLEAR_HEAD(preq->rq_reply.brp_un.brp_status);
+
+	/* protect the request/reply struct until all jobs are done */
+	++preq->rq_refct;
+
+	for (i = 0; i < pmj->rq_count; i++) {
+		pchild = alloc_br(PBS_BATCH_ModifyJob);
+		if (pchild == NULL) {
+			reply_multijob_error(preq, pmj->rq_jobs[i].rq_objname,
+				PBSE_SYSTEM, NULL);
+			continue;
+		}
+		pchild->rq_perm = preq->rq_perm;
+		pchild->rq_fromsvr = preq->rq_fromsvr;
+		pchild->rq_conn = preq->rq_conn;
+		pchild->rq_orgconn = preq->rq_orgconn;
+		pchild->rq_time = preq->rq_time;
+		strcpy(pchild->rq_user, preq->rq_user);
+		strcpy(pchild->rq_host, preq->rq_host);
+		pchild->rq_extend = preq->rq_extend;
+		pchild->rq_reply.brp_choice = BATCH_REPLY_CHOICE_NULL;
+		pchild->rq_refct = 0;
+
+		pchild->rq_ind.rq_modify.rq_cmd = pmj->rq_jobs[i].rq_cmd;
+		pchild->rq_ind.rq_modify.rq_objtype = pmj->rq_jobs[i].rq_objtype;
+		strcpy(pchild->rq_ind.rq_modify.rq_objname,
+			pmj->rq_jobs[i].rq_objname);
+		/* the child owns its attributes, free_br() frees them */
+		list_move(&pmj->rq_jobs[i].rq_attr, &pchild->rq_ind.rq_modify.rq_attr);
+
+		pchild->rq_parentbr = preq;
+		preq->rq_refct++;
+
+		req_modifyjob(pchild);
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
+
 /**
  * @brief
  * 		Returns the svrattrl entry matching attribute 'name', or NULL if not found.
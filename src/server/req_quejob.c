@@ -2406,6 +2406,7 @@ req_commit(struct batch_request *preq)
 		}
 		delete_link(&presv->ri_allresvs);
 		append_link(&svr_allresvs, &presv->ri_allresvs, presv);
+		svr_avlresv_oper(presv, 0);
 		set_scheduler_flag(SCH_SCHEDULE_NEW, dflt_scheduler);
 		Update_Resvstate_if_resv(pj);
 	}
@@ -3221,6 +3222,7 @@ req_resvSub(struct batch_request *preq)
 	 * is available for consideration
 	 */
 	append_link(&svr_allresvs, &presv->ri_allresvs, presv);
+	svr_avlresv_oper(presv, 0);
 	set_scheduler_flag(SCH_SCHEDULE_NEW, dflt_scheduler);
 }
 
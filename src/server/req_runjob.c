@@ -45,6 +45,7 @@
  *	check_and_provision_job()
  *	clear_from_defr()
  *	req_runjob()
+ *	req_runjobs()
  *	req_runjob2()
  *	clear_exec_on_run_fail()
  *	req_stagein()
@@ -605,6 +606,83 @@ req_runjob(struct batch_request *preq)
 		reply_send(preq);
 	return;
 }
+
+/**
+ * @brief
+ * 		req_runjobs - service the Run Jobs Request, which carries an
+ * 		Async Run Job for each of a number of jobs
+ *
+ * @par	Functionality:
+ *		This lets the Scheduler have many jobs in flight in one request,
+ *		instead of waiting for the reply to each run request in turn.
+ *		Each job is run by a child Async Run Job request which is passed
+ *		to req_runjob(), so it is subject to the same checks and hooks as
+ *		if it had been sent on its own.  The reply is sent once each child
+ *		request has replied, that is once each job has been sent to its
+ *		Mom or been refused, and carries a status entry for each job which
+ *		could not be run (see reply_multijob_child()).
+ *
+ * @param[in]	preq	-	Run Jobs Request
+ */
+void
+req_runjobs(struct batch_request *preq)
+{
+	struct rq_runjobs	*prj = &preq->rq_ind.rq_runjobs;
+	struct batch_request	*pchild;
+	int			 i;
+
+	if ((preq->rq_perm & (ATR_DFLAG_MGWR | ATR_DFLAG_OPWR)) == 0) {
+		req_reject(PBSE_PERM, 0, preq);
+		return;
+	}
+
+	preq->rq_reply.brp_code = PBSE_NONE;
+	preq->rq_reply.brp_choice = BATCH_REPLY_CHOICE_Status;
+	CLEAR_HEAD(preq->rq_reply.brp_un.brp_status);
+
+	/* protect the request/reply struct until all jobs are done */
+	++preq->rq_refct;
+
+	for (i = 0; i < prj->rq_count; i++) {
+		/* a job without a destination would be deferred to the */
+		/* Scheduler, which is the one sending this request	 */
+		if ((prj->rq_jobs[i].rq_destin == NULL) ||
+			(*prj->rq_jobs[i].rq_destin == '\0')) {
+			reply_multijob_error(preq, prj->rq_jobs[i].rq_jid,
+				PBSE_IVALREQ, NULL);
+			continue;
+		}
+		pchild = alloc_br(PBS_BATCH_AsyrunJob);
+		if (pchild == NULL) {
+			reply_multijob_error(preq, prj->rq_jobs[i].rq_jid,
+				PBSE_SYSTEM, NULL);
+			continue;
+		}
+		pchild->rq_perm = preq->rq_perm;
+		pchild->rq_fromsvr = preq->rq_fromsvr;
+		pchild->rq_conn = preq->rq_conn;
+		pchild->rq_orgconn = preq->rq_orgconn;
+		pchild->rq_time = preq->rq_time;
+		strcpy(pchild->rq_user, preq->rq_user);
+		strcpy(pchild->rq_host, preq->rq_host);
+		pchild->rq_extend = preq->rq_extend;
+		pchild->rq_reply.brp_choice = BATCH_REPLY_CHOICE_NULL;
+		pchild->rq_refct = 0;
+
+		/* the child owns the destination, free_br() frees it */
+		pchild->rq_ind.rq_run = prj->rq_jobs[i];
+		prj->rq_jobs[i].rq_destin = NULL;
+
+		pchild->rq_parentbr = preq;
+		preq->rq_refct++;
+
+		req_runjob(pchild);
+	}
+
+	if (--preq->rq_refct == 0)
+		reply_send(preq);
+}
+
 /**
  * @brief
  * 		req_runjob - service the Run Job and Asyc Run Job Requests
@@ -92,6 +92,7 @@ extern time_t	 time_now;
 extern char	 statechars[];
 extern long svr_history_enable;
 extern int scheduler_jobs_stat;
+extern struct server server;
 
 /* Private Functions  */
 
@@ -334,6 +335,8 @@ req_selectjobs(struct batch_request *preq)
 	int		    rc;
 	struct select_list *selistp;
 	pbs_sched	   *psched;
+	int		    dodelta = 0;
+	long		    since = 0;
 
 	/*
 	 * if the letter T (or t) is in the extend string,  select subjobs
@@ -360,6 +363,21 @@ req_selectjobs(struct batch_request *preq)
 		}
 		dohistjobs = 1;
 	}
+	/*
+	 * If the letter D followed by "<epoch>:<seq>" is in the extend string
+	 * of a Select-Status request, only return jobs which changed after
+	 * job change sequence <seq>, and an entry without attributes for
+	 * jobs which were purged or are no longer selectable.  If the server
+	 * restarted or the changes are no longer known, reject the request
+	 * with PBSE_RESYNC_REQUIRED so the client falls back to a full query.
+	 */
+	if (preq->rq_type == PBS_BATCH_SelStat) {
+		dodelta = chgseq_since(preq->rq_extend, &since);
+		if (dodelta < 0) {
+			req_reject(PBSE_RESYNC_REQUIRED, 0, preq);
+			return;
+		}
+	}
 
 	/* The first selstat() call from the scheduler indicates that a cycle
 	 * is in progress and has reached the point of querying for jobs.
@@ -394,6 +412,12 @@ req_selectjobs(struct batch_request *preq)
 	}
 	pselx = &preply->brp_un.brp_select;
 
+	/* report purged jobs first, a job may have left and come back */
+	rc = 0;
+	if (dodelta && (rc = status_purged_objs(MGR_OBJ_JOB, since,
+		&preply->brp_un.brp_status)))
+		goto out;
+
 	/* now start checking for jobs that match the selection criteria */
 
 	if (pque)
@@ -401,8 +425,10 @@ req_selectjobs(struct batch_request *preq)
 	else
 		pjob = (job *)GET_NEXT(svr_alljobs);
 	while (pjob) {
-		if (server.sv_attr[(int)SRV_ATR_query_others].at_val.at_long ||
-			(svr_authorize_jobreq(preq, pjob) == 0)) {
+		/* in delta mode, skip jobs unchanged since the client's last request */
+		if (((dodelta == 0) || (pjob->ji_chgseq > since)) &&
+			(server.sv_attr[(int)SRV_ATR_query_others].at_val.at_long ||
+			(svr_authorize_jobreq(preq, pjob) == 0))) {
 
 			/* either job owner or has special permission to see job */
 
@@ -411,7 +437,11 @@ req_selectjobs(struct batch_request *preq)
 			/* an Array Job, then the State is Not checked.  The State   */
 			/* must be checked against the state of each Subjob	     */
 
-			if (select_job(pjob, selistp, dosubjobs, dohistjobs)) {
+			if (!select_job(pjob, selistp, dosubjobs, dohistjobs)) {
+				if (dodelta && (rc = status_purged_obj(MGR_OBJ_JOB,
+					pjob->ji_qs.ji_jobid, &preply->brp_un.brp_status)))
+					goto out;
+			} else {
 
 				/* job is selected, include in reply */
 
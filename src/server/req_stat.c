@@ -45,6 +45,12 @@
  * Functions included are:
  * 	do_stat_of_a_job()
  * 	stat_a_jobidname()
+ * 	count_stat_of_a_job()
+ * 	next_stat_job()
+ * 	save_stat_cursor()
+ * 	advance_stat_cursors()
+ * 	first_stat_job()
+ * 	stream_stat_jobs()
  * 	req_stat_job()
  * 	req_stat_que()
  * 	status_que()
@@ -87,6 +93,8 @@
 #include "pbs_license.h"
 #include "resource.h"
 #include "pbs_sched.h"
+#include "dis.h"
+#include "log.h"
 
 
 /* Global Data Items: */
@@ -102,6 +110,7 @@ extern time_t	     time_now;
 extern char	    *msg_init_norerun;
 extern int resc_access_perm;
 extern long svr_history_enable;
+extern long svr_chgseq;
 
 /* Extern Functions */
 
@@ -117,6 +126,18 @@ extern int svr_chk_histjob(job *);
 
 static int bad;
 
+/*
+ * Where recent pages of job status ended.  The next page resumes at the
+ * saved job even if the job the client names has left the list since.
+ */
+#define STAT_CURSOR_MAX 64
+static struct stat_cursor {
+	char	   sc_jobid[PBS_MAXSVRJOBID + 1];	/* last job of the page */
+	pbs_queue *sc_pque;	/* queue paged through, NULL for the Server */
+	job	  *sc_next;	/* first job of the next page, NULL at the end */
+	time_t	   sc_time;	/* when the page was sent, 0 if the slot is free */
+} stat_cursors[STAT_CURSOR_MAX];
+
 /* The following private support functions are included */
 
 static int status_que(pbs_queue *, struct batch_request *, pbs_list_head *);
@@ -268,6 +289,257 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
 	}
 }
 
+/**
+ * @brief
+ * 		Support function for req_stat_job().
+ * 		Counts the status entries do_stat_of_a_job() would add to the reply
+ * 		for a job, without building them.
+ *
+ * @param[in]	preq	-	pointer to the stat job batch request
+ * @param[in]	pjob	-	job to be statused
+ * @param[in]	dohistjobs	-	flag to include job if it is a history job
+ * @param[in]	dosubjobs	-	flag to expand a Array job to include all subjobs
+ *
+ * @return	int
+ * @retval	number of status entries for the job
+ */
+static int
+count_stat_of_a_job(struct batch_request *preq, job *pjob, int dohistjobs, int dosubjobs)
+{
+	int ct = 1;
+
+	if ((!dohistjobs) &&
+			((pjob->ji_qs.ji_state == JOB_STATE_FINISHED) ||
+			(pjob->ji_qs.ji_state == JOB_STATE_MOVED)))
+		return 0;
+
+	if (pjob->ji_qs.ji_svrflags & JOB_SVFLG_SubJob)
+		return 0;
+
+	if ((! server.sv_attr[(int)SRV_ATR_query_others].at_val.at_long) &&
+			svr_authorize_jobreq(preq, pjob))
+		return 0;
+
+	if (dosubjobs && (pjob->ji_qs.ji_svrflags & JOB_SVFLG_ArrayJob) &&
+			(pjob->ji_ajtrk != NULL))
+		ct += pjob->ji_ajtrk->tkm_ct;
+
+	return ct;
+}
+
+/**
+ * @brief
+ * 		Support function for req_stat_job().
+ * 		Returns the job after pjob in the set being statused: the jobs in
+ * 		queue pque or, if pque is NULL, all the jobs in the Server.
+ *
+ * @param[in]	pque	-	queue being statused or NULL
+ * @param[in]	pjob	-	current job
+ *
+ * @return	job *
+ * @retval	next job, NULL at the end of the set
+ */
+static job *
+next_stat_job(pbs_queue *pque, job *pjob)
+{
+	if (pque)
+		return ((job *)GET_NEXT(pjob->ji_jobque));
+	return ((job *)GET_NEXT(pjob->ji_alljobs));
+}
+
+/**
+ * @brief
+ * 		Support function for req_stat_job().
+ * 		Saves where a page of job status ended, so the next page can resume
+ * 		there.  The oldest saved position is reused when all are taken.
+ *
+ * @param[in]	pque	-	queue being statused or NULL for the Server
+ * @param[in]	plast	-	last job of the page the client was sent
+ * @param[in]	pnext	-	first job of the next page
+ *
+ * @return	void
+ */
+static void
+save_stat_cursor(pbs_queue *pque, job *plast, job *pnext)
+{
+	struct stat_cursor *psc = &stat_cursors[0];
+	int i;
+
+	for (i = 0; i < STAT_CURSOR_MAX; i++) {
+		if ((stat_cursors[i].sc_time != 0) &&
+			(stat_cursors[i].sc_pque == pque) &&
+			(strcmp(stat_cursors[i].sc_jobid, plast->ji_qs.ji_jobid) == 0)) {
+			psc = &stat_cursors[i];
+			break;
+		}
+		if (stat_cursors[i].sc_time < psc->sc_time)
+			psc = &stat_cursors[i];
+	}
+
+	strcpy(psc->sc_jobid, plast->ji_qs.ji_jobid);
+	psc->sc_pque = pque;
+	psc->sc_next = pnext;
+	psc->sc_time = time_now;
+}
+
+/**
+ * @brief
+ * 		Keeps the saved page positions valid while a job leaves the list of
+ * 		the Server or of its queue: a page which was to resume at the job
+ * 		resumes at the job after it.  Called before the job is unlinked.
+ *
+ * @param[in]	pjob	-	job leaving the list
+ * @param[in]	pque	-	queue the job leaves, NULL for the Server's list
+ *
+ * @return	void
+ */
+void
+advance_stat_cursors(job *pjob, pbs_queue *pque)
+{
+	int i;
+
+	for (i = 0; i < STAT_CURSOR_MAX; i++) {
+		if ((stat_cursors[i].sc_time != 0) &&
+			(stat_cursors[i].sc_next == pjob) &&
+			(stat_cursors[i].sc_pque == pque))
+			stat_cursors[i].sc_next = next_stat_job(pque, pjob);
+	}
+}
+
+/**
+ * @brief
+ * 		Support function for req_stat_job().
+ * 		Finds the first job of a page of job status.  The cursor is the id
+ * 		of the last job of the previous page.  The page resumes where the
+ * 		previous page ended, as saved by save_stat_cursor(), so jobs which
+ * 		have left the list since do not matter.  If the position is no
+ * 		longer saved, the page resumes after the cursor job.
+ *
+ * @param[in]	pque	-	queue being statused or NULL for the Server
+ * @param[in]	cursor	-	job id ending the previous page or NULL
+ * @param[out]	pfirst	-	first job of the page, NULL if there are no more jobs
+ *
+ * @return	int
+ * @retval	PBSE_NONE	: success
+ * @retval	PBSE_UNKJOBID	: the cursor job is gone and where its page
+ *				  ended is no longer known
+ */
+static int
+first_stat_job(pbs_queue *pque, char *cursor, job **pfirst)
+{
+	job  *pjob;
+	int   i;
+
+	if (cursor == NULL) {
+		if (pque)
+			*pfirst = (job *)GET_NEXT(pque->qu_jobs);
+		else
+			*pfirst = (job *)GET_NEXT(svr_alljobs);
+		return PBSE_NONE;
+	}
+
+	for (i = 0; i < STAT_CURSOR_MAX; i++) {
+		if ((stat_cursors[i].sc_time != 0) &&
+			(stat_cursors[i].sc_pque == pque) &&
+			(strcmp(stat_cursors[i].sc_jobid, cursor) == 0)) {
+			*pfirst = stat_cursors[i].sc_next;
+			return PBSE_NONE;
+		}
+	}
+
+	pjob = find_job(cursor);
+	if ((pjob != NULL) && ((pque == NULL) || (pjob->ji_qhdr == pque))) {
+		*pfirst = next_stat_job(pque, pjob);
+		return PBSE_NONE;
+	}
+
+	*pfirst = NULL;
+	return PBSE_UNKJOBID;
+}
+
+/**
+ * @brief
+ * 		Support function for req_stat_job().
+ * 		Streams the status of the jobs from pfirst up to the end of the page
+ * 		to the client.  The status entries are counted first, since the count
+ * 		leads the reply, then the status of each job is built, encoded and
+ * 		freed before the next job is looked at.  The reply is never held in
+ * 		memory as a whole; the DIS buffer is written out whenever it fills.
+ *
+ * @param[in,out]	preq	-	pointer to the stat job batch request, freed
+ * @param[in]	pque	-	queue being statused or NULL for the Server
+ * @param[in]	pfirst	-	first job of the page
+ * @param[in]	dohistjobs	-	flag to include job if it is a history job
+ * @param[in]	dosubjobs	-	flag to expand a Array job to include all subjobs
+ * @param[in]	page_size	-	status entries per page, 0 for no limit
+ *
+ * @return	void
+ */
+static void
+stream_stat_jobs(struct batch_request *preq, pbs_queue *pque, job *pfirst,
+	int dohistjobs, int dosubjobs, int page_size)
+{
+	struct batch_reply *preply = &preq->rq_reply;
+	struct brp_status  *pstat;
+	job		   *pjob;
+	job		   *pend;
+	job		   *plast = NULL;
+	int		    sfds = preq->rq_conn;
+	int		    ct = 0;
+	int		    n;
+	int		    rc;
+
+	/* the page ends after the job that brings it to page_size entries */
+	pend = pfirst;
+	while (pend && ((page_size <= 0) || (ct < page_size))) {
+		n = count_stat_of_a_job(preq, pend, dohistjobs, dosubjobs);
+		if (n > 0)
+			plast = pend;
+		ct += n;
+		pend = next_stat_job(pque, pend);
+	}
+	preply->brp_auxcode = (pend != NULL);	/* more jobs to page through */
+	if ((pend != NULL) && (plast != NULL))
+		save_stat_cursor(pque, plast, pend);
+
+	pbs_tcp_errno = 0;
+	DIS_tcp_setup(sfds);
+	rc = encode_DIS_reply_status_head(sfds, preply, ct);
+
+	for (pjob = pfirst; (pjob != pend) && (rc == 0); pjob = next_stat_job(pque, pjob)) {
+		n = count_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
+		if (n == 0)
+			continue;
+		if (do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs) != PBSE_NONE)
+			rc = -1;
+		pstat = (struct brp_status *)GET_NEXT(preply->brp_un.brp_status);
+		while (pstat && (rc == 0)) {
+			/* the count is already on the wire, never send more */
+			if (--n < 0)
+				rc = -1;
+			else
+				rc = encode_DIS_status_entry(sfds, pstat);
+			pstat = (struct brp_status *)GET_NEXT(pstat->brp_stlink);
+		}
+		if (n != 0)
+			rc = -1;
+		reply_free(preply);
+		preply->brp_choice = BATCH_REPLY_CHOICE_Status;
+		CLEAR_HEAD(preply->brp_un.brp_status);
+	}
+	if (rc == 0)
+		rc = DIS_wflush(sfds, 0);
+
+	if (rc) {
+		(void)sprintf(log_buffer, "streamed status reply failure, %d, errno=%d",
+			rc, pbs_tcp_errno);
+		log_event(PBSEVENT_SYSTEM, PBS_EVENTCLASS_REQUEST, LOG_WARNING,
+			__func__, log_buffer);
+		close_client(sfds);
+	}
+	free_br(preq);
+}
+
 /**
  * @brief
  * 		Service the Status Job Request
@@ -280,6 +552,10 @@ stat_a_jobidname(struct batch_request *preq, char *name, int dohistjobs, int dos
  * 		The requested object may be a job id (either a single regular job, an Array
  * 		job, a subjob or a range of subjobs), a comma separated list of the above,
  * 		a queue name or null (or @...) for all jobs in the Server.
+ * @par
+ * 		The jobs of a queue or of the Server are streamed to a remote client
+ * 		and may be asked for in pages; a reply auxcode of 1 tells the client
+ * 		that more jobs follow the page.
  *
  * @param[in,out]	preq	-	pointer to the stat job batch request, reply updated
  *
@@ -298,14 +574,31 @@ void req_stat_job(struct batch_request *preq)
 	int		    rc   = 0;
 	int		    type = 0;
 	char		   *pnxtjid = NULL;
+	char		   *pc;
+	char		   *cursor = NULL;
+	int		    page_size = 0;
+	int		    ct = 0;
+	int		    n;
+	job		   *plast = NULL;
 
 	/* check for any extended flag in the batch request. 't' for
 	 * the sub jobs. If 'x' is there, then check if the server is
 	 * configured for history job info. If not set or set to FALSE,
 	 * return with PBSE_JOBHISTNOTSET error. Otherwise select history
 	 * jobs.
+	 * "P<n>" asks for pages of n entries, rounded up to a whole job and
+	 * its subjobs.  "C<jobid>", always last, continues after the page
+	 * that ended with jobid.
+	 * The cursor is cut off the flags so its letters are not taken
+	 * for flags here or in status_subjob().
 	 */
 	if (preq->rq_extend) {
+		if ((pc = strchr(preq->rq_extend, (int)'C')) != NULL) {
+			*pc = '\0';
+			cursor = pc + 1;
+		}
+		if ((pc = strchr(preq->rq_extend, (int)'P')) != NULL)
+			page_size = atoi(pc + 1);
 		if (strchr(preq->rq_extend, (int)'t'))
 			dosubjobs = 1;	/* status sub jobs of an Array Job */
 		if (strchr(preq->rq_extend, (int)'x')) {
@@ -377,20 +670,42 @@ void req_stat_job(struct batch_request *preq)
 			req_reject(rc, 0, preq);
 		return;
 
-	} else if (type == 2) {
-		pjob = (job *)GET_NEXT(pque->qu_jobs);
-		while (pjob && (rc == PBSE_NONE)) {
-			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
-			pjob = (job *)GET_NEXT(pjob->ji_jobque);
-		}
-	} else {
-		pjob = (job *)GET_NEXT(svr_alljobs);
-		while (pjob && (rc == PBSE_NONE)) {
-			rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
-			pjob = (job *)GET_NEXT(pjob->ji_alljobs);
+	}
+
+	/* type 2 or 3: page through the jobs of the queue or of the server */
+	if ((rc = first_stat_job(pque, cursor, &pjob)) != PBSE_NONE) {
+		req_reject(rc, 0, preq);
+		return;
+	}
+
+	/*
+	 * A reply to a remote client is streamed.  An unknown attribute name
+	 * must be rejected rather than streamed, so that request is left to
+	 * the path below, as are local and rpp requests.
+	 */
+	if ((preq->rq_conn >= 0) && !preq->isrpp && (preq->rq_parentbr == NULL)) {
+		svrattrl *pal;
+
+		pal = (svrattrl *)GET_NEXT(preq->rq_ind.rq_status.rq_attr);
+		while (pal && (find_attr(job_attr_def, pal->al_name, JOB_ATR_LAST) >= 0))
+			pal = (svrattrl *)GET_NEXT(pal->al_link);
+		if (pal == NULL) {
+			stream_stat_jobs(preq, pque, pjob, dohistjobs, dosubjobs, page_size);
+			return;
 		}
+	}
 
+	while (pjob && (rc == PBSE_NONE) && ((page_size <= 0) || (ct < page_size))) {
+		n = count_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
+		if (n > 0)
+			plast = pjob;
+		ct += n;
+		rc = do_stat_of_a_job(preq, pjob, dohistjobs, dosubjobs);
+		pjob = next_stat_job(pque, pjob);
 	}
+	preply->brp_auxcode = (pjob != NULL);	/* more jobs to page through */
+	if ((pjob != NULL) && (plast != NULL))
+		save_stat_cursor(pque, plast, pjob);
 
 	if (rc && (rc != PBSE_PERM))
 		req_reject(rc, bad, preq);
@@ -548,6 +863,8 @@ req_stat_node(struct batch_request *preq)
 	int		    rc   = 0;
 	int		    type = 0;
 	int		    i;
+	int		    dodelta = 0;
+	long		    since = 0;
 
 	/*
 	 * first, check that the server indeed has a list of nodes
@@ -565,9 +882,19 @@ req_stat_node(struct batch_request *preq)
 
 	name = preq->rq_ind.rq_status.rq_id;
 
-	if ((*name == '\0') || (*name =='@'))
+	if ((*name == '\0') || (*name =='@')) {
 		type = 1;
-	else {
+
+		/*
+		 * "D<epoch>:<seq>" in the extend string asks for only the vnodes
+		 * changed after change sequence <seq>, see chgseq_since().
+		 */
+		dodelta = chgseq_since(preq->rq_extend, &since);
+		if (dodelta < 0) {
+			req_reject(PBSE_RESYNC_REQUIRED, 0, preq);
+			return;
+		}
+	} else {
 		pnode = find_nodebyname(name);
 		if (pnode == NULL) {
 			req_reject(PBSE_UNKNODE, 0, preq);
@@ -584,13 +911,18 @@ req_stat_node(struct batch_request *preq)
 
 	} else {			/* get status of all nodes */
 
-		for (i = 0; i < svr_totnodes; i++) {
+		/* in delta mode, report deleted vnodes and skip unchanged ones */
+		if (dodelta)
+			rc = status_purged_objs(MGR_OBJ_NODE, since,
+				&preply->brp_un.brp_status);
+
+		for (i = 0; (rc == 0) && (i < svr_totnodes); i++) {
 			pnode = pbsndlist[i];
+			if (dodelta && (pnode->nd_chgseq <= since))
+				continue;
 
 			rc = status_node(pnode, preq,
 				&preply->brp_un.brp_status);
-			if (rc)
-				break;
 		}
 	}
 
@@ -721,6 +1053,12 @@ req_stat_svr(struct batch_request *preq)
 	update_license_ct(&server.sv_attr[(int)SRV_ATR_license_count],
 		server.sv_license_ct_buf);
 
+	/* job_change_seq is "<server start time>:<change sequence>" */
+	(void)sprintf(server.sv_chgseqbuf, "%ld:%ld",
+		(long)server.sv_started, svr_chgseq);
+	server.sv_attr[(int)SRV_ATR_JobChangeSeq].at_val.at_str = server.sv_chgseqbuf;
+	server.sv_attr[(int)SRV_ATR_JobChangeSeq].at_flags |= ATR_VFLAG_SET|ATR_VFLAG_MODCACHE;
+
 	/* allocate a reply structure and a status sub-structure */
 
 	preply = &preq->rq_reply;
@@ -957,6 +1295,8 @@ req_stat_resv(struct batch_request * preq)
 	resc_resv	   *presv = NULL;
 	int		    rc   = 0;
 	int		    type = 0;
+	int		    dodelta = 0;
+	long		    since = 0;
 
 	/*
 	 * first, validate the name sent in the request.
@@ -966,9 +1306,16 @@ req_stat_resv(struct batch_request * preq)
 
 	name = preq->rq_ind.rq_status.rq_id;
 
-	if ((*name == '\0') || (*name =='@'))
+	if ((*name == '\0') || (*name =='@')) {
 		type = 1;
-	else {
+
+		/* "D<epoch>:<seq>": only the reservations changed since <seq> */
+		dodelta = chgseq_since(preq->rq_extend, &since);
+		if (dodelta < 0) {
+			req_reject(PBSE_RESYNC_REQUIRED, 0, preq);
+			return;
+		}
+	} else {
 		presv = find_resv(name);
 		if (presv == NULL) {
 			req_reject(PBSE_UNKRESVID, 0, preq);
@@ -987,13 +1334,17 @@ req_stat_resv(struct batch_request * preq)
 	} else {
 		/* get status of all the reservations */
 
+		if (dodelta)
+			rc = status_purged_objs(MGR_OBJ_RESV, since,
+				&preply->brp_un.brp_status);
+
 		presv = (resc_resv *)GET_NEXT(svr_allresvs);
-		while (presv) {
-			rc = status_resv(presv, preq, &preply->brp_un.brp_status);
-			if (rc == PBSE_PERM)
-				rc = 0;
-			if (rc)
-				break;
+		while (presv && (rc == 0)) {
+			if ((dodelta == 0) || (presv->ri_chgseq > since)) {
+				rc = status_resv(presv, preq, &preply->brp_un.brp_status);
+				if (rc == PBSE_PERM)
+					rc = 0;
+			}
 			presv = (resc_resv *)GET_NEXT(presv->ri_allresvs);
 		}
 	}
@@ -0,0 +1,304 @@
+/*
+ * Copyright (C) 1994-2018 Altair Engineering, Inc.
+ * For more information, contact Altair at www.altair.com.
+ *
+ * This file is part of the PBS Professional ("PBS Pro") software.
+ *
+ * Open Source License Information:
+ *
+ * PBS Pro is free software. You can redistribute it and/or modify it under the
+ * terms of the GNU Affero General Public License as published by the Free
+ * Software Foundation, either version 3 of the License, or (at your option) any
+ * later version.
+ *
+ * PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+ * WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+ * FOR A PARTICULAR PURPOSE.
+ * See the GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * Commercial License Information:
+ *
+ * For a copy of the commercial license terms and conditions,
+ * go to: (http://www.pbspro.com/UserArea/agreement.html)
+ * or contact the Altair Legal Department.
+ *
+ * Altair’s dual-license business model allows companies, individuals, and
+ * organizations to create proprietary derivative works of PBS Pro and
+ * distribute them - whether embedded or bundled with other software -
+ * under a commercial license agreement.
+ *
+ * Use of Altair’s trademarks, including but not limited to "PBS™",
+ * "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+ * trademark licensing policies.
+ *
+ */
+#include <pbs_config.h>   /* the master config generated by configure */
+
+/*
+ * @file	svr_chgseq.c
+ *
+ * @brief
+ * 	svr_chgseq.c	-	The server's change journal.
+ *
+ *	Every time a job, vnode or reservation is created or modified it is
+ *	stamped with the next value of svr_chgseq.  Names of purged objects
+ *	are remembered in a fixed size ring so that a delta status request
+ *	can report them as deleted.  A client which knows the value of the
+ *	sequence at some earlier time ("<server start time>:<seq>", published
+ *	as the server attribute job_change_seq) can then ask for only the
+ *	objects changed since.  If the client asks for changes older than the
+ *	oldest entry overwritten in the ring, it must do a full status instead.
+ *
+ * Included funtions are:
+ *	svr_job_changed()
+ *	svr_node_changed()
+ *	svr_resv_changed()
+ *	svr_chgseq_purged()
+ *	chgseq_expired()
+ *	chgseq_since()
+ *	status_purged_obj()
+ *	status_purged_objs()
+ *
+ */
+#define STAT_CNTL 1
+
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "libpbs.h"
+#include "server_limits.h"
+#include "list_link.h"
+#include "attribute.h"
+#include "server.h"
+#include "credential.h"
+#include "batch_request.h"
+#include "job.h"
+#include "reservation.h"
+#include "pbs_error.h"
+#include "pbs_nodes.h"
+#include "svrfunc.h"
+
+
+/* Global Data Items: */
+
+extern struct server server;
+
+long	svr_chgseq = 0;
+
+struct chgseq_deleted {
+	long	cd_seq;				/* sequence when purged  */
+	int	cd_objtype;			/* MGR_OBJ_JOB/NODE/RESV */
+	char	cd_name[PBS_MAXSVRJOBID + 1];	/* name of purged object */
+};
+static struct chgseq_deleted *chgseq_ring = NULL;
+static int  chgseq_next = 0;	/* next ring slot to be (over)written */
+static long chgseq_lost = 0;	/* newest sequence dropped from ring  */
+
+/**
+ * @brief
+ * 		svr_job_changed - stamp a job with the next change sequence number
+ *		so the job is included in the next delta status reply.
+ *
+ * @param[in,out]	pjob	-	job which was modified
+ */
+void
+svr_job_changed(job *pjob)
+{
+	if (pjob != NULL)
+		pjob->ji_chgseq = ++svr_chgseq;
+}
+
+/**
+ * @brief
+ * 		svr_node_changed - stamp a vnode with the next change sequence number
+ *		so the vnode is included in the next delta status reply.
+ *
+ * @param[in,out]	pnode	-	vnode which was modified
+ */
+void
+svr_node_changed(struct pbsnode *pnode)
+{
+	if (pnode != NULL)
+		pnode->nd_chgseq = ++svr_chgseq;
+}
+
+/**
+ * @brief
+ * 		svr_resv_changed - stamp a reservation with the next change sequence
+ *		number so it is included in the next delta status reply.
+ *
+ * @param[in,out]	presv	-	reservation which was modified
+ */
+void
+svr_resv_changed(resc_resv *presv)
+{
+	if (presv != NULL)
+		presv->ri_chgseq = ++svr_chgseq;
+}
+
+/**
+ * @brief
+ * 		svr_chgseq_purged - remember the name of an object which is being
+ *		purged so that a delta status reply can report it as deleted.
+ *
+ * @param[in]	objtype	-	MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_RESV
+ * @param[in]	name	-	job id, vnode name or reservation id
+ *
+ * @par
+ *		If the ring cannot be allocated, every delta request issued before
+ *		this point is forced into a full resync.
+ */
+void
+svr_chgseq_purged(int objtype, char *name)
+{
+	struct chgseq_deleted *pd;
+
+	if (chgseq_ring == NULL) {
+		chgseq_ring = (struct chgseq_deleted *)calloc(PBS_CHGSEQ_DELETED,
+			sizeof(struct chgseq_deleted));
+		if (chgseq_ring == NULL) {
+			chgseq_lost = ++svr_chgseq;
+			return;
+		}
+	}
+
+	pd = &chgseq_ring[chgseq_next];
+	if (pd->cd_seq > chgseq_lost)
+		chgseq_lost = pd->cd_seq;
+	pd->cd_seq = ++svr_chgseq;
+	pd->cd_objtype = objtype;
+	(void)strncpy(pd->cd_name, name, sizeof(pd->cd_name) - 1);
+	pd->cd_name[sizeof(pd->cd_name) - 1] = '\0';
+	chgseq_next = (chgseq_next + 1) % PBS_CHGSEQ_DELETED;
+}
+
+/**
+ * @brief
+ * 		chgseq_expired - determine if the changes since a given sequence
+ *		number can still be reported in full
+ *
+ * @param[in]	since	-	sequence number known by the client
+ *
+ * @return	int
+ * @retval	1	: purged objects were forgotten, client must resync
+ * @retval	0	: delta can be computed
+ */
+int
+chgseq_expired(long since)
+{
+	return ((since < chgseq_lost) || (since > svr_chgseq));
+}
+
+/**
+ * @brief
+ * 		chgseq_since - look for "D<epoch>:<seq>" in the extend string of a
+ *		status request and check that the changes since <seq> are known.
+ *
+ * @param[in]	extend	-	extend string of the request, may be NULL
+ * @param[out]	since	-	sequence number known by the client
+ *
+ * @return	int
+ * @retval	0	: no delta asked for, do a full status
+ * @retval	1	: delta asked for, *since is set
+ * @retval	-1	: the server restarted or the changes were forgotten,
+ *			  reject with PBSE_RESYNC_REQUIRED
+ */
+int
+chgseq_since(char *extend, long *since)
+{
+	char *pc;
+	long  epoch;
+
+	if ((extend == NULL) || ((pc = strchr(extend, 'D')) == NULL))
+		return (0);
+	if ((sscanf(pc + 1, "%ld:%ld", &epoch, since) != 2) ||
+		(epoch != (long)server.sv_started) || chgseq_expired(*since))
+		return (-1);
+	return (1);
+}
+
+/**
+ * @brief
+ * 		status_purged_obj - add a status entry without attributes for an
+ *		object, which tells the receiver of a delta reply that it is gone.
+ *
+ * @param[in]	objtype	-	MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_RESV
+ * @param[in]	name	-	name of object
+ * @param[in,out]	pstathd	-	head of list to append status to
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ */
+int
+status_purged_obj(int objtype, char *name, pbs_list_head *pstathd)
+{
+	struct brp_status *pstat;
+
+	pstat = (struct brp_status *)malloc(sizeof(struct brp_status));
+	if (pstat == NULL)
+		return (PBSE_SYSTEM);
+	CLEAR_LINK(pstat->brp_stlink);
+	pstat->brp_objtype = objtype;
+	(void)strcpy(pstat->brp_objname, name);
+	CLEAR_HEAD(pstat->brp_attr);
+	append_link(pstathd, &pstat->brp_stlink, pstat);
+	return (0);
+}
+
+/**
+ * @brief
+ * 		status_purged_objs - add an empty status entry for each object of
+ *		the given type purged after the given sequence number which has not
+ *		since come back (e.g. a job moved between local queues or a vnode
+ *		deleted and created again).
+ *
+ * @param[in]	objtype	-	MGR_OBJ_JOB, MGR_OBJ_NODE or MGR_OBJ_RESV
+ * @param[in]	since	-	sequence number known by the client
+ * @param[in,out]	pstathd	-	head of list to append status to
+ *
+ * @return	int
+ * @retval	0	: success
+ * @retval	PBSE_SYSTEM	: memory allocation error
+ */
+int
+status_purged_objs(int objtype, long since, pbs_list_head *pstathd)
+{
+	int i;
+	int slot;
+	int exists;
+	struct chgseq_deleted *pd;
+
+	if (chgseq_ring == NULL)
+		return (0);
+
+	/* oldest to newest */
+	for (i = 0; i < PBS_CHGSEQ_DELETED; i++) {
+		slot = (chgseq_next + i) % PBS_CHGSEQ_DELETED;
+		pd = &chgseq_ring[slot];
+		if ((pd->cd_seq <= since) || (pd->cd_objtype != objtype))
+			continue;
+		switch (objtype) {
+			case MGR_OBJ_JOB:
+				exists = (find_job(pd->cd_name) != NULL);
+				break;
+			case MGR_OBJ_NODE:
+				exists = (find_nodebyname(pd->cd_name) != NULL);
+				break;
+			case MGR_OBJ_RESV:
+				exists = (find_resv(pd->cd_name) != NULL);
+				break;
+			default:
+				exists = 0;
+		}
+		if (exists)
+			continue;
+		if (status_purged_obj(objtype, pd->cd_name, pstathd) != 0)
+			return (PBSE_SYSTEM);
+	}
+	return (0);
+}
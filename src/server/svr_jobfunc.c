@@ -552,6 +552,7 @@ svr_dequejob(job *pjob)
 	/* remove job from server's all job list and reduce server counts */
 
 	if (is_linked(&svr_alljobs, &pjob->ji_alljobs)) {
+		advance_stat_cursors(pjob, NULL);
 		delete_link(&pjob->ji_alljobs);
 		delete_link(&pjob->ji_unlicjobs);
 
@@ -595,6 +596,7 @@ svr_dequejob(job *pjob)
 
 
 		if (is_linked(&pque->qu_jobs, &pjob->ji_jobque)) {
+			advance_stat_cursors(pjob, pque);
 			delete_link(&pjob->ji_jobque);
 			if (--pque->qu_numjobs < 0)
 				bad_ct = 1;
@@ -1744,15 +1746,18 @@ job_set_wait(attribute *pattr, void *pjob, int mode)
 	when  = pattr->at_val.at_long;
 	ptask = (struct work_task *)GET_NEXT(((job *)pjob)->ji_svrtask);
 
-	/* Is there already an entry for this job?  Then reuse it */
+	/*
+	 * Is there already an entry for this job?  Then replace it, its time
+	 * cannot be changed in place as that is the timed task heap's key
+	 */
 
 	if (((job *)pjob)->ji_qs.ji_svrflags & JOB_SVFLG_HASWAIT) {
 		while (ptask) {
-			if ((ptask->wt_event == WORK_Timed) &&
+			if ((ptask->wt_type == WORK_Timed) &&
 				(ptask->wt_func == job_wait_over) &&
 				(ptask->wt_parm1 == pjob)) {
-				ptask->wt_event = when;
-				return (0);
+				delete_task(ptask);
+				break;
 			}
 			ptask = (struct work_task *)GET_NEXT(ptask->wt_linkobj);
 		}
@@ -3981,6 +3986,7 @@ resv_setResvState(resc_resv *presv, int state, int sub)
 
 	presv->ri_qs.ri_state = state;
 	presv->ri_qs.ri_substate = sub;
+	svr_resv_changed(presv);
 
 	presv->ri_wattr[(int)RESV_ATR_state]
 	.at_val.at_long = state;
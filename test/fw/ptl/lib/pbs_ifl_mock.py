@@ -258,6 +258,8 @@ ATTR_dfltqsubargs = 'default_qsub_arguments'
 ATTR_rpp_retry = 'rpp_retry'
 ATTR_rpp_highwater = 'rpp_highwater'
 ATTR_rpp_max_pkt_check = 'rpp_max_pkt_check'
+ATTR_job_chgseq = 'job_change_seq'
+ATTR_multijob_reqs = 'multijob_requests'
 ATTR_license_location = 'pbs_license_file_location'
 ATTR_pbs_license_info = 'pbs_license_info'
 ATTR_license_min = 'pbs_license_min'
@@ -0,0 +1,110 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestChangeJournal(TestFunctional):
+    """
+    Test the server's change journal, which lets a client status only the
+    vnodes and reservations changed since an earlier job_change_seq
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        # the "D<epoch>:<seq>" extend is only passed through the IFL
+        self.server.set_op_mode(PTL_API)
+
+    def tearDown(self):
+        self.server.set_op_mode(PTL_CLI)
+        TestFunctional.tearDown(self)
+
+    def get_chgseq(self):
+        """
+        Return the server's change sequence as "<epoch>:<seq>"
+        """
+        svr = self.server.status(SERVER, 'job_change_seq')
+        return svr[0]['job_change_seq']
+
+    def test_vnode_delta(self):
+        """
+        Test that a delta vnode status returns a vnode modified after the
+        given sequence, with its new attribute values
+        """
+        seq = self.get_chgseq()
+        self.server.manager(MGR_CMD_SET, NODE, {'comment': 'journaled'},
+                            self.mom.shortname, expect=True)
+        nodes = self.server.status(VNODE, id=None, extend='D' + seq)
+        node = [n for n in nodes if n['id'] == self.mom.shortname]
+        self.assertEqual(len(node), 1)
+        self.assertEqual(node[0]['comment'], 'journaled')
+
+    def test_resv_delta(self):
+        """
+        Test that a delta reservation status returns a new reservation,
+        and an entry without attributes once it is deleted
+        """
+        seq = self.get_chgseq()
+        now = int(time.time())
+        a = {'Resource_List.select': '1:ncpus=1',
+             'reserve_start': now + 3600, 'reserve_end': now + 7200}
+        r = Reservation(TEST_USER, a)
+        rid = self.server.submit(r)
+        self.server.expect(RESV, {'reserve_state':
+                                  (MATCH_RE, "RESV_CONFIRMED|2")}, id=rid)
+        resvs = self.server.status(RESV, id=None, extend='D' + seq)
+        self.assertIn(rid, [rv['id'] for rv in resvs])
+
+        seq = self.get_chgseq()
+        self.server.delete(rid)
+        self.server.expect(RESV, 'queue', id=rid, op=UNSET)
+        resvs = self.server.status(RESV, id=None, extend='D' + seq)
+        gone = [rv for rv in resvs if rv['id'] == rid]
+        self.assertEqual(len(gone), 1)
+        self.assertNotIn('reserve_state', gone[0])
+
+    def test_resync_required(self):
+        """
+        Test that a delta status against another server start time is
+        rejected so the client does a full status
+        """
+        epoch, seq = self.get_chgseq().split(':')
+        stale = 'D%d:%s' % (int(epoch) - 1, seq)
+        with self.assertRaises(PbsStatusError):
+            self.server.status(VNODE, id=None, extend=stale)
+        with self.assertRaises(PbsStatusError):
+            self.server.status(RESV, id=None, extend=stale)
@@ -1967,3 +1967,49 @@ else:
         # one for no foores
         self.scheduler.log_match("Number of job equivalence classes: 3",
                                  max_attempts=10, starttime=self.t)
+
+    def test_identical_jobs_fill_nodes(self):
+        """
+        Test that identical jobs placed in one cycle use all of the free
+        resources and the rest of the class is left queued
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = self.submit_jobs(10)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state=R': 8})
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[8])
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[9])
+        self.server.expect(JOB, 'comment', op=SET, id=jids[9])
+
+        # Freeing resources lets the class run again
+        self.server.delete(jids[0], wait=True)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jids[8])
+
+    def test_identical_jobs_resume_node_search(self):
+        """
+        Test that identical jobs placed in one cycle resume the node search
+        after the nodes earlier jobs filled instead of checking them again
+        """
+        # Each node holds two jobs.  Memory fills before ncpus does, so
+        # full nodes stay free and are checked by the node search.
+        a = {'resources_available.ncpus': 4,
+             'resources_available.mem': '2gb'}
+        self.server.create_vnodes('vnode', a, 10, self.mom,
+                                  sharednode=False)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = self.submit_jobs(20, {'Resource_List.select':
+                                     '1:ncpus=1:mem=1gb'})
+        t = int(time.time())
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state=R': 20})
+        self.scheduler.log_match(
+            jids[19] + ";Skipping 9 nodes an identical job did not fit on",
+            starttime=t)
+
+        # Without the resume position the jobs would check the full nodes
+        # 90 times (job n is searched past (n - 1) / 2 nodes).  With it,
+        # each node is found full once, by the job after it filled.
+        m = self.scheduler.log_match(
+            r"Node;vnode\[\d+\];Insufficient amount of resource: mem",
+            regexp=True, allmatch=True, n='ALL', starttime=t)
+        self.assertEqual(len(m), 9)
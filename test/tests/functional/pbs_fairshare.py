@@ -35,6 +35,10 @@
 # "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
 # trademark licensing policies.
 
+import base64
+import struct
+import tempfile
+
 from tests.functional import *
 
 
@@ -354,3 +358,185 @@ class TestFairshare(TestFunctional):
         job_order = [jid3, jid4]
         for i in range(len(job_order)):
             self.assertEqual(job_order[i].split('.')[0], c.political_order[i])
+
+    def test_wide_resource_group(self):
+        """
+        Test a resource group file with thousands of entities in one group.
+        Each entity must be found with the right percentage, and entities
+        are looked up from the last to the first.
+        """
+
+        num_ents = 5000
+        body = 'wide 100 root 100\n'
+        for i in range(num_ents):
+            body += 'ent%d %d wide %d\n' % (i, 101 + i, i % 3 + 1)
+        body += '%s 99 wide 1\n' % str(TEST_USER)
+        fn = self.du.create_temp_file(body=body)
+        self.du.run_copy(self.server.hostname, src=fn,
+                         dest=self.scheduler.resource_group_file,
+                         sudo=True)
+        os.remove(fn)
+        # 'wide' is the only group with shares, so it has all of the tree
+        self.scheduler.set_sched_config({'fair_share': 'True',
+                                         'unknown_shares': 0})
+        self.scheduler.signal('-HUP')
+
+        # total shares of 'wide' is the sum of 1, 2, 3, ... plus TEST_USER
+        shares = sum([i % 3 + 1 for i in range(num_ents)]) + 1
+        for i in [num_ents - 1, num_ents / 2, 0]:
+            n = self.scheduler.query_fairshare(name='ent%d' % i)
+            perc = (i % 3 + 1) * 100.0 / shares
+            self.assertAlmostEqual(n.perc['TREEROOT'], perc, delta=0.001)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        J = Job(TEST_USER)
+        jid = self.server.submit(J)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+    def test_usage_file_sync(self):
+        """
+        Test that usage synced by the scheduler every cycle is kept in the
+        usage file, that pbsfs can read it while jobs run, and that no
+        journal or temporary file is left behind by the sync.
+        """
+
+        self.scheduler.add_to_resource_group(TEST_USER, 11, 'root', 10)
+        self.scheduler.add_to_resource_group(TEST_USER1, 12, 'root', 10)
+        self.scheduler.set_sched_config({'fair_share': 'True',
+                                         'fairshare_usage_res': 'ncpus'})
+        self.scheduler.set_fairshare_usage(TEST_USER, 100)
+        self.scheduler.set_fairshare_usage(TEST_USER1, 50)
+
+        J = Job(TEST_USER)
+        jid = self.server.submit(J)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+        for _ in range(3):
+            t = int(time.time())
+            self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+            self.scheduler.log_match('Leaving Scheduling Cycle', starttime=t,
+                                     max_attempts=10)
+            n = self.scheduler.query_fairshare(name=str(TEST_USER))
+            self.assertGreaterEqual(n.usage, 100)
+            n = self.scheduler.query_fairshare(name=str(TEST_USER1))
+            self.assertEqual(n.usage, 50)
+
+        usage_file = os.path.join(
+            os.path.dirname(self.scheduler.resource_group_file), 'usage')
+        for suffix in ['.journal', '.new']:
+            self.assertFalse(self.du.isfile(self.server.hostname,
+                                            path=usage_file + suffix,
+                                            sudo=True))
+
+    def usage_file(self):
+        """
+        Path of the scheduler's fairshare usage file
+        """
+        return os.path.join(
+            os.path.dirname(self.scheduler.resource_group_file), 'usage')
+
+    def read_usage_records(self):
+        """
+        Read the v2 usage file and return its last decay time and a list
+        of (name, usage) records in file order
+        """
+        ret = self.du.run_cmd(self.server.hostname,
+                              ['base64', self.usage_file()], sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        data = base64.b64decode(''.join(ret['out']))
+        # group_node_header (24 bytes) is followed by the last decay time
+        last_decay = struct.unpack_from('=q', data, 24)[0]
+        recs = []
+        for off in range(32, len(data), 64):
+            name = data[off:off + 50].split(b'\0')[0]
+            usage = struct.unpack_from('=d', data, off + 56)[0]
+            recs.append((name, usage))
+        return last_decay, recs
+
+    def write_usage_journal(self, last_decay, recs, nslots, torn=0):
+        """
+        Write a usage journal as the scheduler does before updating the
+        usage file in place.  recs is a list of (slot, name, usage).
+        If torn is set, that many bytes are cut off the end of it.
+        """
+        data = struct.pack('=9s3xii4xq', b'PBS_JRN!', len(recs), nslots,
+                           last_decay)
+        for slot, name, usage in recs:
+            data += struct.pack('=i4x50s6xd', slot, name, usage)
+        csum = 5381
+        for c in bytearray(data):
+            csum = (csum * 33 + c) & 0xffffffffffffffff
+        data += struct.pack('=Q', csum)
+        if torn:
+            data = data[:-torn]
+        (fd, fn) = tempfile.mkstemp(prefix='PtlPbsUsageJournal')
+        os.write(fd, data)
+        os.close(fd)
+        self.du.run_copy(self.server.hostname, src=fn,
+                         dest=self.usage_file() + '.journal', sudo=True)
+        os.remove(fn)
+
+    def set_up_journal_test(self):
+        """
+        Give TEST_USER usage, stop the scheduler and return the slot of
+        TEST_USER's record, the last decay time and number of records
+        """
+        self.scheduler.add_to_resource_group(TEST_USER, 11, 'root', 10)
+        self.scheduler.add_to_resource_group(TEST_USER1, 12, 'root', 10)
+        self.scheduler.set_sched_config({'fair_share': 'True'})
+        self.scheduler.set_fairshare_usage(TEST_USER, 100)
+        self.scheduler.set_fairshare_usage(TEST_USER1, 50)
+        self.scheduler.stop()
+
+        last_decay, recs = self.read_usage_records()
+        names = [r[0] for r in recs]
+        self.assertIn(str(TEST_USER).encode(), names)
+        return names.index(str(TEST_USER).encode()), last_decay, len(recs)
+
+    def test_usage_journal_replay(self):
+        """
+        Test that a complete usage journal left by an interrupted update
+        is replayed onto the usage file when the scheduler starts
+        """
+        slot, last_decay, nslots = self.set_up_journal_test()
+        self.write_usage_journal(last_decay,
+                                 [(slot, str(TEST_USER).encode(), 500)],
+                                 nslots)
+
+        t = int(time.time())
+        self.scheduler.start()
+        self.scheduler.log_match('Replayed usage journal', starttime=t)
+        n = self.scheduler.query_fairshare(name=str(TEST_USER))
+        self.assertEqual(n.usage, 500)
+        n = self.scheduler.query_fairshare(name=str(TEST_USER1))
+        self.assertEqual(n.usage, 50)
+        self.assertFalse(self.du.isfile(self.server.hostname,
+                                        path=self.usage_file() + '.journal',
+                                        sudo=True))
+
+    def test_usage_journal_torn(self):
+        """
+        Test that a usage journal whose last record was not completely
+        written is discarded, the usage file is left as it was and the
+        scheduler keeps running
+        """
+        slot, last_decay, nslots = self.set_up_journal_test()
+        self.write_usage_journal(last_decay,
+                                 [(slot, str(TEST_USER).encode(), 500)],
+                                 nslots, torn=20)
+
+        t = int(time.time())
+        self.scheduler.start()
+        self.scheduler.log_match('Discarded incomplete usage journal',
+                                 starttime=t)
+        self.assertTrue(self.scheduler.isUp())
+        n = self.scheduler.query_fairshare(name=str(TEST_USER))
+        self.assertEqual(n.usage, 100)
+        self.assertFalse(self.du.isfile(self.server.hostname,
+                                        path=self.usage_file() + '.journal',
+                                        sudo=True))
+
+        J = Job(TEST_USER)
+        jid = self.server.submit(J)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
@@ -0,0 +1,98 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestJobSortOrder(TestFunctional):
+    """
+    Test that jobs are sorted on up to date values each cycle when
+    the scheduler starts from the previous cycle's job order
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 1},
+                            self.mom.shortname)
+        self.scheduler.set_sched_config({'job_sort_key':
+                                         '"job_priority HIGH"'})
+
+    def test_priority_change_between_cycles(self):
+        """
+        Submit jobs of different priorities, then raise the priority of
+        the lowest one after a cycle and check it is the next to run
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        jids = []
+        for prio in range(1, 6):
+            J = Job(TEST_USER, attrs={ATTR_p: prio})
+            jids.append(self.server.submit(J))
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jids[4])
+        self.server.expect(JOB, {ATTR_state: 'Q'}, id=jids[3])
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.server.alterjob(jids[0], {ATTR_p: 100})
+        self.server.delete(jids[4], wait=True)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jids[0])
+        for jid in jids[1:4]:
+            self.server.expect(JOB, {ATTR_state: 'Q'}, id=jid)
+
+    def test_fairshare_order(self):
+        """
+        With fairshare the job order changes as usage is charged.  Check
+        jobs of the user with less usage run first in each cycle.
+        """
+        self.scheduler.set_sched_config({'fair_share': 'true ALL',
+                                         'fairshare_usage_res': 'ncpus*walltime',
+                                         'unknown_shares': 10})
+        self.scheduler.add_to_resource_group(TEST_USER, 10, 'root', 50)
+        self.scheduler.add_to_resource_group(TEST_USER1, 11, 'root', 50)
+        self.scheduler.set_fairshare_usage(TEST_USER, 100)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        j1 = self.server.submit(Job(TEST_USER))
+        j2 = self.server.submit(Job(TEST_USER1))
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=j2)
+        self.server.expect(JOB, {ATTR_state: 'Q'}, id=j1)
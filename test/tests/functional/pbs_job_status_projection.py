@@ -0,0 +1,76 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+import os
+
+from tests.functional import *
+
+
+class TestJobStatusProjection(TestFunctional):
+
+    """
+    The scheduler and qstat's filtered listings ask the server for only the
+    job attributes they read, and let it do the filtering.
+    """
+
+    def test_sched_runs_job_with_large_env(self):
+        """
+        A job whose Variable_List is large is still queried and run, the
+        scheduler does not ask for the Variable_List
+        """
+        a = {ATTR_v: 'BIG_VAR=' + 'x' * 16384}
+        j = Job(TEST_USER, attrs=a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
+
+    def test_qstat_select_listing(self):
+        """
+        qstat options that select jobs on the server list the jobs they
+        select with the attributes they display
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j = Job(TEST_USER, attrs={ATTR_N: 'projected'})
+        jid = self.server.submit(j)
+        qstat = os.path.join(self.server.client_conf['PBS_EXEC'],
+                             'bin', 'qstat')
+        for opt in ['-u ' + str(TEST_USER), '-i', '-s -u ' + str(TEST_USER)]:
+            ret = self.du.run_cmd(self.server.hostname, qstat + ' ' + opt,
+                                  as_script=True)
+            self.assertEqual(ret['rc'], 0)
+            out = '\n'.join(ret['out'])
+            self.assertIn(jid.split('.')[0], out)
+            self.assertIn('projected', out)
@@ -802,3 +802,32 @@ class TestNodeBuckets(TestFunctional):
         for n in ev:
             self.server.expect(
                 NODE, 'resources_available.bool', op=UNSET, id=n)
+
+    @timeout(450)
+    def test_whole_bucket(self):
+        """
+        Request every node of one color in one cycle with two jobs.  The
+        first job gets the entire bucket and the second can not run.
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        chunk = '1430:ncpus=1:color=yellow'
+        a = {'Resource_List.select': chunk,
+             'Resource_List.place': 'scatter:excl'}
+        j1 = Job(TEST_USER, attrs=a)
+        jid1 = self.server.submit(j1)
+
+        a['Resource_List.select'] = '1:ncpus=1:color=yellow'
+        j2 = Job(TEST_USER, attrs=a)
+        jid2 = self.server.submit(j2)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jid2)
+        self.scheduler.log_match(jid1 + ';Chunk: ' + chunk)
+
+        s1 = self.server.status(JOB, 'exec_vnode', id=jid1)
+        n1 = j1.get_vnodes(s1[0]['exec_vnode'])
+        self.assertEquals(len(set(n1)), 1430,
+                          'job did not run on correct number of nodes')
@@ -74,3 +74,32 @@ class Test_explicit_psets(TestFunctional):
         c = "Can Never Run: can't fit in the largest placement set,\
  and can't span psets"
         self.server.expect(JOB, {'comment': c}, id=jid)
+
+    def test_psets_follow_node_changes(self):
+        """
+        Test that placement sets are regrouped in the next cycle when a
+        node's node_group_key value changes
+        """
+        a = {'resources_available.ncpus': 2}
+        self.server.create_vnodes('vn', a, 2, self.mom)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.foo': 'A'}, id='vn[0]')
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.foo': 'B'}, id='vn[1]')
+        a = {'node_group_enable': 'True', 'node_group_key': 'foo'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+
+        a = {'Resource_List.select': '2:ncpus=2',
+             'Resource_List.place': 'vscatter'}
+        j = Job(TEST_USER, attrs=a)
+        jid = self.server.submit(j)
+
+        c = "Can Never Run: can't fit in the largest placement set,\
+ and can't span psets"
+        self.server.expect(JOB, {'comment': c}, id=jid)
+
+        # Both vnodes now belong to the foo=A placement set
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.foo': 'A'}, id='vn[1]')
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid)
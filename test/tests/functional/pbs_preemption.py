@@ -86,3 +86,41 @@ class TestPreemption(TestFunctional):
         # Check whether scheduler marked the preempted job as "will never run"
         self.scheduler.log_match(
             jidl + ";Job will never run", existence=False, max_attempts=5)
+
+    def test_preempt_only_lower_priority_candidates(self):
+        """
+        Test that only running jobs of a lower preemption priority are
+        considered as preemption candidates and that the work done is logged
+        """
+        self.scheduler.set_sched_config({'log_filter': 2048})
+        attr = {'resources_available.ncpus': '3'}
+        self.server.manager(MGR_CMD_SET, NODE, attr, self.mom.shortname,
+                            expect=True)
+
+        attr = {"queue_type": "Execution", "Priority": 200, "started": "True",
+                "enabled": "True"}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, attr, id="highp",
+                            logerr=False)
+        attr["Priority"] = 100
+        self.server.manager(MGR_CMD_CREATE, QUEUE, attr, id="lowp",
+                            logerr=False)
+
+        # One express job and one normal job fill the node
+        attr = {"Resource_List.ncpus": 1, "queue": "highp",
+                "Resource_List.walltime": "00:10:00"}
+        jidh1 = self.server.submit(Job(TEST_USER, attrs=attr))
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jidh1)
+        attr["Resource_List.ncpus"] = 2
+        attr["queue"] = "lowp"
+        jidl = self.server.submit(Job(TEST_USER, attrs=attr))
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jidl)
+
+        attr["queue"] = "highp"
+        jidh2 = self.server.submit(Job(TEST_USER, attrs=attr))
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jidh2)
+        self.server.expect(JOB, {ATTR_state: 'S'}, id=jidl)
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jidh1)
+
+        self.scheduler.log_match(
+            jidh2 + ";Preemption work: 1 of 2 running jobs were candidates",
+            max_attempts=5)
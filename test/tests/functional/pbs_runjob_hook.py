@@ -119,3 +119,43 @@ pbs.event().reject("runjob hook rejected the job")
         self.server.expect(JOB, {'job_state': 'B'}, id=jid)
         self.server.expect(JOB, {'job_state=R': 3}, count=True,
                            id=jid, extend='t')
+
+    def test_reject_pipelined_runjob(self):
+        """
+        In throughput mode the scheduler sends its run requests in bulk
+        to a server which lists runjobs in multijob_requests, and goes on
+        as if they had succeeded.  Check that a job rejected by a runjob
+        hook is put back with the hook's message as its comment, and that
+        the jobs queued with it still run.
+        """
+        self.server.expect(SERVER,
+                           {ATTR_multijob_reqs: (MATCH_RE, 'runjobs')})
+        hook_script = """
+import pbs
+e = pbs.event()
+if e.job.Job_Name == "reject":
+    e.reject("runjob hook rejected the job")
+"""
+        hook_name = "runjob_hook"
+        attrs = {'event': "runjob"}
+        rv = self.server.create_import_hook(hook_name, attrs, hook_script,
+                                            overwrite=True)
+        self.assertTrue(rv)
+        self.server.manager(MGR_CMD_SET, SCHED, {'throughput_mode': 'True'})
+        a = {'resources_available.ncpus': 2}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = Job(TEST_USER, {ATTR_N: 'reject'})
+        jid1 = self.server.submit(j1)
+        jids = []
+        for _ in range(2):
+            j = Job(TEST_USER)
+            jids.append(self.server.submit(j))
+        t = int(time.time())
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        msg = "Not Running: PBS Error: runjob hook rejected the job"
+        self.server.expect(JOB, {'job_state': 'Q', 'comment': msg}, id=jid1)
+        self.scheduler.log_match(jid1 + ";Failed to run job",
+                                 starttime=t)
+        for jid in jids:
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid)
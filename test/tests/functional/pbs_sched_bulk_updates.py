@@ -0,0 +1,72 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedBulkUpdates(TestFunctional):
+    """
+    The scheduler sends the attribute updates of the jobs of a cycle to
+    the server in bulk, if the server lists the Modify Jobs request in its
+    multijob_requests attribute.
+    """
+
+    def test_bulk_job_comments(self):
+        """
+        Check that the server lists modifyjobs, and that the comments of
+        jobs which cannot run are set by one Modify Jobs request from the
+        scheduler
+        """
+        self.server.expect(SERVER,
+                           {ATTR_multijob_reqs: (MATCH_RE, 'modifyjobs')})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        self.server.manager(MGR_CMD_SET, SERVER, {'log_events': 2047})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        jids = []
+        for _ in range(5):
+            j = Job(TEST_USER, {'Resource_List.select': '1:ncpus=2'})
+            jids.append(self.server.submit(j))
+
+        t = int(time.time())
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        msg = 'Not Running: Insufficient amount of resource: ncpus'
+        for jid in jids:
+            self.server.expect(JOB, {'comment': (MATCH_RE, msg)}, id=jid)
+        self.server.log_match('Type 93 request received from Scheduler',
+                              starttime=t)
@@ -0,0 +1,91 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedCycleProfile(TestFunctional):
+    """
+    Test the scheduler's cycle_profile and cycle_profile_trace options
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 1},
+                            self.mom.shortname)
+        self.trace = os.path.join(self.server.pbs_conf['PBS_HOME'],
+                                  'sched_priv', 'cycle_profile.trace')
+        self.du.rm(path=self.trace, sudo=True, force=True)
+
+    def test_cycle_profile_log(self):
+        """
+        Run one job and leave one queued, then check the phases of the
+        cycle are logged and the trace file is written
+        """
+        self.scheduler.set_sched_config({'cycle_profile': 'true',
+                                         'cycle_profile_trace': self.trace})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = self.server.submit(Job(TEST_USER))
+        j2 = self.server.submit(Job(TEST_USER))
+
+        t = int(time.time())
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=j1)
+        self.server.expect(JOB, {ATTR_state: 'Q'}, id=j2)
+
+        for phase in ['query_server', 'sort', 'eval_selspec']:
+            self.scheduler.log_match('phase=%s calls=' % phase,
+                                     starttime=t)
+        self.scheduler.log_match('phase=main_loop calls=2 secs=[0-9.]+ '
+                                 'normal=2/', regexp=True, starttime=t)
+        self.scheduler.log_match('phase=is_ok_to_run calls=2 ',
+                                 starttime=t)
+        self.scheduler.log_match('phase=run_job calls=1 ', starttime=t)
+        self.scheduler.log_match('phase=cycle calls=1 ', starttime=t)
+        self.assertTrue(self.du.isfile(path=self.trace, sudo=True))
+
+    def test_cycle_profile_off(self):
+        """
+        Check nothing is logged when cycle_profile is not set
+        """
+        t = int(time.time())
+        jid = self.server.submit(Job(TEST_USER))
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=jid)
+        self.scheduler.log_match('phase=cycle calls=1 ', starttime=t,
+                                 existence=False, max_attempts=5)
+        self.assertFalse(self.du.isfile(path=self.trace, sudo=True))
@@ -0,0 +1,118 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedJobCache(TestFunctional):
+    """
+    Test the scheduler's cross-cycle job status cache, which is kept up to
+    date with the jobs changed since the server's job_change_seq of the
+    previous cycle.
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname,
+                            expect=True)
+        self.scheduler.set_sched_config({'log_filter': 2048})
+
+    def get_chgseq(self):
+        """
+        Return the server's job_change_seq as an (epoch, seq) tuple
+        """
+        svr = self.server.status(SERVER, 'job_change_seq')
+        epoch, seq = svr[0]['job_change_seq'].split(':')
+        return (int(epoch), int(seq))
+
+    def test_chgseq_advances(self):
+        """
+        Test that job_change_seq advances when a job is submitted,
+        modified and deleted, but keeps its epoch
+        """
+        (epoch1, seq1) = self.get_chgseq()
+        j = Job(TEST_USER, {ATTR_h: None})
+        jid = self.server.submit(j)
+        (epoch2, seq2) = self.get_chgseq()
+        self.assertEqual(epoch1, epoch2)
+        self.assertGreater(seq2, seq1)
+
+        self.server.alterjob(jid, {ATTR_N: 'cached'})
+        (epoch3, seq3) = self.get_chgseq()
+        self.assertGreater(seq3, seq2)
+
+        self.server.delete(jid)
+        (epoch4, seq4) = self.get_chgseq()
+        self.assertGreater(seq4, seq3)
+
+    def test_delta_sees_changes(self):
+        """
+        Test that the scheduler notices deleted and modified jobs in
+        the cycles after it cached them
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = Job(TEST_USER)
+        jid1 = self.server.submit(j1)
+        j2 = Job(TEST_USER, {ATTR_h: None})
+        jid2 = self.server.submit(j2)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
+
+        # next cycle uses a delta, the deleted job must be gone and the
+        # released job must be seen as queued
+        t = int(time.time())
+        self.server.delete(jid1, wait=True)
+        self.server.rlsjob(jid2, USER_HOLD)
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid2)
+        self.scheduler.log_match("Applied .* job changes since change "
+                                 "sequence", regexp=True, starttime=t)
+
+    def test_server_restart_resync(self):
+        """
+        Test that the scheduler does a full query when the server
+        restarted, and still runs jobs submitted before the restart
+        """
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = Job(TEST_USER)
+        jid1 = self.server.submit(j1)
+        (epoch1, seq1) = self.get_chgseq()
+        self.server.restart()
+        (epoch2, seq2) = self.get_chgseq()
+        self.assertNotEqual(epoch1, epoch2)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state': 'R'}, id=jid1)
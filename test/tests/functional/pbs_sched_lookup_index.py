@@ -0,0 +1,84 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.functional import *
+
+
+class TestSchedLookupIndex(TestFunctional):
+    """
+    Test that the scheduler's name indexes over nodes and per-entity
+    counts return the same answers as the list walks they replace
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.scheduler.set_sched_config({'log_filter': 2048})
+
+    def test_project_limit_many_entities(self):
+        """
+        Test that a generic project limit is honored for more projects
+        than the scheduler keeps in an unindexed counts list
+        """
+        num_proj = 20
+        a = {'resources_available.ncpus': num_proj * 2}
+        self.server.create_vnodes('vnode', a, 1, self.mom)
+        self.server.manager(MGR_CMD_SET, SERVER,
+                            {'max_run': '[p:PBS_GENERIC=1]'})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        for i in range(num_proj):
+            for _ in range(2):
+                j = Job(TEST_USER, {ATTR_project: 'proj%d' % i})
+                self.server.submit(j)
+
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {'job_state=R': num_proj}, count=True)
+        self.server.expect(JOB, {'job_state=Q': num_proj}, count=True)
+
+    def test_run_on_named_vnodes(self):
+        """
+        Test that a job requesting a vnode by name runs on that vnode
+        when the complex has many vnodes
+        """
+        a = {'resources_available.ncpus': 1}
+        self.server.create_vnodes('vnode', a, 50, self.mom)
+        a = {'Resource_List.select': '1:ncpus=1:vnode=vnode[37]'}
+        j = Job(TEST_USER, a)
+        jid = self.server.submit(j)
+        self.server.expect(JOB, {'job_state': 'R',
+                                 'exec_vnode': '(vnode[37]:ncpus=1)'},
+                           id=jid)
@@ -0,0 +1,93 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedSnapshot(TestFunctional):
+    """
+    Test the scheduler's snapshot_capture option and pbs_sched_replay
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 1},
+                            self.mom.shortname)
+        self.snap = os.path.join(self.server.pbs_conf['PBS_HOME'],
+                                 'sched_priv', 'sched.snapshot')
+        self.du.rm(path=self.snap, sudo=True, force=True)
+
+    def test_capture_and_replay(self):
+        """
+        Capture a cycle that runs one job and leaves one queued, then
+        replay the snapshot offline and check the same decisions are made
+        """
+        self.scheduler.set_sched_config({'snapshot_capture': self.snap})
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        j1 = self.server.submit(Job(TEST_USER))
+        j2 = self.server.submit(Job(TEST_USER))
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'True'})
+        self.server.expect(JOB, {ATTR_state: 'R'}, id=j1)
+        self.server.expect(JOB, {ATTR_state: 'Q'}, id=j2)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        self.assertTrue(self.du.isfile(path=self.snap, sudo=True))
+        lines = self.du.cat(filename=self.snap, sudo=True)['out']
+        self.assertTrue(lines[0].startswith('#PBS scheduler snapshot'))
+
+        replay = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'sbin',
+                              'pbs_sched_replay')
+        ret = self.du.run_cmd(self.server.hostname,
+                              [replay, '-n', '1', self.snap], sudo=True)
+        self.assertEqual(ret['rc'], 0)
+        out = '\n'.join(ret['out'])
+        self.assertIn('cycle 1', out)
+        self.assertIn('not_run\t%s\t' % j2, out)
+        self.assertIn('phase=cycle calls=1 ', out)
+
+    def test_replay_bad_snapshot(self):
+        """
+        Check pbs_sched_replay rejects a file that is not a snapshot
+        """
+        fn = self.du.create_temp_file(body='not a snapshot\n')
+        replay = os.path.join(self.server.pbs_conf['PBS_EXEC'], 'sbin',
+                              'pbs_sched_replay')
+        ret = self.du.run_cmd(self.server.hostname, [replay, fn], sudo=True)
+        self.assertNotEqual(ret['rc'], 0)
+        self.du.rm(path=fn, force=True)
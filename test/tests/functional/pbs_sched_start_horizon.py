@@ -0,0 +1,84 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+from tests.functional import *
+
+
+class TestSchedStartHorizon(TestFunctional):
+    """
+    Test the start time search of top jobs skips calendar events before
+    enough resources can be free
+    """
+
+    def setUp(self):
+        TestFunctional.setUp(self)
+        self.server.manager(MGR_CMD_SET, NODE,
+                            {'resources_available.ncpus': 3},
+                            self.mom.shortname)
+        self.scheduler.set_sched_config({'strict_ordering': 'true ALL',
+                                         'log_filter': 2048})
+
+    def test_top_job_waits_for_free_ncpus(self):
+        """
+        Run three jobs ending at different times, then check a top job
+        needing two ncpus is estimated to start when the second ends
+        """
+        jids = []
+        for w in [100, 200, 300]:
+            a = {'Resource_List.select': '1:ncpus=1',
+                 'Resource_List.walltime': w}
+            J = Job(TEST_USER, attrs=a)
+            J.set_sleep_time(1000)
+            jids.append(self.server.submit(J))
+            self.server.expect(JOB, {ATTR_state: 'R'}, id=jids[-1])
+
+        t = int(time.time())
+        a = {'Resource_List.select': '1:ncpus=2',
+             'Resource_List.walltime': 100}
+        jid = self.server.submit(Job(TEST_USER, attrs=a))
+        self.server.expect(JOB, 'estimated.start_time', op=SET, id=jid)
+        self.scheduler.log_match(jid + ';Not enough resources can be free '
+                                 'for the job before', starttime=t)
+
+        self.server.expect(JOB, ATTR_stime, op=SET, id=jids[1])
+        stime = self.server.status(JOB, ATTR_stime, id=jids[1])[0][ATTR_stime]
+        end = int(time.mktime(time.strptime(stime, '%c'))) + 200
+        est = self.server.status(JOB, 'estimated.start_time',
+                                 id=jid)[0]['estimated.start_time']
+        est = int(time.mktime(time.strptime(est, '%c')))
+        self.assertTrue(end - 5 <= est <= end + 5)
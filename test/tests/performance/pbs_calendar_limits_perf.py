@@ -0,0 +1,110 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestCalendarLimitsPerf(TestPerformance):
+
+    """
+    Time scheduling cycles which check hard limits for many jobs against a
+    calendar full of top jobs.  Each limit check looks up the most each
+    entity will use while the job runs instead of replaying the calendar.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.scheduler.set_sched_config({'log_filter': 2048})
+        a = {'resources_available.ncpus': 100}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+        a = {'backfill_depth': 500,
+             'max_run_res.ncpus': '[u:PBS_GENERIC=60]',
+             'scheduling': 'False'}
+        self.server.manager(MGR_CMD_SET, SERVER, a)
+        self.users = [TEST_USER, TEST_USER1, TEST_USER2, TEST_USER3]
+
+    def run_n_get_cycle_time(self):
+        """
+        Run a scheduling cycle and calculate its duration
+        """
+
+        t = int(time.time())
+
+        # Run only one cycle
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        # Wait for cycle to finish
+        self.scheduler.log_match("Leaving Scheduling Cycle", starttime=t,
+                                 max_attempts=300, interval=3)
+
+        c = self.scheduler.cycles(lastN=1)[0]
+        cycle_time = c.end - c.start
+
+        return cycle_time, t
+
+    @timeout(3600)
+    def test_limits_with_calendar(self):
+        """
+        Fill the calendar with top jobs of several users and time the cycle
+        which checks limits for the rest.  No user may be calendared past
+        its limit.
+        """
+
+        num_jobs = 2000
+        for n in range(num_jobs):
+            a = {'Resource_List.select': '1:ncpus=%d' % (n % 4 + 1),
+                 'Resource_List.walltime': 100 + (n % 50) * 10}
+            J = Job(self.users[n % len(self.users)], attrs=a)
+            J.set_sleep_time(1000)
+            self.server.submit(J)
+
+        cycle_time, t = self.run_n_get_cycle_time()
+        self.logger.info('Cycle time with %d jobs and limits: %d' %
+                         (num_jobs, cycle_time))
+
+        jobs = self.server.status(JOB, ['job_state', 'Job_Owner',
+                                        'Resource_List.ncpus'])
+        for u in self.users:
+            used = 0
+            for j in jobs:
+                if j['job_state'] == 'R' and \
+                        j['Job_Owner'].split('@')[0] == str(u):
+                    used += int(j['Resource_List.ncpus'])
+            self.assertLessEqual(used, 60)
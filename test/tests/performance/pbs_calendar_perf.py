@@ -0,0 +1,123 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestCalendarPerf(TestPerformance):
+
+    """
+    Time scheduling cycles whose calendar holds the end events of many
+    running jobs.  Every calendared job adds its events into the calendar
+    and every cycle builds it from the running jobs.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.scheduler.set_sched_config({'log_filter': 2048,
+                                         'strict_ordering': 'true ALL'})
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'backfill_depth': 100})
+
+        self.num_vnodes = 1000
+        a = {'resources_available.ncpus': 10}
+        self.server.create_vnodes('vnode', a, self.num_vnodes, self.mom,
+                                  sharednode=False)
+
+    def run_n_get_cycle_time(self):
+        """
+        Run a scheduling cycle and calculate its duration
+        """
+
+        t = int(time.time())
+
+        # Run only one cycle
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        # Wait for cycle to finish
+        self.scheduler.log_match("Leaving Scheduling Cycle", starttime=t,
+                                 max_attempts=300, interval=3)
+
+        c = self.scheduler.cycles(lastN=1)[0]
+        cycle_time = c.end - c.start
+
+        return cycle_time
+
+    @timeout(3600)
+    def test_many_running_jobs(self):
+        """
+        Fill the complex with 10000 running subjobs of differing walltimes
+        and time a cycle which calendars 100 top jobs
+        """
+
+        num_arrays = 10
+        subjobs = self.num_vnodes
+        for n in range(num_arrays):
+            a = {'Resource_List.select': '1:ncpus=1',
+                 'Resource_List.walltime': '%d:00:00' % (n + 1),
+                 ATTR_J: '1-%d' % subjobs}
+            J = Job(TEST_USER, attrs=a)
+            J.set_sleep_time(10000)
+            jid = self.server.submit(J)
+            self.server.expect(JOB, {'job_state': 'B'}, id=jid,
+                               max_attempts=120)
+
+        self.server.expect(SERVER, {'server_state': 'Active'})
+        self.server.expect(JOB, {'job_state=R': num_arrays * subjobs},
+                           extend='t', max_attempts=300, interval=5)
+
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        num_top = 100
+        jids = []
+        for n in range(num_top):
+            a = {'Resource_List.select': '%d:ncpus=10' % (n + 1),
+                 'Resource_List.walltime': '1:00:00'}
+            J = Job(TEST_USER, attrs=a)
+            jids.append(self.server.submit(J))
+
+        cycle_time = self.run_n_get_cycle_time()
+        self.logger.info('Cycle time calendaring %d jobs among %d running '
+                         'jobs: %d' % (num_top, num_arrays * subjobs,
+                                       cycle_time))
+
+        self.server.expect(JOB, 'estimated.start_time', op=SET,
+                           id=jids[-1])
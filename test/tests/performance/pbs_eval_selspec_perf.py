@@ -0,0 +1,117 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestEvalSelspecPerf(TestPerformance):
+
+    """
+    Microbenchmark for node selection (eval_selspec()).  Every job
+    evaluates every vnode and fails on the last resource it checks, so
+    the cycle time is dominated by per-vnode resource lookups.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.scheduler.set_sched_config({'log_filter': 2048})
+
+        self.num_res = 20
+        res_list = []
+        for i in range(self.num_res):
+            name = 'res%d' % i
+            a = {'type': 'long', 'flag': 'nh'}
+            self.server.manager(MGR_CMD_CREATE, RSC, a, id=name)
+            res_list.append(name)
+        self.scheduler.add_resource(','.join(res_list))
+
+        a = {'resources_available.ncpus': 4, 'resources_available.mem': '8gb'}
+        for name in res_list:
+            a['resources_available.' + name] = 10
+        self.server.create_vnodes('vnode', a, 5000, self.mom,
+                                  sharednode=False)
+
+    def run_n_get_cycle_time(self):
+        """
+        Run a scheduling cycle and calculate its duration
+        """
+
+        t = int(time.time())
+
+        # Run only one cycle
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        # Wait for cycle to finish
+        self.scheduler.log_match("Leaving Scheduling Cycle", starttime=t,
+                                 max_attempts=300, interval=3)
+
+        c = self.scheduler.cycles(lastN=1)[0]
+        cycle_time = c.end - c.start
+
+        return cycle_time
+
+    @timeout(3600)
+    def test_eval_selspec(self):
+        """
+        Time a cycle of jobs which request every custom resource and can
+        not be placed because the last one is too large
+        """
+
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        chunk = 'ncpus=1:mem=1gb'
+        for i in range(self.num_res - 1):
+            chunk += ':res%d=1' % i
+        chunk += ':res%d=11' % (self.num_res - 1)
+
+        num_jobs = 100
+        for n in range(num_jobs):
+            # Different chunk counts keep the jobs in separate
+            # equivalence classes so each one is evaluated
+            a = {'Resource_List.select': '%d:%s' % (n + 1, chunk),
+                 'Resource_List.place': 'free'}
+            J = Job(TEST_USER, attrs=a)
+            self.server.submit(J)
+
+        cycle_time = self.run_n_get_cycle_time()
+        self.logger.info('eval_selspec cycle time for %d jobs on 5000 '
+                         'vnodes with %d resources: %d' %
+                         (num_jobs, self.num_res, cycle_time))
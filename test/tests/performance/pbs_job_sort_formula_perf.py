@@ -0,0 +1,113 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestJobSortFormulaPerf(TestPerformance):
+
+    """
+    Time scheduling cycles which evaluate job_sort_formula for many queued
+    jobs.  Arithmetic formulas are compiled and evaluated by the scheduler
+    itself, other formulas are evaluated through the embedded Python
+    interpreter.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.scheduler.set_sched_config({'log_filter': 2048})
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+        # keep every job but the first queued
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+        self.num_jobs = 5000
+        self.jids = []
+        for n in range(self.num_jobs):
+            a = {'Resource_List.select': '1:ncpus=1:mem=%dkb' % (n + 1)}
+            J = Job(TEST_USER, attrs=a)
+            self.jids.append(self.server.submit(J))
+
+    def run_n_get_cycle_time(self):
+        """
+        Run a scheduling cycle and calculate its duration
+        """
+
+        t = int(time.time())
+
+        # Run only one cycle
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        # Wait for cycle to finish
+        self.scheduler.log_match("Leaving Scheduling Cycle", starttime=t,
+                                 max_attempts=300, interval=3)
+
+        c = self.scheduler.cycles(lastN=1)[0]
+        cycle_time = c.end - c.start
+
+        return cycle_time, t
+
+    @timeout(3600)
+    def test_compiled_vs_python_formula(self):
+        """
+        Time a cycle with an arithmetic formula and a cycle with the same
+        formula wrapped in a function call which forces it through Python.
+        Both must give the same values.
+        """
+
+        formula = 'ncpus + mem / 1024.0 + job_priority * 10 - eligible_time'
+        forms = [('compiled', formula),
+                 ('python', 'abs(%s)' % formula)]
+        last = self.jids[-1]
+        value = None
+        for (name, f) in forms:
+            self.server.manager(MGR_CMD_SET, SERVER, {'job_sort_formula': f})
+            cycle_time, t = self.run_n_get_cycle_time()
+            self.logger.info('Cycle time with %s formula over %d jobs: %d' %
+                             (name, self.num_jobs, cycle_time))
+
+            m = self.scheduler.log_match(last + ';Formula Evaluation = ',
+                                         starttime=t, max_attempts=10,
+                                         interval=2)
+            v = m[1].split('Formula Evaluation = ')[1]
+            if value is None:
+                value = v
+            self.assertEqual(abs(float(value)), float(v))
@@ -0,0 +1,139 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestNodeEvalThreadsPerf(TestPerformance):
+
+    """
+    Compare cycle times with the node_eval_threads sched_config option
+    set to 1 and 4.  A future reservation on every vnode makes each job
+    walk the calendar on each vnode before it is found not to fit.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.scheduler.set_sched_config({'log_filter': 2048})
+
+        self.num_vnodes = 5000
+        a = {'resources_available.ncpus': 4, 'resources_available.mem': '8gb'}
+        self.server.create_vnodes('vnode', a, self.num_vnodes, self.mom,
+                                  sharednode=False)
+
+        now = int(time.time())
+        a = {'Resource_List.select': '%d:ncpus=4' % self.num_vnodes,
+             'reserve_start': now + 3600,
+             'reserve_end': now + 7200}
+        R = Reservation(TEST_USER, attrs=a)
+        rid = self.server.submit(R)
+        a = {'reserve_state': (MATCH_RE, 'RESV_CONFIRMED|2')}
+        self.server.expect(RESV, a, id=rid, max_attempts=60)
+
+    def run_n_get_cycle_time(self):
+        """
+        Run a scheduling cycle and calculate its duration
+        """
+
+        t = int(time.time())
+
+        # Run only one cycle
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        # Wait for cycle to finish
+        self.scheduler.log_match("Leaving Scheduling Cycle", starttime=t,
+                                 max_attempts=300, interval=3)
+
+        c = self.scheduler.cycles(lastN=1)[0]
+        cycle_time = c.end - c.start
+
+        return cycle_time
+
+    @timeout(3600)
+    def test_node_eval_threads(self):
+        """
+        Time the same cycle serially and with 4 node evaluation threads,
+        and check both cycles come to the same decision
+        """
+
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        num_jobs = 50
+        jids = []
+        for n in range(num_jobs):
+            # Different chunk counts keep the jobs in separate
+            # equivalence classes so each one is evaluated
+            a = {'Resource_List.select': '%d:ncpus=1' % (n + 1),
+                 'Resource_List.place': 'scatter',
+                 'Resource_List.walltime': '2:00:00'}
+            J = Job(TEST_USER, attrs=a)
+            jids.append(self.server.submit(J))
+
+        # A job which fits in front of the reservation is placed the same
+        # way no matter how many threads evaluate the nodes
+        a = {'Resource_List.select': '2:ncpus=1',
+             'Resource_List.place': 'scatter',
+             'Resource_List.walltime': '10:00'}
+        J = Job(TEST_USER, attrs=a)
+        jid_short = self.server.submit(J)
+
+        times = {}
+        comments = {}
+        exec_vnode = {}
+        for nthreads in [1, 4]:
+            self.scheduler.set_sched_config({'node_eval_threads': nthreads})
+            if nthreads != 1:
+                self.server.rerunjob(jid_short)
+                self.server.expect(JOB, {'job_state': 'Q'}, id=jid_short)
+            times[nthreads] = self.run_n_get_cycle_time()
+            self.server.expect(JOB, {'job_state': 'R'}, id=jid_short)
+            exec_vnode[nthreads] = self.server.status(
+                JOB, 'exec_vnode', id=jid_short)[0]['exec_vnode']
+            comments[nthreads] = self.server.status(
+                JOB, 'comment', id=jids[0])[0]['comment']
+            self.logger.info('Cycle time with %d node eval threads for %d '
+                             'jobs on %d vnodes: %d' %
+                             (nthreads, num_jobs, self.num_vnodes,
+                              times[nthreads]))
+
+        self.assertEqual(exec_vnode[1], exec_vnode[4])
+        self.assertEqual(comments[1].split(':', 1)[1],
+                         comments[4].split(':', 1)[1])
@@ -0,0 +1,129 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestPreemptionPerf(TestPerformance):
+
+    """
+    Measure the cost of a scheduling cycle that preempts jobs.  Each
+    preemption attempt simulates the complex on a copy of the server
+    universe, so the cycle time grows with the number of running jobs.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.scheduler.set_sched_config({'log_filter': 2048})
+
+        a = {'queue_type': 'execution', 'started': 'True',
+             'enabled': 'True', 'priority': 200}
+        self.server.manager(MGR_CMD_CREATE, QUEUE, a, id='expressq')
+
+    def run_n_get_cycle_time(self):
+        """
+        Run a scheduling cycle and calculate its duration
+        """
+
+        t = int(time.time())
+
+        # Run only one cycle
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+
+        # Wait for cycle to finish
+        self.scheduler.log_match("Leaving Scheduling Cycle", starttime=t,
+                                 max_attempts=300, interval=3)
+
+        c = self.scheduler.cycles(lastN=1)[0]
+        cycle_time = c.end - c.start
+
+        return cycle_time
+
+    def preempt_cycle_time(self, num_nodes):
+        """
+        Fill num_nodes vnodes with single cpu jobs and time the cycle
+        that preempts half of them for one express queue job
+        """
+
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        a = {'resources_available.ncpus': 1, 'resources_available.mem': '1gb'}
+        self.server.create_vnodes('vnode', a, num_nodes, self.mom,
+                                  sharednode=False)
+
+        a = {'Resource_List.select': '1:ncpus=1',
+             'Resource_List.walltime': 3600}
+        J = Job(TEST_USER, attrs=a)
+        J.set_attributes({ATTR_J: '1-%d' % num_nodes})
+        jid = self.server.submit(J)
+        self.server.expect(JOB, {'job_state': 'B'}, id=jid)
+        self.server.expect(JOB, {'job_state=R': num_nodes}, count=True,
+                           extend='t', interval=5, max_attempts=120)
+
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'False'})
+        a = {'Resource_List.select': '%d:ncpus=1' % (num_nodes // 2),
+             'Resource_List.place': 'free', 'queue': 'expressq'}
+        hj = Job(TEST_USER, attrs=a)
+        hjid = self.server.submit(hj)
+
+        cycle_time = self.run_n_get_cycle_time()
+        self.server.expect(JOB, {'job_state': 'R'}, id=hjid)
+
+        self.server.manager(MGR_CMD_SET, MGR_OBJ_SERVER,
+                            {'scheduling': 'True'})
+        self.server.cleanup_jobs()
+        return cycle_time
+
+    @timeout(7200)
+    def test_preemption_cycle_time(self):
+        """
+        Report the preemption cycle time as the number of running
+        jobs grows.  The time should not grow faster than the size
+        of the complex.
+        """
+
+        times = {}
+        for n in [500, 1000, 2000]:
+            times[n] = self.preempt_cycle_time(n)
+            self.logger.info('Nodes: %d Preemption cycle time: %d' %
+                             (n, times[n]))
+
+        self.assertLessEqual(times[2000], max(times[500], 1) * 4 * 2)
@@ -0,0 +1,98 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+
+import os
+
+from tests.performance import *
+
+
+class TestQstatPagingPerf(TestPerformance):
+
+    """
+    Status more jobs than fit in one page.  The server streams the status
+    of the jobs of a queue or of the server.  qstat fetches it a page at
+    a time and pbs_statjob() in one reply.  No job may be missed or listed
+    twice.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        self.qstat = os.path.join(self.server.client_conf['PBS_EXEC'],
+                                  'bin', 'qstat')
+
+    def qstat_ids(self, args):
+        """
+        Run qstat with args and return the job ids it lists, timing it
+        """
+        t = time.time()
+        ret = self.du.run_cmd(self.server.hostname,
+                              self.qstat + ' ' + args, as_script=True)
+        self.assertEqual(ret['rc'], 0)
+        self.logger.info('qstat %s took %.2f seconds' %
+                         (args, time.time() - t))
+        return [l.split()[0] for l in ret['out'] if l and l[0].isdigit()]
+
+    @timeout(3600)
+    def test_page_through_jobs(self):
+        """
+        Submit 2500 jobs with an Array job between them and list them with
+        qstat, qstat -t and pbs_statjob()
+        """
+        num_jobs = 2500
+        j = Job(TEST_USER)
+        j.set_sleep_time(1000)
+        for n in range(num_jobs):
+            if n == 1200:
+                a = Job(TEST_USER, attrs={ATTR_J: '1-5'})
+                a.set_sleep_time(1000)
+                self.server.submit(a)
+            self.server.submit(j)
+
+        for args in ['', 'workq']:
+            ids = self.qstat_ids(args)
+            self.assertEqual(len(ids), num_jobs + 1)
+            self.assertEqual(len(set(ids)), num_jobs + 1)
+
+        ids = self.qstat_ids('-t')
+        self.assertEqual(len(ids), num_jobs + 6)
+        self.assertEqual(len(set(ids)), num_jobs + 6)
+
+        jobs = self.server.status(JOB, 'job_state')
+        self.assertEqual(len(jobs), num_jobs + 1)
+        self.assertEqual(len(set([x['id'] for x in jobs])), num_jobs + 1)
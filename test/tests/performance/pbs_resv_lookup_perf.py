@@ -0,0 +1,96 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestResvLookupPerf(TestPerformance):
+    """
+    Time job submission on a server with thousands of reservations.  Every
+    submission looks up its queue, and a reservation queue also looks up
+    its reservation, so these lookups must not scan all the queues and
+    reservations.
+    """
+
+    def setUp(self):
+        TestPerformance.setUp(self)
+        a = {'resources_available.ncpus': 1}
+        self.server.manager(MGR_CMD_SET, NODE, a, self.mom.shortname)
+
+    def submit_jobs(self, num, queue=None):
+        """
+        Submit num jobs, to queue if given, and return the time it took
+        """
+        a = {}
+        if queue is not None:
+            a[ATTR_queue] = queue
+        start = time.time()
+        for _ in range(num):
+            j = Job(TEST_USER, attrs=a)
+            self.server.submit(j)
+        return time.time() - start
+
+    @timeout(14400)
+    def test_submit_with_many_resvs(self):
+        """
+        Create 5000 confirmed reservations in disjoint windows, then time
+        job submissions to the default queue and to a reservation queue
+        """
+        num_resvs = 5000
+        num_jobs = 1000
+        now = int(time.time())
+        rids = []
+        for n in range(num_resvs):
+            start = now + 3600 + n * 120
+            a = {'Resource_List.select': '1:ncpus=1',
+                 'reserve_start': start, 'reserve_end': start + 60}
+            r = Reservation(TEST_USER, a)
+            rids.append(self.server.submit(r))
+        a = {'reserve_state': (MATCH_RE, "RESV_CONFIRMED|2")}
+        self.server.expect(RESV, a, id=rids[-1], max_attempts=600,
+                           interval=5)
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+
+        dflt_time = self.submit_jobs(num_jobs)
+        resvq = rids[-1].split('.')[0]
+        resv_time = self.submit_jobs(num_jobs, queue=resvq)
+        self.logger.info('Submitted %d jobs with %d reservations: '
+                         'default queue %.2f sec, reservation queue %.2f '
+                         'sec' % (num_jobs, num_resvs, dflt_time, resv_time))
+
+        self.server.expect(JOB, {'job_state=Q': 2 * num_jobs}, count=True)
+        self.server.expect(RESV, a, id=rids[0])
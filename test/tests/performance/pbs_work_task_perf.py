@@ -0,0 +1,77 @@
+# coding: utf-8
+
+# Copyright (C) 1994-2018 Altair Engineering, Inc.
+# For more information, contact Altair at www.altair.com.
+#
+# This file is part of the PBS Professional ("PBS Pro") software.
+#
+# Open Source License Information:
+#
+# PBS Pro is free software. You can redistribute it and/or modify it under the
+# terms of the GNU Affero General Public License as published by the Free
+# Software Foundation, either version 3 of the License, or (at your option) any
+# later version.
+#
+# PBS Pro is distributed in the hope that it will be useful, but WITHOUT ANY
+# WARRANTY; without even the implied warranty of MERCHANTABILITY or FITNESS
+# FOR A PARTICULAR PURPOSE.
+# See the GNU Affero General Public License for more details.
+#
+# You should have received a copy of the GNU Affero General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Commercial License Information:
+#
+# For a copy of the commercial license terms and conditions,
+# go to: (http://www.pbspro.com/UserArea/agreement.html)
+# or contact the Altair Legal Department.
+#
+# Altair’s dual-license business model allows companies, individuals, and
+# organizations to create proprietary derivative works of PBS Pro and
+# distribute them - whether embedded or bundled with other software -
+# under a commercial license agreement.
+#
+# Use of Altair’s trademarks, including but not limited to "PBS™",
+# "PBS Professional®", and "PBS Pro™" and Altair’s logos is subject to Altair's
+# trademark licensing policies.
+
+from tests.performance import *
+
+
+class TestWorkTaskPerf(TestPerformance):
+    """
+    Time the server's timed work tasks.  Every job with an execution time
+    has a timed task that ends its wait, so submitting, altering and
+    deleting many such jobs adds and cancels many timed tasks.
+    """
+
+    @timeout(7200)
+    def test_many_waiting_jobs(self):
+        """
+        Submit 10000 jobs with execution times in the future, time the
+        submission and their deletion, and check that moving one job's
+        execution time forward still releases it from the wait
+        """
+        num_jobs = 10000
+        self.server.manager(MGR_CMD_SET, SERVER, {'scheduling': 'False'})
+        now = int(time.time())
+        jids = []
+        start = time.time()
+        for n in range(num_jobs):
+            a = {ATTR_a: time.strftime('%Y%m%d%H%M.%S',
+                                       time.localtime(now + 3600 + n))}
+            j = Job(TEST_USER, attrs=a)
+            jids.append(self.server.submit(j))
+        sub_time = time.time() - start
+        self.server.expect(JOB, {'job_state=W': num_jobs}, count=True)
+
+        a = {ATTR_a: time.strftime('%Y%m%d%H%M.%S',
+                                   time.localtime(int(time.time()) + 10))}
+        self.server.alterjob(jids[-1], a)
+        self.server.expect(JOB, {'job_state': 'Q'}, id=jids[-1], offset=10)
+
+        start = time.time()
+        self.server.delete(jids, wait=True)
+        del_time = time.time() - start
+        self.logger.info('%d waiting jobs: submit %.2f sec, delete %.2f sec'
+                         % (num_jobs, sub_time, del_time))